@@ -235,6 +235,8 @@ FawkesMainThread::once()
     throw;
   }
 
+  Time plugin_load_start(clock_);
+
   // if plugins passed on command line or in init options, load!
   if ( load_plugins_) {
     try {
@@ -280,6 +282,10 @@ FawkesMainThread::once()
     }
   }
 
+  Time plugin_load_end(clock_);
+  multi_logger_->log_debug("FawkesMainThread", "Initial plugins loaded in %.2f sec",
+                           plugin_load_end - &plugin_load_start);
+
   if (init_barrier_)  init_barrier_->wait();
 }
 
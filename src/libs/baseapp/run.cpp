@@ -242,7 +242,11 @@ init(const InitOptions& options, int & retval)
     config = new YamlConfiguration(CONFDIR);
   }
 
+  Time config_load_start;
   config->load(options.config_file());
+  Time config_load_end;
+  logger->log_debug("FawkesMainThread", "Configuration loaded in %.1f ms",
+                    (config_load_end - &config_load_start) * 1000.);
 
   if (sqconfig) {
     try {
@@ -323,6 +327,15 @@ init(const InitOptions& options, int & retval)
     } catch (Exception &e) {}  // ignore, we stick with the default
   }
 
+  unsigned int net_io_threads = 2;
+  unsigned int net_max_send_queue_kb = 16384;
+  try {
+    net_io_threads = config->get_uint("/network/fawkes/io_threads");
+  } catch (Exception &e) {}  // ignore, we stick with the default
+  try {
+    net_max_send_queue_kb = config->get_uint("/network/fawkes/max_send_queue_kb");
+  } catch (Exception &e) {}  // ignore, we stick with the default
+
   if (net_tcp_port > 65535) {
     logger->log_warn("FawkesMainThread", "Invalid port '%u', using 1910",
 		     net_tcp_port);
@@ -410,7 +423,9 @@ init(const InitOptions& options, int & retval)
                                                 enable_ipv4, enable_ipv6,
                                                 listen_ipv4, listen_ipv6,
                                                 net_tcp_port,
-                                                net_service_name.c_str());
+                                                net_service_name.c_str(),
+                                                net_io_threads,
+                                                (size_t)net_max_send_queue_kb * 1024);
 #  ifdef HAVE_CONFIG_NETWORK_HANDLER
   nethandler_config  = new ConfigNetworkHandler(config,
                                                 network_manager->hub());
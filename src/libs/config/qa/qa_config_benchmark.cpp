@@ -0,0 +1,150 @@
+
+/***************************************************************************
+ *  qa_config_benchmark.cpp - Benchmark configuration value access
+ *
+ *  Created: Sun Oct 18 19:12:40 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+/// @cond QA
+
+#include <config/yaml.h>
+#include <config/memory.h>
+#include <config/sqlite.h>
+#include <config/snapshot.h>
+#include <config/value.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace fawkes;
+
+#define PATH "/fawkes/mainapp/blackboard_size"
+
+template <typename F>
+static void
+run(const char *name, unsigned int iterations, F f)
+{
+  volatile unsigned int sink = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (unsigned int i = 0; i < iterations; ++i) {
+    sink += f();
+  }
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+  double sec = std::chrono::duration<double>(end - start).count();
+  printf("%-32s %10u gets in %8.3f sec  %12.0f gets/sec  %8.1f ns/get\n",
+         name, iterations, sec, iterations / sec, sec * 1e9 / iterations);
+  (void)sink;
+}
+
+int
+main(int argc, char **argv)
+{
+  unsigned int iterations = 1000000;
+  if (argc > 1)  iterations = atoi(argv[1]);
+
+  YamlConfiguration *yaml = new YamlConfiguration(CONFDIR);
+  try {
+    yaml->load("config.yaml");
+  } catch (Exception &e) {
+    e.print_trace();
+    return -1;
+  }
+
+  MemoryConfiguration *memory = new MemoryConfiguration();
+  memory->set_uint(PATH, yaml->get_uint(PATH));
+
+  SQLiteConfiguration *sqlite = new SQLiteConfiguration();
+  try {
+    sqlite->load(":memory:");
+    sqlite->set_uint(PATH, yaml->get_uint(PATH));
+  } catch (Exception &e) {
+    e.print_trace();
+    return -1;
+  }
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  ConfigurationSnapshot *snapshot = new ConfigurationSnapshot(yaml);
+  double snap_sec =
+    std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  printf("Snapshot of %zu values took %.3f ms\n\n", snapshot->size(), snap_sec * 1000.);
+
+  ConfigValue<unsigned int> *value = new ConfigValue<unsigned int>(yaml, PATH);
+  ConfigurationSnapshot *sqlite_snapshot = new ConfigurationSnapshot(sqlite);
+  ConfigValue<unsigned int> *sqlite_value = new ConfigValue<unsigned int>(sqlite, PATH);
+  std::string path = PATH;
+
+  run("YamlConfiguration", iterations, [&]() { return yaml->get_uint(PATH); });
+  run("MemoryConfiguration", iterations, [&]() { return memory->get_uint(PATH); });
+  run("SQLiteConfiguration", iterations, [&]() { return sqlite->get_uint(PATH); });
+  run("ConfigurationSnapshot", iterations, [&]() { return snapshot->get_uint(path); });
+  run("ConfigurationSnapshot (SQLite)", iterations,
+      [&]() { return sqlite_snapshot->get_uint(path); });
+  run("ConfigValue", iterations, [&]() { return value->get(); });
+  run("ConfigValue (SQLite)", iterations, [&]() { return sqlite_value->get(); });
+
+  // the SQLite backend notifies change handlers, both the snapshot and
+  // the value handle must follow changes, also beyond the history size,
+  // while entries found before remain unchanged
+  int rv = 0;
+  std::shared_ptr<const ConfigurationSnapshot::Entry> kept = sqlite_snapshot->find(path);
+  unsigned int kept_value = kept->u;
+  for (unsigned int i = 1; i <= 2 * CONFIG_VALUE_HISTORY_SIZE; ++i) {
+    sqlite->set_uint(PATH, i);
+    if (sqlite_value->get() != i || sqlite_snapshot->get_uint(path) != i) {
+      printf("\nChange %u not reflected: value %u  snapshot %u\n",
+             i, sqlite_value->get(), sqlite_snapshot->get_uint(path));
+      rv = 1;
+    }
+  }
+  if (rv == 0) {
+    printf("\nSnapshot and value handle followed %u changes\n",
+           sqlite_value->num_updates());
+  }
+
+  if (kept->u != kept_value) {
+    printf("Entry found before changes was modified\n");
+    rv = 1;
+  }
+
+  // integer lists are valid float lists
+  std::vector<unsigned int> uints = {1, 2, 3};
+  memory->set_uints("/qa/list", uints);
+  ConfigurationSnapshot *memory_snapshot = new ConfigurationSnapshot(memory, "/qa");
+  std::vector<float> floats = memory_snapshot->get_floats("/qa/list");
+  if (floats != std::vector<float>({1.f, 2.f, 3.f})) {
+    printf("Unsigned int list not read as float list\n");
+    rv = 1;
+  }
+
+  delete memory_snapshot;
+  delete sqlite_value;
+  delete sqlite_snapshot;
+  delete value;
+  delete snapshot;
+  delete sqlite;
+  delete memory;
+  delete yaml;
+  return rv;
+}
+
+/// @endcond
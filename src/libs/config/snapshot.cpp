@@ -0,0 +1,423 @@
+
+/***************************************************************************
+ *  snapshot.cpp - Immutable hash-indexed configuration snapshot
+ *
+ *  Created: Sun Oct 18 18:10:32 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#include <config/snapshot.h>
+#include <core/threading/mutex_locker.h>
+
+#include <climits>
+
+namespace fawkes {
+
+/** @class ConfigurationSnapshot <config/snapshot.h>
+ * Hash-indexed snapshot of a configuration.
+ * All values below a given prefix are read once from the configuration
+ * and stored in a hash map indexed by their full path. Lookups cost a
+ * single hash computation and do not require locking the configuration.
+ *
+ * The snapshot registers as change handler for its prefix. Each path
+ * has a slot holding its current entry, a changed value is read into a
+ * new entry which atomically replaces the one in the slot. Only adding
+ * or erasing a path requires a new map, which is a copy of the current
+ * one sharing all other entries and atomically replaces it. Maps and
+ * entries are reference counted, readers keep them alive for as long
+ * as they use them.
+ *
+ * The getters behave like the ones of the configuration backends, they
+ * throw a ConfigEntryNotFoundException if the value does not exist and
+ * a ConfigTypeMismatchException if it has a different type.
+ * @author agent
+ */
+
+/** Constructor.
+ * @param config configuration to read values from
+ * @param prefix only read values with this path prefix
+ */
+ConfigurationSnapshot::ConfigurationSnapshot(Configuration *config, const char *prefix)
+	: ConfigurationChangeHandler(prefix), config_(config)
+{
+	std::shared_ptr<EntryMap> entries(new EntryMap());
+	config_->lock();
+	try {
+		std::unique_ptr<Configuration::ValueIterator> v(config_->search(prefix));
+		while (v->next()) {
+			std::shared_ptr<Entry> e(new Entry());
+			read_entry(v.get(), *e);
+			(*entries)[v->path()].entry = e;
+		}
+	} catch (Exception &e) {
+		config_->unlock();
+		throw;
+	}
+	std::atomic_store(&entries_, entries);
+	// register while locked, no change between reading and registering
+	config_->add_change_handler(this);
+	config_->unlock();
+}
+
+
+/** Destructor. */
+ConfigurationSnapshot::~ConfigurationSnapshot()
+{
+	config_->rem_change_handler(this);
+}
+
+
+void
+ConfigurationSnapshot::config_tag_changed(const char *new_tag)
+{
+}
+
+
+void
+ConfigurationSnapshot::config_value_changed(const Configuration::ValueIterator *v)
+{
+	std::shared_ptr<Entry> e(new Entry());
+	try {
+		read_entry(v, *e);
+	} catch (Exception &ex) {
+		// could not read value, keep the previous one
+		return;
+	}
+
+	MutexLocker lock(&update_mutex_);
+	std::shared_ptr<EntryMap> entries = std::atomic_load(&entries_);
+	EntryMap::iterator s = entries->find(v->path());
+	if (s != entries->end()) {
+		std::atomic_store(&s->second.entry, std::shared_ptr<const Entry>(e));
+	} else {
+		// the set of paths of a published map is never modified
+		std::shared_ptr<EntryMap> new_entries(new EntryMap(*entries));
+		(*new_entries)[v->path()].entry = e;
+		std::atomic_store(&entries_, new_entries);
+	}
+}
+
+
+void
+ConfigurationSnapshot::config_comment_changed(const Configuration::ValueIterator *v)
+{
+}
+
+
+void
+ConfigurationSnapshot::config_value_erased(const char *path)
+{
+	MutexLocker lock(&update_mutex_);
+	std::shared_ptr<EntryMap> entries = std::atomic_load(&entries_);
+	if (entries->find(path) == entries->end())  return;
+
+	std::shared_ptr<EntryMap> new_entries(new EntryMap(*entries));
+	new_entries->erase(path);
+	std::atomic_store(&entries_, new_entries);
+}
+
+
+/** Read value into entry.
+ * @param v value iterator pointing at the value to read
+ * @param e entry to fill
+ */
+void
+ConfigurationSnapshot::read_entry(const Configuration::ValueIterator *v, Entry &e)
+{
+	e.is_list = v->is_list();
+	// most specific type first, integers are also valid floats
+	if (v->is_uint()) {
+		e.type = TYPE_UINT;
+		if (e.is_list) e.us = v->get_uints();
+		else           e.u  = v->get_uint();
+	} else if (v->is_int()) {
+		e.type = TYPE_INT;
+		if (e.is_list) e.is = v->get_ints();
+		else           e.i  = v->get_int();
+	} else if (v->is_float()) {
+		e.type = TYPE_FLOAT;
+		if (e.is_list) e.fs = v->get_floats();
+		else           e.f  = v->get_float();
+	} else if (v->is_bool()) {
+		e.type = TYPE_BOOL;
+		if (e.is_list) e.bs = v->get_bools();
+		else           e.b  = v->get_bool();
+	} else {
+		e.type = TYPE_STRING;
+		if (e.is_list) e.ss = v->get_strings();
+		else           e.s  = v->get_string();
+	}
+}
+
+
+/** Get number of values in snapshot.
+ * @return number of values
+ */
+size_t
+ConfigurationSnapshot::size() const
+{
+	return std::atomic_load(&entries_)->size();
+}
+
+
+/** Find entry.
+ * The returned entry is not modified, a changed value is stored in a new
+ * entry. Find the entry again to see changes.
+ * @param path path to value
+ * @return entry or an empty pointer if no value exists for the given path
+ */
+std::shared_ptr<const ConfigurationSnapshot::Entry>
+ConfigurationSnapshot::find(const std::string &path) const
+{
+	std::shared_ptr<EntryMap> entries = std::atomic_load(&entries_);
+	EntryMap::const_iterator s = entries->find(path);
+	if (s == entries->end()) return std::shared_ptr<const Entry>();
+	return std::atomic_load(&s->second.entry);
+}
+
+
+std::shared_ptr<const ConfigurationSnapshot::Entry>
+ConfigurationSnapshot::get_entry(const std::string &path, value_type_t type,
+                                 bool is_list, const char *requested) const
+{
+	std::shared_ptr<const Entry> e = find(path);
+	if (! e) {
+		throw ConfigEntryNotFoundException(path.c_str());
+	}
+	if (e->is_list != is_list) {
+		throw ConfigTypeMismatchException(path.c_str(),
+		                                  e->is_list ? "list" : "scalar",
+		                                  is_list ? "list" : "scalar");
+	}
+	bool matches = (e->type == type);
+	// allow implicit numeric widening as the backends do
+	if (! matches) {
+		if (type == TYPE_FLOAT) {
+			matches = (e->type == TYPE_UINT || e->type == TYPE_INT);
+		} else if (type == TYPE_INT && e->type == TYPE_UINT) {
+			if (is_list) {
+				matches = true;
+				for (unsigned int u : e->us) {
+					if (u > (unsigned int)INT_MAX) {
+						matches = false;
+						break;
+					}
+				}
+			} else {
+				matches = (e->u <= (unsigned int)INT_MAX);
+			}
+		}
+	}
+	if (! matches) {
+		static const char *type_names[] = {"float", "unsigned int", "int", "bool", "string"};
+		throw ConfigTypeMismatchException(path.c_str(), type_names[e->type], requested);
+	}
+	return e;
+}
+
+
+/** Check if a value exists.
+ * @param path path to value
+ * @return true if the value exists, false otherwise
+ */
+bool
+ConfigurationSnapshot::exists(const std::string &path) const
+{
+	return (find(path) != NULL);
+}
+
+/** Check if a value is of type float.
+ * @param path path to value
+ * @return true if the value exists and is of type float
+ */
+bool
+ConfigurationSnapshot::is_float(const std::string &path) const
+{
+	std::shared_ptr<const Entry> e = find(path);
+	return e && e->type == TYPE_FLOAT;
+}
+
+/** Check if a value is of type unsigned int.
+ * @param path path to value
+ * @return true if the value exists and is of type unsigned int
+ */
+bool
+ConfigurationSnapshot::is_uint(const std::string &path) const
+{
+	std::shared_ptr<const Entry> e = find(path);
+	return e && e->type == TYPE_UINT;
+}
+
+/** Check if a value is of type int.
+ * @param path path to value
+ * @return true if the value exists and is of type int
+ */
+bool
+ConfigurationSnapshot::is_int(const std::string &path) const
+{
+	std::shared_ptr<const Entry> e = find(path);
+	return e && e->type == TYPE_INT;
+}
+
+/** Check if a value is of type bool.
+ * @param path path to value
+ * @return true if the value exists and is of type bool
+ */
+bool
+ConfigurationSnapshot::is_bool(const std::string &path) const
+{
+	std::shared_ptr<const Entry> e = find(path);
+	return e && e->type == TYPE_BOOL;
+}
+
+/** Check if a value is of type string.
+ * @param path path to value
+ * @return true if the value exists and is of type string
+ */
+bool
+ConfigurationSnapshot::is_string(const std::string &path) const
+{
+	std::shared_ptr<const Entry> e = find(path);
+	return e && e->type == TYPE_STRING;
+}
+
+/** Check if a value is a list.
+ * @param path path to value
+ * @return true if the value exists and is a list
+ */
+bool
+ConfigurationSnapshot::is_list(const std::string &path) const
+{
+	std::shared_ptr<const Entry> e = find(path);
+	return e && e->is_list;
+}
+
+
+/** Get float value.
+ * @param path path to value
+ * @return value
+ */
+float
+ConfigurationSnapshot::get_float(const std::string &path) const
+{
+	std::shared_ptr<const Entry> e = get_entry(path, TYPE_FLOAT, false, "float");
+	switch (e->type) {
+	case TYPE_UINT: return e->u;
+	case TYPE_INT: return e->i;
+	default: return e->f;
+	}
+}
+
+/** Get unsigned int value.
+ * @param path path to value
+ * @return value
+ */
+unsigned int
+ConfigurationSnapshot::get_uint(const std::string &path) const
+{
+	return get_entry(path, TYPE_UINT, false, "unsigned int")->u;
+}
+
+/** Get int value.
+ * @param path path to value
+ * @return value
+ */
+int
+ConfigurationSnapshot::get_int(const std::string &path) const
+{
+	std::shared_ptr<const Entry> e = get_entry(path, TYPE_INT, false, "int");
+	return (e->type == TYPE_UINT) ? (int)e->u : e->i;
+}
+
+/** Get bool value.
+ * @param path path to value
+ * @return value
+ */
+bool
+ConfigurationSnapshot::get_bool(const std::string &path) const
+{
+	return get_entry(path, TYPE_BOOL, false, "bool")->b;
+}
+
+/** Get string value.
+ * @param path path to value
+ * @return value
+ */
+std::string
+ConfigurationSnapshot::get_string(const std::string &path) const
+{
+	return get_entry(path, TYPE_STRING, false, "string")->s;
+}
+
+/** Get list of float values.
+ * @param path path to value
+ * @return values
+ */
+std::vector<float>
+ConfigurationSnapshot::get_floats(const std::string &path) const
+{
+	std::shared_ptr<const Entry> e = get_entry(path, TYPE_FLOAT, true, "float");
+	switch (e->type) {
+	case TYPE_UINT: return std::vector<float>(e->us.begin(), e->us.end());
+	case TYPE_INT: return std::vector<float>(e->is.begin(), e->is.end());
+	default: return e->fs;
+	}
+}
+
+/** Get list of unsigned int values.
+ * @param path path to value
+ * @return values
+ */
+std::vector<unsigned int>
+ConfigurationSnapshot::get_uints(const std::string &path) const
+{
+	return get_entry(path, TYPE_UINT, true, "unsigned int")->us;
+}
+
+/** Get list of int values.
+ * @param path path to value
+ * @return values
+ */
+std::vector<int>
+ConfigurationSnapshot::get_ints(const std::string &path) const
+{
+	std::shared_ptr<const Entry> e = get_entry(path, TYPE_INT, true, "int");
+	if (e->type == TYPE_UINT) return std::vector<int>(e->us.begin(), e->us.end());
+	return e->is;
+}
+
+/** Get list of bool values.
+ * @param path path to value
+ * @return values
+ */
+std::vector<bool>
+ConfigurationSnapshot::get_bools(const std::string &path) const
+{
+	return get_entry(path, TYPE_BOOL, true, "bool")->bs;
+}
+
+/** Get list of string values.
+ * @param path path to value
+ * @return values
+ */
+std::vector<std::string>
+ConfigurationSnapshot::get_strings(const std::string &path) const
+{
+	return get_entry(path, TYPE_STRING, true, "string")->ss;
+}
+
+} // end namespace fawkes
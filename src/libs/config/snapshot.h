@@ -0,0 +1,119 @@
+
+/***************************************************************************
+ *  snapshot.h - Immutable hash-indexed configuration snapshot
+ *
+ *  Created: Sun Oct 18 18:10:32 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#ifndef _CONFIG_SNAPSHOT_H_
+#define _CONFIG_SNAPSHOT_H_
+
+#include <config/config.h>
+#include <config/change_handler.h>
+#include <core/threading/mutex.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace fawkes {
+
+class ConfigurationSnapshot : public ConfigurationChangeHandler
+{
+ public:
+	/** Type of a snapshot entry. */
+	typedef enum {
+		TYPE_FLOAT,	///< float value
+		TYPE_UINT,	///< unsigned int value
+		TYPE_INT,	///< int value
+		TYPE_BOOL,	///< bool value
+		TYPE_STRING	///< string value
+	} value_type_t;
+
+	/** Single value of a snapshot. */
+	class Entry {
+	 public:
+		value_type_t               type;     ///< value type
+		bool                       is_list;  ///< true if the value is a list
+		float                      f;        ///< float value
+		unsigned int               u;        ///< unsigned int value
+		int                        i;        ///< int value
+		bool                       b;        ///< bool value
+		std::string                s;        ///< string value
+		std::vector<float>         fs;       ///< float list
+		std::vector<unsigned int>  us;       ///< unsigned int list
+		std::vector<int>           is;       ///< int list
+		std::vector<bool>          bs;       ///< bool list
+		std::vector<std::string>   ss;       ///< string list
+	};
+
+	ConfigurationSnapshot(Configuration *config, const char *prefix = "/");
+	virtual ~ConfigurationSnapshot();
+
+	size_t        size() const;
+	std::shared_ptr<const Entry> find(const std::string &path) const;
+	bool          exists(const std::string &path) const;
+
+	bool          is_float(const std::string &path) const;
+	bool          is_uint(const std::string &path) const;
+	bool          is_int(const std::string &path) const;
+	bool          is_bool(const std::string &path) const;
+	bool          is_string(const std::string &path) const;
+	bool          is_list(const std::string &path) const;
+
+	float         get_float(const std::string &path) const;
+	unsigned int  get_uint(const std::string &path) const;
+	int           get_int(const std::string &path) const;
+	bool          get_bool(const std::string &path) const;
+	std::string   get_string(const std::string &path) const;
+
+	std::vector<float>         get_floats(const std::string &path) const;
+	std::vector<unsigned int>  get_uints(const std::string &path) const;
+	std::vector<int>           get_ints(const std::string &path) const;
+	std::vector<bool>          get_bools(const std::string &path) const;
+	std::vector<std::string>   get_strings(const std::string &path) const;
+
+	static void   read_entry(const Configuration::ValueIterator *v, Entry &e);
+
+	virtual void config_tag_changed(const char *new_tag);
+	virtual void config_value_changed(const Configuration::ValueIterator *v);
+	virtual void config_comment_changed(const Configuration::ValueIterator *v);
+	virtual void config_value_erased(const char *path);
+
+ private:
+	/// @cond INTERNALS
+	class Slot {
+	 public:
+		std::shared_ptr<const Entry> entry;
+	};
+	/// @endcond
+	typedef std::unordered_map<std::string, Slot> EntryMap;
+
+	std::shared_ptr<const Entry> get_entry(const std::string &path, value_type_t type,
+	                                       bool is_list, const char *requested) const;
+
+ private:
+	Configuration                         *config_;
+	Mutex                                  update_mutex_;
+	std::shared_ptr<EntryMap>              entries_;
+};
+
+} // end namespace fawkes
+
+#endif
@@ -0,0 +1,169 @@
+
+/***************************************************************************
+ *  value.cpp - Typed configuration value handles
+ *
+ *  Created: Sun Oct 18 18:47:05 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#include <config/value.h>
+
+#include <cstring>
+
+namespace fawkes {
+
+/** @class ConfigValueBase <config/value.h>
+ * Type-independent base of configuration value handles.
+ * Registers as change handler for the exact path of the value and
+ * forwards changes to the typed handle.
+ * @author agent
+ */
+
+/** @class ConfigValue <config/value.h>
+ * Typed configuration value handle.
+ * The value is looked up once on construction. Afterwards get() merely
+ * dereferences an atomic pointer, it neither locks the configuration nor
+ * parses the path. The handle registers itself as a change handler and
+ * atomically replaces the value whenever it is modified, for example if
+ * a YAML file is edited and reloaded. Use these handles for values that
+ * are read in a thread's loop(). The values are stored in a ring of
+ * CONFIG_VALUE_HISTORY_SIZE slots, a new value overwrites the oldest one,
+ * hence memory does not grow with the number of changes.
+ * @code
+ * ConfigValue<float> max_vel(config, "/plugins/foo/max_velocity");
+ * ...
+ * float v = max_vel.get();
+ * @endcode
+ * Supported types are float, unsigned int, int, bool, std::string and
+ * std::vector of these.
+ * @author agent
+ */
+
+/** Constructor.
+ * @param config configuration to read value from
+ * @param path path to value
+ */
+ConfigValueBase::ConfigValueBase(Configuration *config, const char *path)
+	: ConfigurationChangeHandler(path),
+	  config_(config), path_(path), registered_(false), num_updates_(0)
+{
+}
+
+
+/** Destructor. */
+ConfigValueBase::~ConfigValueBase()
+{
+	unregister_handler();
+}
+
+
+/** Get path of value.
+ * @return path of value
+ */
+const char *
+ConfigValueBase::path() const
+{
+	return path_.c_str();
+}
+
+
+/** Get number of updates.
+ * @return number of times the value has been changed since construction
+ */
+unsigned int
+ConfigValueBase::num_updates() const
+{
+	return num_updates_.load(std::memory_order_acquire);
+}
+
+
+/** Read current value from configuration.
+ * @return true if the value exists and has been read, false otherwise
+ */
+bool
+ConfigValueBase::resolve()
+{
+	std::unique_ptr<Configuration::ValueIterator> v(config_->get_value(path_.c_str()));
+	if (! v->next()) return false;
+	MutexLocker lock(&update_mutex_);
+	update(v.get());
+	return true;
+}
+
+
+/** Register as change handler.
+ * Must be called from the constructor of the typed handle once the value
+ * has been initialized.
+ */
+void
+ConfigValueBase::register_handler()
+{
+	if (! registered_) {
+		config_->add_change_handler(this);
+		registered_ = true;
+	}
+}
+
+
+/** Unregister as change handler.
+ * Must be called from the destructor of the typed handle.
+ */
+void
+ConfigValueBase::unregister_handler()
+{
+	if (registered_) {
+		config_->rem_change_handler(this);
+		registered_ = false;
+	}
+}
+
+
+void
+ConfigValueBase::config_tag_changed(const char *new_tag)
+{
+}
+
+
+void
+ConfigValueBase::config_value_changed(const Configuration::ValueIterator *v)
+{
+	// handlers are matched by prefix, ignore values which merely share it
+	if (strcmp(v->path(), path_.c_str()) != 0) return;
+
+	MutexLocker lock(&update_mutex_);
+	try {
+		update(v);
+		num_updates_.fetch_add(1, std::memory_order_acq_rel);
+	} catch (Exception &e) {
+		// type changed, keep the last valid value
+	}
+}
+
+
+void
+ConfigValueBase::config_comment_changed(const Configuration::ValueIterator *v)
+{
+}
+
+
+void
+ConfigValueBase::config_value_erased(const char *path)
+{
+	// keep the last value
+}
+
+} // end namespace fawkes
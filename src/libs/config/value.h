@@ -0,0 +1,202 @@
+
+/***************************************************************************
+ *  value.h - Typed configuration value handles
+ *
+ *  Created: Sun Oct 18 18:47:05 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#ifndef _CONFIG_VALUE_H_
+#define _CONFIG_VALUE_H_
+
+#include <config/config.h>
+#include <config/change_handler.h>
+#include <core/threading/mutex.h>
+#include <core/threading/mutex_locker.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+/// Number of previous values kept valid for readers of a ConfigValue.
+#define CONFIG_VALUE_HISTORY_SIZE 8
+
+namespace fawkes {
+
+/// @cond INTERNALS
+inline void config_value_read(const Configuration::ValueIterator *v, float &val)
+{ val = v->get_float(); }
+inline void config_value_read(const Configuration::ValueIterator *v, unsigned int &val)
+{ val = v->get_uint(); }
+inline void config_value_read(const Configuration::ValueIterator *v, int &val)
+{ val = v->get_int(); }
+inline void config_value_read(const Configuration::ValueIterator *v, bool &val)
+{ val = v->get_bool(); }
+inline void config_value_read(const Configuration::ValueIterator *v, std::string &val)
+{ val = v->get_string(); }
+inline void config_value_read(const Configuration::ValueIterator *v, std::vector<float> &val)
+{ val = v->get_floats(); }
+inline void config_value_read(const Configuration::ValueIterator *v, std::vector<unsigned int> &val)
+{ val = v->get_uints(); }
+inline void config_value_read(const Configuration::ValueIterator *v, std::vector<int> &val)
+{ val = v->get_ints(); }
+inline void config_value_read(const Configuration::ValueIterator *v, std::vector<bool> &val)
+{ val = v->get_bools(); }
+inline void config_value_read(const Configuration::ValueIterator *v, std::vector<std::string> &val)
+{ val = v->get_strings(); }
+/// @endcond
+
+class ConfigValueBase : public ConfigurationChangeHandler
+{
+ public:
+	ConfigValueBase(Configuration *config, const char *path);
+	virtual ~ConfigValueBase();
+
+	const char *  path() const;
+	unsigned int  num_updates() const;
+
+	virtual void config_tag_changed(const char *new_tag);
+	virtual void config_value_changed(const Configuration::ValueIterator *v);
+	virtual void config_comment_changed(const Configuration::ValueIterator *v);
+	virtual void config_value_erased(const char *path);
+
+ protected:
+	/** Update the value.
+	 * Called with the update mutex locked.
+	 * @param v iterator pointing to the new value */
+	virtual void update(const Configuration::ValueIterator *v) = 0;
+
+	bool resolve();
+	void register_handler();
+	void unregister_handler();
+
+ protected:
+	/** Mutex serializing updates. */
+	Mutex                      update_mutex_;
+
+ private:
+	Configuration             *config_;
+	std::string                path_;
+	bool                       registered_;
+	std::atomic<unsigned int>  num_updates_;
+};
+
+
+template <typename T>
+class ConfigValue : public ConfigValueBase
+{
+ public:
+	ConfigValue(Configuration *config, const char *path);
+	ConfigValue(Configuration *config, const char *path, const T &default_value);
+	virtual ~ConfigValue();
+
+	/** Get current value.
+	 * This does neither lock nor look up the value in the configuration.
+	 * The reference stays valid until the value has been changed
+	 * CONFIG_VALUE_HISTORY_SIZE - 1 more times, copy the value to keep it
+	 * for longer.
+	 * @return current value */
+	const T & get() const
+	{ return *current_.load(std::memory_order_acquire); }
+
+	/** Get current value.
+	 * @return current value */
+	operator const T &() const
+	{ return get(); }
+
+ protected:
+	virtual void update(const Configuration::ValueIterator *v);
+
+ private:
+	void set(const T &value);
+
+ private:
+	std::atomic<const T *>  current_;
+	T                       values_[CONFIG_VALUE_HISTORY_SIZE];
+	unsigned int            next_;
+};
+
+
+/** Constructor.
+ * Resolves the value once and registers for changes.
+ * @param config configuration to read value from
+ * @param path path to value
+ * @exception ConfigEntryNotFoundException thrown if the value does not exist
+ */
+template <typename T>
+ConfigValue<T>::ConfigValue(Configuration *config, const char *path)
+	: ConfigValueBase(config, path), current_(NULL), next_(0)
+{
+	if (! resolve()) {
+		throw ConfigEntryNotFoundException(path);
+	}
+	register_handler();
+}
+
+
+/** Constructor.
+ * Resolves the value once and registers for changes. If the value does
+ * not exist the default value is used until it is set.
+ * @param config configuration to read value from
+ * @param path path to value
+ * @param default_value value to use if the path does not exist
+ */
+template <typename T>
+ConfigValue<T>::ConfigValue(Configuration *config, const char *path, const T &default_value)
+	: ConfigValueBase(config, path), current_(NULL), next_(0)
+{
+	if (! resolve()) {
+		MutexLocker lock(&update_mutex_);
+		set(default_value);
+	}
+	register_handler();
+}
+
+
+/** Destructor. */
+template <typename T>
+ConfigValue<T>::~ConfigValue()
+{
+	unregister_handler();
+}
+
+
+template <typename T>
+void
+ConfigValue<T>::update(const Configuration::ValueIterator *v)
+{
+	T value;
+	config_value_read(v, value);
+	set(value);
+}
+
+
+template <typename T>
+void
+ConfigValue<T>::set(const T &value)
+{
+	// The slot written is the oldest one, the previous values are kept
+	// since readers might still reference them.
+	values_[next_] = value;
+	current_.store(&values_[next_], std::memory_order_release);
+	next_ = (next_ + 1) % CONFIG_VALUE_HISTORY_SIZE;
+}
+
+} // end namespace fawkes
+
+#endif
@@ -31,6 +31,7 @@
 #include <logging/liblogger.h>
 #include <utils/system/fam_thread.h>
 #include <utils/misc/string_split.h>
+#include <utils/time/time.h>
 
 #include <queue>
 #include <fstream>
@@ -41,6 +42,9 @@
 #include <dirent.h>
 #include <sys/stat.h>
 #include <sys/socket.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <cinttypes>
 #include <regex>
 
 #include <yaml-cpp/exceptions.h>
@@ -410,7 +414,23 @@ YamlConfiguration::load(const char *file_path)
 
 	host_file_ = "";
 	std::list<std::string> files, dirs;
-	read_yaml_config(filename, host_file_, root_, host_root_, files, dirs);
+
+	Time start;
+	std::string cache = cache_file();
+	if (read_cache(cache, files, dirs)) {
+		Time end;
+		LibLogger::log_debug("YamlConfiguration", "Loaded %s from cache in %.1f ms",
+		                     config_file_.c_str(), (end - &start) * 1000.);
+	} else {
+		std::list<std::string> deps;
+		files.clear();
+		dirs.clear();
+		read_yaml_config(filename, host_file_, root_, host_root_, files, dirs, &deps);
+		Time end;
+		LibLogger::log_debug("YamlConfiguration", "Parsed %zu YAML files in %.1f ms",
+		                     files.size(), (end - &start) * 1000.);
+		write_cache(cache, files, dirs, deps);
+	}
 
 #ifdef HAVE_INOTIFY
 	fam_thread_ = new FamThread();
@@ -481,7 +501,8 @@ void
 YamlConfiguration::read_yaml_config(std::string filename, std::string &host_file,
                                     std::shared_ptr<YamlConfigurationNode>& root,
                                     std::shared_ptr<YamlConfigurationNode>& host_root,
-                                    std::list<std::string> &files, std::list<std::string> &dirs)
+                                    std::list<std::string> &files, std::list<std::string> &dirs,
+                                    std::list<std::string> *deps)
 {
 	root = std::make_shared<YamlConfigurationNode>();
 
@@ -491,6 +512,9 @@ YamlConfiguration::read_yaml_config(std::string filename, std::string &host_file
 	while (! load_queue.empty()) {
 		LoadQueueEntry &qe = load_queue.front();
 
+		// record all candidates, a file missing now might be added later
+		if (deps)  deps->push_back(qe.filename);
+
 		if (qe.is_dir) {
 			dirs.push_back(qe.filename);
 		} else {
@@ -513,6 +537,7 @@ YamlConfiguration::read_yaml_config(std::string filename, std::string &host_file
 	if (host_file != "") {
 		//LibLogger::log_debug("YamlConfiguration",
 		//			 "Reading Host YAML file '%s'", host_file.c_str());
+		if (deps)  deps->push_back(host_file);
 		std::queue<LoadQueueEntry> host_load_queue;
 		host_root = read_yaml_file(host_file, true, host_load_queue, host_file);
 		if (! host_load_queue.empty()) {
@@ -574,6 +599,215 @@ YamlConfiguration::fam_event(const char *filename, unsigned int mask)
 	}
 }
 
+/// @cond INTERNALS
+#define CACHE_MAGIC   "FAWKES-YAML-CACHE"
+#define CACHE_VERSION 1
+
+/** Stamp of a file the cache depends on. */
+typedef struct {
+	int64_t  mtime_sec;	///< modification time, seconds
+	int64_t  mtime_nsec;	///< modification time, nanoseconds
+	int64_t  size;		///< size in bytes, -1 if file does not exist
+	uint64_t inode;		///< inode number
+} cache_file_stamp_t;
+
+static cache_file_stamp_t
+cache_stamp(const std::string &filename)
+{
+	cache_file_stamp_t stamp;
+	memset(&stamp, 0, sizeof(stamp));
+	struct stat s;
+	if (stat(filename.c_str(), &s) == 0) {
+		stamp.mtime_sec  = s.st_mtim.tv_sec;
+		stamp.mtime_nsec = s.st_mtim.tv_nsec;
+		stamp.size       = s.st_size;
+		stamp.inode      = s.st_ino;
+	} else {
+		stamp.size = -1;
+	}
+	return stamp;
+}
+/// @endcond
+
+
+/** Get path of the binary cache for the current config file.
+ * @return path to cache file
+ */
+std::string
+YamlConfiguration::cache_file() const
+{
+	// FNV-1a, stable across builds unlike std::hash
+	uint64_t hash = 14695981039346656037ULL;
+	for (char c : config_file_) {
+		hash = (hash ^ (unsigned char)c) * 1099511628211ULL;
+	}
+	char *cache_file;
+	if (asprintf(&cache_file, "%s/.config-cache-%016" PRIx64 ".bin", userconfdir_, hash) == -1) {
+		return "";
+	}
+	std::string rv = cache_file;
+	free(cache_file);
+	return rv;
+}
+
+
+/** Read configuration from binary cache.
+ * The cache contains the merged configuration tree along with stamps
+ * of all files and directories it was generated from. It is only used if
+ * none of them has changed. Reading it avoids parsing all YAML documents
+ * and determining value types, which dominates startup time with many
+ * configuration files.
+ * @param cache_file path to cache file
+ * @param files upon successful return contains the configuration files
+ * @param dirs upon successful return contains the included directories
+ * @return true if the cache was valid and has been read, false otherwise
+ */
+bool
+YamlConfiguration::read_cache(const std::string &cache_file,
+                              std::list<std::string> &files, std::list<std::string> &dirs)
+{
+	if (cache_file.empty())  return false;
+
+	int fd = open(cache_file.c_str(), O_RDONLY);
+	if (fd == -1)  return false;
+
+	struct stat s;
+	if (fstat(fd, &s) != 0 || s.st_size == 0) {
+		close(fd);
+		return false;
+	}
+	void *data = mmap(NULL, s.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED)  return false;
+
+	const char *p   = (const char *)data;
+	const char *end = p + s.st_size;
+
+	bool valid = false;
+	try {
+		const size_t magic_len = strlen(CACHE_MAGIC);
+		if ((size_t)(end - p) < magic_len || strncmp(p, CACHE_MAGIC, magic_len) != 0) {
+			throw Exception("YamlConfig: invalid cache magic");
+		}
+		p += magic_len;
+
+		if (YamlConfigurationNode::deserialize_uint(p, end) != CACHE_VERSION) {
+			throw Exception("YamlConfig: cache version mismatch");
+		}
+		if (YamlConfigurationNode::deserialize_string(p, end) != config_file_) {
+			throw Exception("YamlConfig: cache for different config file");
+		}
+
+		uint32_t num_deps = YamlConfigurationNode::deserialize_uint(p, end);
+		for (uint32_t i = 0; i < num_deps; ++i) {
+			std::string dep = YamlConfigurationNode::deserialize_string(p, end);
+			cache_file_stamp_t cached;
+			if ((size_t)(end - p) < sizeof(cached))  throw Exception("YamlConfig: truncated cache");
+			memcpy(&cached, p, sizeof(cached));
+			p += sizeof(cached);
+
+			cache_file_stamp_t current = cache_stamp(dep);
+			if (memcmp(&cached, &current, sizeof(cached)) != 0) {
+				throw Exception("YamlConfig: %s modified", dep.c_str());
+			}
+		}
+
+		std::string host_file = YamlConfigurationNode::deserialize_string(p, end);
+
+		uint32_t num_files = YamlConfigurationNode::deserialize_uint(p, end);
+		for (uint32_t i = 0; i < num_files; ++i) {
+			files.push_back(YamlConfigurationNode::deserialize_string(p, end));
+		}
+		uint32_t num_dirs = YamlConfigurationNode::deserialize_uint(p, end);
+		for (uint32_t i = 0; i < num_dirs; ++i) {
+			dirs.push_back(YamlConfigurationNode::deserialize_string(p, end));
+		}
+
+		std::shared_ptr<YamlConfigurationNode> root = YamlConfigurationNode::deserialize(p, end);
+		std::shared_ptr<YamlConfigurationNode> host_root = YamlConfigurationNode::deserialize(p, end);
+
+		root_      = root;
+		host_root_ = host_root;
+		host_file_ = host_file;
+		valid = true;
+	} catch (Exception &e) {
+		LibLogger::log_debug("YamlConfiguration", "Not using config cache: %s",
+		                     e.what_no_backtrace());
+	}
+
+	munmap(data, s.st_size);
+	return valid;
+}
+
+
+/** Write configuration to binary cache.
+ * Failure to write the cache is not an error, the configuration will
+ * simply be parsed again on the next start.
+ * @param cache_file path to cache file
+ * @param files configuration files which have been read
+ * @param dirs directories which have been included
+ * @param deps files and directories the configuration depends on,
+ * including those which do not exist
+ */
+void
+YamlConfiguration::write_cache(const std::string &cache_file,
+                               const std::list<std::string> &files,
+                               const std::list<std::string> &dirs,
+                               const std::list<std::string> &deps)
+{
+	if (cache_file.empty())  return;
+
+	std::string buf = CACHE_MAGIC;
+	YamlConfigurationNode::serialize_uint(buf, CACHE_VERSION);
+	YamlConfigurationNode::serialize_string(buf, config_file_);
+
+	YamlConfigurationNode::serialize_uint(buf, deps.size());
+	for (const std::string &dep : deps) {
+		YamlConfigurationNode::serialize_string(buf, dep);
+		cache_file_stamp_t stamp = cache_stamp(dep);
+		buf.append((const char *)&stamp, sizeof(stamp));
+	}
+
+	YamlConfigurationNode::serialize_string(buf, host_file_);
+	YamlConfigurationNode::serialize_uint(buf, files.size());
+	for (const std::string &f : files) {
+		YamlConfigurationNode::serialize_string(buf, f);
+	}
+	YamlConfigurationNode::serialize_uint(buf, dirs.size());
+	for (const std::string &d : dirs) {
+		YamlConfigurationNode::serialize_string(buf, d);
+	}
+
+	root_->serialize(buf);
+	host_root_->serialize(buf);
+
+	// write to temporary file and rename, concurrent readers never see
+	// a partially written cache
+	std::string tmp_file = cache_file + ".tmp." + std::to_string(getpid());
+	int fd = open(tmp_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd == -1)  return;
+
+	const char *p = buf.data();
+	size_t remaining = buf.size();
+	while (remaining > 0) {
+		ssize_t written = write(fd, p, remaining);
+		if (written <= 0) {
+			if (written == -1 && errno == EINTR)  continue;
+			close(fd);
+			unlink(tmp_file.c_str());
+			return;
+		}
+		p += written;
+		remaining -= written;
+	}
+	close(fd);
+
+	if (rename(tmp_file.c_str(), cache_file.c_str()) != 0) {
+		unlink(tmp_file.c_str());
+	}
+}
+
+
 /** Create absolute config path.
  * If the @p path starts with / it is considered to be absolute. Otherwise
  * it is prefixed with the config directory.
@@ -182,9 +182,17 @@ class YamlConfiguration
   void read_yaml_config(std::string filename, std::string &host_file,
                         std::shared_ptr<YamlConfigurationNode>& root,
                         std::shared_ptr<YamlConfigurationNode>& host_root,
-                        std::list<std::string> &files, std::list<std::string> &dirs);
+                        std::list<std::string> &files, std::list<std::string> &dirs,
+                        std::list<std::string> *deps = NULL);
   void write_host_file();
 
+  std::string cache_file() const;
+  bool read_cache(const std::string &cache_file,
+                  std::list<std::string> &files, std::list<std::string> &dirs);
+  void write_cache(const std::string &cache_file,
+                   const std::list<std::string> &files, const std::list<std::string> &dirs,
+                   const std::list<std::string> &deps);
+
   std::string config_file_;
   std::string host_file_;
 
@@ -34,6 +34,8 @@
 #include <stack>
 #include <cerrno>
 #include <climits>
+#include <cstdint>
+#include <cstring>
 #include <unistd.h>
 #include <algorithm>
 #include <yaml-cpp/traits.h>
@@ -868,6 +870,78 @@ class YamlConfigurationNode : public std::enable_shared_from_this<YamlConfigurat
 		is_default_ = is_default;
 	}
 
+	void serialize(std::string &buf) const
+	{
+		buf.push_back((char)type_);
+		buf.push_back(is_default_ ? 1 : 0);
+		serialize_string(buf, name_);
+		serialize_string(buf, scalar_value_);
+		serialize_uint(buf, list_values_.size());
+		for (const std::string &v : list_values_) {
+			serialize_string(buf, v);
+		}
+		serialize_uint(buf, children_.size());
+		for (const auto &c : children_) {
+			serialize_string(buf, c.first);
+			c.second->serialize(buf);
+		}
+	}
+
+	static std::shared_ptr<YamlConfigurationNode>
+	deserialize(const char *&p, const char *end)
+	{
+		if (end - p < 2)  throw Exception("YamlConfig: truncated cache");
+		Type::value type = (Type::value)*p++;
+		bool is_default = (*p++ != 0);
+
+		auto n = std::make_shared<YamlConfigurationNode>(deserialize_string(p, end));
+		n->type_       = type;
+		n->is_default_ = is_default;
+		n->scalar_value_ = deserialize_string(p, end);
+
+		uint32_t num_values = deserialize_uint(p, end);
+		n->list_values_.resize(num_values);
+		for (uint32_t i = 0; i < num_values; ++i) {
+			n->list_values_[i] = deserialize_string(p, end);
+		}
+
+		uint32_t num_children = deserialize_uint(p, end);
+		for (uint32_t i = 0; i < num_children; ++i) {
+			std::string key = deserialize_string(p, end);
+			n->children_[key] = deserialize(p, end);
+		}
+		return n;
+	}
+
+	static void serialize_uint(std::string &buf, uint32_t v)
+	{
+		buf.append((const char *)&v, sizeof(v));
+	}
+
+	static void serialize_string(std::string &buf, const std::string &s)
+	{
+		serialize_uint(buf, s.size());
+		buf.append(s);
+	}
+
+	static uint32_t deserialize_uint(const char *&p, const char *end)
+	{
+		uint32_t v;
+		if ((size_t)(end - p) < sizeof(v))  throw Exception("YamlConfig: truncated cache");
+		memcpy(&v, p, sizeof(v));
+		p += sizeof(v);
+		return v;
+	}
+
+	static std::string deserialize_string(const char *&p, const char *end)
+	{
+		uint32_t size = deserialize_uint(p, end);
+		if ((size_t)(end - p) < size)  throw Exception("YamlConfig: truncated cache");
+		std::string s(p, size);
+		p += size;
+		return s;
+	}
+
 	void enum_leafs(std::map<std::string, std::shared_ptr<YamlConfigurationNode>> &nodes,
 	                std::string prefix = "") const
 	{
@@ -26,6 +26,9 @@
 
 #include <core/exception.h>
 #include <core/exceptions/software.h>
+#include <core/threading/mutex.h>
+#include <core/threading/mutex_locker.h>
+#include <core/threading/wait_condition.h>
 
 #include <fvutils/net/fuse_client.h>
 #include <fvutils/net/fuse_message.h>
@@ -37,6 +40,7 @@
 #include <netinet/in.h>
 #include <cstdlib>
 #include <cstring>
+#include <cmath>
 
 using namespace fawkes;
 
@@ -66,23 +70,11 @@ NetworkCamera::NetworkCamera(const char *host, unsigned short port, bool jpeg)
   host_ = strdup(host);
   port_ = port;
   get_jpeg_ = jpeg;
+  subscribe_ = true;
+  min_interval_usec_ = 0;
+  queue_length_ = 1;
 
-  connected_       = false;
-  opened_          = false;
-  local_version_   = 0;
-  remote_version_  = 0;
-  decompressor_    = NULL;
-  decompressed_buffer_ = NULL;
-  last_width_ = 0;
-  last_height_ = 0;
-  fuse_image_ = NULL;
-  fuse_message_ = NULL;
-  fuse_imageinfo_ = NULL;
-
-  fusec_ = new FuseClient(host_, port_, this);
-  if ( get_jpeg_ ) {
-    decompressor_ = new JpegImageDecompressor();
-  }
+  init();
 }
 
 /** Constructor.
@@ -105,23 +97,11 @@ NetworkCamera::NetworkCamera(const char *host, unsigned short port, const char *
   host_ = strdup(host);
   port_ = port;
   get_jpeg_ = jpeg;
+  subscribe_ = true;
+  min_interval_usec_ = 0;
+  queue_length_ = 1;
 
-  connected_       = false;
-  opened_          = false;
-  local_version_   = 0;
-  remote_version_  = 0;
-  decompressor_    = NULL;
-  decompressed_buffer_ = NULL;
-  last_width_ = 0;
-  last_height_ = 0;
-  fuse_image_ = NULL;
-  fuse_message_ = NULL;
-  fuse_imageinfo_ = NULL;
-
-  fusec_ = new FuseClient(host_, port_, this);
-  if ( get_jpeg_ ) {
-    decompressor_ = new JpegImageDecompressor();
-  }
+  init();
 }
 
 
@@ -132,6 +112,14 @@ NetworkCamera::NetworkCamera(const char *host, unsigned short port, const char *
  * - image=ID, image ID of image to retrieve
  * - jpeg=<true|false>, if true JPEGs are recieved and decompressed otherwise
  *   raw images will be transferred (raw is the default)
+ * - subscribe=<true|false>, if true (the default) and the server supports
+ *   it, images are pushed by the server as they are published instead of
+ *   being requested for each capture. Until the next image is pushed
+ *   capture() returns the last one again. Images without capture time
+ *   are pushed at most once per second
+ * - fps=FPS, maximum frame rate of pushed images
+ * - queue=N, maximum number of pushed images queued on the server for this
+ *   client, older images are dropped first (default 1)
  * @param cap camera argument parser
  */
 NetworkCamera::NetworkCamera(const CameraArgumentParser *cap)
@@ -158,8 +146,36 @@ NetworkCamera::NetworkCamera(const CameraArgumentParser *cap)
 
   get_jpeg_ = ( cap->has("jpeg") && (cap->get("jpeg") == "true"));
 
+  subscribe_ = ! ( cap->has("subscribe") && (cap->get("subscribe") == "false"));
+  min_interval_usec_ = 0;
+  if ( cap->has("fps") ) {
+    float fps = atof(cap->get("fps").c_str());
+    if ( fps <= 0. ) {
+      throw IllegalArgumentException("Frame rate must be positive");
+    }
+    min_interval_usec_ = (unsigned int)roundf(1000000. / fps);
+  }
+  queue_length_ = 1;
+  if ( cap->has("queue") ) {
+    int i = atoi(cap->get("queue").c_str());
+    if ( i < 1 ) {
+      throw IllegalArgumentException("Queue length must be at least 1");
+    }
+    queue_length_ = i;
+  }
+
+  init();
+}
+
+
+/** Initialize members common to all constructors. */
+void
+NetworkCamera::init()
+{
+  started_         = false;
   connected_       = false;
   opened_          = false;
+  subscribed_      = false;
   local_version_   = 0;
   remote_version_  = 0;
   decompressor_    = NULL;
@@ -169,6 +185,13 @@ NetworkCamera::NetworkCamera(const CameraArgumentParser *cap)
   fuse_image_ = NULL;
   fuse_message_ = NULL;
   fuse_imageinfo_ = NULL;
+  next_message_ = NULL;
+  last_message_ = NULL;
+  image_failed_ = false;
+  image_list_received_ = false;
+
+  image_mutex_    = new Mutex();
+  image_waitcond_ = new WaitCondition(image_mutex_);
 
   fusec_ = new FuseClient(host_, port_, this);
   if ( get_jpeg_ ) {
@@ -182,6 +205,8 @@ NetworkCamera::~NetworkCamera()
 {
   close();
   delete fusec_;
+  delete image_waitcond_;
+  delete image_mutex_;
   free(host_);
   free(image_id_);
   if ( decompressed_buffer_ != NULL) free(decompressed_buffer_);
@@ -198,14 +223,13 @@ NetworkCamera::open()
   fusec_->start();
   fusec_->wait_greeting();
 
-  if ( image_id_) {
-    FUSE_imagedesc_message_t *imagedesc = (FUSE_imagedesc_message_t *)calloc(1, sizeof(FUSE_imagedesc_message_t));
-    strncpy(imagedesc->image_id, image_id_, IMAGE_ID_MAX_LENGTH-1);
-    fusec_->enqueue_and_wait(FUSE_MT_GET_IMAGE_INFO, imagedesc, sizeof(FUSE_imagedesc_message_t));
+  if ( fusec_->server_version() < FUSE_VERSION_4 ) {
+    // server does not support subscriptions, request images one by one
+    subscribe_ = false;
+  }
 
-    if ( ! fuse_imageinfo_ ) {
-      throw Exception("Could not receive image info. Image not available?");
-    }
+  if ( image_id_) {
+    request_image_info();
   }
 
   opened_ = true;
@@ -221,6 +245,7 @@ NetworkCamera::start()
 void
 NetworkCamera::stop()
 {
+  unsubscribe();
   started_ = false;
 }
 
@@ -244,11 +269,46 @@ NetworkCamera::capture()
     throw CaptureException("You must specify an image id");
   }
 
-  FUSE_imagereq_message_t *irm = (FUSE_imagereq_message_t *)malloc(sizeof(FUSE_imagereq_message_t));
-  memset(irm, 0, sizeof(FUSE_imagereq_message_t));
-  strncpy(irm->image_id, image_id_, IMAGE_ID_MAX_LENGTH-1);
-  irm->format = (get_jpeg_ ? FUSE_IF_JPEG : FUSE_IF_RAW);
-  fusec_->enqueue_and_wait(FUSE_MT_GET_IMAGE, irm, sizeof(FUSE_imagereq_message_t));
+  image_mutex_->lock();
+  image_failed_ = false;
+
+  if ( subscribe_ ) {
+    if ( ! subscribed_ )  subscribe();
+    // The server pushes the current image right after subscribing and then
+    // each update. Until the next update the last pushed image is still
+    // the current one, neither wait for nor request another one.
+    while ( ! next_message_ && ! last_message_ && subscribe_ && connected_ ) {
+      image_waitcond_->wait();
+    }
+    if ( ! next_message_ && last_message_ ) {
+      next_message_ = last_message_;
+      next_message_->ref();
+    }
+  }
+
+  if ( ! next_message_ && connected_ && ! image_failed_ ) {
+    FUSE_imagereq_message_t *irm = (FUSE_imagereq_message_t *)malloc(sizeof(FUSE_imagereq_message_t));
+    memset(irm, 0, sizeof(FUSE_imagereq_message_t));
+    strncpy(irm->image_id, image_id_, IMAGE_ID_MAX_LENGTH-1);
+    irm->format = (get_jpeg_ ? FUSE_IF_JPEG : FUSE_IF_RAW);
+    fusec_->enqueue(FUSE_MT_GET_IMAGE, irm, sizeof(FUSE_imagereq_message_t));
+
+    while ( ! next_message_ && connected_ && ! image_failed_ ) {
+      image_waitcond_->wait();
+    }
+  }
+
+  if ( next_message_ ) {
+    fuse_message_ = next_message_;
+    next_message_ = NULL;
+    try {
+      fuse_image_ = fuse_message_->msgc<FuseImageContent>();
+    } catch (Exception &e) {
+      fuse_message_->unref();
+      fuse_message_ = NULL;
+    }
+  }
+  image_mutex_->unlock();
 
   if (! connected_) {
     throw CaptureException("Capture failed, connection died while waiting for image");
@@ -267,6 +327,8 @@ NetworkCamera::capture()
 						  fuse_image_->pixel_height());
       decompressed_buffer_ = (unsigned char *)malloc(buffer_size);
       decompressor_->set_decompressed_buffer(decompressed_buffer_, buffer_size);
+      last_width_  = fuse_image_->pixel_width();
+      last_height_ = fuse_image_->pixel_height();
     }
     decompressor_->set_compressed_buffer(fuse_image_->buffer(), fuse_image_->buffer_size());
     decompressor_->decompress();
@@ -321,6 +383,11 @@ NetworkCamera::close()
     fusec_->join();
     opened_ = false;
   }
+  drop_next_image();
+  image_mutex_->lock();
+  subscribed_ = false;
+  drop_last_image();
+  image_mutex_->unlock();
 }
 
 void
@@ -369,6 +436,7 @@ NetworkCamera::flush()
 {
   if (! connected_)  return;
   dispose_buffer();
+  drop_next_image();
 }
 
 
@@ -385,15 +453,12 @@ NetworkCamera::ready()
 void
 NetworkCamera::set_image_id(const char *image_id)
 {
+  unsubscribe();
+  drop_next_image();
+  free(image_id_);
   image_id_ = strdup(image_id);
 
-  FUSE_imagedesc_message_t *imagedesc = (FUSE_imagedesc_message_t *)calloc(1, sizeof(FUSE_imagedesc_message_t));
-  strncpy(imagedesc->image_id, image_id_, IMAGE_ID_MAX_LENGTH-1);
-  fusec_->enqueue_and_wait(FUSE_MT_GET_IMAGE_INFO, imagedesc, sizeof(FUSE_imagedesc_message_t));
-
-  if ( ! fuse_imageinfo_ ) {
-    throw Exception("Could not received image info. Image not available?");
-  }
+  request_image_info();
 }
 
 
@@ -431,7 +496,13 @@ NetworkCamera::image_list()
     throw CaptureException("Capture failed, not connected");
   }
 
-  fusec_->enqueue_and_wait(FUSE_MT_GET_IMAGE_LIST);
+  // pushed images may arrive meanwhile, hence wait for the list explicitly
+  MutexLocker lock(image_mutex_);
+  image_list_received_ = false;
+  fusec_->enqueue(FUSE_MT_GET_IMAGE_LIST);
+  while ( ! image_list_received_ && connected_ ) {
+    image_waitcond_->wait();
+  }
 
   return image_list_;
 }
@@ -456,7 +527,10 @@ NetworkCamera::fuse_connection_established() throw()
 void
 NetworkCamera::fuse_connection_died() throw()
 {
+  image_mutex_->lock();
   connected_ = false;
+  image_waitcond_->wake_all();
+  image_mutex_->unlock();
 }
 
 
@@ -466,40 +540,61 @@ NetworkCamera::fuse_inbound_received(FuseNetworkMessage *m) throw()
   switch(m->type()) {
 
   case FUSE_MT_IMAGE:
-    try {
-      fuse_image_ = m->msgc<FuseImageContent>();
-      if ( fuse_image_ ) {
-	fuse_message_ = m;
-	fuse_message_->ref();
-      }
-    } catch (Exception &e) {
-      fuse_image_ = NULL;
-      fuse_message_ = NULL;
+    // only keep the most recent image, older ones have not been captured in time
+    image_mutex_->lock();
+    if ( next_message_ )  next_message_->unref();
+    next_message_ = m;
+    next_message_->ref();
+    if ( subscribed_ ) {
+      // pushed image, it stays current until the next one is pushed
+      if ( last_message_ )  last_message_->unref();
+      last_message_ = m;
+      last_message_->ref();
     }
+    image_waitcond_->wake_all();
+    image_mutex_->unlock();
     break;
 
 
   case FUSE_MT_IMAGE_INFO:
+    image_mutex_->lock();
     try {
       fuse_imageinfo_ = m->msg_copy<FUSE_imageinfo_t>();
     } catch (Exception &e) {
       fuse_imageinfo_ = NULL;
+      image_failed_ = true;
     }
+    image_waitcond_->wake_all();
+    image_mutex_->unlock();
     break;
 
   case FUSE_MT_IMAGE_INFO_FAILED:
+    image_mutex_->lock();
     fuse_imageinfo_ = NULL;
+    image_failed_ = true;
+    image_waitcond_->wake_all();
+    image_mutex_->unlock();
     break;
 
   case FUSE_MT_GET_IMAGE_FAILED:
-    if ( fuse_message_ ) {
-      fuse_message_->unref();
-    }
-    fuse_message_ = NULL;
-    fuse_image_ = NULL;
+    image_mutex_->lock();
+    image_failed_ = true;
+    image_waitcond_->wake_all();
+    image_mutex_->unlock();
+    break;
+
+  case FUSE_MT_SUBSCRIBE_IMAGE_FAILED:
+    // continue by requesting images one by one
+    image_mutex_->lock();
+    subscribe_ = false;
+    subscribed_ = false;
+    drop_last_image();
+    image_waitcond_->wake_all();
+    image_mutex_->unlock();
     break;
 
   case FUSE_MT_IMAGE_LIST:
+    image_mutex_->lock();
     try {
       FuseImageListContent* fuse_image_list = m->msgc<FuseImageListContent>();
       if (fuse_image_list ) {
@@ -517,6 +612,9 @@ NetworkCamera::fuse_inbound_received(FuseNetworkMessage *m) throw()
     }
     catch (Exception &e) {
     }
+    image_list_received_ = true;
+    image_waitcond_->wake_all();
+    image_mutex_->unlock();
     break;
 
   default:
@@ -524,4 +622,88 @@ NetworkCamera::fuse_inbound_received(FuseNetworkMessage *m) throw()
   }
 }
 
+/** Subscribe to the current image.
+ * Must be called with the image mutex locked.
+ */
+void
+NetworkCamera::subscribe()
+{
+  FUSE_imagesub_message_t *ism = (FUSE_imagesub_message_t *)calloc(1, sizeof(FUSE_imagesub_message_t));
+  strncpy(ism->image_id, image_id_, IMAGE_ID_MAX_LENGTH-1);
+  ism->format = (get_jpeg_ ? FUSE_IF_JPEG : FUSE_IF_RAW);
+  ism->min_interval_usec = htonl(min_interval_usec_);
+  ism->queue_length = htonl(queue_length_);
+  fusec_->enqueue(FUSE_MT_SUBSCRIBE_IMAGE, ism, sizeof(FUSE_imagesub_message_t));
+  subscribed_ = true;
+}
+
+
+/** Unsubscribe from the current image if subscribed. */
+void
+NetworkCamera::unsubscribe()
+{
+  MutexLocker lock(image_mutex_);
+  if ( ! subscribed_ )  return;
+  subscribed_ = false;
+  drop_last_image();
+
+  if ( connected_ && image_id_ ) {
+    FUSE_imagedesc_message_t *idm = (FUSE_imagedesc_message_t *)calloc(1, sizeof(FUSE_imagedesc_message_t));
+    strncpy(idm->image_id, image_id_, IMAGE_ID_MAX_LENGTH-1);
+    fusec_->enqueue(FUSE_MT_UNSUBSCRIBE_IMAGE, idm, sizeof(FUSE_imagedesc_message_t));
+  }
+}
+
+
+/** Request info about the current image and wait for it.
+ * Failure is signaled by the server with FUSE_MT_IMAGE_INFO_FAILED.
+ */
+void
+NetworkCamera::request_image_info()
+{
+  MutexLocker lock(image_mutex_);
+  if ( fuse_imageinfo_ ) {
+    free(fuse_imageinfo_);
+    fuse_imageinfo_ = NULL;
+  }
+  image_failed_ = false;
+
+  FUSE_imagedesc_message_t *imagedesc = (FUSE_imagedesc_message_t *)calloc(1, sizeof(FUSE_imagedesc_message_t));
+  strncpy(imagedesc->image_id, image_id_, IMAGE_ID_MAX_LENGTH-1);
+  fusec_->enqueue(FUSE_MT_GET_IMAGE_INFO, imagedesc, sizeof(FUSE_imagedesc_message_t));
+
+  while ( ! fuse_imageinfo_ && ! image_failed_ && connected_ ) {
+    image_waitcond_->wait();
+  }
+
+  if ( ! fuse_imageinfo_ ) {
+    throw Exception("Could not receive image info. Image not available?");
+  }
+}
+
+
+/** Drop image received but not yet captured. */
+void
+NetworkCamera::drop_next_image()
+{
+  MutexLocker lock(image_mutex_);
+  if ( next_message_ ) {
+    next_message_->unref();
+    next_message_ = NULL;
+  }
+}
+
+
+/** Drop last pushed image.
+ * Must be called with the image mutex locked.
+ */
+void
+NetworkCamera::drop_last_image()
+{
+  if ( last_message_ ) {
+    last_message_->unref();
+    last_message_ = NULL;
+  }
+}
+
 } // end namespace firevision
@@ -28,6 +28,10 @@
 #include <fvutils/net/fuse_client_handler.h>
 #include <vector>
 
+namespace fawkes {
+  class Mutex;
+  class WaitCondition;
+}
 namespace firevision {
 
 class CameraArgumentParser;
@@ -78,6 +82,13 @@ class NetworkCamera : public Camera, public FuseClientHandler
   virtual void fuse_inbound_received(FuseNetworkMessage *m) throw();
 
  private:
+  void init();
+  void subscribe();
+  void unsubscribe();
+  void request_image_info();
+  void drop_next_image();
+  void drop_last_image();
+
   bool started_;
   bool opened_;
 
@@ -101,6 +112,18 @@ class NetworkCamera : public Camera, public FuseClientHandler
 
   FUSE_imageinfo_t   *fuse_imageinfo_;
 
+  bool                subscribe_;
+  bool                subscribed_;
+  unsigned int        min_interval_usec_;
+  unsigned int        queue_length_;
+
+  fawkes::Mutex         *image_mutex_;
+  fawkes::WaitCondition *image_waitcond_;
+  FuseNetworkMessage    *next_message_;
+  FuseNetworkMessage    *last_message_;
+  bool                   image_failed_;
+  bool                   image_list_received_;
+
   std::vector<FUSE_imageinfo_t> image_list_;
 };
 
@@ -119,7 +119,7 @@ SharedMemoryCamera::init()
   try {
     shm_buffer_ = new SharedMemoryImageBuffer(image_id_);
     if ( deep_copy_ ) {
-      deep_buffer_ = (unsigned char *)malloc(shm_buffer_->data_size());
+      deep_buffer_ = (unsigned char *)malloc(buffer_size());
       if ( ! deep_buffer_ ) {
 	throw OutOfMemoryException("SharedMemoryCamera: Cannot allocate deep buffer");
       }
@@ -158,7 +158,7 @@ SharedMemoryCamera::capture()
 {
   if ( deep_copy_ ) {
     shm_buffer_->lock_for_read();
-    memcpy(deep_buffer_, shm_buffer_->buffer(), shm_buffer_->data_size());
+    memcpy(deep_buffer_, shm_buffer_->buffer(), buffer_size());
     capture_time_->set_time(shm_buffer_->capture_time());
     shm_buffer_->unlock();
   }
@@ -0,0 +1,69 @@
+
+/***************************************************************************
+ *  user_buffers.cpp - Abstract class for cameras capturing to given buffers
+ *
+ *  Created: Mon Oct 19 14:21:37 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#include <fvcams/user_buffers.h>
+
+namespace firevision {
+
+/** @class CameraUserBuffers <fvcams/user_buffers.h>
+ * Camera capturing into buffers provided by the user.
+ * Cameras implementing this interface can write images directly into
+ * memory provided by the caller, for example the slots of a shared memory
+ * image buffer, instead of their own buffers. This avoids copying each
+ * image if no conversion is required.
+ *
+ * While user buffers are set, the buffer of the last capture is not handed
+ * back to the device on dispose_buffer(), but only on the following
+ * dispose_buffer() call. This way the image can be published and remains
+ * valid until the next image has been captured and published.
+ *
+ * @fn bool CameraUserBuffers::supports_user_buffers() = 0
+ * Check if user buffers can be used with the current configuration.
+ * @return true if set_user_buffers() may be called
+ *
+ * @fn unsigned int CameraUserBuffers::num_user_buffers() = 0
+ * Get number of buffers required.
+ * @return number of buffers that must be passed to set_user_buffers()
+ *
+ * @fn size_t CameraUserBuffers::user_buffer_size() = 0
+ * Get required size of each buffer.
+ * @return minimum size in bytes of each buffer
+ *
+ * @fn void CameraUserBuffers::set_user_buffers(unsigned char **buffers, unsigned int num_buffers) = 0
+ * Set buffers to capture to.
+ * May only be called while the camera is not started. The buffers must
+ * remain valid until the camera has been closed.
+ * @param buffers array of buffers, each of at least user_buffer_size() bytes
+ * @param num_buffers number of buffers, must be num_user_buffers()
+ *
+ * @fn unsigned int CameraUserBuffers::current_user_buffer() = 0
+ * Get index of buffer of last capture.
+ * @return index into the array of buffers passed to set_user_buffers()
+ */
+
+/** Empty virtual destructor. */
+CameraUserBuffers::~CameraUserBuffers()
+{
+}
+
+} // end namespace firevision
@@ -0,0 +1,46 @@
+
+/***************************************************************************
+ *  user_buffers.h - Abstract class for cameras capturing to given buffers
+ *
+ *  Created: Mon Oct 19 14:21:37 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#ifndef _FIREVISION_CAMS_USER_BUFFERS_H_
+#define _FIREVISION_CAMS_USER_BUFFERS_H_
+
+#include <cstddef>
+
+namespace firevision {
+
+class CameraUserBuffers
+{
+ public:
+  virtual ~CameraUserBuffers();
+
+  virtual bool          supports_user_buffers()                        = 0;
+  virtual unsigned int  num_user_buffers()                             = 0;
+  virtual size_t        user_buffer_size()                             = 0;
+  virtual void          set_user_buffers(unsigned char **buffers,
+					 unsigned int num_buffers)     = 0;
+  virtual unsigned int  current_user_buffer()                          = 0;
+};
+
+} // end namespace firevision
+
+#endif
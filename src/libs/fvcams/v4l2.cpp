@@ -34,7 +34,9 @@
 #include <iostream>
 #include <cstring>
 #include <cerrno>
+#include <algorithm>
 #include <cstdlib>
+#include <unistd.h>
 #include <linux/version.h>
 
 using std::cout;
@@ -73,7 +75,6 @@ class V4L2CameraData
 /** @class V4L2Camera <fvcams/v4l2.h>
  * Video4Linux 2 camera access implementation.
  *
- * @todo UPTR method
  * @todo v4l2_pix_format.field
  * @author Tobias Kellner
  * @author Tim Niemueller
@@ -89,6 +90,9 @@ V4L2Camera::V4L2Camera(const char *device_name)
   _nao_hacks = _switch_u_v = false;
   _width = _height = _bytes_per_line = _fps = _buffers_length = 0;
   _current_buffer = -1;
+  _held_buffer = -1;
+  _queue_depth = 0;
+  _user_buffers = false;
   _standard = NULL;
   _input = NULL;
   _brightness.set = _contrast.set = _saturation.set = _hue.set =
@@ -119,7 +123,8 @@ V4L2Camera::V4L2Camera(const char *device_name)
  * - read_method=METHOD, preferred read method
  *    READ: read()
  *    MMAP: memory mapping
- *    UPTR: user pointer
+ *    UPTR: user pointer, capture into memory given to set_user_buffers()
+ * - buffers=N, number of buffers queued with the driver for MMAP and UPTR
  * - standard=std, set video standard, e.g. PAL or NTSC
  * - input=inp, set video input, e.g. S-Video
  * - format=FOURCC, preferred format
@@ -149,6 +154,9 @@ V4L2Camera::V4L2Camera(const CameraArgumentParser *cap)
   _nao_hacks = false;
   _width = _height = _bytes_per_line = _buffers_length = 0;
   _current_buffer = -1;
+  _held_buffer = -1;
+  _queue_depth = 0;
+  _user_buffers = false;
   _frame_buffers = NULL;
   _capture_time = NULL;
   _standard = NULL;
@@ -172,6 +180,12 @@ V4L2Camera::V4L2Camera(const CameraArgumentParser *cap)
     _read_method = MMAP;
   }
 
+  if (cap->has("buffers")) {
+    int buffers = atoi(cap->get("buffers").c_str());
+    if (buffers < 2) throw Exception("V4L2Cam: Need at least two buffers");
+    _queue_depth = buffers;
+  }
+
   if (cap->has("format")) {
     string fmt = cap->get("format");
     if (fmt.length() != 4) throw Exception("V4L2Cam: Invalid format fourcc");
@@ -365,6 +379,9 @@ V4L2Camera::V4L2Camera(const char *device_name, int dev)
   _nao_hacks = _switch_u_v = false;
   _width = _height = _bytes_per_line = _buffers_length = _fps = 0;
   _current_buffer = -1;
+  _held_buffer = -1;
+  _queue_depth = 0;
+  _user_buffers = false;
   _brightness.set = _contrast.set = _saturation.set = _hue.set =
     _red_balance.set = _blue_balance.set = _exposure.set = _gain.set =
     _lens_x.set = _lens_y.set = false;
@@ -479,28 +496,20 @@ V4L2Camera::select_read_method()
     v4l2_requestbuffers buf;
 
     /* Streaming IO - Try 1st method, and if that fails 2nd */
-    if (_read_method == MMAP) {
-      _buffers_length = MMAP_NUM_BUFFERS;
-      buf.count = _buffers_length;
-      buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-      buf.memory = V4L2_MEMORY_MMAP;
-    } else if (_read_method == UPTR) {
-      _buffers_length = 0;
-      buf.count = 0;
-      buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-      buf.memory = V4L2_MEMORY_USERPTR;
-    }
+    _buffers_length = (_queue_depth > 0) ? _queue_depth : MMAP_NUM_BUFFERS;
+    memset(&buf, 0, sizeof(buf));
+    buf.count = _buffers_length;
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = (_read_method == MMAP) ? V4L2_MEMORY_MMAP : V4L2_MEMORY_USERPTR;
 
     if (v4l2_ioctl(_dev, VIDIOC_REQBUFS, &buf)) {
       close();
       throw Exception("V4L2Cam: REQBUFS query failed");
     }
 
-    if (_read_method == MMAP) {
-      if (buf.count < _buffers_length) {
-	close();
-	throw Exception("V4L2Cam: Not enough memory for the buffers");
-      }
+    if (buf.count < _buffers_length) {
+      close();
+      throw Exception("V4L2Cam: Not enough memory for the buffers");
     }
   } else {
     /* Read IO */
@@ -519,8 +528,6 @@ V4L2Camera::select_read_method()
 
     case UPTR:
       LibLogger::log_debug("V4L2Cam", "Using user pointer method");
-      //TODO
-      throw Exception("V4L2Cam: user pointer method not supported yet");
       break;
   }
 }
@@ -902,7 +909,7 @@ V4L2Camera::get_one_control(const char *ctrl, unsigned int id)
 void
 V4L2Camera::create_buffer()
 {
-  _frame_buffers = new FrameBuffer[_buffers_length];
+  _frame_buffers = new FrameBuffer[_buffers_length]();
 
   switch (_read_method)
   {
@@ -951,9 +958,65 @@ V4L2Camera::create_buffer()
     }
 
     case UPTR:
-      /* not supported yet */
+    {
+      // capture into our own page-aligned memory until
+      // set_user_buffers() provides the final destination
+      long page_size = sysconf(_SC_PAGESIZE);
+      for (unsigned int i = 0; i < _buffers_length; ++i)
+      {
+        void *buffer = NULL;
+        if (posix_memalign(&buffer, page_size, user_buffer_size()) != 0)
+        {
+          close();
+          throw Exception("V4L2Cam: Out of memory");
+        }
+        _frame_buffers[i].size = user_buffer_size();
+        _frame_buffers[i].buffer = static_cast<unsigned char *>(buffer);
+      }
       break;
+    }
+  }
+}
+
+/**
+ * Free buffers created by create_buffer().
+ * Buffers passed to set_user_buffers() are owned by the caller and
+ * are not freed.
+ */
+void
+V4L2Camera::free_buffer()
+{
+  if (! _frame_buffers)  return;
+
+  switch (_read_method) {
+  case READ:
+  {
+    free(_frame_buffers[0].buffer);
+    break;
+  }
+
+  case MMAP:
+  {
+    for (unsigned int i = 0; i < _buffers_length; ++i) {
+      v4l2_munmap(_frame_buffers[i].buffer, _frame_buffers[i].size);
+    }
+    break;
   }
+
+  case UPTR:
+  {
+    if (! _user_buffers) {
+      for (unsigned int i = 0; i < _buffers_length; ++i) {
+	free(_frame_buffers[i].buffer);
+      }
+    }
+    break;
+  }
+  }
+  delete[] _frame_buffers;
+  _frame_buffers = NULL;
+  _current_buffer = -1;
+  _held_buffer = -1;
 }
 
 /**
@@ -993,30 +1056,8 @@ V4L2Camera::close()
 
   if (_started) stop();
 
-  if (_frame_buffers) {
-    switch (_read_method) {
-    case READ:
-    {
-      free(_frame_buffers[0].buffer);
-      break;
-    }
-
-    case MMAP:
-    {
-      for (unsigned int i = 0; i < _buffers_length; ++i) {
-	v4l2_munmap(_frame_buffers[i].buffer, _frame_buffers[i].size);
-      }
-      break;
-    }
-
-    case UPTR:
-      /* not supported yet */
-      break;
-    }
-    delete[] _frame_buffers;
-    _frame_buffers = NULL;
-    _current_buffer = -1;
-  }
+  free_buffer();
+  _user_buffers = false;
 
   if (_opened) {
     v4l2_close(_dev);
@@ -1043,14 +1084,21 @@ V4L2Camera::start()
       break;
 
     case MMAP:
+    case UPTR:
     {
       // enqueue buffers
       for (unsigned int i = 0; i < _buffers_length; ++i) {
 	v4l2_buffer buffer;
 	memset(&buffer, 0, sizeof(buffer));
 	buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-	buffer.memory = V4L2_MEMORY_MMAP;
 	buffer.index = i;
+	if (_read_method == MMAP) {
+	  buffer.memory = V4L2_MEMORY_MMAP;
+	} else {
+	  buffer.memory = V4L2_MEMORY_USERPTR;
+	  buffer.m.userptr = (unsigned long)_frame_buffers[i].buffer;
+	  buffer.length = _frame_buffers[i].size;
+	}
 
 	if (v4l2_ioctl(_dev, VIDIOC_QBUF, &buffer)) {
 	  close();
@@ -1066,10 +1114,6 @@ V4L2Camera::start()
       }
       break;
     }
-
-    case UPTR:
-      /* not supported yet */
-      break;
   }
 
   //LibLogger::log_debug("V4L2Cam", "start() complete");
@@ -1100,7 +1144,9 @@ V4L2Camera::stop()
     }
   }
 
+  // stopping the stream dequeued all buffers, including the held one
   _current_buffer = -1;
+  _held_buffer = -1;
   _started = false;
 }
 
@@ -1141,12 +1187,13 @@ V4L2Camera::capture()
     }
 
     case MMAP:
+    case UPTR:
     {
       // dequeue buffer
       v4l2_buffer buffer;
       memset(&buffer, 0, sizeof(buffer));
       buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-      buffer.memory = V4L2_MEMORY_MMAP;
+      buffer.memory = (_read_method == MMAP) ? V4L2_MEMORY_MMAP : V4L2_MEMORY_USERPTR;
 
       if (v4l2_ioctl(_dev, VIDIOC_DQBUF, &buffer)) {
         close();
@@ -1162,10 +1209,6 @@ V4L2Camera::capture()
       }
       break;
     }
-
-    case UPTR:
-      /* not supported yet */
-      break;
   }
 }
 
@@ -1198,13 +1241,31 @@ V4L2Camera::dispose_buffer()
       break;
 
     case MMAP:
+    case UPTR:
     {
+      if (_current_buffer == -1) break;
+
+      int enqueue_buffer = _current_buffer;
+      if (_user_buffers) {
+        // user buffers may still be read after dispose, e.g. from shared
+        // memory, hold the current buffer and enqueue the previous one
+        enqueue_buffer = _held_buffer;
+        _held_buffer = _current_buffer;
+        if (enqueue_buffer == -1) break;
+      }
+
       /* enqueue next buffer */
       v4l2_buffer buffer;
       memset(&buffer, 0, sizeof(buffer));
       buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-      buffer.memory = V4L2_MEMORY_MMAP;
-      buffer.index = _current_buffer;
+      buffer.index = enqueue_buffer;
+      if (_read_method == MMAP) {
+        buffer.memory = V4L2_MEMORY_MMAP;
+      } else {
+        buffer.memory = V4L2_MEMORY_USERPTR;
+        buffer.m.userptr = (unsigned long)_frame_buffers[enqueue_buffer].buffer;
+        buffer.length = _frame_buffers[enqueue_buffer].size;
+      }
 
       //TODO: Test if the next buffer is also the latest buffer (VIDIOC_QUERYBUF)
       if (v4l2_ioctl(_dev, VIDIOC_QBUF, &buffer)) {
@@ -1214,10 +1275,6 @@ V4L2Camera::dispose_buffer()
       }
       break;
     }
-
-    case UPTR:
-      /* not supported yet */
-      break;
   }
 
   _current_buffer = -1;
@@ -1265,6 +1322,61 @@ V4L2Camera::set_image_number(unsigned int n)
 }
 
 
+/* --- CameraUserBuffers --- */
+
+bool
+V4L2Camera::supports_user_buffers()
+{
+  return _opened && (_read_method == UPTR);
+}
+
+unsigned int
+V4L2Camera::num_user_buffers()
+{
+  return _buffers_length;
+}
+
+size_t
+V4L2Camera::user_buffer_size()
+{
+  // bytes per line only refers to the first plane of planar formats
+  return std::max<size_t>(_bytes_per_line * _height,
+			  colorspace_buffer_size(_colorspace, _width, _height));
+}
+
+void
+V4L2Camera::set_user_buffers(unsigned char **buffers, unsigned int num_buffers)
+{
+  if (! supports_user_buffers()) {
+    throw Exception("V4L2Cam: User buffers require an opened camera with UPTR method");
+  }
+  if (_started) {
+    throw Exception("V4L2Cam: Cannot set user buffers while started");
+  }
+  if (num_buffers != _buffers_length) {
+    throw Exception("V4L2Cam: Expected %u user buffers, got %u",
+		    _buffers_length, num_buffers);
+  }
+
+  free_buffer();
+  _frame_buffers = new FrameBuffer[_buffers_length];
+  for (unsigned int i = 0; i < _buffers_length; ++i) {
+    _frame_buffers[i].buffer = buffers[i];
+    _frame_buffers[i].size = user_buffer_size();
+  }
+  _user_buffers = true;
+}
+
+unsigned int
+V4L2Camera::current_user_buffer()
+{
+  if (_current_buffer == -1) {
+    throw Exception("V4L2Cam: No image has been captured");
+  }
+  return _current_buffer;
+}
+
+
 /* --- CameraControls --- */
 
 /**
@@ -31,9 +31,10 @@
 
 #include <fvcams/control/color.h>
 #include <fvcams/control/image.h>
+#include <fvcams/user_buffers.h>
 
-/* Number of buffers to use for memory mapped IO */
-#define MMAP_NUM_BUFFERS 4;
+/* Number of buffers to use for memory mapped and user pointer IO */
+#define MMAP_NUM_BUFFERS 4
 
 namespace firevision {
 
@@ -44,7 +45,8 @@ class V4LCamera;
 class V4L2Camera:
   public Camera,
   public CameraControlColor,
-  public CameraControlImage
+  public CameraControlImage,
+  public CameraUserBuffers
 {
  friend V4LCamera;
 
@@ -126,6 +128,11 @@ class V4L2Camera:
   virtual unsigned int sharpness();
   virtual void         set_sharpness(unsigned int sharpness);
 
+  virtual bool         supports_user_buffers();
+  virtual unsigned int num_user_buffers();
+  virtual size_t       user_buffer_size();
+  virtual void         set_user_buffers(unsigned char **buffers, unsigned int num_buffers);
+  virtual unsigned int current_user_buffer();
 
  protected:
   V4L2Camera(const char *device_name, int dev);
@@ -141,6 +148,7 @@ class V4L2Camera:
   virtual void set_fps();
   virtual void set_controls();
   virtual void create_buffer();
+  virtual void free_buffer();
   virtual void reset_cropping();
 
  protected:
@@ -190,7 +198,10 @@ class V4L2Camera:
   unsigned int _bytes_per_line;      ///< Image bytes per line
   FrameBuffer *_frame_buffers;       ///< Image buffers
   unsigned int _buffers_length;      ///< Image buffer size
+  unsigned int _queue_depth;         ///< Requested number of buffers, 0 for default
+  bool _user_buffers;                ///< UPTR buffers have been set by the user
   int _current_buffer;               ///< Current Image buffer (-1 if not set)
+  int _held_buffer;                  ///< Disposed but not yet enqueued user buffer
   fawkes::Time *_capture_time;       ///< Time when last picture was captured
 
   bool _switch_u_v;                  ///< Switch U and V channels
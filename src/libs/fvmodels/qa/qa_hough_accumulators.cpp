@@ -0,0 +1,184 @@
+/***************************************************************************
+ *  qa_hough_accumulators.cpp - QA for Hough accumulators
+ *
+ *  Created: Mon Oct 19 01:02:17 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+/// @cond QA
+
+// Feeds the same random votes to the tree, hash and dense accumulators
+// and checks that they agree on the number of votes, the maximum, the
+// nodes and, for tree and hash accumulator, the dump.
+
+#include <fvmodels/shape/accumulators/ht_accum.h>
+#include <fvmodels/shape/accumulators/ht_hash_accum.h>
+#include <fvmodels/shape/accumulators/ht_dense_accum.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <sstream>
+#include <vector>
+
+using namespace firevision;
+
+#define NUM_VOTES 20000
+
+typedef std::vector< std::vector< int > > Nodes;
+
+static Nodes
+sorted(Nodes *nodes)
+{
+  Nodes rv(*nodes);
+  delete nodes;
+  std::sort(rv.begin(), rv.end());
+  return rv;
+}
+
+static int
+count_at(const Nodes &nodes, int x, int y, int r)
+{
+  for (const std::vector<int> &n : nodes) {
+    if (n[0] == x && n[1] == y && n[2] == r)  return n[3];
+  }
+  return 0;
+}
+
+static bool
+test_tree_vs_hash()
+{
+  RhtAccumulator     tree;
+  RhtHashAccumulator hash;
+
+  // two rounds to cover reset()
+  for (unsigned int round = 0; round < 2; ++round) {
+    tree.reset();
+    hash.reset();
+
+    for (unsigned int i = 0; i < NUM_VOTES; ++i) {
+      int x = rand() % 40 - 20, y = rand() % 30, r = rand() % 10;
+      int tc = tree.accumulate(x, y, r);
+      int hc = hash.accumulate(x, y, r);
+      if (tc != hc) {
+        printf("Tree/hash: count for (%i, %i, %i) differs: %i vs %i\n", x, y, r, tc, hc);
+        return false;
+      }
+    }
+
+    if (tree.getNumVotes() != hash.getNumVotes()) {
+      printf("Tree/hash: number of votes differs: %u vs %u\n",
+             tree.getNumVotes(), hash.getNumVotes());
+      return false;
+    }
+
+    int tx, ty, tr, hx, hy, hr;
+    int tmax = tree.getMax(tx, ty, tr);
+    int hmax = hash.getMax(hx, hy, hr);
+    if (tmax != hmax) {
+      printf("Tree/hash: maximum differs: %i vs %i\n", tmax, hmax);
+      return false;
+    }
+
+    Nodes tnodes = sorted(tree.getNodes(2));
+    Nodes hnodes = sorted(hash.getNodes(2));
+    if (tnodes != hnodes) {
+      printf("Tree/hash: nodes differ\n");
+      return false;
+    }
+    if (count_at(hnodes, hx, hy, hr) != hmax) {
+      printf("Tree/hash: maximum not at (%i, %i, %i)\n", hx, hy, hr);
+      return false;
+    }
+
+    std::ostringstream tdump, hdump;
+    tree.dump(tdump);
+    hash.dump(hdump);
+    if (tdump.str() != hdump.str()) {
+      printf("Tree/hash: dumps differ\n");
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool
+test_dense_vs_hash()
+{
+  HtDenseAccumulator dense;
+  RhtHashAccumulator hash;
+
+  for (unsigned int round = 0; round < 2; ++round) {
+    dense.init(-50, 50, -90, 90);
+    hash.reset();
+
+    for (unsigned int i = 0; i < NUM_VOTES; ++i) {
+      int x = rand() % 101 - 50, y = rand() % 181 - 90;
+      dense.accumulate(x, y);
+      hash.accumulate(x, y, 0);
+    }
+
+    if (dense.getNumVotes() != hash.getNumVotes()) {
+      printf("Dense/hash: number of votes differs: %u vs %u\n",
+             dense.getNumVotes(), hash.getNumVotes());
+      return false;
+    }
+
+    int dx, dy, hx, hy, hr;
+    int dmax = dense.getMax(dx, dy);
+    int hmax = hash.getMax(hx, hy, hr);
+    if (dmax != hmax) {
+      printf("Dense/hash: maximum differs: %i vs %i\n", dmax, hmax);
+      return false;
+    }
+
+    Nodes dnodes = sorted(dense.getNodes(1));
+    Nodes hnodes = sorted(hash.getNodes(1));
+    if (dnodes != hnodes) {
+      printf("Dense/hash: nodes differ\n");
+      return false;
+    }
+    if (count_at(dnodes, dx, dy, 0) != dmax) {
+      printf("Dense/hash: maximum not at (%i, %i)\n", dx, dy);
+      return false;
+    }
+  }
+  return true;
+}
+
+int
+main(int argc, char **argv)
+{
+  srand(argc > 1 ? atoi(argv[1]) : 42);
+
+  bool success = true;
+  if (! test_tree_vs_hash()) {
+    printf("FAILED tree vs. hash accumulator\n");
+    success = false;
+  }
+  if (! test_dense_vs_hash()) {
+    printf("FAILED dense vs. hash accumulator\n");
+    success = false;
+  }
+
+  if (success)  printf("PASSED\n");
+  return success ? 0 : 1;
+}
+
+/// @endcond
@@ -0,0 +1,147 @@
+
+/***************************************************************************
+ *  ht_dense_accum.cpp - Dense two-dimensional Hough-Transform accumulator
+ *
+ *  Created: Mon Oct 19 15:02:11 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#include <fvmodels/shape/accumulators/ht_dense_accum.h>
+
+#include <algorithm>
+
+using namespace std;
+
+namespace firevision {
+
+/** @class HtDenseAccumulator <fvmodels/shape/accumulators/ht_dense_accum.h>
+ * Dense two-dimensional Hough-Transform accumulator.
+ * For a bounded Hough space, like the (r, phi) space of lines in a
+ * region of interest, all bins are kept in a single row-major array.
+ * Voting is a plain increment without any search or allocation, and
+ * all memory is owned by the instance. Rows can be voted concurrently.
+ */
+
+/** Constructor. */
+HtDenseAccumulator::HtDenseAccumulator()
+{
+  x_min_ = y_min_ = 0;
+  width_ = height_ = 0;
+}
+
+
+/** Destructor. */
+HtDenseAccumulator::~HtDenseAccumulator()
+{
+}
+
+
+/** Initialize accumulator.
+ * Sets the Hough space range and clears all votes. Memory is only
+ * re-allocated if the space grows.
+ * @param x_min minimum x value
+ * @param x_max maximum x value
+ * @param y_min minimum y value
+ * @param y_max maximum y value
+ */
+void
+HtDenseAccumulator::init(int x_min, int x_max, int y_min, int y_max)
+{
+  x_min_  = x_min;
+  y_min_  = y_min;
+  width_  = std::max(0, x_max - x_min + 1);
+  height_ = std::max(0, y_max - y_min + 1);
+  bins_.assign((size_t)width_ * height_, 0);
+}
+
+
+/** Reset, clears all votes. */
+void
+HtDenseAccumulator::reset(void)
+{
+  std::fill(bins_.begin(), bins_.end(), 0);
+}
+
+
+/** Get maximum.
+ * If several bins have the maximum number of votes, the one with the
+ * smallest y and then smallest x is returned.
+ * @param x x return value
+ * @param y y return value
+ * @return max
+ */
+int
+HtDenseAccumulator::getMax(int &x, int &y) const
+{
+  size_t max_i = 0;
+  unsigned int max = 0;
+  for (size_t i = 0; i < bins_.size(); ++i) {
+    if (bins_[i] > max) {
+      max = bins_[i];
+      max_i = i;
+    }
+  }
+  x = (width_ > 0) ? x_min_ + (int)(max_i % width_) : 0;
+  y = (width_ > 0) ? y_min_ + (int)(max_i / width_) : 0;
+  return max;
+}
+
+
+/** Get number of votes.
+ * @return number of votes
+ */
+unsigned int
+HtDenseAccumulator::getNumVotes() const
+{
+  unsigned int num_votes = 0;
+  for (unsigned int v : bins_) {
+    num_votes += v;
+  }
+  return num_votes;
+}
+
+
+/** Get nodes.
+ * @param min_votes min votes
+ * @return nodes ordered by x and then y, each node consists of x, y,
+ * zero (for compatibility with RhtAccumulator), and the number of votes
+ */
+vector< vector< int > > *
+HtDenseAccumulator::getNodes(int min_votes) const
+{
+  vector< vector< int > > *rv = new vector< vector< int > >();
+  unsigned int min_count = std::max(1, min_votes);
+
+  for (int x = 0; x < width_; ++x) {
+    for (int y = 0; y < height_; ++y) {
+      unsigned int count = bins_[(size_t)y * width_ + x];
+      if (count >= min_count) {
+	vector< int > node;
+	node.push_back( x_min_ + x );
+	node.push_back( y_min_ + y );
+	node.push_back( 0 );
+	node.push_back( count );
+	rv->push_back( node );
+      }
+    }
+  }
+
+  return rv;
+}
+
+} // end namespace firevision
@@ -0,0 +1,64 @@
+
+/***************************************************************************
+ *  ht_dense_accum.h - Dense two-dimensional Hough-Transform accumulator
+ *
+ *  Created: Mon Oct 19 15:02:11 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#ifndef _FIREVISION_MODELS_SHAPE_ACCUMULATORS_HT_DENSE_ACCUM_H_
+#define _FIREVISION_MODELS_SHAPE_ACCUMULATORS_HT_DENSE_ACCUM_H_
+
+#include <vector>
+
+namespace firevision {
+
+class HtDenseAccumulator
+{
+ public:
+  HtDenseAccumulator();
+  ~HtDenseAccumulator();
+
+  void init(int x_min, int x_max, int y_min, int y_max);
+  void reset(void);
+
+  /** Accumulate new candidate.
+   * Coordinates must be within the range given to init(). This may be
+   * called concurrently from several threads as long as each thread
+   * votes for a distinct set of y values.
+   * @param x x
+   * @param y y
+   */
+  void accumulate(int x, int y)
+  { ++bins_[(y - y_min_) * width_ + (x - x_min_)]; }
+
+  int getMax(int& x, int& y) const;
+  unsigned int getNumVotes() const;
+  std::vector< std::vector< int > > * getNodes(int min_count) const;
+
+ private:
+  std::vector<unsigned int> bins_;
+  int x_min_;
+  int y_min_;
+  int width_;
+  int height_;
+};
+
+} // end namespace firevision
+
+#endif
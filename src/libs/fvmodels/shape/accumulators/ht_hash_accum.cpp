@@ -0,0 +1,237 @@
+
+/***************************************************************************
+ *  ht_hash_accum.cpp - Hash table based Hough-Transform accumulator
+ *
+ *  Created: Mon Oct 19 14:21:37 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#include <fvmodels/shape/accumulators/ht_hash_accum.h>
+
+#include <algorithm>
+#include <stdint.h>
+
+using namespace std;
+
+namespace firevision {
+
+/** @class RhtHashAccumulator <fvmodels/shape/accumulators/ht_hash_accum.h>
+ * Hash table based Hough-Transform accumulator.
+ * This accumulator has the same interface as RhtAccumulator, but stores
+ * the quantised (x, y, r) bins in an open addressing hash table instead
+ * of nested binary trees. All memory is owned by the instance and reused
+ * on reset(), therefore several instances can be used concurrently from
+ * different threads, for example by shape models in parallel vision
+ * threads. Nodes are returned and dumped in the same (x, y, r) order as
+ * by RhtAccumulator.
+ */
+
+/** Constructor.
+ * @param initial_capacity initial number of bins, the table grows as
+ * needed while accumulating and keeps its size on reset()
+ */
+RhtHashAccumulator::RhtHashAccumulator(unsigned int initial_capacity)
+{
+  unsigned int capacity = 16;
+  while (capacity < initial_capacity)  capacity <<= 1;
+
+  Bin empty = {0, 0, 0, 0};
+  bins_.resize(capacity, empty);
+  mask_ = capacity - 1;
+
+  x_max_ = y_max_ = r_max_ = 0;
+  max_ = 0;
+  num_votes_ = 0;
+}
+
+
+/** Destructor. */
+RhtHashAccumulator::~RhtHashAccumulator()
+{
+}
+
+
+/** Reset. */
+void
+RhtHashAccumulator::reset(void)
+{
+  for (unsigned int i : used_) {
+    bins_[i].count = 0;
+  }
+  used_.clear();
+
+  x_max_ = y_max_ = r_max_ = 0;
+  max_ = 0;
+  num_votes_ = 0;
+}
+
+
+unsigned int
+RhtHashAccumulator::slot(int x, int y, int r) const
+{
+  uint32_t h = (uint32_t)x * 73856093u ^ (uint32_t)y * 19349663u ^ (uint32_t)r * 83492791u;
+  return (h * 2654435761u) & mask_;
+}
+
+
+void
+RhtHashAccumulator::grow()
+{
+  std::vector<Bin> old_bins;
+  old_bins.swap(bins_);
+
+  Bin empty = {0, 0, 0, 0};
+  bins_.resize(old_bins.size() * 2, empty);
+  mask_ = bins_.size() - 1;
+
+  for (unsigned int &u : used_) {
+    const Bin &b = old_bins[u];
+    unsigned int i = slot(b.x, b.y, b.r);
+    while (bins_[i].count != 0)  i = (i + 1) & mask_;
+    bins_[i] = b;
+    u = i;
+  }
+}
+
+
+/** Accumulate new candidate.
+ * @param x x
+ * @param y y
+ * @param r r
+ * @return count
+ */
+int
+RhtHashAccumulator::accumulate(int x, int y, int r)
+{
+  ++num_votes_;
+
+  unsigned int i = slot(x, y, r);
+  while (bins_[i].count != 0) {
+    Bin &b = bins_[i];
+    if (b.x == x && b.y == y && b.r == r)  break;
+    i = (i + 1) & mask_;
+  }
+
+  Bin &b = bins_[i];
+  if (b.count == 0) {
+    b.x = x;
+    b.y = y;
+    b.r = r;
+    used_.push_back(i);
+  }
+
+  int count = ++b.count;
+  if (count > max_) {
+    max_ = count;
+    x_max_ = x;
+    y_max_ = y;
+    r_max_ = r;
+  }
+
+  // keep probe sequences short
+  if (used_.size() * 2 > bins_.size())  grow();
+
+  return count;
+}
+
+
+/** Get maximum
+ * @param x x return value
+ * @param y y return value
+ * @param r r return value
+ * @return max
+ */
+int
+RhtHashAccumulator::getMax(int &x, int &y, int &r) const
+{
+  x = x_max_;
+  y = y_max_;
+  r = r_max_;
+  return max_;
+}
+
+
+void
+RhtHashAccumulator::sorted_bins(std::vector<const Bin *> &bins) const
+{
+  bins.clear();
+  bins.reserve(used_.size());
+  for (unsigned int i : used_) {
+    bins.push_back(&bins_[i]);
+  }
+  std::sort(bins.begin(), bins.end(),
+	    [](const Bin *a, const Bin *b) -> bool {
+	      if (a->x != b->x)  return a->x < b->x;
+	      if (a->y != b->y)  return a->y < b->y;
+	      return a->r < b->r;
+	    });
+}
+
+
+/** Dump.
+ * @param s stream
+ */
+void
+RhtHashAccumulator::dump(std::ostream& s)
+{
+  std::vector<const Bin *> bins;
+  sorted_bins(bins);
+  for (const Bin *b : bins) {
+    s << "("<<b->x<<","<<b->y<<","<<b->r<<") with vote "<<b->count<<endl;
+  }
+}
+
+
+/** Get number of votes.
+ * @return number of votes
+ */
+unsigned int
+RhtHashAccumulator::getNumVotes() const
+{
+  return num_votes_;
+}
+
+
+/** Get nodes.
+ * @param min_votes min votes
+ * @return nodes, each node consists of x, y, r, and the number of votes
+ */
+vector< vector< int > > *
+RhtHashAccumulator::getNodes(int min_votes)
+{
+  vector< vector< int > > *rv = new vector< vector< int > >();
+
+  if (min_votes <= (int)num_votes_) {
+    std::vector<const Bin *> bins;
+    sorted_bins(bins);
+    for (const Bin *b : bins) {
+      if (b->count >= min_votes) {
+	vector< int > node;
+	node.push_back( b->x );
+	node.push_back( b->y );
+	node.push_back( b->r );
+	node.push_back( b->count );
+	rv->push_back( node );
+      }
+    }
+  }
+
+  return rv;
+}
+
+} // end namespace firevision
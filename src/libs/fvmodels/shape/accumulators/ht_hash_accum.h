@@ -0,0 +1,73 @@
+
+/***************************************************************************
+ *  ht_hash_accum.h - Hash table based Hough-Transform accumulator
+ *
+ *  Created: Mon Oct 19 14:21:37 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#ifndef _FIREVISION_MODELS_SHAPE_ACCUMULATORS_HT_HASH_ACCUM_H_
+#define _FIREVISION_MODELS_SHAPE_ACCUMULATORS_HT_HASH_ACCUM_H_
+
+#include <ostream>
+#include <vector>
+
+namespace firevision {
+
+class RhtHashAccumulator
+{
+ public:
+  RhtHashAccumulator(unsigned int initial_capacity = 1024);
+  ~RhtHashAccumulator();
+
+  int accumulate(int x, int y, int r);
+  int getMax(int& x, int& y, int& r) const;
+  void dump(std::ostream&);
+  void reset(void);
+  unsigned int getNumVotes() const;
+  std::vector< std::vector< int > > * getNodes(int min_count);
+
+ private:
+  /// @cond INTERNALS
+  typedef struct {
+    int x;
+    int y;
+    int r;
+    int count;
+  } Bin;
+  /// @endcond
+
+  unsigned int slot(int x, int y, int r) const;
+  void grow();
+  void sorted_bins(std::vector<const Bin *> &bins) const;
+
+ private:
+  std::vector<Bin>          bins_;
+  std::vector<unsigned int> used_;
+  unsigned int              mask_;
+
+  int          x_max_;
+  int          y_max_;
+  int          r_max_;
+  int          max_;
+  unsigned int num_votes_;
+};
+
+} // end namespace firevision
+
+#endif
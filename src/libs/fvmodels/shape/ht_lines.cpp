@@ -28,6 +28,9 @@
 #include <fvmodels/shape/ht_lines.h>
 #include <utils/math/angle.h>
 
+#include <algorithm>
+#include <map>
+
 using namespace std;
 using namespace fawkes;
 
@@ -37,6 +40,8 @@ namespace firevision {
 
 /** @class HtLinesModel <fvmodels/shape/ht_lines.h>
  * Hough-Transform line matcher.
+ * Votes are collected in a dense (r, phi) accumulator. If compiled with
+ * OpenMP, voting is distributed over threads by candidate angle.
  */
 
 /** Constructor.
@@ -59,6 +64,21 @@ HtLinesModel::HtLinesModel(unsigned int nr_candidates, float angle_from, float a
   RHT_ANGLE_FROM      = angle_from -  (floor(angle_from  / (2 * M_PI )) * (2 * M_PI));
   RHT_ANGLE_RANGE     = angle_range - (floor(angle_range / (2 * M_PI )) * (2 * M_PI));
   RHT_ANGLE_INCREMENT = RHT_ANGLE_RANGE / RHT_NR_CANDIDATES;
+
+  // Candidates are grouped by their rounded angle, which is the
+  // accumulator row they vote for. Each group can then be voted
+  // independently of the others.
+  std::map<int, std::vector<unsigned int> > groups;
+  for (unsigned int i = 0; i < RHT_NR_CANDIDATES; ++i) {
+    float phi = RHT_ANGLE_FROM + i * RHT_ANGLE_INCREMENT;
+    cand_cos_.push_back(cos(phi));
+    cand_sin_.push_back(sin(phi));
+    cand_angle_.push_back((int)round(fawkes::rad2deg( phi )));
+    groups[cand_angle_.back()].push_back(i);
+  }
+  for (std::map<int, std::vector<unsigned int> >::iterator g = groups.begin(); g != groups.end(); ++g) {
+    angle_groups_.push_back(g->second);
+  }
 }
 
 
@@ -74,8 +94,12 @@ HtLinesModel::parseImage( unsigned char *buf,
 {
   unsigned char *buffer = roi->get_roi_buffer_start(buf);
 
-  // clear the accumulator
-  accumulator.reset();
+  // clear the accumulator, a line through the ROI has
+  // |r| <= sqrt(width^2 + height^2)
+  int r_max_idx = (int)ceil(hypotf(roi->width, roi->height) / RHT_R_SCALE) + 1;
+  int angle_min = cand_angle_.empty() ? 0 : *std::min_element(cand_angle_.begin(), cand_angle_.end());
+  int angle_max = cand_angle_.empty() ? 0 : *std::max_element(cand_angle_.begin(), cand_angle_.end());
+  accumulator.init(-r_max_idx, r_max_idx, angle_min, angle_max);
 
   // clear all the remembered lines
   m_Lines.clear();
@@ -99,36 +123,34 @@ HtLinesModel::parseImage( unsigned char *buf,
     buffer = line_start;
   }
 
-  // Then perform the RHT algorithm
-  upoint_t p;
-  float r, phi; // used for line representation
-  vector< upoint_t >::iterator pos;
+  // Then perform the HT algorithm
   if (pixels.size() == 0) {
     // No edge pixels found => no lines
     return 0;
   }
 
-
-  while (pixels.size() > 0) {
-    p = pixels.back();
-    pixels.pop_back();
-
-    for (unsigned int i = 0; i < RHT_NR_CANDIDATES; ++i) {
-      phi = RHT_ANGLE_FROM + i * RHT_ANGLE_INCREMENT;
-      r   = p.x * cos( phi )  +   p.y * sin( phi );
-
-      int angle = (int)round(fawkes::rad2deg( phi ));
-
-      accumulator.accumulate( (int)round(r / RHT_R_SCALE),
-            angle,
-            0 );
+  // Vote in parallel, each angle group writes to its own accumulator row
+  const long num_groups = angle_groups_.size();
+#ifdef _OPENMP
+  #pragma omp parallel for schedule(dynamic)
+#endif
+  for (long g = 0; g < num_groups; ++g) {
+    const vector<unsigned int> &group = angle_groups_[g];
+    for (unsigned int c = 0; c < group.size(); ++c) {
+      const double cos_phi = cand_cos_[group[c]];
+      const double sin_phi = cand_sin_[group[c]];
+      const int    angle   = cand_angle_[group[c]];
+      for (unsigned int i = 0; i < pixels.size(); ++i) {
+	float r = pixels[i].x * cos_phi + pixels[i].y * sin_phi;
+	accumulator.accumulate( (int)round(r / RHT_R_SCALE), angle );
+      }
     }
   }
 
 
   // Find the most dense region, and decide on the lines
-  int max, r_max, phi_max, any_max;
-  max = accumulator.getMax(r_max, phi_max, any_max);
+  int max, r_max, phi_max;
+  max = accumulator.getMax(r_max, phi_max);
 
   roi_width = roi->width;
   roi_height = roi->height;
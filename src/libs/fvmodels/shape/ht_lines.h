@@ -31,7 +31,7 @@
 
 #include <fvutils/base/types.h>
 #include <fvmodels/shape/line.h>
-#include <fvmodels/shape/accumulators/ht_accum.h>
+#include <fvmodels/shape/accumulators/ht_dense_accum.h>
 
 namespace firevision {
 
@@ -41,7 +41,7 @@ class HtLinesModel: public ShapeModel
 {
  private:
   std::vector<LineShape> m_Lines;
-  RhtAccumulator accumulator;
+  HtDenseAccumulator accumulator;
 
  public:
   /** Creates a new HtLinesModel instance
@@ -87,6 +87,11 @@ class HtLinesModel: public ShapeModel
   unsigned int  roi_width;
   unsigned int  roi_height;
 
+  std::vector<double>                     cand_cos_;
+  std::vector<double>                     cand_sin_;
+  std::vector<int>                        cand_angle_;
+  std::vector<std::vector<unsigned int> > angle_groups_;
+
 };
 
 } // end namespace firevision
@@ -31,7 +31,7 @@
 #include <utils/math/types.h>
 #include <fvutils/base/types.h>
 #include <fvmodels/shape/circle.h>
-#include <fvmodels/shape/accumulators/ht_accum.h>
+#include <fvmodels/shape/accumulators/ht_hash_accum.h>
 
 namespace firevision {
 
@@ -41,7 +41,7 @@ class RhtCircleModel: public ShapeModel
 {
  private:
   std::vector<Circle> m_Circles;
-  RhtAccumulator accumulator;
+  RhtHashAccumulator accumulator;
   static const float RHT_MIN_RADIUS;
   static const float RHT_MAX_RADIUS;
 
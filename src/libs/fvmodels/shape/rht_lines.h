@@ -31,7 +31,7 @@
 
 #include <fvutils/base/types.h>
 #include <fvmodels/shape/line.h>
-#include <fvmodels/shape/accumulators/ht_accum.h>
+#include <fvmodels/shape/accumulators/ht_hash_accum.h>
 
 namespace firevision {
 
@@ -41,7 +41,7 @@ class RhtLinesModel: public ShapeModel
 {
  private:
   std::vector<LineShape> m_Lines;
-  RhtAccumulator accumulator;
+  RhtHashAccumulator accumulator;
 
  public:
   /** Creates a new RhtLinesModel instance
@@ -28,20 +28,38 @@
 #include <utils/ipc/shm_exceptions.h>
 #include <utils/misc/strndup.h>
 
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <cstring>
 #include <cstdlib>
 #include <cstdio>
+#include <unistd.h>
 
 using namespace std;
 using namespace fawkes;
 
 namespace firevision {
 
+/// @cond INTERNALS
+/** Round size up to a multiple of the page size. */
+static size_t
+page_round(size_t size)
+{
+  const size_t page_size = sysconf(_SC_PAGESIZE);
+  return (size + page_size - 1) / page_size * page_size;
+}
+/// @endcond
+
 /** @class SharedMemoryImageBuffer <fvutils/ipc/shm_image.h>
  * Shared memory image buffer.
  * Write images to or retrieve images from a shared memory segment.
+ *
+ * A segment may hold several image slots of which one is the current
+ * image returned by buffer(). This allows for a producer to capture the
+ * next image into another slot, e.g. by a camera writing via DMA directly
+ * into the slot, and then to publish it by only setting the current slot.
+ * Each slot starts at a page boundary.
  * @author Tim Niemueller
  */
 
@@ -57,17 +75,22 @@ namespace firevision {
  * @param cspace colorspace
  * @param width image width
  * @param height image height
+ * @param num_slots number of image slots, at most 255
  */
 SharedMemoryImageBuffer::SharedMemoryImageBuffer(const char *image_id,
 						 colorspace_t cspace,
 						 unsigned int width,
-						 unsigned int height)
+						 unsigned int height,
+						 unsigned int num_slots)
   : SharedMemory(FIREVISION_SHM_IMAGE_MAGIC_TOKEN,
 		 /* read-only */ false,
 		 /* create */ true,
 		 /* destroy on delete */ true)
 {
-  constructor(image_id, cspace, width, height, false);
+  if (num_slots < 1 || num_slots > 255) {
+    throw Exception("SharedMemoryImageBuffer: invalid number of slots %u", num_slots);
+  }
+  constructor(image_id, cspace, width, height, num_slots, false);
   add_semaphore();
 }
 
@@ -85,14 +108,14 @@ SharedMemoryImageBuffer::SharedMemoryImageBuffer(const char *image_id,
 SharedMemoryImageBuffer::SharedMemoryImageBuffer(const char *image_id, bool is_read_only)
   : SharedMemory(FIREVISION_SHM_IMAGE_MAGIC_TOKEN, is_read_only, /* create */ false, /* destroy */ false)
 {
-  constructor(image_id, CS_UNKNOWN, 0, 0, is_read_only);
+  constructor(image_id, CS_UNKNOWN, 0, 0, 1, is_read_only);
 }
 
 
 void
 SharedMemoryImageBuffer::constructor(const char *image_id, colorspace_t cspace,
 				     unsigned int width, unsigned int height,
-				     bool is_read_only)
+				     unsigned int num_slots, bool is_read_only)
 {
   _image_id     = strdup(image_id);
   _is_read_only = is_read_only;
@@ -101,7 +124,8 @@ SharedMemoryImageBuffer::constructor(const char *image_id, colorspace_t cspace,
   _width      = width;
   _height     = height;
 
-  priv_header = new SharedMemoryImageBufferHeader(_image_id, _colorspace, width, height);
+  priv_header = new SharedMemoryImageBufferHeader(_image_id, _colorspace, width, height,
+						  num_slots);
   _header = priv_header;
   try {
     attach();
@@ -226,12 +250,71 @@ SharedMemoryImageBuffer::set_capture_time(long int sec, long int usec)
 }
 
 /** Get image buffer.
- * @return image buffer.
+ * @return buffer of the current image slot
  */
 unsigned char *
 SharedMemoryImageBuffer::buffer() const
 {
-  return (unsigned char *)_memptr;
+  return slot_buffer(raw_header->current_slot);
+}
+
+
+/** Get number of image slots.
+ * @return number of image slots
+ */
+unsigned int
+SharedMemoryImageBuffer::num_slots() const
+{
+  return (raw_header->num_slots == 0) ? 1 : raw_header->num_slots;
+}
+
+
+/** Get buffer of image slot.
+ * @param slot image slot
+ * @return buffer of the given image slot
+ */
+unsigned char *
+SharedMemoryImageBuffer::slot_buffer(unsigned int slot) const
+{
+  if (raw_header->num_slots <= 1) {
+    if (slot > 0)  throw Exception("Invalid image slot %u", slot);
+    return (unsigned char *)_memptr;
+  }
+  if (slot >= raw_header->num_slots) {
+    throw Exception("Invalid image slot %u (%u slots)", slot, raw_header->num_slots);
+  }
+  size_t slot_size = page_round(colorspace_buffer_size((colorspace_t)raw_header->colorspace,
+							raw_header->width, raw_header->height));
+  size_t first_slot = page_round((size_t)_memptr);
+  return (unsigned char *)(first_slot + slot * slot_size);
+}
+
+
+/** Get current image slot.
+ * @return slot holding the image returned by buffer()
+ */
+unsigned int
+SharedMemoryImageBuffer::current_slot() const
+{
+  return raw_header->current_slot;
+}
+
+
+/** Set current image slot.
+ * This publishes the image in the given slot. The segment should be
+ * locked for writing while doing so.
+ * @param slot new current image slot
+ */
+void
+SharedMemoryImageBuffer::set_current_slot(unsigned int slot)
+{
+  if (_is_read_only) {
+    throw Exception("Buffer is read-only. Not setting current slot.");
+  }
+  if (slot >= num_slots()) {
+    throw Exception("Invalid image slot %u (%u slots)", slot, num_slots());
+  }
+  raw_header->current_slot = slot;
 }
 
 
@@ -583,9 +666,14 @@ SharedMemoryImageBufferHeader::SharedMemoryImageBufferHeader()
   _frame_id = NULL;
   _width = 0;
   _height = 0;
+  _num_slots = 1;
   _header = NULL;
   _orig_image_id = NULL;
   _orig_frame_id = NULL;
+  _orig_width = 0;
+  _orig_height = 0;
+  _orig_num_slots = 1;
+  _orig_colorspace = CS_UNKNOWN;
 }
 
 
@@ -594,16 +682,19 @@ SharedMemoryImageBufferHeader::SharedMemoryImageBufferHeader()
  * @param colorspace colorspace
  * @param width width
  * @param height height
+ * @param num_slots number of image slots
  */
 SharedMemoryImageBufferHeader::SharedMemoryImageBufferHeader(const char *image_id,
 							     colorspace_t colorspace,
 							     unsigned int width,
-							     unsigned int height)
+							     unsigned int height,
+							     unsigned int num_slots)
 {
   _image_id   = strdup(image_id);
   _colorspace = colorspace;
   _width      = width;
   _height     = height;
+  _num_slots  = num_slots;
   _header     = NULL;
   _frame_id   = NULL;
 
@@ -611,6 +702,7 @@ SharedMemoryImageBufferHeader::SharedMemoryImageBufferHeader(const char *image_i
   _orig_frame_id   = NULL;
   _orig_width      = 0;
   _orig_height     = 0;
+  _orig_num_slots  = 1;
   _orig_colorspace = CS_UNKNOWN;
 }
 
@@ -633,12 +725,14 @@ SharedMemoryImageBufferHeader::SharedMemoryImageBufferHeader(const SharedMemoryI
   _colorspace = h->_colorspace;
   _width      = h->_width;
   _height     = h->_height;
+  _num_slots  = h->_num_slots;
   _header     = h->_header;
 
   _orig_image_id   = NULL;
   _orig_frame_id   = NULL;
   _orig_width      = 0;
   _orig_height     = 0;
+  _orig_num_slots  = 1;
   _orig_colorspace = CS_UNKNOWN;
 }
 
@@ -670,10 +764,21 @@ SharedMemoryImageBufferHeader::clone() const
 size_t
 SharedMemoryImageBufferHeader::data_size()
 {
+  size_t image_size;
+  unsigned int slots;
   if (_header == NULL) {
-    return colorspace_buffer_size(_colorspace, _width, _height);
+    image_size = colorspace_buffer_size(_colorspace, _width, _height);
+    slots = _num_slots;
   } else {
-    return colorspace_buffer_size((colorspace_t)_header->colorspace, _header->width, _header->height);
+    image_size = colorspace_buffer_size((colorspace_t)_header->colorspace,
+					_header->width, _header->height);
+    slots = _header->num_slots;
+  }
+  if (slots <= 1) {
+    return image_size;
+  } else {
+    // extra page to align the first slot at a page boundary
+    return slots * page_round(image_size) + sysconf(_SC_PAGESIZE);
   }
 }
 
@@ -691,6 +796,7 @@ SharedMemoryImageBufferHeader::matches(void *memptr)
 	 (((colorspace_t)h->colorspace == _colorspace) &&
 	  (h->width == _width) &&
 	  (h->height == _height) &&
+	  (std::max(h->num_slots, 1u) == _num_slots) &&
           (! _frame_id || (strncmp(h->frame_id, _frame_id, FRAME_ID_MAX_LENGTH) == 0))
 	  )
 	 )
@@ -778,6 +884,7 @@ SharedMemoryImageBufferHeader::initialize(void *memptr)
   header->colorspace = _colorspace;
   header->width      = _width;
   header->height     = _height;
+  header->num_slots  = _num_slots;
 
   _header = header;
 }
@@ -803,6 +910,7 @@ SharedMemoryImageBufferHeader::set(void *memptr)
   }
   _orig_width = _width;
   _orig_height = _height;
+  _orig_num_slots = _num_slots;
   _orig_colorspace = _colorspace;
   _header = header;
 
@@ -810,6 +918,7 @@ SharedMemoryImageBufferHeader::set(void *memptr)
   _frame_id = strndup(header->frame_id, FRAME_ID_MAX_LENGTH);
   _width = header->width;
   _height = header->height;
+  _num_slots = std::max(header->num_slots, 1u);
   _colorspace = (colorspace_t)header->colorspace;
 }
 
@@ -833,6 +942,7 @@ SharedMemoryImageBufferHeader::reset()
   }
   _width =_orig_width;
   _height =_orig_height;
+  _num_slots =_orig_num_slots;
   _colorspace =_orig_colorspace;
   _header = NULL;
 }
@@ -871,6 +981,17 @@ SharedMemoryImageBufferHeader::height() const
 }
 
 
+/** Get number of image slots.
+ * @return number of image slots
+ */
+unsigned int
+SharedMemoryImageBufferHeader::num_slots() const
+{
+  if ( _header)  return std::max(_header->num_slots, 1u);
+  else           return _num_slots;
+}
+
+
 /** Get image number
  * @return image number
  */
@@ -60,7 +60,9 @@ typedef struct {
 					 * micro seconds. */
   unsigned int  flag_circle_found :  1;	/**< 1 if circle found */
   unsigned int  flag_image_ready  :  1;	/**< 1 if image ready */
-  unsigned int  flag_reserved     : 30;	/**< reserved for future use */
+  unsigned int  num_slots         :  8;	/**< number of image slots, 0 means 1 */
+  unsigned int  current_slot      :  8;	/**< slot holding the current image */
+  unsigned int  flag_reserved     : 14;	/**< reserved for future use */
 } SharedMemoryImageBuffer_header_t;
 
 class SharedMemoryImageBufferHeader
@@ -71,7 +73,8 @@ class SharedMemoryImageBufferHeader
   SharedMemoryImageBufferHeader(const char *image_id,
 				colorspace_t colorspace,
 				unsigned int width,
-				unsigned int height);
+				unsigned int height,
+				unsigned int num_slots = 1);
   SharedMemoryImageBufferHeader(const SharedMemoryImageBufferHeader *h);
   virtual ~SharedMemoryImageBufferHeader();
 
@@ -91,6 +94,7 @@ class SharedMemoryImageBufferHeader
   colorspace_t         colorspace() const;
   unsigned int         width() const;
   unsigned int         height() const;
+  unsigned int         num_slots() const;
   const char *         image_id() const;
   const char *         frame_id() const;
 
@@ -102,12 +106,14 @@ class SharedMemoryImageBufferHeader
   colorspace_t   _colorspace;
   unsigned int   _width;
   unsigned int   _height;
+  unsigned int   _num_slots;
 
   char          *_orig_image_id;
   char          *_orig_frame_id;
   colorspace_t   _orig_colorspace;
   unsigned int   _orig_width;
   unsigned int   _orig_height;
+  unsigned int   _orig_num_slots;
 
   SharedMemoryImageBuffer_header_t *_header;
 };
@@ -181,7 +187,8 @@ class SharedMemoryImageBuffer : public fawkes::SharedMemory
  public:
   SharedMemoryImageBuffer(const char *image_id,
 			  colorspace_t cspace,
-			  unsigned int width, unsigned int height);
+			  unsigned int width, unsigned int height,
+			  unsigned int num_slots = 1);
   SharedMemoryImageBuffer(const char *image_id, bool is_read_only = true);
   ~SharedMemoryImageBuffer();
 
@@ -199,6 +206,10 @@ class SharedMemoryImageBuffer : public fawkes::SharedMemory
   int              circle_y() const;
   unsigned int     circle_radius() const;
   bool             circle_found() const;
+  unsigned int     num_slots() const;
+  unsigned char *  slot_buffer(unsigned int slot) const;
+  unsigned int     current_slot() const;
+  void             set_current_slot(unsigned int slot);
   void             set_roi_x(unsigned int roi_x);
   void             set_roi_y(unsigned int roi_y);
   void             set_roi_width(unsigned int roi_w);
@@ -228,7 +239,7 @@ class SharedMemoryImageBuffer : public fawkes::SharedMemory
  private:
   void constructor(const char *image_id, colorspace_t cspace,
 		   unsigned int width, unsigned int height,
-		   bool is_read_only);
+		   unsigned int num_slots, bool is_read_only);
 
   SharedMemoryImageBufferHeader    *priv_header;
   SharedMemoryImageBuffer_header_t *raw_header;
@@ -39,11 +39,20 @@ namespace firevision {
 typedef enum {
   FUSE_VERSION_1 = 1,	/**< Version 1 */
   FUSE_VERSION_2 = 2,	/**< Version 2 */
-  FUSE_VERSION_3 = 3	/**< Version 3 - current */
+  FUSE_VERSION_3 = 3,	/**< Version 3 */
+  FUSE_VERSION_4 = 4	/**< Version 4 - current, adds image subscriptions */
 } FUSE_version_t;
 
 /** Current FUSE version */
-#define FUSE_CURRENT_VERSION FUSE_VERSION_3
+#define FUSE_CURRENT_VERSION FUSE_VERSION_4
+/** Oldest FUSE version still accepted from the other side */
+#define FUSE_MIN_VERSION FUSE_VERSION_3
+/** Version announced in the initial greeting of the server.
+ * Version 3 clients only accept their own version. Newer clients announce
+ * their version in their greeting, the server confirms the version used
+ * with a second greeting if it is newer than this one.
+ */
+#define FUSE_GREETING_VERSION FUSE_VERSION_3
 
 /** FUSE packet types */
 typedef enum {
@@ -61,6 +70,7 @@ typedef enum {
   FUSE_MT_SET_LUT_FAILED      = 1007,		/**< Setting a LUT failed */
   FUSE_MT_IMAGE_INFO          = 1008,		/**< image info */
   FUSE_MT_IMAGE_INFO_FAILED   = 1009,		/**< Retrieval of image info failed */
+  FUSE_MT_SUBSCRIBE_IMAGE_FAILED = 1010,	/**< Image subscription failed, since v4 */
 
   /* client to server, 2000-2999 */
   FUSE_MT_GET_IMAGE           = 2000,		/**< request image */
@@ -69,6 +79,8 @@ typedef enum {
   FUSE_MT_GET_IMAGE_LIST      = 2003,		/**< get image list */
   FUSE_MT_GET_LUT_LIST        = 2004,		/**< get LUT list */
   FUSE_MT_GET_IMAGE_INFO      = 2005,		/**< get image info */
+  FUSE_MT_SUBSCRIBE_IMAGE     = 2006,		/**< subscribe to image, since v4 */
+  FUSE_MT_UNSUBSCRIBE_IMAGE   = 2007,		/**< unsubscribe from image, since v4 */
 
 } FUSE_message_type_t;
 
@@ -148,6 +160,21 @@ typedef struct {
 } FUSE_imagereq_message_t;
 
 
+/** Image subscription message.
+ * After subscribing, the server sends a FUSE_MT_IMAGE message whenever the
+ * image in the buffer has been updated, i.e. its capture time changed.
+ * If the client cannot keep up, the oldest queued images are dropped.
+ * Available since FUSE version 4.
+ */
+typedef struct {
+  char image_id[IMAGE_ID_MAX_LENGTH];	/**< image ID */
+  uint32_t format   : 8;		/**< requested image format, see FUSE_image_format_t */
+  uint32_t reserved : 24;		/**< reserved for future use */
+  uint32_t min_interval_usec;		/**< minimum time between two images, 0 for no limit */
+  uint32_t queue_length;		/**< maximum number of images queued for sending */
+} FUSE_imagesub_message_t;
+
+
 /** Image description message. */
 typedef struct {
   char image_id[IMAGE_ID_MAX_LENGTH];	/**< image ID */
@@ -34,6 +34,7 @@
 #include <netcomm/socket/stream.h>
 #include <netcomm/utils/exceptions.h>
 
+#include <algorithm>
 #include <cstring>
 #include <netinet/in.h>
 #include <cstdlib>
@@ -80,6 +81,9 @@ FuseClient::FuseClient(const char *hostname, unsigned short int port,
 
   alive_ = true;
   greeting_received_ = false;
+  server_version_ = 0;
+  greeting_version_ = 0;
+  announced_version_ = FUSE_CURRENT_VERSION;
 }
 
 
@@ -111,16 +115,78 @@ FuseClient::~FuseClient()
 }
 
 
-/** Connect. */
+/** Connect.
+ * The greeting announcing the current version is sent right away. Servers
+ * greet with FUSE_GREETING_VERSION and confirm a newer version with a
+ * second greeting. Version 3 servers instead close the connection, in
+ * that case the client connects again announcing version 3.
+ */
 void
 FuseClient::connect()
 {
+  announced_version_ = FUSE_CURRENT_VERSION;
+  greeting_version_ = 0;
   socket_->connect(hostname_, port_);
+  send_greeting();
+}
 
-  FUSE_greeting_message_t *greetmsg = (FUSE_greeting_message_t *)malloc(sizeof(FUSE_greeting_message_t));
-  greetmsg->version = htonl(FUSE_CURRENT_VERSION);
-  outbound_msgq_->push(new FuseNetworkMessage(FUSE_MT_GREETING,
-					       greetmsg, sizeof(FUSE_greeting_message_t)));
+
+/** Enqueue greeting announcing the version to use. */
+void
+FuseClient::send_greeting()
+{
+  FUSE_greeting_message_t *greetmsg =
+    (FUSE_greeting_message_t *)malloc(sizeof(FUSE_greeting_message_t));
+  greetmsg->version = htonl(announced_version_);
+  outbound_msgq_->push_locked(new FuseNetworkMessage(FUSE_MT_GREETING, greetmsg,
+						     sizeof(FUSE_greeting_message_t)));
+}
+
+
+/** Connect again announcing the oldest supported version.
+ * A version 3 server closes the connection when receiving a greeting with
+ * a newer version. The connection may be closed before the greeting of
+ * the server has been processed, hence any connection lost before the
+ * greeting exchange completed is retried once with FUSE_MIN_VERSION.
+ * @return true if connected again, false if the greeting exchange was
+ * completed or the oldest version had been announced already, or if
+ * connecting failed
+ */
+bool
+FuseClient::reconnect_older_version()
+{
+  if ( greeting_received_ || (announced_version_ <= FUSE_MIN_VERSION) ) {
+    return false;
+  }
+
+  delete socket_;
+  socket_ = new StreamSocket();
+  announced_version_ = FUSE_MIN_VERSION;
+  greeting_version_ = 0;
+  try {
+    socket_->connect(hostname_, port_);
+  } catch (Exception &e) {
+    return false;
+  }
+  send_greeting();
+  return true;
+}
+
+
+/** Greeting exchange completed.
+ * @param version protocol version used with the server
+ */
+void
+FuseClient::greeting_complete(uint32_t version)
+{
+  // notify handler first, it is considered connected once
+  // wait_greeting() returns
+  handler_->fuse_connection_established();
+  greeting_mutex_->lock();
+  server_version_ = version;
+  greeting_received_ = true;
+  greeting_waitcond_->wake_all();
+  greeting_mutex_->unlock();
 }
 
 
@@ -143,6 +209,7 @@ FuseClient::send()
   try {
     FuseNetworkTransceiver::send(socket_, outbound_msgq_);
   } catch (ConnectionDiedException &e) {
+    if ( reconnect_older_version() )  return;
     e.print_trace();
     socket_->close();
     alive_ = false;
@@ -162,6 +229,10 @@ FuseClient::recv()
       FuseNetworkTransceiver::recv(socket_, inbound_msgq_);
     }
   } catch (ConnectionDiedException &e) {
+    if ( reconnect_older_version() ) {
+      recv_mutex_->unlock();
+      return;
+    }
     e.print_trace();
     socket_->close();
     alive_ = false;
@@ -300,15 +371,22 @@ FuseClient::loop()
 
     if ( m->type() == FUSE_MT_GREETING ) {
       FUSE_greeting_message_t *gm = m->msg<FUSE_greeting_message_t>();
-      if ( ntohl(gm->version) != FUSE_CURRENT_VERSION ) {
-	handler_->fuse_invalid_server_version(FUSE_CURRENT_VERSION, ntohl(gm->version));
+      uint32_t version = ntohl(gm->version);
+      if ( version < FUSE_MIN_VERSION ) {
+	handler_->fuse_invalid_server_version(FUSE_CURRENT_VERSION, version);
 	alive_ = false;
-      } else {
-	greeting_mutex_->lock();
-	greeting_received_ = true;
-	greeting_waitcond_->wake_all();
-	greeting_mutex_->unlock();
-	handler_->fuse_connection_established();
+      } else if ( ! greeting_received_ ) {
+	if ( greeting_version_ == 0 ) {
+	  // initial greeting, if it offers a lower version than announced
+	  // the server either confirms a version with another greeting or
+	  // closes the connection if it is a version 3 server
+	  greeting_version_ = version;
+	  if ( version >= announced_version_ ) {
+	    greeting_complete(announced_version_);
+	  }
+	} else {
+	  greeting_complete(std::min(version, announced_version_));
+	}
       }
     } else {
       handler_->fuse_inbound_received(m);
@@ -357,4 +435,16 @@ FuseClient::wait_greeting()
   greeting_mutex_->unlock();
 }
 
+
+/** Get protocol version used with the server.
+ * This is the lower of the version of the server and the local version.
+ * Only valid after the greeting has been received, cf. wait_greeting().
+ * @return protocol version, 0 if no greeting has been received, yet
+ */
+uint32_t
+FuseClient::server_version() const
+{
+  return server_version_;
+}
+
 } // end namespace firevision
@@ -57,12 +57,17 @@ class FuseClient : public fawkes::Thread {
   void wait();
   void wait_greeting();
 
+  uint32_t server_version() const;
+
   virtual void loop();
 
  private:
   void send();
   void recv();
   void sleep();
+  void send_greeting();
+  bool reconnect_older_version();
+  void greeting_complete(uint32_t version);
 
   char *hostname_;
   unsigned short int port_;
@@ -80,6 +85,9 @@ class FuseClient : public fawkes::Thread {
   FuseClientHandler       *handler_;
 
   bool greeting_received_;
+  uint32_t server_version_;
+  uint32_t greeting_version_;
+  uint32_t announced_version_;
   fawkes::Mutex         *greeting_mutex_;
   fawkes::WaitCondition *greeting_waitcond_;
 
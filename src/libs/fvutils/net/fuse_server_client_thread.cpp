@@ -41,10 +41,14 @@
 #include <logging/liblogger.h>
 
 #include <netinet/in.h>
+#include <algorithm>
 #include <cstring>
 #include <cstdlib>
 #include <unistd.h>
 
+/// Minimum interval between pushed images of buffers without capture time.
+#define UNKNOWN_CAPTURE_TIME_INTERVAL_USEC 1000000
+
 using namespace fawkes;
 
 namespace firevision {
@@ -68,12 +72,13 @@ FuseServerClientThread::FuseServerClientThread(FuseServer *fuse_server, StreamSo
   fuse_server_ = fuse_server;
   socket_ = s;
   jpeg_compressor_ = NULL;
+  client_version_ = 0;
 
   inbound_queue_  = new FuseNetworkMessageQueue();
   outbound_queue_  = new FuseNetworkMessageQueue();
 
   FUSE_greeting_message_t *greetmsg = (FUSE_greeting_message_t *)malloc(sizeof(FUSE_greeting_message_t));
-  greetmsg->version = htonl(FUSE_CURRENT_VERSION);
+  greetmsg->version = htonl(FUSE_GREETING_VERSION);
   outbound_queue_->push(new FuseNetworkMessage(FUSE_MT_GREETING,
 						greetmsg, sizeof(FUSE_greeting_message_t)));
 
@@ -87,6 +92,10 @@ FuseServerClientThread::~FuseServerClientThread()
   delete socket_;
   delete jpeg_compressor_;
 
+  while (! subscriptions_.empty()) {
+    unsubscribe(subscriptions_.begin());
+  }
+
   for (bit_ = buffers_.begin(); bit_ != buffers_.end(); ++bit_) {
     delete bit_->second;
   }
@@ -147,15 +156,30 @@ FuseServerClientThread::recv()
 
 
 /** Process greeting message.
+ * Clients may announce any version from FUSE_MIN_VERSION on, the lower
+ * of the announced and the current version is used. If that is newer
+ * than the version of the initial greeting it is confirmed with another
+ * greeting. Features of newer versions are only used if requested by
+ * the client.
  * @param m received message
  */
 void
 FuseServerClientThread::process_greeting_message(FuseNetworkMessage *m)
 {
   FUSE_greeting_message_t *gm = m->msg<FUSE_greeting_message_t>();
-  if ( ntohl(gm->version) != FUSE_CURRENT_VERSION ) {
+  uint32_t version = ntohl(gm->version);
+  if ( version < FUSE_MIN_VERSION ) {
     throw Exception("Invalid version on other side");
   }
+  client_version_ = std::min(version, (uint32_t)FUSE_CURRENT_VERSION);
+
+  if ( client_version_ > FUSE_GREETING_VERSION ) {
+    FUSE_greeting_message_t *greetmsg =
+      (FUSE_greeting_message_t *)malloc(sizeof(FUSE_greeting_message_t));
+    greetmsg->version = htonl(client_version_);
+    outbound_queue_->push(new FuseNetworkMessage(FUSE_MT_GREETING, greetmsg,
+						 sizeof(FUSE_greeting_message_t)));
+  }
 }
 
 
@@ -181,29 +205,18 @@ FuseServerClientThread::get_shmimgbuf(const char *id)
 }
 
 
-/** Process image request message.
- * @param m received message
+/** Create image message.
+ * @param b image buffer to send
+ * @param format image format, cf. FUSE_image_format_t
+ * @return image message, or NULL if the format is not supported
  */
-void
-FuseServerClientThread::process_getimage_message(FuseNetworkMessage *m)
+FuseNetworkMessage *
+FuseServerClientThread::create_image_message(SharedMemoryImageBuffer *b, unsigned int format)
 {
-  FUSE_imagereq_message_t *irm = m->msg<FUSE_imagereq_message_t>();
-
-  SharedMemoryImageBuffer *b;
-  try {
-    b = get_shmimgbuf(irm->image_id);
-  } catch (Exception &e) {
-    FuseNetworkMessage *nm = new FuseNetworkMessage(FUSE_MT_GET_IMAGE_FAILED,
-						    m->payload(), m->payload_size(),
-						    /* copy payload */ true);
-    outbound_queue_->push(nm);
-    return;
-  }
-
-  if ( irm->format == FUSE_IF_RAW ) {
+  if ( format == FUSE_IF_RAW ) {
     FuseImageContent *im = new FuseImageContent(b);
-    outbound_queue_->push(new FuseNetworkMessage(FUSE_MT_IMAGE, im));
-  } else if ( irm->format == FUSE_IF_JPEG ) {
+    return new FuseNetworkMessage(FUSE_MT_IMAGE, im);
+  } else if ( format == FUSE_IF_JPEG ) {
     if ( ! jpeg_compressor_) {
       jpeg_compressor_ = new JpegImageCompressor();
       jpeg_compressor_->set_compression_destination(ImageCompressor::COMP_DEST_MEM);
@@ -222,8 +235,30 @@ FuseServerClientThread::process_getimage_message(FuseNetworkMessage *m)
 						compressed_buffer, compressed_buffer_size,
 						CS_UNKNOWN, b->width(), b->height(),
 						sec, usec);
-    outbound_queue_->push(new FuseNetworkMessage(FUSE_MT_IMAGE, im));
     free(compressed_buffer);
+    return new FuseNetworkMessage(FUSE_MT_IMAGE, im);
+  } else {
+    return NULL;
+  }
+}
+
+
+/** Process image request message.
+ * @param m received message
+ */
+void
+FuseServerClientThread::process_getimage_message(FuseNetworkMessage *m)
+{
+  FUSE_imagereq_message_t *irm = m->msg<FUSE_imagereq_message_t>();
+
+  FuseNetworkMessage *im = NULL;
+  try {
+    SharedMemoryImageBuffer *b = get_shmimgbuf(irm->image_id);
+    im = create_image_message(b, irm->format);
+  } catch (Exception &e) {} // sending failure below
+
+  if ( im ) {
+    outbound_queue_->push(im);
   } else {
     FuseNetworkMessage *nm = new FuseNetworkMessage(FUSE_MT_GET_IMAGE_FAILED,
 						    m->payload(), m->payload_size(),
@@ -232,6 +267,134 @@ FuseServerClientThread::process_getimage_message(FuseNetworkMessage *m)
   }
 }
 
+
+/** Process image subscription message.
+ * Subscribing again to the same image updates the subscription parameters.
+ * @param m received message
+ */
+void
+FuseServerClientThread::process_subscribeimage_message(FuseNetworkMessage *m)
+{
+  FUSE_imagesub_message_t *ism = m->msg<FUSE_imagesub_message_t>();
+
+  SharedMemoryImageBuffer *b = NULL;
+  try {
+    b = get_shmimgbuf(ism->image_id);
+  } catch (Exception &e) {} // sending failure below
+
+  if ( ! b || ((ism->format != FUSE_IF_RAW) && (ism->format != FUSE_IF_JPEG)) ) {
+    FuseNetworkMessage *nm = new FuseNetworkMessage(FUSE_MT_SUBSCRIBE_IMAGE_FAILED,
+						    m->payload(), m->payload_size(),
+						    /* copy payload */ true);
+    outbound_queue_->push(nm);
+    return;
+  }
+
+  ImageSubscription &s = subscriptions_[b->image_id()];
+  s.buffer            = b;
+  s.format            = (FUSE_image_format_t)ism->format;
+  s.min_interval_usec = ntohl(ism->min_interval_usec);
+  s.queue_length      = std::max(1u, (unsigned int)ntohl(ism->queue_length));
+  // send the current image right away
+  s.last_capture_time.set_time(0, 0);
+  s.last_sent.set_time(0, 0);
+}
+
+
+/** Process image unsubscription message.
+ * @param m received message
+ */
+void
+FuseServerClientThread::process_unsubscribeimage_message(FuseNetworkMessage *m)
+{
+  FUSE_imagedesc_message_t *idm = m->msg<FUSE_imagedesc_message_t>();
+
+  char tmp_image_id[IMAGE_ID_MAX_LENGTH + 1];
+  tmp_image_id[IMAGE_ID_MAX_LENGTH] = 0;
+  strncpy(tmp_image_id, idm->image_id, IMAGE_ID_MAX_LENGTH);
+
+  std::map<std::string, ImageSubscription>::iterator s = subscriptions_.find(tmp_image_id);
+  if ( s != subscriptions_.end() ) {
+    unsubscribe(s);
+  }
+}
+
+
+/** Remove subscription and drop its queued images.
+ * @param s iterator to subscription to remove
+ */
+void
+FuseServerClientThread::unsubscribe(std::map<std::string, ImageSubscription>::iterator s)
+{
+  for (FuseNetworkMessage *m : s->second.queue) {
+    m->unref();
+  }
+  subscriptions_.erase(s);
+}
+
+
+/** Process image subscriptions.
+ * Queues an image for each subscription whose buffer has been updated
+ * since the last image was queued and the minimum interval has passed.
+ * Updates of buffers with an unset capture time cannot be detected, such
+ * images are pushed at most once every UNKNOWN_CAPTURE_TIME_INTERVAL_USEC,
+ * or less often if the subscription asks for it. If more than the
+ * requested number of images are waiting to be sent the oldest are
+ * dropped. Queued images are only handed to the outbound queue if the
+ * socket can accept more data, so that a slow client cannot stall the
+ * client thread with outdated images.
+ */
+void
+FuseServerClientThread::process_subscriptions()
+{
+  if ( subscriptions_.empty() )  return;
+
+  fawkes::Time now;
+  std::map<std::string, ImageSubscription>::iterator s;
+  for (s = subscriptions_.begin(); s != subscriptions_.end(); ++s) {
+    ImageSubscription &sub = s->second;
+
+    fawkes::Time capture_time = sub.buffer->capture_time();
+    bool unknown_capture_time = (capture_time.get_sec() == 0) && (capture_time.get_usec() == 0);
+    if ( ! unknown_capture_time && (capture_time == sub.last_capture_time) )  continue;
+    long int min_interval_usec = sub.min_interval_usec;
+    if ( unknown_capture_time ) {
+      min_interval_usec = std::max(min_interval_usec, (long int)UNKNOWN_CAPTURE_TIME_INTERVAL_USEC);
+    }
+    if ( (now - sub.last_sent).in_usec() < min_interval_usec )  continue;
+
+    sub.last_capture_time = capture_time;
+    sub.last_sent = now;
+    try {
+      sub.queue.push_back(create_image_message(sub.buffer, sub.format));
+    } catch (Exception &e) {
+      LibLogger::log_warn("FuseServerClientThread", "Failed to create image for "
+			  "subscription to %s", s->first.c_str());
+      LibLogger::log_warn("FuseServerClientThread", e);
+      continue;
+    }
+
+    while ( sub.queue.size() > sub.queue_length ) {
+      sub.queue.front()->unref();
+      sub.queue.pop_front();
+    }
+  }
+
+  short p = 0;
+  try {
+    p = socket_->poll(0, Socket::POLL_OUT);
+  } catch (InterruptedException &e) {} // try again next time
+
+  if ( p & Socket::POLL_OUT ) {
+    for (s = subscriptions_.begin(); s != subscriptions_.end(); ++s) {
+      while ( ! s->second.queue.empty() ) {
+	outbound_queue_->push(s->second.queue.front());
+	s->second.queue.pop_front();
+      }
+    }
+  }
+}
+
 /** Process image info request message.
  * @param m received message
  */
@@ -431,6 +594,18 @@ FuseServerClientThread::process_inbound()
       case FUSE_MT_SET_LUT:
 	process_setlut_message(m);
 	break;
+      case FUSE_MT_SUBSCRIBE_IMAGE:
+	if ( client_version_ < FUSE_VERSION_4 ) {
+	  throw Exception("Image subscription requires FUSE version 4");
+	}
+	process_subscribeimage_message(m);
+	break;
+      case FUSE_MT_UNSUBSCRIBE_IMAGE:
+	if ( client_version_ < FUSE_VERSION_4 ) {
+	  throw Exception("Image subscription requires FUSE version 4");
+	}
+	process_unsubscribeimage_message(m);
+	break;
       default:
 	throw Exception("Unknown message type received\n");
       }
@@ -482,6 +657,7 @@ FuseServerClientThread::loop()
   }
 
   if ( alive_ ) {
+    process_subscriptions();
     send();
   }
 }
@@ -25,7 +25,10 @@
 #define _FIREVISION_FVUTILS_NET_FUSE_SERVER_CLIENT_THREAD_H_
 
 #include <core/threading/thread.h>
+#include <fvutils/net/fuse.h>
+#include <utils/time/time.h>
 
+#include <list>
 #include <map>
 #include <string>
 
@@ -59,9 +62,27 @@ class FuseServerClientThread : public fawkes::Thread
   void process_getlut_message(FuseNetworkMessage *m);
   void process_setlut_message(FuseNetworkMessage *m);
   void process_getlutlist_message(FuseNetworkMessage *m);
+  void process_subscribeimage_message(FuseNetworkMessage *m);
+  void process_unsubscribeimage_message(FuseNetworkMessage *m);
 
  private:
+  /// @cond INTERNALS
+  typedef struct {
+    SharedMemoryImageBuffer *        buffer;
+    FUSE_image_format_t              format;
+    long int                         min_interval_usec;
+    unsigned int                     queue_length;
+    fawkes::Time                     last_capture_time;
+    fawkes::Time                     last_sent;
+    std::list<FuseNetworkMessage *>  queue;
+  } ImageSubscription;
+  /// @endcond
+
   void process_inbound();
+  void process_subscriptions();
+  void unsubscribe(std::map<std::string, ImageSubscription>::iterator s);
+  FuseNetworkMessage *       create_image_message(SharedMemoryImageBuffer *b,
+						  unsigned int format);
   SharedMemoryImageBuffer *  get_shmimgbuf(const char *id);
 
   FuseServer   *fuse_server_;
@@ -78,6 +99,10 @@ class FuseServerClientThread : public fawkes::Thread
   std::map< std::string, SharedMemoryLookupTable * >  luts_;
   std::map< std::string, SharedMemoryLookupTable * >::iterator  lit_;
 
+  std::map<std::string, ImageSubscription>  subscriptions_;
+
+  uint32_t client_version_;
+
   bool alive_;
 };
 
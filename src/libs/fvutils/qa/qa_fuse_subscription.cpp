@@ -0,0 +1,344 @@
+/***************************************************************************
+ *  qa_fuse_subscription.cpp - QA for FUSE version negotiation and
+ *                             image subscriptions
+ *
+ *  Created: Mon Oct 19 00:31:08 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+/// @cond QA
+
+#include <fvutils/net/fuse_server.h>
+#include <fvutils/net/fuse_client.h>
+#include <fvutils/net/fuse_client_handler.h>
+#include <fvutils/net/fuse_message.h>
+#include <fvutils/ipc/shm_image.h>
+#include <netcomm/socket/stream.h>
+#include <core/exception.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <unistd.h>
+
+using namespace fawkes;
+using namespace firevision;
+
+#define V3_SERVER_PORT 5101
+#define V3_CLIENT_PORT 5102
+#define SERVER_PORT    5103
+#define IMAGE_ID       "qa-fuse-subscription"
+
+class QaFuseClientHandler : public FuseClientHandler
+{
+ public:
+  QaFuseClientHandler() : num_images(0), num_failed(0) {}
+
+  virtual void fuse_invalid_server_version(uint32_t local_version,
+					   uint32_t remote_version) throw()
+  {
+    printf("Invalid server version %u (local %u)\n", remote_version, local_version);
+  }
+
+  virtual void fuse_connection_established() throw() {}
+  virtual void fuse_connection_died() throw() {}
+
+  virtual void fuse_inbound_received(FuseNetworkMessage *m) throw()
+  {
+    if (m->type() == FUSE_MT_IMAGE)  ++num_images;
+    else if (m->type() == FUSE_MT_SUBSCRIBE_IMAGE_FAILED)  ++num_failed;
+  }
+
+  std::atomic<unsigned int> num_images;
+  std::atomic<unsigned int> num_failed;
+};
+
+
+static void
+write_greeting(Socket *s, uint32_t version)
+{
+  FUSE_header_t header;
+  FUSE_greeting_message_t greeting;
+  header.message_type = htonl(FUSE_MT_GREETING);
+  header.payload_size = htonl(sizeof(greeting));
+  greeting.version    = htonl(version);
+  s->write(&header, sizeof(header));
+  s->write(&greeting, sizeof(greeting));
+}
+
+
+static bool
+read_greeting(Socket *s, uint32_t &version)
+{
+  FUSE_header_t header;
+  FUSE_greeting_message_t greeting;
+  s->read(&header, sizeof(header));
+  if ((ntohl(header.message_type) != FUSE_MT_GREETING) ||
+      (ntohl(header.payload_size) != sizeof(greeting))) {
+    printf("Expected greeting, got message %u of size %u\n",
+	   ntohl(header.message_type), ntohl(header.payload_size));
+    return false;
+  }
+  s->read(&greeting, sizeof(greeting));
+  version = ntohl(greeting.version);
+  return true;
+}
+
+
+static FuseServer *
+start_server(unsigned short int port)
+{
+  FuseServer *fs = new FuseServer(true, false, "", "", port);
+  fs->start();
+  return fs;
+}
+
+
+static void
+stop_server(FuseServer *fs)
+{
+  fs->cancel();
+  fs->join();
+  delete fs;
+}
+
+
+static void
+connect(FuseClient *fc)
+{
+  // acceptor thread may not be listening, yet
+  for (unsigned int i = 0; ; ++i) {
+    try {
+      fc->connect();
+      return;
+    } catch (Exception &e) {
+      if (i == 50)  throw;
+      usleep(20000);
+    }
+  }
+}
+
+
+/* A version 3 server greets with version 3 and closes the connection
+ * if the client greets with another version. The client must connect
+ * again announcing version 3. */
+static bool
+test_v3_server()
+{
+  StreamSocket server(Socket::IPv4);
+  server.bind(V3_SERVER_PORT);
+  server.listen();
+
+  QaFuseClientHandler handler;
+  FuseClient *fc = new FuseClient("127.0.0.1", V3_SERVER_PORT, &handler);
+  fc->connect();
+  fc->start();
+
+  bool success = true;
+  uint32_t version = 0;
+  Socket *conn = server.accept();
+  write_greeting(conn, FUSE_VERSION_3);
+  if (! read_greeting(conn, version))  success = false;
+  else if (version != FUSE_CURRENT_VERSION) {
+    printf("Client announced version %u, expected %u\n", version, FUSE_CURRENT_VERSION);
+    success = false;
+  }
+  delete conn;
+
+  if (success) {
+    conn = server.accept();
+    write_greeting(conn, FUSE_VERSION_3);
+    if (! read_greeting(conn, version))  success = false;
+    else if (version != FUSE_VERSION_3) {
+      printf("Client announced version %u after reconnect, expected 3\n", version);
+      success = false;
+    }
+
+    fc->wait_greeting();
+    if (fc->server_version() != FUSE_VERSION_3) {
+      printf("Client uses version %u with a version 3 server\n", fc->server_version());
+      success = false;
+    }
+    delete conn;
+  }
+
+  fc->cancel();
+  fc->join();
+  delete fc;
+  return success;
+}
+
+
+/* A version 3 client only accepts a greeting with version 3 and sends its
+ * own version. It must be served without ever seeing another greeting. */
+static bool
+test_v3_client()
+{
+  FuseServer *fs = start_server(V3_CLIENT_PORT);
+
+  StreamSocket client(Socket::IPv4);
+  for (unsigned int i = 0; ; ++i) {
+    try {
+      client.connect("127.0.0.1", V3_CLIENT_PORT);
+      break;
+    } catch (Exception &e) {
+      if (i == 50)  throw;
+      usleep(20000);
+    }
+  }
+
+  bool success = true;
+  uint32_t version = 0;
+  if (! read_greeting(&client, version))  success = false;
+  else if (version != FUSE_VERSION_3) {
+    printf("Server greeted with version %u, expected 3\n", version);
+    success = false;
+  }
+
+  if (success) {
+    write_greeting(&client, FUSE_VERSION_3);
+
+    FUSE_header_t header;
+    header.message_type = htonl(FUSE_MT_GET_IMAGE_LIST);
+    header.payload_size = 0;
+    client.write(&header, sizeof(header));
+
+    client.read(&header, sizeof(header));
+    if (ntohl(header.message_type) != FUSE_MT_IMAGE_LIST) {
+      printf("Expected image list, got message %u\n", ntohl(header.message_type));
+      success = false;
+    }
+  }
+
+  client.close();
+  stop_server(fs);
+  return success;
+}
+
+
+static void
+subscribe(FuseClient *fc)
+{
+  FUSE_imagesub_message_t *ism =
+    (FUSE_imagesub_message_t *)calloc(1, sizeof(FUSE_imagesub_message_t));
+  strncpy(ism->image_id, IMAGE_ID, IMAGE_ID_MAX_LENGTH - 1);
+  ism->format            = FUSE_IF_RAW;
+  ism->min_interval_usec = htonl(0);
+  ism->queue_length      = htonl(1);
+  fc->enqueue(FUSE_MT_SUBSCRIBE_IMAGE, ism, sizeof(FUSE_imagesub_message_t));
+}
+
+
+/* A current client and server negotiate version 4. A subscription pushes
+ * the current image, one image per change of the capture time and none
+ * while it stays the same. Images without capture time are throttled
+ * rather than sent on every loop of the server thread. */
+static bool
+test_subscription()
+{
+  SharedMemoryImageBuffer *buf =
+    new SharedMemoryImageBuffer(IMAGE_ID, YUV422_PLANAR, 64, 48);
+  buf->set_capture_time(1, 0);
+
+  FuseServer *fs = start_server(SERVER_PORT);
+
+  QaFuseClientHandler handler;
+  FuseClient *fc = new FuseClient("127.0.0.1", SERVER_PORT, &handler);
+  connect(fc);
+  fc->start();
+  fc->wait_greeting();
+
+  bool success = true;
+  if (fc->server_version() != FUSE_VERSION_4) {
+    printf("Client uses version %u with a current server\n", fc->server_version());
+    success = false;
+  }
+
+  subscribe(fc);
+  usleep(200000);
+  if (handler.num_failed != 0) {
+    printf("Subscription failed\n");
+    success = false;
+  }
+  if (handler.num_images != 1) {
+    printf("%u images after subscribing, expected 1\n", handler.num_images.load());
+    success = false;
+  }
+
+  for (unsigned int i = 2; i < 7; ++i) {
+    buf->set_capture_time(i, 0);
+    usleep(100000);
+  }
+  if (handler.num_images != 6) {
+    printf("%u images after 5 updates, expected 6\n", handler.num_images.load());
+    success = false;
+  }
+
+  usleep(300000);
+  if (handler.num_images != 6) {
+    printf("%u images without update, expected 6\n", handler.num_images.load());
+    success = false;
+  }
+
+  buf->set_capture_time(0, 0);
+  usleep(1500000);
+  unsigned int num_unknown = handler.num_images - 6;
+  if (num_unknown < 1 || num_unknown > 2) {
+    printf("%u images pushed in 1.5 sec without capture time\n", num_unknown);
+    success = false;
+  }
+
+  fc->cancel();
+  fc->join();
+  delete fc;
+  stop_server(fs);
+  delete buf;
+  return success;
+}
+
+
+int
+main(int argc, char **argv)
+{
+  bool success = true;
+  try {
+    if (! test_v3_server()) {
+      printf("FAILED new client with version 3 server\n");
+      success = false;
+    }
+    if (! test_v3_client()) {
+      printf("FAILED version 3 client with new server\n");
+      success = false;
+    }
+    if (! test_subscription()) {
+      printf("FAILED image subscription\n");
+      success = false;
+    }
+  } catch (Exception &e) {
+    printf("FAILED, exception:\n");
+    e.print_trace();
+    success = false;
+  }
+
+  if (success)  printf("PASSED\n");
+  return success ? 0 : 1;
+}
+
+/// @endcond
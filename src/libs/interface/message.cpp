@@ -73,7 +73,6 @@ Message::Message(const char *type)
   data_ts      = NULL;
   _sender_id   = 0;
   _type        = strdup(type);
-  time_enqueued_ = new Time();
 
   _transmit_via_iface              = NULL;
   sender_interface_instance_serial = 0;
@@ -92,6 +91,7 @@ Message::Message(const char *type)
  * @param mesg Message to copy.
  */
 Message::Message(const Message &mesg)
+  : time_enqueued_(mesg.time_enqueued_)
 {
   message_id_ = 0;
   hops_       = mesg.hops_;
@@ -102,7 +102,6 @@ Message::Message(const Message &mesg)
   data_ts      = (message_data_ts_t *)data_ptr;
   _sender_id   = 0;
   _type        = strdup(mesg._type);
-  time_enqueued_ = new Time(mesg.time_enqueued_);
 
   _transmit_via_iface              = NULL;
   sender_interface_instance_serial = 0;
@@ -134,6 +133,7 @@ Message::Message(const Message &mesg)
  * @param mesg Message to copy.
  */
 Message::Message(const Message *mesg)
+  : time_enqueued_(mesg->time_enqueued_)
 {
   message_id_ = 0;
   hops_       = mesg->hops_;
@@ -147,7 +147,6 @@ Message::Message(const Message *mesg)
   _transmit_via_iface              = NULL;
   sender_interface_instance_serial = 0;
   recipient_interface_mem_serial   = 0;
-  time_enqueued_ = new Time(mesg->time_enqueued_);
 
   memcpy(data_ptr, mesg->data_ptr, data_size);
 
@@ -176,7 +175,6 @@ Message::~Message()
 {
   free(_sender_thread_name);
   free(_type);
-  delete time_enqueued_;
 
   interface_fieldinfo_t *infol = fieldinfo_list_;
   while ( infol ) {
@@ -231,9 +229,9 @@ Message::set_hops(unsigned int hops)
 void
 Message::mark_enqueued()
 {
-  time_enqueued_->stamp();
+  time_enqueued_.stamp();
   long sec = 0, usec = 0;
-  time_enqueued_->get_timestamp(sec, usec);
+  time_enqueued_.get_timestamp(sec, usec);
   data_ts->timestamp_sec  = sec;
   data_ts->timestamp_usec = usec;
 
@@ -261,7 +259,7 @@ Message::enqueued() const
 const Time *
 Message::time_enqueued() const
 {
-  return time_enqueued_;
+  return &time_enqueued_;
 }
 
 
@@ -304,7 +302,7 @@ void
 Message::set_from_chunk(const void *chunk)
 {
   memcpy(data_ptr, chunk, data_size);
-  time_enqueued_->set_time(data_ts->timestamp_sec, data_ts->timestamp_usec);
+  time_enqueued_.set_time(data_ts->timestamp_sec, data_ts->timestamp_usec);
 }
 
 
@@ -318,7 +316,7 @@ Message::operator=  (const Message & m)
 {
   if ( data_size == m.data_size ) {
     memcpy(data_ptr, m.data_ptr, data_size);
-    time_enqueued_->set_time(data_ts->timestamp_sec, data_ts->timestamp_usec);
+    time_enqueued_.set_time(data_ts->timestamp_sec, data_ts->timestamp_usec);
   }
 
   return *this;
@@ -28,6 +28,7 @@
 #include <interface/types.h>
 #include <core/utils/refcount.h>
 #include <core/exceptions/software.h>
+#include <utils/time/time.h>
 
 #define INTERFACE_MESSAGE_TYPE_SIZE_ 32
 
@@ -36,7 +37,6 @@ namespace fawkes {
 class Mutex;
 class Interface;
 class InterfaceFieldIterator;
-class Time;
 
 class Message : public RefCount
 {
@@ -95,7 +95,7 @@ class Message : public RefCount
   unsigned int  message_id_;
   unsigned int  hops_;
   bool          enqueued_;
-  Time         *time_enqueued_;
+  Time          time_enqueued_;
 
   unsigned int  recipient_interface_mem_serial;  
   unsigned int  sender_interface_instance_serial;  
@@ -0,0 +1,214 @@
+/***************************************************************************
+ *  qa_tolua_ffi_layout.cpp - QA for the LuaJIT FFI data layout
+ *
+ *  Created: Sun Oct 18 16:41:52 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+/// @cond QA
+
+// Generates tolua++ packages for interfaces covering all field types and
+// checks with LuaJIT that the FFI struct declared by the package has the
+// layout of the C++ data struct, i.e. the same size as datasize() and the
+// same field offsets. The C++ layout is that of the packed struct written
+// by the C++ generator. The check is written as Lua script and run with
+// the given LuaJIT command, "luajit" by default.
+
+#include "../tolua_generator.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdint.h>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+/* Size of the C++ type used for a field in the data struct. */
+static size_t
+struct_type_size(const InterfaceField &field)
+{
+  std::string t = field.getStructType();
+  if (t == "char")     return sizeof(char);
+  if (t == "bool")     return sizeof(bool);
+  if (t == "float")    return sizeof(float);
+  if (t == "double")   return sizeof(double);
+  if (t == "int8_t")   return sizeof(int8_t);
+  if (t == "uint8_t")  return sizeof(uint8_t);
+  if (t == "int16_t")  return sizeof(int16_t);
+  if (t == "uint16_t") return sizeof(uint16_t);
+  if (t == "int32_t")  return sizeof(int32_t);
+  if (t == "uint32_t") return sizeof(uint32_t);
+  if (t == "int64_t")  return sizeof(int64_t);
+  if (t == "uint64_t") return sizeof(uint64_t);
+  printf("Unknown struct type %s of field %s\n", t.c_str(), field.getName().c_str());
+  exit(1);
+}
+
+
+static InterfaceField
+field(const std::string &name, const std::string &type, const std::string &length = "",
+      std::vector<InterfaceEnumConstant> *enum_constants = NULL)
+{
+  InterfaceField f(enum_constants);
+  f.setName(name);
+  f.setType(type);
+  if (! length.empty())  f.setLength(length);
+  return f;
+}
+
+
+/* Generate the package and append the check for it to the script. */
+static void
+add_interface(const std::string &dir, const std::string &name,
+	      const std::vector<InterfaceEnumConstant> &enum_constants,
+	      const std::vector<InterfaceField> &fields, FILE *script)
+{
+  unsigned char hash[16] = {0};
+  ToLuaInterfaceGenerator g(dir, name, name, "qa", "2026", "", "", hash, sizeof(hash),
+			    std::vector<InterfaceConstant>(), enum_constants, fields,
+			    std::vector<InterfacePseudoMap>(), std::vector<InterfaceMessage>());
+  g.generate();
+
+  // packed struct, the timestamp comes first
+  size_t offset = 2 * sizeof(int64_t);
+  fprintf(script, "check(\"%s\", {\n", name.c_str());
+  for (const InterfaceField &f : fields) {
+    fprintf(script, "  { \"%s\", %zu },\n", f.getName().c_str(), offset);
+    size_t count = (f.getLengthValue() > 0) ? f.getLengthValue() : 1;
+    offset += count * struct_type_size(f);
+  }
+  fprintf(script, "}, %zu)\n", offset);
+}
+
+
+int
+main(int argc, char **argv)
+{
+  std::string luajit = "luajit";
+  if (argc > 1)  luajit = argv[1];
+
+  char dirtmpl[] = "/tmp/qa_tolua_ffi_layout.XXXXXX";
+  if (! mkdtemp(dirtmpl)) {
+    printf("FAILED, cannot create temporary directory\n");
+    return 1;
+  }
+  std::string dir = std::string(dirtmpl) + "/";
+
+  std::string script_file = dir + "check.lua";
+  FILE *script = fopen(script_file.c_str(), "w");
+  fprintf(script,
+	  "local ffi = require(\"ffi\")\n"
+	  "local dir = \"%s\"\n"
+	  "local success = true\n"
+	  "fawkes = {}\n\n"
+	  "-- run the FFI block embedded in the generated package\n"
+	  "local function load_package(name)\n"
+	  "  local f = assert(io.open(dir .. name .. \".tolua\"))\n"
+	  "  local pkg = f:read(\"*a\")\n"
+	  "  f:close()\n"
+	  "  for block in pkg:gmatch(\"%%$%%[(.-)%%$%%]\") do\n"
+	  "    if block:find(\"if jit then\", 1, true) then\n"
+	  "      fawkes[name] = {}\n"
+	  "      assert(loadstring(block, name))()\n"
+	  "      return\n"
+	  "    end\n"
+	  "  end\n"
+	  "  error(\"No FFI code in package \" .. name)\n"
+	  "end\n\n"
+	  "function check(name, offsets, size)\n"
+	  "  load_package(name)\n"
+	  "  local ctype = \"fawkes_\" .. name .. \"_data_t\"\n"
+	  "  if ffi.sizeof(ctype) ~= size then\n"
+	  "    print(string.format(\"%%s: FFI size %%d, C++ data size %%d\",\n"
+	  "                        name, ffi.sizeof(ctype), size))\n"
+	  "    success = false\n"
+	  "  end\n"
+	  "  for _, o in ipairs(offsets) do\n"
+	  "    if ffi.offsetof(ctype, o[1]) ~= o[2] then\n"
+	  "      print(string.format(\"%%s: FFI offset of %%s %%s, C++ offset %%d\",\n"
+	  "                          name, o[1], tostring(ffi.offsetof(ctype, o[1])), o[2]))\n"
+	  "      success = false\n"
+	  "    end\n"
+	  "  end\n"
+	  "  -- ffi_data() must accept an interface with the C++ data size\n"
+	  "  local chunk = ffi.new(\"uint8_t[?]\", size)\n"
+	  "  local iface = { datasize = function() return size end,\n"
+	  "                  datachunk = function() return chunk end }\n"
+	  "  local ok, err = pcall(fawkes[name].ffi_data, iface)\n"
+	  "  if not ok then\n"
+	  "    print(name .. \": ffi_data() failed: \" .. tostring(err))\n"
+	  "    success = false\n"
+	  "  end\n"
+	  "end\n\n",
+	  dir.c_str());
+
+  std::vector<InterfaceEnumConstant> no_enums;
+
+  std::vector<InterfaceField> scalars;
+  const char *types[] = { "bool", "int8", "uint8", "int16", "uint16", "int32", "uint32",
+			  "int64", "uint64", "float", "double", "byte" };
+  for (const char *t : types) {
+    // odd sized bool in front of each field, everything is unaligned
+    scalars.push_back(field(std::string("pad_") + t, "bool"));
+    scalars.push_back(field(std::string("value_") + t, t));
+  }
+  add_interface(dir, "QaScalarInterface", no_enums, scalars, script);
+
+  std::vector<InterfaceField> arrays;
+  for (const char *t : types) {
+    arrays.push_back(field(std::string("array_") + t, t, "3"));
+  }
+  arrays.push_back(field("text", "string", "33"));
+  arrays.push_back(field("flag", "bool"));
+  add_interface(dir, "QaArrayInterface", no_enums, arrays, script);
+
+  std::vector<InterfaceEnumConstant> enums;
+  enums.push_back(InterfaceEnumConstant("QaMode", "mode"));
+  enums.back().add_item("MODE_A", "a");
+  enums.back().add_item("MODE_B", "b");
+  std::vector<InterfaceField> enum_fields;
+  enum_fields.push_back(field("flag", "bool"));
+  enum_fields.push_back(field("mode", "QaMode", "", &enums));
+  enum_fields.push_back(field("modes", "QaMode", "2", &enums));
+  enum_fields.push_back(field("frame", "string", "32"));
+  enum_fields.push_back(field("distances", "float", "1080"));
+  add_interface(dir, "QaEnumInterface", enums, enum_fields, script);
+
+  fprintf(script,
+	  "\nprint(success and \"PASSED\" or \"FAILED LuaJIT FFI layout\")\n"
+	  "os.exit(success and 0 or 1)\n");
+  fclose(script);
+
+  std::string cmd = luajit + " " + script_file;
+  int rv = system(cmd.c_str());
+  if (rv == -1 || ! WIFEXITED(rv) || WEXITSTATUS(rv) == 127) {
+    printf("FAILED, cannot run '%s'\n", cmd.c_str());
+    return 1;
+  }
+  if (WEXITSTATUS(rv) == 0) {
+    std::string rm = "rm -rf " + dir;
+    if (system(rm.c_str()) != 0) {
+      printf("Failed to remove %s\n", dir.c_str());
+    }
+  } else {
+    printf("Generated files kept in %s\n", dir.c_str());
+  }
+  return WEXITSTATUS(rv);
+}
+
+/// @endcond
@@ -406,6 +406,55 @@ ToLuaInterfaceGenerator::write_lua_code(FILE *f, std::string classname)
 	        classname.c_str(), classname.c_str(), classname.c_str());
 }
 
+
+/** Write LuaJIT FFI data access code to file.
+ * On LuaJIT the code declares a struct matching the packed data chunk
+ * and adds the ffi_data() method returning a pointer to the chunk.
+ * @param f file to write to
+ * @param classname name of the interface class
+ */
+void
+ToLuaInterfaceGenerator::write_lua_ffi_code(FILE *f, std::string classname)
+{
+  std::string ctype = "fawkes_" + classname + "_data_t";
+
+  fprintf(f,
+	  "$[\n\n"
+	  "if jit then\n"
+	  "  local ok, ffi = pcall(require, \"ffi\")\n"
+	  "  if ok then\n"
+	  "    if not pcall(ffi.typeof, \"%s\") then\n"
+	  "      ffi.cdef(\"typedef struct __attribute__((packed)) { \" ..\n"
+	  "               \"int64_t timestamp_sec; int64_t timestamp_usec; \" ..\n",
+	  ctype.c_str());
+
+  for (vector<InterfaceField>::iterator i = data_fields.begin(); i != data_fields.end(); ++i) {
+    if ( i->getLengthValue() > 0 ) {
+      fprintf(f, "               \"%s %s[%u]; \" ..\n",
+	      i->getStructType().c_str(), i->getName().c_str(), i->getLengthValue());
+    } else {
+      fprintf(f, "               \"%s %s; \" ..\n",
+	      i->getStructType().c_str(), i->getName().c_str());
+    }
+  }
+
+  fprintf(f,
+	  "               \"} %s;\")\n"
+	  "    end\n"
+	  "    local ptr_type = ffi.typeof(\"const %s *\")\n"
+	  "    local size = ffi.sizeof(\"%s\")\n"
+	  "    function fawkes.%s.ffi_data(iface)\n"
+	  "      assert(iface:datasize() == size, \"FFI data layout of %s does not match\")\n"
+	  "      return ffi.cast(ptr_type, iface:datachunk())\n"
+	  "    end\n"
+	  "  end\n"
+	  "end\n"
+	  "\n$]\n\n",
+	  ctype.c_str(), ctype.c_str(), ctype.c_str(),
+	  classname.c_str(), classname.c_str());
+}
+
+
 /** Write methods to h file.
  * @param f file to write to
  * @param is indentation space.
@@ -498,6 +547,7 @@ ToLuaInterfaceGenerator::write_toluaf(FILE *f)
   write_superclass_h(f);
   fprintf(f, "\n};\n\n");
   write_lua_code(f, class_name);
+  write_lua_ffi_code(f, class_name);
   fprintf(f, "}\n");
 }
 
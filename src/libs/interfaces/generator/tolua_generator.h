@@ -57,6 +57,7 @@ class ToLuaInterfaceGenerator
   void write_message_superclass_h(FILE *f);
   void write_superclass_h(FILE *f);
   void write_lua_code(FILE *f, std::string classname);
+  void write_lua_ffi_code(FILE *f, std::string classname);
   void write_methods_h(FILE *f,
 		       std::string /* indent space */ is,
 		       std::vector<InterfaceField> fields);
@@ -53,6 +53,12 @@ namespace fawkes {
  * Lua instance is then automatically restarted (closed, re-opened and
  * re-initialized).
  *
+ * Functions which are called periodically, for example once per loop,
+ * should be registered as entry points with add_entry_point(). They are
+ * compiled once and kept in the Lua registry, calling them requires
+ * neither formatting nor compiling a string. Entry points are compiled
+ * again for the new state on restart().
+ *
  * @author Tim Niemueller
  */
 
@@ -294,6 +300,16 @@ LuaContext::restart()
 	  lock.relock();
     lua_State *tL = L_;
 
+    std::vector<int> entry_point_refs;
+    try {
+      for (size_t i = 0; i < entry_points_.size(); ++i) {
+        entry_point_refs.push_back(load_entry_point(L, entry_points_[i]));
+      }
+    } catch (Exception &e) {
+      lua_close(L);
+      throw;
+    }
+
     try {
 	    if (! finalize_call_.empty())
 		    do_string(L_, "%s", finalize_call_.c_str());
@@ -304,6 +320,7 @@ LuaContext::restart()
     }
 
     L_ = L;
+    entry_point_refs_.swap(entry_point_refs);
     if (owns_L_)  lua_close(tL);
     owns_L_ = true;
 
@@ -644,6 +661,98 @@ LuaContext::pcall(int nargs, int nresults, int errfunc)
 }
 
 
+/** Compile entry point.
+ * @param L Lua state to compile the entry point in
+ * @param function Lua expression evaluating to the function to call
+ * @return registry reference to the compiled chunk
+ */
+int
+LuaContext::load_entry_point(lua_State *L, const std::string &function)
+{
+  // chunks are vararg functions, arguments are passed on to the function
+  std::string code = "return " + function + "(...)";
+  int err;
+  if ( (err = luaL_loadstring(L, code.c_str())) != 0 ) {
+    std::string errmsg = lua_tostring(L, -1);
+    lua_pop(L, 1);
+    switch (err) {
+    case LUA_ERRSYNTAX:
+      throw SyntaxErrorException("Lua syntax error in entry point '%s': %s",
+				 function.c_str(), errmsg.c_str());
+
+    default:
+      throw OutOfMemoryException("Could not load entry point '%s'", function.c_str());
+    }
+  }
+  return luaL_ref(L, LUA_REGISTRYINDEX);
+}
+
+
+/** Add an entry point.
+ * An entry point is a function which is called often, for example in
+ * every loop. The call is compiled once and stored in the Lua registry.
+ * The function itself is looked up on each call, hence it may be defined
+ * or replaced after the entry point has been added. Entry points survive
+ * restart(), they are compiled again for the new Lua state.
+ * @param function Lua expression evaluating to the function to call,
+ * for example "skillenv.loop"
+ * @return ID of the entry point to pass to call_entry_point(), the same
+ * ID is returned if the function has been added before
+ * @exception SyntaxErrorException thrown if the expression is invalid
+ */
+unsigned int
+LuaContext::add_entry_point(const char *function)
+{
+  MutexLocker lock(lua_mutex_);
+  for (size_t i = 0; i < entry_points_.size(); ++i) {
+    if (entry_points_[i] == function)  return i;
+  }
+  entry_point_refs_.push_back(load_entry_point(L_, function));
+  entry_points_.push_back(function);
+  return entry_points_.size() - 1;
+}
+
+
+/** Push entry point on top of stack.
+ * @param id ID of the entry point as returned by add_entry_point()
+ * @exception OutOfBoundsException thrown if the ID is invalid
+ */
+void
+LuaContext::push_entry_point(unsigned int id)
+{
+  if (id >= entry_point_refs_.size()) {
+    throw OutOfBoundsException("Invalid entry point", id,
+			       0, (float)entry_point_refs_.size() - 1);
+  }
+  lua_rawgeti(L_, LUA_REGISTRYINDEX, entry_point_refs_[id]);
+}
+
+
+/** Call entry point.
+ * The arguments must have been pushed on the stack before, the first
+ * argument is pushed first. Unlike do_string() no string is formatted
+ * or compiled.
+ * @param id ID of the entry point as returned by add_entry_point()
+ * @param nargs number of arguments on top of the stack
+ * @param nresults number of results
+ * @exception OutOfBoundsException thrown if the ID is invalid
+ * @exception Exception thrown for errors during the call, see pcall()
+ */
+void
+LuaContext::call_entry_point(unsigned int id, int nargs, int nresults)
+{
+  MutexLocker lock(lua_mutex_);
+  try {
+    push_entry_point(id);
+  } catch (Exception &e) {
+    lua_pop(L_, nargs);
+    throw;
+  }
+  if (nargs > 0)  lua_insert(L_, -(nargs + 1));
+  pcall(nargs, nresults);
+}
+
+
 /** Assert that the name is unique.
  * Checks the internal context structures if the name has been used
  * already. It will accept a value that has already been set that is of the same
@@ -35,6 +35,7 @@
 #include <utility>
 #include <list>
 #include <string>
+#include <vector>
 
 namespace fawkes {
 
@@ -74,6 +75,10 @@ class LuaContext : public FamListener
   void load_string(const char *s);
   void pcall(int nargs = 0, int nresults = 0, int errfunc = 0);
 
+  unsigned int add_entry_point(const char *function);
+  void         push_entry_point(unsigned int id);
+  void         call_entry_point(unsigned int id, int nargs = 0, int nresults = 0);
+
   void set_usertype(const char *name, void *data, const char *type_name,
 		     const char *name_space = 0);
   void set_string(const char *name, const char *value);
@@ -154,6 +159,7 @@ class LuaContext : public FamListener
   void         do_string(lua_State *L, const char *format, ...);
   void         do_file(lua_State *L, const char *s);
   void         assert_unique_name(const char *name, std::string type);
+  int          load_entry_point(lua_State *L, const std::string &function);
 
  
  private:
@@ -182,6 +188,9 @@ class LuaContext : public FamListener
   std::map<std::string, lua_CFunction>           cfuncs_;
   std::map<std::string, lua_CFunction>::iterator cfuncs_it_;
 
+  std::vector<std::string>  entry_points_;
+  std::vector<int>          entry_point_refs_;
+
   std::string finalize_call_;
   std::string finalize_prepare_call_;
   std::string finalize_cancel_call_;
@@ -25,17 +25,98 @@
 ///@cond QA
 
 #include <lua/context.h>
+#include <core/exception.h>
+#include <utils/time/time.h>
 #include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
 
 using namespace fawkes;
 
+#define NUM_CALLS 100000
+
 int
 main(int argc, char **argv)
 {
+  char script[] = "/tmp/qa_lua_context_XXXXXX";
+  int fd = mkstemp(script);
+  FILE *f = (fd != -1) ? fdopen(fd, "w") : NULL;
+  if (! f) {
+    printf("Failed to create start script\n");
+    return 5;
+  }
+  fprintf(f, "counter = { n = 0 }\nfunction counter.inc(v) counter.n = counter.n + v end\n");
+  fclose(f);
+
   LuaContext lua;
+  int rv = 0;
+  try {
+    lua.set_start_script(script);
+
+    unsigned int inc = lua.add_entry_point("counter.inc");
+    if (lua.add_entry_point("counter.inc") != inc) {
+      printf("FAILED: entry point added twice\n");
+      rv = 1;
+    }
+
+    Time start;
+    for (unsigned int i = 0; i < NUM_CALLS; ++i) {
+      lua.do_string("counter.inc(%u)", 1);
+    }
+    Time end;
+    printf("do_string():        %6.3f usec per call\n", (end - &start) * 1000000. / NUM_CALLS);
+
+    start.stamp();
+    for (unsigned int i = 0; i < NUM_CALLS; ++i) {
+      lua.push_integer(1);
+      lua.call_entry_point(inc, 1);
+    }
+    end.stamp();
+    printf("call_entry_point(): %6.3f usec per call\n", (end - &start) * 1000000. / NUM_CALLS);
+
+    lua.get_global("counter");
+    lua.get_field(-1, "n");
+    if (lua.to_integer(-1) != 2 * NUM_CALLS) {
+      printf("FAILED: counter is %li, expected %i\n", (long)lua.to_integer(-1), 2 * NUM_CALLS);
+      rv = 2;
+    }
+    lua.pop(2);
+
+    // entry points must be valid in the new state after a restart,
+    // the start script resets the counter
+    lua.restart();
+    lua.push_integer(5);
+    lua.call_entry_point(inc, 1);
+    lua.get_global("counter");
+    lua.get_field(-1, "n");
+    if (lua.to_integer(-1) != 5) {
+      printf("FAILED: entry point not restored on restart\n");
+      rv = 3;
+    }
+    lua.pop(2);
 
+    // like skiller and luaagent, register before the function is defined
+    unsigned int late = lua.add_entry_point("late.env.notify");
+    lua.do_string("late = { env = { serial = 0 } }\n"
+		  "function late.env.notify(s) late.env.serial = s end");
+    lua.push_integer(42);
+    lua.call_entry_point(late, 1);
+    lua.get_global("late");
+    lua.get_field(-1, "env");
+    lua.get_field(-1, "serial");
+    if (lua.to_integer(-1) != 42) {
+      printf("FAILED: entry point registered before definition not called\n");
+      rv = 3;
+    }
+    lua.pop(3);
+  } catch (Exception &e) {
+    e.print_trace();
+    rv = 4;
+  }
+  unlink(script);
 
-  return 0;
+  if (rv == 0)  printf("PASSED\n");
+  return rv;
 }
 
 /// @endcond
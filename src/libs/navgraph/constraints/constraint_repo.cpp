@@ -28,6 +28,16 @@ namespace fawkes{
 
 /** @class NavGraphConstraintRepo <navgraph/constraints/constraint_repo.h>
  * Constraint repository to maintain blocks on nodes.
+ *
+ * Besides querying all registered constraints on each call, the repository
+ * can compile a view of the constraints for a specific graph. The view
+ * stores for each node and edge the constraint that blocks it and the
+ * resulting cost factor, such that checks during a search are a single
+ * lookup instead of evaluating every constraint, e.g. doing point in
+ * polygon tests or scanning reservation lists, for every expansion. The
+ * view is invalidated whenever the constraints change, i.e. if constraints
+ * are registered or removed or compute() reports a modification, and must
+ * be invalidated by the graph if the graph changes.
  * @author Sebastian Reuter
  * @author Tim Niemueller
  */
@@ -37,6 +47,7 @@ namespace fawkes{
 NavGraphConstraintRepo::NavGraphConstraintRepo()
 {
   modified_ = false;
+  compiled_ = false;
 }
 
 /** Destructor. */
@@ -52,6 +63,7 @@ void
 NavGraphConstraintRepo::register_constraint(NavGraphNodeConstraint* constraint)
 {
   modified_ = true;
+  compiled_ = false;
   node_constraints_.push_back(constraint);
 }
 
@@ -62,6 +74,7 @@ void
 NavGraphConstraintRepo::register_constraint(NavGraphEdgeConstraint* constraint)
 {
   modified_ = true;
+  compiled_ = false;
   edge_constraints_.push_back(constraint);
 }
 
@@ -72,6 +85,7 @@ void
 NavGraphConstraintRepo::register_constraint(NavGraphEdgeCostConstraint* constraint)
 {
   modified_ = true;
+  compiled_ = false;
   edge_cost_constraints_.push_back(constraint);
 }
 
@@ -83,6 +97,7 @@ void
 NavGraphConstraintRepo::unregister_constraint(std::string name)
 {
   modified_ = true;
+  compiled_ = false;
 
   NodeConstraintList::iterator nc =
     std::find_if(node_constraints_.begin(), node_constraints_.end(),
@@ -247,6 +262,7 @@ NavGraphConstraintRepo::has_constraints() const
 
 
 /** Call compute method on all registered constraints.
+ * If any constraint reports a change the compiled view is invalidated.
  * @return true if any constraint reported a change, false otherwise
  */
 bool
@@ -263,6 +279,7 @@ NavGraphConstraintRepo::compute()
     if (c->compute())  modified = true;
   }
 
+  if (modified)  compiled_ = false;
   return modified;
 }
 
@@ -481,4 +498,238 @@ NavGraphConstraintRepo::modified(bool reset_modified)
   }
 }
 
+
+/** Compile constraints for a graph.
+ * Evaluates all constraints once for every node and for the edges to all
+ * reachable nodes of every node, and stores the results. They are then
+ * returned by compiled_blocks() and compiled_increases_cost(). Does nothing
+ * if the view is still valid. The view reflects the constraints as they
+ * were when compiling, call compute() before to update them.
+ *
+ * Nodes are identified in the view by their index in @p nodes, the edges
+ * of a node are numbered in the order of its reachable nodes. The
+ * reachability of the nodes must have been calculated.
+ * @param nodes nodes of the graph
+ */
+void
+NavGraphConstraintRepo::compile(const std::vector<fawkes::NavGraphNode> &nodes)
+{
+  if (compiled_)  return;
+
+  compiled_node_index_.clear();
+  compiled_node_blocks_.clear();
+  compiled_edge_offsets_.clear();
+  compiled_edges_.clear();
+
+  compiled_node_index_.reserve(nodes.size());
+  compiled_node_blocks_.resize(nodes.size(), NULL);
+  for (unsigned int i = 0; i < nodes.size(); ++i) {
+    compiled_node_index_[nodes[i].name()] = i;
+    compiled_node_blocks_[i] = blocks(nodes[i]);
+  }
+
+  compiled_edge_offsets_.resize(nodes.size() + 1, 0);
+  for (unsigned int i = 0; i < nodes.size(); ++i) {
+    compiled_edge_offsets_[i] = compiled_edges_.size();
+    const std::vector<std::string> &reachable = nodes[i].reachable_nodes();
+    for (const std::string &r : reachable) {
+      std::unordered_map<std::string, int>::const_iterator t = compiled_node_index_.find(r);
+      CompiledEdge ce;
+      ce.to_id       = (t != compiled_node_index_.end()) ? t->second : -1;
+      ce.blocked_by  = NULL;
+      ce.cost_constraint = NULL;
+      ce.cost_factor = 1.0;
+      if (ce.to_id >= 0) {
+	ce.blocked_by      = blocks(nodes[i], nodes[ce.to_id]);
+	ce.cost_constraint = increases_cost(nodes[i], nodes[ce.to_id], ce.cost_factor);
+      }
+      compiled_edges_.push_back(ce);
+    }
+  }
+  compiled_edge_offsets_[nodes.size()] = compiled_edges_.size();
+
+  compiled_ = true;
+}
+
+
+int
+NavGraphConstraintRepo::compiled_edge_id(const fawkes::NavGraphNode &from,
+					 const fawkes::NavGraphNode &to) const
+{
+  int from_id = compiled_node_id(from);
+  if (from_id < 0)  return -1;
+  int to_id = compiled_node_id(to);
+  if (to_id < 0)  return -1;
+
+  for (unsigned int e = compiled_edge_offsets_[from_id];
+       e < compiled_edge_offsets_[from_id + 1]; ++e)
+  {
+    if (compiled_edges_[e].to_id == to_id)  return e;
+  }
+  return -1;
+}
+
+
+/** Invalidate compiled view.
+ * To be called if the graph the view has been compiled for changed.
+ * This may be called without holding the repository lock.
+ */
+void
+NavGraphConstraintRepo::invalidate_compiled()
+{
+  compiled_ = false;
+}
+
+
+/** Check if the compiled view is valid.
+ * @return true if the compiled view is valid, false otherwise
+ */
+bool
+NavGraphConstraintRepo::compiled() const
+{
+  return compiled_;
+}
+
+
+/** Check if a node is blocked using the compiled view.
+ * Same as blocks(), but answered from the compiled view if it is valid
+ * and contains the node.
+ * @param node Node to check for a block
+ * @return the (first) node constraint that blocked the node,
+ * NULL if the node is not blocked
+ */
+fawkes::NavGraphNodeConstraint *
+NavGraphConstraintRepo::compiled_blocks(const fawkes::NavGraphNode &node)
+{
+  int node_id = compiled_node_id(node);
+  if (node_id >= 0)  return compiled_node_blocks_[node_id];
+  return blocks(node);
+}
+
+
+/** Check if an edge is blocked using the compiled view.
+ * Same as blocks(), but answered from the compiled view if it is valid
+ * and contains the edge.
+ * @param from node from which the edge originates
+ * @param to node to which the edge leads
+ * @return the (first) edge constraint that blocked the edge,
+ * NULL if the edge is not blocked
+ */
+fawkes::NavGraphEdgeConstraint *
+NavGraphConstraintRepo::compiled_blocks(const fawkes::NavGraphNode &from,
+					const fawkes::NavGraphNode &to)
+{
+  int edge_id = compiled_edge_id(from, to);
+  if (edge_id >= 0)  return compiled_edges_[edge_id].blocked_by;
+  return blocks(from, to);
+}
+
+
+/** Check if the cost of an edge is increased using the compiled view.
+ * Same as increases_cost(), but answered from the compiled view if it is
+ * valid and contains the edge.
+ * @param from node from which the edge originates
+ * @param to node to which the edge leads
+ * @param cost_factor upon return with a non-NULL edge cost constraints
+ * contains the cost increase.
+ * @return the edge cost constraint that returns the highest increase
+ * in cost of the node (and by a cost factor of at least >= 1.00001).
+ */
+fawkes::NavGraphEdgeCostConstraint *
+NavGraphConstraintRepo::compiled_increases_cost(const fawkes::NavGraphNode &from,
+						const fawkes::NavGraphNode &to,
+						float & cost_factor)
+{
+  int edge_id = compiled_edge_id(from, to);
+  if (edge_id >= 0)  return compiled_increases_cost(edge_id, cost_factor);
+  return increases_cost(from, to, cost_factor);
+}
+
+
+/** Get ID of a node in the compiled view.
+ * The ID can be used for lookups without referring to the node by name.
+ * It remains valid as long as the view is valid.
+ * @param node node to get the ID for
+ * @return ID of the node, -1 if the view is invalid or does not contain
+ * the node
+ */
+int
+NavGraphConstraintRepo::compiled_node_id(const fawkes::NavGraphNode &node) const
+{
+  if (! compiled_)  return -1;
+  std::unordered_map<std::string, int>::const_iterator n =
+    compiled_node_index_.find(node.name());
+  return (n != compiled_node_index_.end()) ? n->second : -1;
+}
+
+
+/** Get ID of an edge in the compiled view.
+ * @param from_id ID of the node the edge originates from
+ * @param reachable_index index of the node the edge leads to in the list
+ * of reachable nodes of the originating node
+ * @return ID of the edge, -1 if the view is invalid or does not contain
+ * the edge
+ */
+int
+NavGraphConstraintRepo::compiled_edge_id(int from_id, unsigned int reachable_index) const
+{
+  if (! compiled_ || from_id < 0 || (size_t)from_id >= compiled_node_blocks_.size())  return -1;
+  unsigned int e = compiled_edge_offsets_[from_id] + reachable_index;
+  if (e >= compiled_edge_offsets_[from_id + 1] || compiled_edges_[e].to_id < 0)  return -1;
+  return e;
+}
+
+
+/** Get node an edge of the compiled view leads to.
+ * @param edge_id ID of the edge as returned by compiled_edge_id()
+ * @return ID of the node the edge leads to, which is its index in the
+ * node vector passed to compile()
+ */
+int
+NavGraphConstraintRepo::compiled_edge_target(int edge_id) const
+{
+  return compiled_edges_[edge_id].to_id;
+}
+
+
+/** Check if a node is blocked using its compiled view ID.
+ * @param node_id ID of the node as returned by compiled_node_id() or
+ * compiled_edge_target()
+ * @return the (first) node constraint that blocked the node,
+ * NULL if the node is not blocked
+ */
+fawkes::NavGraphNodeConstraint *
+NavGraphConstraintRepo::compiled_blocks(int node_id) const
+{
+  return compiled_node_blocks_[node_id];
+}
+
+
+/** Check if an edge is blocked using its compiled view ID.
+ * @param edge_id ID of the edge as returned by compiled_edge_id()
+ * @return the (first) edge constraint that blocked the edge,
+ * NULL if the edge is not blocked
+ */
+fawkes::NavGraphEdgeConstraint *
+NavGraphConstraintRepo::compiled_edge_blocks(int edge_id) const
+{
+  return compiled_edges_[edge_id].blocked_by;
+}
+
+
+/** Check if the cost of an edge is increased using its compiled view ID.
+ * @param edge_id ID of the edge as returned by compiled_edge_id()
+ * @param cost_factor upon return with a non-NULL edge cost constraints
+ * contains the cost increase.
+ * @return the edge cost constraint that returns the highest increase
+ * in cost of the node (and by a cost factor of at least >= 1.00001).
+ */
+fawkes::NavGraphEdgeCostConstraint *
+NavGraphConstraintRepo::compiled_increases_cost(int edge_id, float & cost_factor) const
+{
+  const CompiledEdge &ce = compiled_edges_[edge_id];
+  if (ce.cost_constraint)  cost_factor = ce.cost_factor;
+  return ce.cost_constraint;
+}
+
 } // namespace
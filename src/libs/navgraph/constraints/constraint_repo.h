@@ -32,6 +32,8 @@
 #include <tuple>
 #include <list>
 #include <map>
+#include <unordered_map>
+#include <atomic>
 
 namespace fawkes{
 
@@ -91,12 +93,50 @@ class NavGraphConstraintRepo
 
   bool modified(bool reset_modified = false);
 
+  void compile(const std::vector<fawkes::NavGraphNode> &nodes);
+  void invalidate_compiled();
+  bool compiled() const;
+
+  NavGraphNodeConstraint *     compiled_blocks(const fawkes::NavGraphNode &node);
+  NavGraphEdgeConstraint *     compiled_blocks(const fawkes::NavGraphNode &from,
+					       const fawkes::NavGraphNode &to);
+  NavGraphEdgeCostConstraint * compiled_increases_cost(const fawkes::NavGraphNode &from,
+						       const fawkes::NavGraphNode &to,
+						       float & cost_factor);
+
+  int compiled_node_id(const fawkes::NavGraphNode &node) const;
+  int compiled_edge_id(int from_id, unsigned int reachable_index) const;
+  int compiled_edge_target(int edge_id) const;
+
+  NavGraphNodeConstraint *     compiled_blocks(int node_id) const;
+  NavGraphEdgeConstraint *     compiled_edge_blocks(int edge_id) const;
+  NavGraphEdgeCostConstraint * compiled_increases_cost(int edge_id, float & cost_factor) const;
+
+ private:
+  /// @cond INTERNALS
+  typedef struct {
+    int                         to_id;
+    NavGraphEdgeConstraint     *blocked_by;
+    NavGraphEdgeCostConstraint *cost_constraint;
+    float                       cost_factor;
+  } CompiledEdge;
+  /// @endcond
+
+  int compiled_edge_id(const fawkes::NavGraphNode &from,
+		       const fawkes::NavGraphNode &to) const;
+
  private:
 
   NodeConstraintList node_constraints_;
   EdgeConstraintList edge_constraints_;
   EdgeCostConstraintList edge_cost_constraints_;
   bool    modified_;
+
+  std::atomic<bool>                              compiled_;
+  std::unordered_map<std::string, int>           compiled_node_index_;
+  std::vector<NavGraphNodeConstraint *>          compiled_node_blocks_;
+  std::vector<unsigned int>                      compiled_edge_offsets_;
+  std::vector<CompiledEdge>                      compiled_edges_;
 };
 } // namespace
 
@@ -35,6 +35,7 @@ namespace fawkes{
 NavGraphPolygonConstraint::NavGraphPolygonConstraint()
 {
   cur_polygon_handle_ = 0;
+  modified_ = false;
 }
 
 
@@ -45,6 +46,7 @@ NavGraphPolygonConstraint::NavGraphPolygonConstraint()
 NavGraphPolygonConstraint::NavGraphPolygonConstraint(const Polygon &polygon)
 {
   cur_polygon_handle_ = 0;
+  modified_ = false;
   add_polygon(polygon);
 }
 
@@ -64,6 +66,7 @@ NavGraphPolygonConstraint::add_polygon(const NavGraphPolygonConstraint::Polygon
 {
   PolygonHandle handle = ++cur_polygon_handle_;
   polygons_[handle] = polygon;
+  modified_ = true;
   return handle;
 }
 
@@ -75,6 +78,7 @@ NavGraphPolygonConstraint::remove_polygon(const PolygonHandle &handle)
 {
   if (polygons_.find(handle) != polygons_.end()) {
     polygons_.erase(handle);
+    modified_ = true;
   }
 }
 
@@ -95,6 +99,7 @@ NavGraphPolygonConstraint::clear_polygons()
 {
   if (! polygons_.empty()) {
     polygons_.clear();
+    modified_ = true;
   }
 }
 
@@ -67,6 +67,7 @@ class NavGraphPolygonConstraint
 
  protected:
   PolygonMap      polygons_;	///< currently registered polygons
+  bool            modified_;	///< true if polygons changed since last compute()
 
  private:
   unsigned int    cur_polygon_handle_;
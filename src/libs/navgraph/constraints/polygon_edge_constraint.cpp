@@ -59,7 +59,8 @@ NavGraphPolygonEdgeConstraint::~NavGraphPolygonEdgeConstraint()
 bool
 NavGraphPolygonEdgeConstraint::compute(void) throw()
 {
-  if (! polygons_.empty()) {
+  if (modified_) {
+    modified_ = false;
     return true;
   } else {
     return false;
@@ -24,6 +24,7 @@
 #include <navgraph/constraints/constraint_repo.h>
 #include <navgraph/search_state.h>
 #include <core/exception.h>
+#include <core/threading/mutex_locker.h>
 #include <utils/search/astar.h>
 #include <utils/math/common.h>
 
@@ -55,6 +56,15 @@ namespace navgraph {
  * is changed, that is if a node or edge is added or if the graph is assigned
  * from another one (i.e. graph := new_graph).
  *
+ * Geometric queries like closest_node() and closest_edge() as well as
+ * the intersection tests when adding edges are answered using a
+ * NavGraphSpatialIndex. It is updated incrementally when adding nodes
+ * and edges and rebuilt lazily on the next query after other changes.
+ * Since const queries may rebuild it, the index is guarded by a mutex
+ * which is also held for any modification of it. The graph itself is
+ * not thread-safe, modifications must not run concurrently with any
+ * other access, e.g. by only accessing the graph through a LockPtr.
+ *
  * This class is based on KBSG RCSoft's MapGraph but has been
  * abstracted and improved.
  * @author Tim Niemueller
@@ -92,6 +102,9 @@ NavGraph::NavGraph(const NavGraph &g)
   nodes_      = g.nodes_;
   edges_.clear();
   edges_      = g.edges_;
+  constraint_repo_ = LockPtr<NavGraphConstraintRepo>(new NavGraphConstraintRepo(),
+						     /* recursive mutex */ true);
+  invalidate_spatial_index();
 }
 
 /** Virtual empty destructor. */
@@ -116,6 +129,8 @@ NavGraph::operator=(const NavGraph &g)
   nodes_      = g.nodes_;
   edges_.clear();
   edges_      = g.edges_;
+  invalidate_spatial_index();
+  constraint_repo_->invalidate_compiled();
 
   notify_of_change();
 
@@ -261,28 +276,21 @@ NavGraphNode
 NavGraph::closest_node(float pos_x, float pos_y, bool consider_unconnected,
 		       const std::string &property) const
 {
-  std::vector<NavGraphNode> nodes = search_nodes(property);
+  MutexLocker lock(&spatial_index_mutex_);
+  update_spatial_index();
 
-  float min_dist = std::numeric_limits<float>::max();
+  long i =
+    spatial_index_.closest_node(pos_x, pos_y,
+				[this, consider_unconnected, &property](size_t i) -> bool {
+				  const NavGraphNode &n = nodes_[i];
+				  return (consider_unconnected || ! n.unconnected()) &&
+				    (property == "" || n.has_property(property));
+				});
 
-  std::vector<NavGraphNode>::iterator i;
-  std::vector<NavGraphNode>::iterator elem = nodes.end();
-  for (i = nodes.begin(); i != nodes.end(); ++i) {
-    if (! consider_unconnected && i->unconnected())  continue;
-
-    float dx   = i->x() - pos_x;
-    float dy   = i->y() - pos_y;
-    float dist = sqrtf(dx * dx + dy * dy);
-    if (sqrtf(dx * dx + dy * dy) < min_dist) {
-      min_dist = dist;
-      elem = i;
-    }
-  }
-
-  if (elem == nodes.end()) {
+  if (i < 0) {
     return NavGraphNode();
   } else {
-    return *elem;
+    return nodes_[i];
   }
 }
 
@@ -301,28 +309,23 @@ NavGraph::closest_node_to(const std::string &node_name, bool consider_unconnecte
 			  const std::string &property) const
 {
   NavGraphNode n = node(node_name);
-  std::vector<NavGraphNode> nodes = search_nodes(property);
 
-  float min_dist = std::numeric_limits<float>::max();
+  MutexLocker lock(&spatial_index_mutex_);
+  update_spatial_index();
 
-  std::vector<NavGraphNode>::iterator i;
-  std::vector<NavGraphNode>::iterator elem = nodes.begin();
-  for (i = nodes.begin(); i != nodes.end(); ++i) {
-    if (! consider_unconnected && i->unconnected())  continue;
-
-    float dx   = i->x() - n.x();
-    float dy   = i->y() - n.y();
-    float dist = sqrtf(dx * dx + dy * dy);
-    if ((sqrtf(dx * dx + dy * dy) < min_dist) && (i->name() != node_name)) {
-      min_dist = dist;
-      elem = i;
-    }
-  }
+  long i =
+    spatial_index_.closest_node(n.x(), n.y(),
+				[this, consider_unconnected, &property, &node_name](size_t i) -> bool {
+				  const NavGraphNode &c = nodes_[i];
+				  return (consider_unconnected || ! c.unconnected()) &&
+				    (c.name() != node_name) &&
+				    (property == "" || c.has_property(property));
+				});
 
-  if (elem == nodes.end()) {
+  if (i < 0) {
     return NavGraphNode();
   } else {
-    return *elem;
+    return nodes_[i];
   }
 }
 
@@ -363,26 +366,47 @@ NavGraph::edge(const std::string &from, const std::string &to) const
 NavGraphEdge
 NavGraph::closest_edge(float pos_x, float pos_y) const
 {
-  float min_dist = std::numeric_limits<float>::max();
-
-  NavGraphEdge rv;
-
-  Eigen::Vector2f point(pos_x, pos_y);
-  for (const NavGraphEdge &edge : edges_) {
-    const Eigen::Vector2f origin(edge.from_node().x(), edge.from_node().y());
-    const Eigen::Vector2f target(edge.to_node().x(), edge.to_node().y());
-    const Eigen::Vector2f direction(target - origin);
-    const Eigen::Vector2f direction_norm = direction.normalized();
-    const Eigen::Vector2f diff = point - origin;
-    const float t = direction.dot(diff) / direction.squaredNorm();
-
-    if (t >= 0.0 && t <= 1.0) {
-      // projection of the point onto the edge is within the line segment
-      float distance = (diff - direction_norm.dot(diff) * direction_norm).norm();
-      if (distance < min_dist) {
-	min_dist = distance;
-	rv = edge;
-      }
+  MutexLocker lock(&spatial_index_mutex_);
+  update_spatial_index();
+
+  long i = spatial_index_.closest_edge(pos_x, pos_y);
+  if (i < 0) {
+    return NavGraphEdge();
+  } else {
+    return edges_[i];
+  }
+}
+
+
+/** Get edges close to a specified point.
+ * The distance is determined like for closest_edge(), that is only
+ * edges are considered for which a line perpendicular to the edge
+ * goes through the point and a point on the edge line segment.
+ * @param pos_x X coordinate in global (map) frame of point
+ * @param pos_y X coordinate in global (map) frame of point
+ * @param max_dist maximum distance of the point to the edge
+ * @return edges within the given distance of the point
+ */
+std::vector<NavGraphEdge>
+NavGraph::search_edges(float pos_x, float pos_y, float max_dist) const
+{
+  std::vector<NavGraphEdge> rv;
+
+  MutexLocker lock(&spatial_index_mutex_);
+  update_spatial_index();
+
+  std::vector<size_t> candidates;
+  spatial_index_.edges_in_box(pos_x - max_dist, pos_y - max_dist,
+			      pos_x + max_dist, pos_y + max_dist, candidates);
+  for (size_t i : candidates) {
+    const NavGraphEdge &e = edges_[i];
+    float dist;
+    if (NavGraphSpatialIndex::edge_distance(e.from_node().x(), e.from_node().y(),
+					    e.to_node().x(), e.to_node().y(),
+					    pos_x, pos_y, dist) &&
+	dist <= max_dist)
+    {
+      rv.push_back(e);
     }
   }
 
@@ -480,6 +504,11 @@ NavGraph::add_node(const NavGraphNode &node)
   } else {
     nodes_.push_back(node);
     apply_default_properties(nodes_.back());
+    {
+      MutexLocker lock(&spatial_index_mutex_);
+      spatial_index_.add_node(nodes_.size() - 1, nodes_.back());
+    }
+    constraint_repo_->invalidate_compiled();
     reachability_calced_ = false;
     notify_of_change();
   }
@@ -623,9 +652,14 @@ NavGraph::add_edge(const NavGraphEdge &edge, NavGraph::EdgeMode mode, bool allow
     case EDGE_FORCE:
       edges_.push_back(edge);
       edges_.back().set_nodes(node(edge.from()), node(edge.to()));
+      {
+        MutexLocker lock(&spatial_index_mutex_);
+        spatial_index_.add_edge(edges_.size() - 1, edges_.back());
+      }
       break;
     }
     
+    constraint_repo_->invalidate_compiled();
     reachability_calced_ = false;
     notify_of_change();
   }
@@ -644,6 +678,8 @@ NavGraph::remove_node(const NavGraphNode &node)
 		   [&node](const NavGraphEdge &edge)->bool {
 		     return edge.from() == node.name() || edge.to() == node.name();
 		   }), edges_.end());
+  invalidate_spatial_index();
+  constraint_repo_->invalidate_compiled();
   reachability_calced_ = false;
   notify_of_change();
 }
@@ -664,6 +700,8 @@ NavGraph::remove_node(const std::string &node_name)
 		   [&node_name](const NavGraphEdge &edge)->bool {
 		     return edge.from() == node_name || edge.to() == node_name;
 		   }), edges_.end());
+  invalidate_spatial_index();
+  constraint_repo_->invalidate_compiled();
   reachability_calced_ = false;
   notify_of_change();
 }
@@ -705,6 +743,8 @@ NavGraph::remove_edge(const NavGraphEdge &edge)
 		     return (edge.from() == e.from() && edge.to() == e.to()) ||
 		       (! e.is_directed() && (edge.from() == e.to() && edge.to() == e.from()));
 		   }), edges_.end());
+  invalidate_spatial_index();
+  constraint_repo_->invalidate_compiled();
   reachability_calced_ = false;
   notify_of_change();
 }
@@ -722,6 +762,8 @@ NavGraph::remove_edge(const std::string &from, const std::string &to)
 		     return (edge.from() == from && edge.to() == to) ||
 		       (! edge.is_directed() && (edge.to() == from && edge.from() == to));
 		   }), edges_.end());
+  invalidate_spatial_index();
+  constraint_repo_->invalidate_compiled();
   reachability_calced_ = false;
   notify_of_change();
 }
@@ -739,6 +781,8 @@ NavGraph::update_node(const NavGraphNode &node)
     std::find(nodes_.begin(), nodes_.end(), node);
   if (n != nodes_.end()) {
     *n = node;
+    invalidate_spatial_index();
+    constraint_repo_->invalidate_compiled();
   } else {
     throw Exception("No node with name %s known", node.name().c_str());
   }
@@ -757,6 +801,8 @@ NavGraph::update_edge(const NavGraphEdge &edge)
     std::find(edges_.begin(), edges_.end(), edge);
   if (e != edges_.end()) {
     *e = edge;
+    invalidate_spatial_index();
+    constraint_repo_->invalidate_compiled();
   } else {
     throw Exception("No edge from %s to %s is known",
 		    edge.from().c_str(), edge.to().c_str());
@@ -773,6 +819,8 @@ NavGraph::clear()
   nodes_.clear();
   edges_.clear();
   default_properties_.clear();
+  invalidate_spatial_index();
+  constraint_repo_->invalidate_compiled();
   notify_of_change();
 }
 
@@ -1107,6 +1155,9 @@ NavGraph::search_path(const NavGraphNode &from, const NavGraphNode &to,
     if (compute_constraints && constraint_repo_->has_constraints()) {
       constraint_repo_->compute();
     }
+    if (constraint_repo_->has_constraints()) {
+      constraint_repo_->compile(nodes_);
+    }
 
     NavGraphSearchState *initial_state =
       new NavGraphSearchState(from, to, this, estimate_func, cost_func,
@@ -1176,7 +1227,16 @@ NavGraph::edge_add_no_intersection(const NavGraphEdge &edge)
   try {
     const NavGraphNode &n1 = node(edge.from());
     const NavGraphNode &n2 = node(edge.to());
-    for (const NavGraphEdge &ne : edges_) {
+
+    std::vector<size_t> candidates;
+    {
+      MutexLocker lock(&spatial_index_mutex_);
+      update_spatial_index();
+      spatial_index_.edges_near_segment(n1.x(), n1.y(), n2.x(), n2.y(), candidates);
+    }
+
+    for (size_t i : candidates) {
+      const NavGraphEdge &ne = edges_[i];
       if (edge.from() == ne.from() || edge.from() == ne.to() ||
 	  edge.to() == ne.to() || edge.to() == ne.from())  continue;
 
@@ -1204,7 +1264,15 @@ NavGraph::edge_add_split_intersection(const NavGraphEdge &edge)
 
   try {
 
-    for (const NavGraphEdge &e : edges_) {
+    std::vector<size_t> candidates;
+    {
+      MutexLocker lock(&spatial_index_mutex_);
+      update_spatial_index();
+      spatial_index_.edges_near_segment(n1.x(), n1.y(), n2.x(), n2.y(), candidates);
+    }
+
+    for (size_t i : candidates) {
+      const NavGraphEdge &e = edges_[i];
       cart_coord_2d_t ip;
       if (e.intersection(n1.x(), n1.y(), n2.x(), n2.y(), ip)) {
 	// we need to split the edge at the given intersection point,
@@ -1439,12 +1507,37 @@ NavGraph::calc_reachability(bool allow_multi_graph)
   for (e = edges_.begin(); e != edges_.end(); ++e) {
     e->set_nodes(node(e->from()), node(e->to()));
   }
+  invalidate_spatial_index();
+  constraint_repo_->invalidate_compiled();
 
   if (! allow_multi_graph)  assert_connected();
   reachability_calced_ = true;
 }
 
 
+/** Invalidate spatial index.
+ * It is rebuilt on the next query.
+ */
+void
+NavGraph::invalidate_spatial_index()
+{
+  MutexLocker lock(&spatial_index_mutex_);
+  spatial_index_.invalidate();
+}
+
+
+/** Rebuild spatial index if necessary.
+ * Must be called with the spatial index mutex locked.
+ */
+void
+NavGraph::update_spatial_index() const
+{
+  if (! spatial_index_.valid()) {
+    spatial_index_.build(nodes_, edges_);
+  }
+}
+
+
 /** Generate a unique node name for the given prefix.
  * Will simply add a number and tries from 0 to MAXINT.
  * Note that to add a unique name you must protect the navgraph
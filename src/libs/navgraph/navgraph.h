@@ -26,7 +26,9 @@
 #include <navgraph/navgraph_node.h>
 #include <navgraph/navgraph_edge.h>
 #include <navgraph/navgraph_path.h>
+#include <navgraph/navgraph_spatial_index.h>
 #include <core/utils/lockptr.h>
+#include <core/threading/mutex.h>
 
 #include <vector>
 #include <list>
@@ -117,6 +119,7 @@ class NavGraph
 
   NavGraphEdge edge(const std::string &from, const std::string &to) const;
   NavGraphEdge closest_edge(float pos_x, float pos_y) const;
+  std::vector<NavGraphEdge> search_edges(float pos_x, float pos_y, float max_dist) const;
 
   std::vector<NavGraphNode> search_nodes(const std::string &property) const;
 
@@ -200,6 +203,8 @@ class NavGraph
   void assert_connected();
   void edge_add_no_intersection(const NavGraphEdge &edge);
   void edge_add_split_intersection(const NavGraphEdge &edge);
+  void invalidate_spatial_index();
+  void update_spatial_index() const;
 
  private:
   std::string                             graph_name_;
@@ -217,6 +222,9 @@ class NavGraph
 
 
   bool                                    notifications_enabled_;
+
+  mutable NavGraphSpatialIndex            spatial_index_;
+  mutable fawkes::Mutex                   spatial_index_mutex_;
 };
 
 
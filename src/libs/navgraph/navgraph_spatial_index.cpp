@@ -0,0 +1,461 @@
+
+/***************************************************************************
+ *  navgraph_spatial_index.cpp - Uniform grid over navgraph nodes and edges
+ *
+ *  Created: Sun Oct 18 21:02:17 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#include <navgraph/navgraph_spatial_index.h>
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+#include <Eigen/Geometry>
+
+namespace fawkes {
+
+/// Minimum edge length of a grid cell in meters
+#define MIN_CELL_SIZE         0.1f
+/// Maximum number of cells per grid dimension
+#define MAX_CELLS_PER_DIM     1024
+
+/** @class NavGraphSpatialIndex <navgraph/navgraph_spatial_index.h>
+ * Uniform grid over the nodes and edges of a navgraph.
+ * The bounding box of the graph is divided into square cells. Each cell
+ * stores the indices of the nodes located in it and of the edges passing
+ * through it, referring to the node and edge vectors of the graph. The
+ * cell size is chosen such that each cell holds a few elements on
+ * average.
+ *
+ * Closest element queries search rings of cells of increasing size
+ * around the query point and stop as soon as no unvisited cell can
+ * contain a closer element. Ties are resolved in favor of the element
+ * with the lower index, therefore queries yield the same results as a
+ * linear scan over the graph's vectors.
+ *
+ * Elements appended to the graph can be added incrementally as long as
+ * they lie within the grid bounds. Any other change to the graph, in
+ * particular removal, shifts the indices and requires to invalidate and
+ * rebuild the index. NavGraph does this lazily on the next query.
+ * @author agent
+ */
+
+/** Constructor.
+ * The index is invalid until build() has been called.
+ */
+NavGraphSpatialIndex::NavGraphSpatialIndex()
+  : valid_(false), min_x_(0.), min_y_(0.), max_x_(0.), max_y_(0.),
+    cell_size_(1.), size_x_(0), size_y_(0), built_size_(0)
+{
+}
+
+
+/** Build index.
+ * @param nodes nodes of the graph
+ * @param edges edges of the graph, their node positions must have been
+ * set, e.g. using NavGraphEdge::set_nodes().
+ */
+void
+NavGraphSpatialIndex::build(const std::vector<NavGraphNode> &nodes,
+			    const std::vector<NavGraphEdge> &edges)
+{
+  node_pos_.clear();
+  segments_.clear();
+  node_cells_.clear();
+  edge_cells_.clear();
+
+  node_pos_.reserve(nodes.size());
+  for (const NavGraphNode &n : nodes) {
+    node_pos_.push_back(cart_coord_2d_t(n.x(), n.y()));
+  }
+  segments_.reserve(edges.size());
+  for (const NavGraphEdge &e : edges) {
+    Segment s = { e.from_node().x(), e.from_node().y(), e.to_node().x(), e.to_node().y() };
+    segments_.push_back(s);
+  }
+
+  float min_x = std::numeric_limits<float>::max();
+  float min_y = std::numeric_limits<float>::max();
+  float max_x = std::numeric_limits<float>::lowest();
+  float max_y = std::numeric_limits<float>::lowest();
+  auto extend = [&](float x, float y) {
+    min_x = std::min(min_x, x); max_x = std::max(max_x, x);
+    min_y = std::min(min_y, y); max_y = std::max(max_y, y);
+  };
+  for (const cart_coord_2d_t &p : node_pos_)  extend(p.x, p.y);
+  for (const Segment &s : segments_) {
+    extend(s.x1, s.y1);
+    extend(s.x2, s.y2);
+  }
+  if (min_x > max_x) {
+    min_x = max_x = min_y = max_y = 0.;
+  }
+
+  const float width  = max_x - min_x;
+  const float height = max_y - min_y;
+  const size_t num_elements = std::max<size_t>(node_pos_.size() + segments_.size(), 1);
+  const float area = std::max(width, MIN_CELL_SIZE) * std::max(height, MIN_CELL_SIZE);
+
+  cell_size_ = 2. * sqrtf(area / num_elements);
+  cell_size_ = std::max(cell_size_, MIN_CELL_SIZE);
+  cell_size_ = std::max(cell_size_, std::max(width, height) / MAX_CELLS_PER_DIM);
+
+  // leave a margin so that nodes added close to the border need no rebuild
+  min_x_ = min_x - cell_size_;
+  min_y_ = min_y - cell_size_;
+  max_x_ = max_x + cell_size_;
+  max_y_ = max_y + cell_size_;
+  size_x_ = (long)floorf((max_x_ - min_x_) / cell_size_) + 1;
+  size_y_ = (long)floorf((max_y_ - min_y_) / cell_size_) + 1;
+
+  node_cells_.resize(size_x_ * size_y_);
+  edge_cells_.resize(size_x_ * size_y_);
+
+  for (size_t i = 0; i < node_pos_.size(); ++i) {
+    node_cells_[cell_y(node_pos_[i].y) * size_x_ + cell_x(node_pos_[i].x)].push_back(i);
+  }
+  for (size_t i = 0; i < segments_.size(); ++i) {
+    insert_edge(i);
+  }
+
+  built_size_ = node_pos_.size() + segments_.size();
+  valid_ = true;
+}
+
+
+/** Invalidate index.
+ * Must be called whenever nodes or edges have been modified or removed.
+ */
+void
+NavGraphSpatialIndex::invalidate()
+{
+  valid_ = false;
+}
+
+
+/** Add a node.
+ * If the node does not fit into the current grid, the index is
+ * invalidated instead.
+ * @param index index of the node in the graph's node vector, this must
+ * be the next index after the last node
+ * @param node node which has been added
+ */
+void
+NavGraphSpatialIndex::add_node(size_t index, const NavGraphNode &node)
+{
+  if (! valid_)  return;
+  if (index != node_pos_.size() || ! contains(node.x(), node.y()) ||
+      node_pos_.size() + segments_.size() > 2 * built_size_ + 64)
+  {
+    valid_ = false;
+    return;
+  }
+
+  node_pos_.push_back(cart_coord_2d_t(node.x(), node.y()));
+  node_cells_[cell_y(node.y()) * size_x_ + cell_x(node.x())].push_back(index);
+}
+
+
+/** Add an edge.
+ * If the edge does not fit into the current grid, the index is
+ * invalidated instead.
+ * @param index index of the edge in the graph's edge vector, this must
+ * be the next index after the last edge
+ * @param edge edge which has been added, its nodes must have been set
+ */
+void
+NavGraphSpatialIndex::add_edge(size_t index, const NavGraphEdge &edge)
+{
+  if (! valid_)  return;
+  const NavGraphNode &from = edge.from_node();
+  const NavGraphNode &to   = edge.to_node();
+  if (index != segments_.size() ||
+      ! contains(from.x(), from.y()) || ! contains(to.x(), to.y()) ||
+      node_pos_.size() + segments_.size() > 2 * built_size_ + 64)
+  {
+    valid_ = false;
+    return;
+  }
+
+  Segment s = { from.x(), from.y(), to.x(), to.y() };
+  segments_.push_back(s);
+  insert_edge(index);
+}
+
+
+/** Get closest node.
+ * @param x X coordinate of query point
+ * @param y Y coordinate of query point
+ * @param filter function called with a node index, return true to
+ * consider the node, false to ignore it.
+ * @return index of closest node or -1 if no node has been accepted
+ * by the filter
+ */
+long
+NavGraphSpatialIndex::closest_node(float x, float y,
+				   const std::function<bool (size_t)> &filter) const
+{
+  return ring_search(x, y, node_cells_,
+		     [this, x, y, &filter](size_t i, float &dist) -> bool {
+		       if (! filter(i))  return false;
+		       float dx = node_pos_[i].x - x;
+		       float dy = node_pos_[i].y - y;
+		       dist = sqrtf(dx * dx + dy * dy);
+		       return true;
+		     });
+}
+
+
+/** Get closest edge.
+ * Only edges are considered onto whose line segment the query point
+ * can be projected perpendicularly, cf. edge_distance().
+ * @param x X coordinate of query point
+ * @param y Y coordinate of query point
+ * @return index of closest edge or -1 if there is no such edge
+ */
+long
+NavGraphSpatialIndex::closest_edge(float x, float y) const
+{
+  return ring_search(x, y, edge_cells_,
+		     [this, x, y](size_t i, float &dist) -> bool {
+		       const Segment &s = segments_[i];
+		       return edge_distance(s.x1, s.y1, s.x2, s.y2, x, y, dist);
+		     });
+}
+
+
+/** Get edges which might pass through a box.
+ * This is a conservative query, it may yield edges passing close to
+ * but not through the box.
+ * @param min_x minimum X coordinate of box
+ * @param min_y minimum Y coordinate of box
+ * @param max_x maximum X coordinate of box
+ * @param max_y maximum Y coordinate of box
+ * @param indices upon return contains the sorted indices of edges
+ */
+void
+NavGraphSpatialIndex::edges_in_box(float min_x, float min_y, float max_x, float max_y,
+				   std::vector<size_t> &indices) const
+{
+  indices.clear();
+  if (max_x < min_x_ || max_y < min_y_ || min_x > max_x_ || min_y > max_y_)  return;
+
+  const long cx_min = std::max(cell_x(min_x), 0L);
+  const long cx_max = std::min(cell_x(max_x), size_x_ - 1);
+  const long cy_min = std::max(cell_y(min_y), 0L);
+  const long cy_max = std::min(cell_y(max_y), size_y_ - 1);
+
+  for (long cy = cy_min; cy <= cy_max; ++cy) {
+    for (long cx = cx_min; cx <= cx_max; ++cx) {
+      const std::vector<size_t> &cell = edge_cells_[cy * size_x_ + cx];
+      indices.insert(indices.end(), cell.begin(), cell.end());
+    }
+  }
+  std::sort(indices.begin(), indices.end());
+  indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+}
+
+
+/** Get edges which might intersect a line segment.
+ * This is a conservative query, any edge intersecting or touching
+ * the line segment is returned, but also some which merely pass
+ * close by.
+ * @param x1 X coordinate of first point of line segment
+ * @param y1 Y coordinate of first point of line segment
+ * @param x2 X coordinate of second point of line segment
+ * @param y2 Y coordinate of second point of line segment
+ * @param indices upon return contains the sorted indices of edges
+ */
+void
+NavGraphSpatialIndex::edges_near_segment(float x1, float y1, float x2, float y2,
+					 std::vector<size_t> &indices) const
+{
+  indices.clear();
+
+  const long cx_min = std::max(cell_x(std::min(x1, x2)), 0L);
+  const long cx_max = std::min(cell_x(std::max(x1, x2)), size_x_ - 1);
+  const long cy_min = std::max(cell_y(std::min(y1, y2)), 0L);
+  const long cy_max = std::min(cell_y(std::max(y1, y2)), size_y_ - 1);
+
+  const Eigen::Vector2f origin(x1, y1);
+  const Eigen::Vector2f direction(x2 - x1, y2 - y1);
+  const float length_sq = direction.squaredNorm();
+  const float max_dist = 0.5 * M_SQRT2 * cell_size_ * 1.01;
+
+  for (long cy = cy_min; cy <= cy_max; ++cy) {
+    for (long cx = cx_min; cx <= cx_max; ++cx) {
+      const Eigen::Vector2f center(min_x_ + (cx + 0.5) * cell_size_,
+				   min_y_ + (cy + 0.5) * cell_size_);
+      float t = (length_sq > 0.) ? direction.dot(center - origin) / length_sq : 0.;
+      t = std::min(std::max(t, 0.f), 1.f);
+      if ((origin + t * direction - center).norm() > max_dist)  continue;
+
+      const std::vector<size_t> &cell = edge_cells_[cy * size_x_ + cx];
+      indices.insert(indices.end(), cell.begin(), cell.end());
+    }
+  }
+  std::sort(indices.begin(), indices.end());
+  indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+}
+
+
+/** Calculate perpendicular distance of a point to a line segment.
+ * This is the distance measure used by NavGraph::closest_edge().
+ * @param x1 X coordinate of first point of line segment
+ * @param y1 Y coordinate of first point of line segment
+ * @param x2 X coordinate of second point of line segment
+ * @param y2 Y coordinate of second point of line segment
+ * @param px X coordinate of point
+ * @param py Y coordinate of point
+ * @param distance upon returning true contains the distance
+ * @return true if the projection of the point onto the line
+ * is within the line segment, false otherwise
+ */
+bool
+NavGraphSpatialIndex::edge_distance(float x1, float y1, float x2, float y2,
+				    float px, float py, float &distance)
+{
+  const Eigen::Vector2f point(px, py);
+  const Eigen::Vector2f origin(x1, y1);
+  const Eigen::Vector2f target(x2, y2);
+  const Eigen::Vector2f direction(target - origin);
+  const Eigen::Vector2f direction_norm = direction.normalized();
+  const Eigen::Vector2f diff = point - origin;
+  const float t = direction.dot(diff) / direction.squaredNorm();
+
+  if (t >= 0.0 && t <= 1.0) {
+    // projection of the point onto the edge is within the line segment
+    distance = (diff - direction_norm.dot(diff) * direction_norm).norm();
+    return true;
+  }
+  return false;
+}
+
+
+bool
+NavGraphSpatialIndex::contains(float x, float y) const
+{
+  return x >= min_x_ && x <= max_x_ && y >= min_y_ && y <= max_y_;
+}
+
+
+long
+NavGraphSpatialIndex::cell_x(float x) const
+{
+  long cx = (long)floorf((x - min_x_) / cell_size_);
+  // map the upper bound itself into the last cell
+  return (cx == size_x_ && x <= max_x_) ? size_x_ - 1 : cx;
+}
+
+
+long
+NavGraphSpatialIndex::cell_y(float y) const
+{
+  long cy = (long)floorf((y - min_y_) / cell_size_);
+  return (cy == size_y_ && y <= max_y_) ? size_y_ - 1 : cy;
+}
+
+
+void
+NavGraphSpatialIndex::insert_edge(size_t index)
+{
+  const Segment &s = segments_[index];
+
+  const long cx_min = std::max(cell_x(std::min(s.x1, s.x2)), 0L);
+  const long cx_max = std::min(cell_x(std::max(s.x1, s.x2)), size_x_ - 1);
+  const long cy_min = std::max(cell_y(std::min(s.y1, s.y2)), 0L);
+  const long cy_max = std::min(cell_y(std::max(s.y1, s.y2)), size_y_ - 1);
+
+  const Eigen::Vector2f origin(s.x1, s.y1);
+  const Eigen::Vector2f direction(s.x2 - s.x1, s.y2 - s.y1);
+  const float length_sq = direction.squaredNorm();
+  // a cell is touched if its center is within half a diagonal,
+  // slightly enlarged to be robust against rounding errors
+  const float max_dist = 0.5 * M_SQRT2 * cell_size_ * 1.01;
+
+  for (long cy = cy_min; cy <= cy_max; ++cy) {
+    for (long cx = cx_min; cx <= cx_max; ++cx) {
+      const Eigen::Vector2f center(min_x_ + (cx + 0.5) * cell_size_,
+				   min_y_ + (cy + 0.5) * cell_size_);
+      float t = (length_sq > 0.) ? direction.dot(center - origin) / length_sq : 0.;
+      t = std::min(std::max(t, 0.f), 1.f);
+      if ((origin + t * direction - center).norm() <= max_dist) {
+	edge_cells_[cy * size_x_ + cx].push_back(index);
+      }
+    }
+  }
+}
+
+
+long
+NavGraphSpatialIndex::ring_search(float x, float y,
+				  const std::vector<std::vector<size_t>> &cells,
+				  const std::function<bool (size_t, float &)> &distance) const
+{
+  if (size_x_ == 0 || size_y_ == 0 || ! std::isfinite(x) || ! std::isfinite(y))  return -1;
+
+  const long cx = cell_x(x);
+  const long cy = cell_y(y);
+
+  // rings closer than this are completely outside the grid
+  long r_min = 0;
+  if (cx < 0)             r_min = std::max(r_min, -cx);
+  if (cx >= size_x_)      r_min = std::max(r_min, cx - size_x_ + 1);
+  if (cy < 0)             r_min = std::max(r_min, -cy);
+  if (cy >= size_y_)      r_min = std::max(r_min, cy - size_y_ + 1);
+  const long r_max = std::max(std::max(std::abs(cx), std::abs(cx - size_x_ + 1)),
+			      std::max(std::abs(cy), std::abs(cy - size_y_ + 1)));
+
+  long  best = -1;
+  float best_dist = std::numeric_limits<float>::max();
+
+  auto visit = [&](long x, long y) {
+    if (x < 0 || x >= size_x_ || y < 0 || y >= size_y_)  return;
+    for (size_t i : cells[y * size_x_ + x]) {
+      float dist;
+      if (distance(i, dist) &&
+	  (dist < best_dist || (dist == best_dist && (long)i < best)))
+      {
+	best_dist = dist;
+	best = i;
+      }
+    }
+  };
+
+  for (long r = r_min; r <= r_max; ++r) {
+    if (r == 0) {
+      visit(cx, cy);
+    } else {
+      for (long i = -r; i <= r; ++i) {
+	visit(cx + i, cy - r);
+	visit(cx + i, cy + r);
+      }
+      for (long j = -r + 1; j <= r - 1; ++j) {
+	visit(cx - r, cy + j);
+	visit(cx + r, cy + j);
+      }
+    }
+    // all cells not yet visited are at least r cells away
+    if (best >= 0 && best_dist < r * cell_size_)  break;
+  }
+
+  return best;
+}
+
+} // end of namespace fawkes
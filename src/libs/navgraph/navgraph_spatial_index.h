@@ -0,0 +1,96 @@
+
+/***************************************************************************
+ *  navgraph_spatial_index.h - Uniform grid over navgraph nodes and edges
+ *
+ *  Created: Sun Oct 18 21:02:17 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#ifndef _LIBS_NAVGRAPH_NAVGRAPH_SPATIAL_INDEX_H_
+#define _LIBS_NAVGRAPH_NAVGRAPH_SPATIAL_INDEX_H_
+
+#include <navgraph/navgraph_node.h>
+#include <navgraph/navgraph_edge.h>
+
+#include <vector>
+#include <functional>
+#include <cstddef>
+
+namespace fawkes {
+
+class NavGraphSpatialIndex
+{
+ public:
+  NavGraphSpatialIndex();
+
+  void build(const std::vector<NavGraphNode> &nodes,
+	     const std::vector<NavGraphEdge> &edges);
+  void invalidate();
+
+  /** Check if index is valid.
+   * @return true if the index reflects the graph it was built from */
+  bool valid() const
+  { return valid_; }
+
+  void add_node(size_t index, const NavGraphNode &node);
+  void add_edge(size_t index, const NavGraphEdge &edge);
+
+  long closest_node(float x, float y, const std::function<bool (size_t)> &filter) const;
+  long closest_edge(float x, float y) const;
+
+  void edges_in_box(float min_x, float min_y, float max_x, float max_y,
+		    std::vector<size_t> &indices) const;
+  void edges_near_segment(float x1, float y1, float x2, float y2,
+			  std::vector<size_t> &indices) const;
+
+  static bool edge_distance(float x1, float y1, float x2, float y2,
+			    float px, float py, float &distance);
+
+ private:
+  /// @cond INTERNALS
+  typedef struct {
+    float x1, y1, x2, y2;
+  } Segment;
+  /// @endcond
+
+  bool contains(float x, float y) const;
+  long cell_x(float x) const;
+  long cell_y(float y) const;
+  void insert_edge(size_t index);
+  long ring_search(float x, float y, const std::vector<std::vector<size_t>> &cells,
+		   const std::function<bool (size_t, float &)> &distance) const;
+
+ private:
+  bool   valid_;
+  float  min_x_;
+  float  min_y_;
+  float  max_x_;
+  float  max_y_;
+  float  cell_size_;
+  long   size_x_;
+  long   size_y_;
+  size_t built_size_;
+
+  std::vector<cart_coord_2d_t>      node_pos_;
+  std::vector<Segment>              segments_;
+  std::vector<std::vector<size_t>>  node_cells_;
+  std::vector<std::vector<size_t>>  edge_cells_;
+};
+
+} // end of namespace fawkes
+
+#endif
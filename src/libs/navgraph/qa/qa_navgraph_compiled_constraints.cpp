@@ -0,0 +1,278 @@
+/***************************************************************************
+ *  qa_navgraph_compiled_constraints.cpp - QA for compiled constraint view
+ *
+ *  Created: Sun Oct 18 14:05:21 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+/// @cond QA
+
+// Registers polygon, static list and cost constraints on a grid graph and
+// checks that the compiled constraint view gives the same results as
+// evaluating the constraints, both by name and by ID. Then compares path
+// searches using the compiled view with searches that compile it anew for
+// every search.
+
+#include <navgraph/navgraph.h>
+#include <navgraph/constraints/constraint_repo.h>
+#include <navgraph/constraints/polygon_node_constraint.h>
+#include <navgraph/constraints/polygon_edge_constraint.h>
+#include <navgraph/constraints/static_list_node_constraint.h>
+#include <navgraph/constraints/static_list_edge_cost_constraint.h>
+#include <core/exception.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace fawkes;
+
+static double
+elapsed(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+static void
+build_grid(NavGraph &graph, unsigned int size)
+{
+  for (unsigned int y = 0; y < size; ++y) {
+    for (unsigned int x = 0; x < size; ++x) {
+      graph.add_node(NavGraphNode(NavGraph::format_name("N_%u_%u", x, y), x, y));
+    }
+  }
+  for (unsigned int y = 0; y < size; ++y) {
+    for (unsigned int x = 0; x < size; ++x) {
+      std::string n = NavGraph::format_name("N_%u_%u", x, y);
+      if (x + 1 < size) {
+	graph.add_edge(NavGraphEdge(n, NavGraph::format_name("N_%u_%u", x + 1, y)),
+		       NavGraph::EDGE_FORCE);
+      }
+      if (y + 1 < size) {
+	graph.add_edge(NavGraphEdge(n, NavGraph::format_name("N_%u_%u", x, y + 1)),
+		       NavGraph::EDGE_FORCE);
+      }
+    }
+  }
+  graph.calc_reachability(true);
+}
+
+
+static void
+register_constraints(NavGraph &graph, unsigned int size)
+{
+  LockPtr<NavGraphConstraintRepo> repo = graph.constraint_repo();
+
+  // small blocked squares spread over the grid
+  for (unsigned int i = 0; i < size / 6; ++i) {
+    float cx = 5 + i * 5, cy = 10 + (i % 3) * (size / 4);
+    NavGraphPolygonConstraint::Polygon p;
+    p.push_back(NavGraphPolygonConstraint::Point(cx - 1.5, cy - 1.5));
+    p.push_back(NavGraphPolygonConstraint::Point(cx + 1.5, cy - 1.5));
+    p.push_back(NavGraphPolygonConstraint::Point(cx + 1.5, cy + 1.5));
+    p.push_back(NavGraphPolygonConstraint::Point(cx - 1.5, cy + 1.5));
+    repo->register_constraint(new NavGraphPolygonNodeConstraint(NavGraph::format_name("poly_%u", i), p));
+  }
+
+  // wall crossing the edges in one column, with a gap at the top
+  float wx = size / 2 + 0.5;
+  NavGraphPolygonConstraint::Polygon wall;
+  wall.push_back(NavGraphPolygonConstraint::Point(wx, -1));
+  wall.push_back(NavGraphPolygonConstraint::Point(wx + 0.1, -1));
+  wall.push_back(NavGraphPolygonConstraint::Point(wx + 0.1, size - 3));
+  wall.push_back(NavGraphPolygonConstraint::Point(wx, size - 3));
+  repo->register_constraint(new NavGraphPolygonEdgeConstraint("wall", wall));
+
+  const std::vector<NavGraphEdge> &edges = graph.edges();
+  NavGraphStaticListEdgeCostConstraint *cost =
+    new NavGraphStaticListEdgeCostConstraint("cost");
+  for (unsigned int i = 0; i < edges.size(); i += 7) {
+    cost->add_edge(edges[i], 1.5 + (i % 5));
+  }
+  repo->register_constraint(cost);
+
+  const std::vector<NavGraphNode> &nodes = graph.nodes();
+  NavGraphStaticListNodeConstraint *blocked =
+    new NavGraphStaticListNodeConstraint("static");
+  for (unsigned int i = 0; i < nodes.size() / 20; ++i) {
+    const NavGraphNode &n = nodes[(i * 37) % nodes.size()];
+    // keep start and goal free
+    if (n.name() != nodes.front().name() && n.name() != nodes.back().name()) {
+      blocked->add_node(n);
+    }
+  }
+  repo->register_constraint(blocked);
+}
+
+
+static bool
+check_edge(NavGraphConstraintRepo *repo, const NavGraphNode &from, const NavGraphNode &to,
+	   int edge_id)
+{
+  bool success = true;
+
+  NavGraphEdgeConstraint *blocks = repo->blocks(from, to);
+  if (repo->compiled_blocks(from, to) != blocks ||
+      repo->compiled_edge_blocks(edge_id) != blocks)
+  {
+    printf("Edge %s -> %s: compiled block differs\n", from.name().c_str(), to.name().c_str());
+    success = false;
+  }
+
+  float live_factor = 0., name_factor = 0., id_factor = 0.;
+  NavGraphEdgeCostConstraint *cost = repo->increases_cost(from, to, live_factor);
+  if (repo->compiled_increases_cost(from, to, name_factor) != cost ||
+      repo->compiled_increases_cost(edge_id, id_factor) != cost ||
+      (cost && (name_factor != live_factor || id_factor != live_factor)))
+  {
+    printf("Edge %s -> %s: compiled cost differs\n", from.name().c_str(), to.name().c_str());
+    success = false;
+  }
+
+  return success;
+}
+
+
+/* The compiled view must return the same constraints as evaluating them,
+ * for every node and both directions of every edge. */
+static bool
+test_equivalence(NavGraph &graph)
+{
+  LockPtr<NavGraphConstraintRepo> repo = graph.constraint_repo();
+  const std::vector<NavGraphNode> &nodes = graph.nodes();
+  bool success = true;
+
+  repo->compute();
+  repo->compile(nodes);
+  if (! repo->compiled()) {
+    printf("View not valid after compiling\n");
+    return false;
+  }
+
+  unsigned int num_blocked = 0, num_edges = 0;
+  for (unsigned int i = 0; i < nodes.size(); ++i) {
+    NavGraphNodeConstraint *blocks = repo->blocks(nodes[i]);
+    if (blocks)  ++num_blocked;
+    if (repo->compiled_node_id(nodes[i]) != (int)i ||
+	repo->compiled_blocks(nodes[i]) != blocks ||
+	repo->compiled_blocks(i) != blocks)
+    {
+      printf("Node %s: compiled block differs\n", nodes[i].name().c_str());
+      success = false;
+    }
+
+    const std::vector<std::string> &reachable = nodes[i].reachable_nodes();
+    for (unsigned int r = 0; r < reachable.size(); ++r) {
+      int edge_id = repo->compiled_edge_id(i, r);
+      if (edge_id < 0 || nodes[repo->compiled_edge_target(edge_id)].name() != reachable[r]) {
+	printf("Edge %s -> %s not in compiled view\n", nodes[i].name().c_str(),
+	       reachable[r].c_str());
+	success = false;
+	continue;
+      }
+      if (! check_edge(*repo, nodes[i], graph.node(reachable[r]), edge_id))  success = false;
+      ++num_edges;
+    }
+    if (repo->compiled_edge_id(i, reachable.size()) != -1) {
+      printf("Node %s: edge beyond reachable nodes\n", nodes[i].name().c_str());
+      success = false;
+    }
+  }
+  printf("Compared %zu nodes (%u blocked) and %u edge directions\n",
+	 nodes.size(), num_blocked, num_edges);
+
+  repo->invalidate_compiled();
+  if (repo->compiled_node_id(nodes[0]) != -1 || repo->compiled_edge_id(0, 0) != -1) {
+    printf("IDs returned for invalidated view\n");
+    success = false;
+  }
+
+  return success;
+}
+
+
+/* Searches with the cached view must find paths of the same cost as
+ * searches which compile the view every time. */
+static bool
+test_search(NavGraph &graph, unsigned int num_searches)
+{
+  const NavGraphNode &from = graph.nodes().front();
+  const NavGraphNode &to   = graph.nodes().back();
+
+  float recompiled_cost = 0.;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (unsigned int i = 0; i < num_searches; ++i) {
+    graph.constraint_repo()->invalidate_compiled();
+    recompiled_cost = graph.search_path(from, to, true, true).cost();
+  }
+  double recompiled_time = elapsed(start);
+
+  float cached_cost = 0.;
+  start = std::chrono::steady_clock::now();
+  for (unsigned int i = 0; i < num_searches; ++i) {
+    cached_cost = graph.search_path(from, to, true, true).cost();
+  }
+  double cached_time = elapsed(start);
+
+  printf("%u searches: %.3f sec compiling every time, %.3f sec cached\n",
+	 num_searches, recompiled_time, cached_time);
+
+  if (recompiled_cost <= 0. || recompiled_cost != cached_cost) {
+    printf("Path cost %f with cached view, %f compiling every time\n",
+	   cached_cost, recompiled_cost);
+    return false;
+  }
+  return true;
+}
+
+
+int
+main(int argc, char **argv)
+{
+  unsigned int size = 60;
+  if (argc > 1)  size = atoi(argv[1]);
+  unsigned int num_searches = 20;
+  if (argc > 2)  num_searches = atoi(argv[2]);
+
+  bool success = true;
+  try {
+    NavGraph graph("qa");
+    graph.set_notifications_enabled(false);
+    build_grid(graph, size);
+    register_constraints(graph, size);
+
+    if (! test_equivalence(graph)) {
+      printf("FAILED compiled view equivalence\n");
+      success = false;
+    }
+    if (! test_search(graph, num_searches)) {
+      printf("FAILED search with compiled view\n");
+      success = false;
+    }
+  } catch (Exception &e) {
+    printf("FAILED, exception:\n");
+    e.print_trace();
+    success = false;
+  }
+
+  if (success)  printf("PASSED\n");
+  return success ? 0 : 1;
+}
+
+/// @endcond
@@ -0,0 +1,213 @@
+
+/***************************************************************************
+ *  qa_navgraph_generator_benchmark.cpp - Benchmark navgraph generation steps
+ *
+ *  Created: Sun Oct 18 21:48:36 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+/// @cond QA
+
+// Replays the geometric steps of the navgraph-generator plugin on a
+// synthetic graph: adding edges with intersection splitting, connecting
+// points of interest, filtering edges close to occupied map cells and
+// querying closest nodes. For comparison, the closest node and map
+// filter queries are also run as linear scans.
+
+#include <navgraph/navgraph.h>
+#include <core/exception.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+#include <list>
+#include <vector>
+
+using namespace fawkes;
+
+static double
+elapsed(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static float
+frand(float max)
+{
+  return (float)rand() / RAND_MAX * max;
+}
+
+int
+main(int argc, char **argv)
+{
+  unsigned int size = 40;
+  if (argc > 1)  size = atoi(argv[1]);
+  const unsigned int num_pois    = size * 4;
+  const unsigned int num_cells   = size * size * 20;
+  const unsigned int num_queries = 100000;
+  const float        spacing     = 1.0;
+  const float        max_dist    = 0.05;
+
+  srand(42);
+
+  NavGraph graph("benchmark");
+  graph.set_notifications_enabled(false);
+
+  // jittered grid, similar to the nodes generated from a Voronoi diagram
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (unsigned int x = 0; x < size; ++x) {
+    for (unsigned int y = 0; y < size; ++y) {
+      graph.add_node(NavGraphNode(NavGraph::format_name("V_%u_%u", x, y),
+				  x * spacing + frand(0.3 * spacing),
+				  y * spacing + frand(0.3 * spacing)));
+    }
+  }
+  for (unsigned int x = 0; x < size; ++x) {
+    for (unsigned int y = 0; y < size; ++y) {
+      std::string n = NavGraph::format_name("V_%u_%u", x, y);
+      if (x + 1 < size) {
+	graph.add_edge(NavGraphEdge(n, NavGraph::format_name("V_%u_%u", x + 1, y)),
+		       NavGraph::EDGE_FORCE);
+      }
+      if (y + 1 < size) {
+	graph.add_edge(NavGraphEdge(n, NavGraph::format_name("V_%u_%u", x, y + 1)),
+		       NavGraph::EDGE_FORCE);
+      }
+    }
+  }
+  printf("Graph with %zu nodes and %zu edges built in %.3f sec\n",
+	 graph.nodes().size(), graph.edges().size(), elapsed(start));
+
+  // diagonals crossing existing edges, these must be split
+  start = std::chrono::steady_clock::now();
+  unsigned int num_diagonals = 0;
+  for (unsigned int i = 0; i < size; ++i) {
+    unsigned int x = rand() % (size - 1);
+    unsigned int y = rand() % (size - 1);
+    try {
+      graph.add_edge(NavGraphEdge(NavGraph::format_name("V_%u_%u", x, y),
+				  NavGraph::format_name("V_%u_%u", x + 1, y + 1)),
+		     NavGraph::EDGE_SPLIT_INTERSECTION);
+      ++num_diagonals;
+    } catch (Exception &e) {} // exists already
+  }
+  printf("%-32s %8.3f sec  (%u edges)\n", "Split intersections", elapsed(start), num_diagonals);
+
+  // points of interest
+  start = std::chrono::steady_clock::now();
+  for (unsigned int i = 0; i < num_pois; ++i) {
+    NavGraphNode poi(NavGraph::format_name("P_%u", i),
+		     frand(size * spacing), frand(size * spacing));
+    try {
+      graph.add_node_and_connect(poi, NavGraph::CLOSEST_EDGE_OR_NODE);
+    } catch (Exception &e) {
+      printf("Failed to connect %s: %s\n", poi.name().c_str(), e.what_no_backtrace());
+    }
+  }
+  printf("%-32s %8.3f sec  (%u POIs)\n", "Connect points of interest", elapsed(start), num_pois);
+
+  // occupied map cells
+  std::vector<cart_coord_2d_t> cells;
+  for (unsigned int i = 0; i < num_cells; ++i) {
+    cells.push_back(cart_coord_2d_t(frand(size * spacing), frand(size * spacing)));
+  }
+
+  start = std::chrono::steady_clock::now();
+  size_t num_close_scan = 0;
+  const std::vector<NavGraphEdge> &edges = graph.edges();
+  for (const cart_coord_2d_t &c : cells) {
+    for (const NavGraphEdge &e : edges) {
+      float dist;
+      if (NavGraphSpatialIndex::edge_distance(e.from_node().x(), e.from_node().y(),
+					      e.to_node().x(), e.to_node().y(),
+					      c.x, c.y, dist) && dist <= max_dist)
+      {
+	++num_close_scan;
+      }
+    }
+  }
+  printf("%-32s %8.3f sec  (%zu close)\n", "Filter edges (linear scan)",
+	 elapsed(start), num_close_scan);
+
+  start = std::chrono::steady_clock::now();
+  size_t num_close = 0;
+  std::list<NavGraphEdge> remove_edges;
+  for (const cart_coord_2d_t &c : cells) {
+    std::vector<NavGraphEdge> close = graph.search_edges(c.x, c.y, max_dist);
+    num_close += close.size();
+    remove_edges.insert(remove_edges.end(), close.begin(), close.end());
+  }
+  remove_edges.sort();
+  remove_edges.unique();
+  printf("%-32s %8.3f sec  (%zu close)\n", "Filter edges (spatial index)",
+	 elapsed(start), num_close);
+
+  start = std::chrono::steady_clock::now();
+  for (const NavGraphEdge &e : remove_edges) {
+    graph.remove_edge(e);
+  }
+  printf("%-32s %8.3f sec  (%zu edges left)\n", "Remove filtered edges",
+	 elapsed(start), graph.edges().size());
+
+  // closest node queries
+  std::vector<cart_coord_2d_t> queries;
+  for (unsigned int i = 0; i < num_queries; ++i) {
+    queries.push_back(cart_coord_2d_t(frand(size * spacing), frand(size * spacing)));
+  }
+
+  start = std::chrono::steady_clock::now();
+  size_t sum_scan = 0;
+  const std::vector<NavGraphNode> &nodes = graph.nodes();
+  for (const cart_coord_2d_t &q : queries) {
+    float min_dist = std::numeric_limits<float>::max();
+    size_t min_i = 0;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      float dx = nodes[i].x() - q.x;
+      float dy = nodes[i].y() - q.y;
+      float dist = sqrtf(dx * dx + dy * dy);
+      if (dist < min_dist) {
+	min_dist = dist;
+	min_i = i;
+      }
+    }
+    sum_scan += nodes[min_i].name().size();
+  }
+  double scan_sec = elapsed(start);
+  printf("%-32s %8.3f sec  %8.1f ns/query\n", "Closest node (linear scan)",
+	 scan_sec, scan_sec * 1e9 / num_queries);
+
+  start = std::chrono::steady_clock::now();
+  size_t sum = 0;
+  for (const cart_coord_2d_t &q : queries) {
+    sum += graph.closest_node(q.x, q.y).name().size();
+  }
+  double index_sec = elapsed(start);
+  printf("%-32s %8.3f sec  %8.1f ns/query\n", "Closest node (spatial index)",
+	 index_sec, index_sec * 1e9 / num_queries);
+
+  if (sum != sum_scan || num_close != num_close_scan) {
+    printf("Results of linear scan and spatial index differ\n");
+    return 1;
+  }
+
+  return 0;
+}
+
+/// @endcond
@@ -47,13 +47,15 @@ namespace fawkes {
  * time that it takes to travel from one node to the other. The estimate function must
  * match the cost function to be admissible.
  * @param constraint_repo constraint repository, null to plan only without constraints
+ * @param compiled_id ID of the node in the compiled constraint view, -1 if unknown
  */
 NavGraphSearchState::NavGraphSearchState(const NavGraphNode& node, const NavGraphNode& goal,
                                          double cost_sofar, NavGraphSearchState *parent,
                                          NavGraph *map_graph,
                                          navgraph::EstimateFunction estimate_func,
                                          navgraph::CostFunction cost_func,
-                                         fawkes::NavGraphConstraintRepo *constraint_repo)
+                                         fawkes::NavGraphConstraintRepo *constraint_repo,
+                                         int compiled_id)
 : AStarState(cost_sofar, parent), estimate_func_(estimate_func), cost_func_(cost_func)
 {
   node_ = node;
@@ -66,6 +68,7 @@ NavGraphSearchState::NavGraphSearchState(const NavGraphNode& node, const NavGrap
   key_ = h(node_.name());
 
   constraint_repo_ = constraint_repo;
+  compiled_id_ = compiled_id;
 }
 
 
@@ -93,6 +96,7 @@ NavGraphSearchState::NavGraphSearchState(const NavGraphNode& node, const NavGrap
   key_ = h(node_.name());
 
   constraint_repo_ = constraint_repo;
+  compiled_id_ = -1;
 }
 
 
@@ -129,6 +133,7 @@ NavGraphSearchState::NavGraphSearchState(const NavGraphNode& node,
   key_ = h(node_.name());
 
   constraint_repo_ = constraint_repo;
+  compiled_id_ = -1;
 }
 
 
@@ -168,16 +173,44 @@ NavGraphSearchState::children()
   std::vector< AStarState * > children;
   children.clear();
 
-  std::vector<std::string> descendants = node_.reachable_nodes();
+  if (constraint_repo_ && (compiled_id_ < 0)) {
+    compiled_id_ = constraint_repo_->compiled_node_id(node_);
+  }
+
+  const std::vector<std::string> &descendants = node_.reachable_nodes();
 
   for (unsigned int i = 0; i < descendants.size(); ++i) {
+    // use the compiled view by ID if possible, it avoids looking up
+    // nodes and constraint results by name
+    int edge_id = constraint_repo_ ? constraint_repo_->compiled_edge_id(compiled_id_, i) : -1;
+    if (edge_id >= 0) {
+      int d_id = constraint_repo_->compiled_edge_target(edge_id);
+      if (constraint_repo_->compiled_blocks(d_id) ||
+	  constraint_repo_->compiled_edge_blocks(edge_id))
+      {
+	continue;
+      }
+
+      const NavGraphNode &d = map_graph_->nodes()[d_id];
+      float d_cost = cost_func_(node_, d);
+      float cost_factor = 0.;
+      if (constraint_repo_->compiled_increases_cost(edge_id, cost_factor)) {
+	d_cost *= cost_factor;
+      }
+
+      children.push_back(new NavGraphSearchState(d, goal_, path_cost + d_cost, this,
+						 map_graph_, estimate_func_, cost_func_,
+						 constraint_repo_, d_id));
+      continue;
+    }
+
     NavGraphNode d = map_graph_->node(descendants[i]);
 
     bool expand = true;
     if (constraint_repo_) {
-      if (constraint_repo_->blocks(d)) {
+      if (constraint_repo_->compiled_blocks(d)) {
 	expand = false;
-      } else if (constraint_repo_->blocks(node_, d)) {
+      } else if (constraint_repo_->compiled_blocks(node_, d)) {
 	expand = false;
       }
     }
@@ -187,7 +220,7 @@ NavGraphSearchState::children()
 
       if (constraint_repo_) {
 	float cost_factor = 0.;
-	if (constraint_repo_->increases_cost(node_, d, cost_factor)) {
+	if (constraint_repo_->compiled_increases_cost(node_, d, cost_factor)) {
 	  d_cost *= cost_factor;
 	}
       }
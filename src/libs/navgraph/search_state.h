@@ -89,7 +89,8 @@ class NavGraphSearchState : public fawkes::AStarState
                       fawkes::NavGraph *map_graph,
                       navgraph::EstimateFunction estimate_func,
                       navgraph::CostFunction cost_func,
-                      fawkes::NavGraphConstraintRepo *constraint_repo = NULL);
+                      fawkes::NavGraphConstraintRepo *constraint_repo = NULL,
+                      int compiled_id = -1);
 
  private:
   std::vector<AStarState *> children();
@@ -103,6 +104,7 @@ class NavGraphSearchState : public fawkes::AStarState
   fawkes::NavGraph *map_graph_;
 
   fawkes::NavGraphConstraintRepo *constraint_repo_;
+  int compiled_id_;
 
   size_t key_;
 
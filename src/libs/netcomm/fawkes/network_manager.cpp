@@ -57,19 +57,26 @@ namespace fawkes {
  * empty string or :: to listen on any local address
  * @param fawkes_port port to listen on for Fawkes network connections
  * @param service_name Avahi service name for Fawkes network service
+ * @param num_io_threads number of threads performing the client socket I/O
+ * @param max_send_queue_bytes maximum number of bytes queued for sending
+ * to a single client before it is disconnected
  */
 FawkesNetworkManager::FawkesNetworkManager(ThreadCollector *thread_collector,
                                            bool enable_ipv4, bool enable_ipv6,
                                            const std::string &listen_ipv4, const std::string &listen_ipv6,
                                            unsigned short int fawkes_port,
-                                           const char *service_name)
+                                           const char *service_name,
+                                           unsigned int num_io_threads,
+                                           size_t max_send_queue_bytes)
 {
   fawkes_port_      = fawkes_port;
   thread_collector_ = thread_collector;
   fawkes_network_thread_ = new FawkesNetworkServerThread(enable_ipv4, enable_ipv6,
                                                           listen_ipv4, listen_ipv6,
                                                           fawkes_port_,
-                                                          thread_collector_);
+                                                          thread_collector_,
+                                                          num_io_threads,
+                                                          max_send_queue_bytes);
   thread_collector_->add(fawkes_network_thread_);
 #ifdef HAVE_AVAHI
   avahi_thread_          = new AvahiThread(enable_ipv4, enable_ipv6);
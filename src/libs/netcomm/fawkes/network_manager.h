@@ -25,6 +25,7 @@
 #define _FAWKES_NETWORK_MANAGER_H_
 
 #include <string>
+#include <cstddef>
 
 namespace fawkes {
 class ThreadCollector;
@@ -43,7 +44,9 @@ class FawkesNetworkManager
 	                     bool enable_ipv4, bool enable_ipv6,
 	                     const std::string &listen_ipv4, const std::string &listen_ipv6,
                        unsigned short int fawkes_port,
-                       const char *service_name);
+                       const char *service_name,
+                       unsigned int num_io_threads = 2,
+                       size_t max_send_queue_bytes = 16 * 1024 * 1024);
   ~FawkesNetworkManager();
 
   FawkesNetworkHub *     hub();
@@ -0,0 +1,323 @@
+
+/***************************************************************************
+ *  server_client.cpp - Fawkes network client connection on the server
+ *
+ *  Created: Tue Oct 20 09:12:44 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#include <netcomm/fawkes/server_client.h>
+#include <netcomm/fawkes/message.h>
+#include <netcomm/fawkes/transceiver.h>
+#include <netcomm/socket/stream.h>
+#include <netcomm/utils/exceptions.h>
+#include <core/threading/mutex.h>
+#include <core/threading/mutex_locker.h>
+#include <core/threading/wait_condition.h>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+namespace fawkes {
+
+/// @cond INTERNALS
+/** Initial size of the receive buffer. */
+#define RECV_BUFFER_SIZE   16384
+/// @endcond
+
+/** @class FawkesNetworkServerClient <netcomm/fawkes/server_client.h>
+ * Client connected to the Fawkes network server.
+ * Holds the socket and the message queues of a client. The actual
+ * I/O is performed by the FawkesNetworkServerIOThread the client has
+ * been assigned to. Outgoing messages are written with a single gathering
+ * system call for up to 64 queued messages. Incoming data is read in
+ * large chunks into a receive buffer that is kept for the lifetime of the
+ * connection, and complete messages are parsed from it.
+ *
+ * If more than the configured number of bytes is queued for sending,
+ * the client is considered to be too slow and the connection is closed.
+ *
+ * @ingroup NetComm
+ * @author agent
+ */
+
+/** Constructor.
+ * @param clid client ID
+ * @param s socket to client, the client takes ownership
+ * @param max_send_queue_bytes maximum number of bytes queued for sending
+ */
+FawkesNetworkServerClient::FawkesNetworkServerClient(unsigned int clid, StreamSocket *s,
+						     size_t max_send_queue_bytes)
+{
+  clid_  = clid;
+  s_     = s;
+  alive_ = true;
+
+  send_mutex_           = new Mutex();
+  all_sent_waitcond_    = new WaitCondition(send_mutex_);
+  send_queue_bytes_     = 0;
+  max_send_queue_bytes_ = max_send_queue_bytes;
+  sent_offset_          = 0;
+  send_notified_        = false;
+  write_armed_          = false;
+
+  recv_buffer_.resize(RECV_BUFFER_SIZE);
+  recv_length_ = 0;
+}
+
+
+/** Destructor. */
+FawkesNetworkServerClient::~FawkesNetworkServerClient()
+{
+  while (! send_queue_.empty()) {
+    send_queue_.front()->unref();
+    send_queue_.pop_front();
+  }
+  delete all_sent_waitcond_;
+  delete send_mutex_;
+  delete s_;
+}
+
+
+/** Get client ID.
+ * @return client ID
+ */
+unsigned int
+FawkesNetworkServerClient::clid() const
+{
+  return clid_;
+}
+
+
+/** Check aliveness of connection.
+ * @return true if connection is still alive, false otherwise.
+ */
+bool
+FawkesNetworkServerClient::alive() const
+{
+  return alive_;
+}
+
+
+/** Mark connection as dead.
+ * No more messages are accepted for sending. The socket is closed once
+ * the server removed the client.
+ */
+void
+FawkesNetworkServerClient::connection_died()
+{
+  MutexLocker lock(send_mutex_);
+  alive_ = false;
+  all_sent_waitcond_->wake_all();
+}
+
+
+int
+FawkesNetworkServerClient::fd() const
+{
+  return s_->fd();
+}
+
+
+/** Enqueue message to send queue.
+ * The message must have been packed. This method takes ownership of the
+ * message. If you want to use the message after enqueuing you must
+ * reference it explicitly. If the send queue limit is exceeded the message
+ * is dropped and the connection is marked dead.
+ * @param msg message to enqueue
+ * @return true if the I/O thread must be notified to send, false if it
+ * has been notified already or the message was dropped
+ */
+bool
+FawkesNetworkServerClient::enqueue(FawkesNetworkMessage *msg)
+{
+  MutexLocker lock(send_mutex_);
+  if (! alive_) {
+    msg->unref();
+    return false;
+  }
+
+  size_t size = sizeof(fawkes_message_header_t) + msg->payload_size();
+  if (! send_queue_.empty() && (send_queue_bytes_ + size > max_send_queue_bytes_)) {
+    msg->unref();
+    lock.unlock();
+    connection_died();
+    return false;
+  }
+
+  send_queue_.push_back(msg);
+  send_queue_bytes_ += size;
+
+  bool notify = ! send_notified_;
+  send_notified_ = true;
+  return notify;
+}
+
+
+/** Wait until all queued messages have been sent.
+ * Returns early if the connection dies.
+ */
+void
+FawkesNetworkServerClient::wait_for_all_sent()
+{
+  MutexLocker lock(send_mutex_);
+  while (alive_ && ! send_queue_.empty()) {
+    all_sent_waitcond_->wait();
+  }
+}
+
+
+/** Write queued messages.
+ * Writes as much as possible without blocking.
+ * @return true if all messages have been sent, false if the socket would block
+ * @exception ConnectionDiedException thrown if writing fails
+ */
+bool
+FawkesNetworkServerClient::flush()
+{
+  MutexLocker lock(send_mutex_);
+  send_notified_ = false;
+
+  while (alive_ && ! send_queue_.empty()) {
+    FawkesNetworkMessage *msgs[FawkesNetworkTransceiver::SEND_MAX_MESSAGES];
+    struct iovec iov[FawkesNetworkTransceiver::SEND_MAX_MESSAGES * 2];
+    unsigned int num_msgs = 0;
+    while ((num_msgs < send_queue_.size()) &&
+	   (num_msgs < FawkesNetworkTransceiver::SEND_MAX_MESSAGES))
+    {
+      msgs[num_msgs] = send_queue_[num_msgs];
+      ++num_msgs;
+    }
+    int niov = FawkesNetworkTransceiver::gather(msgs, num_msgs, sent_offset_, iov);
+
+    struct msghdr mh;
+    memset(&mh, 0, sizeof(mh));
+    mh.msg_iov    = iov;
+    mh.msg_iovlen = niov;
+
+    ssize_t written = ::sendmsg(fd(), &mh, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (written < 0) {
+      if (errno == EINTR)  continue;
+      if ((errno == EAGAIN) || (errno == EWOULDBLOCK))  return false;
+      throw ConnectionDiedException("Write failed");
+    }
+
+    size_t w = written;
+    while (w > 0) {
+      FawkesNetworkMessage *m = send_queue_.front();
+      size_t size = sizeof(fawkes_message_header_t) + m->payload_size();
+      if (w >= size - sent_offset_) {
+	w -= size - sent_offset_;
+	sent_offset_ = 0;
+	send_queue_bytes_ -= size;
+	m->unref();
+	send_queue_.pop_front();
+      } else {
+	sent_offset_ += w;
+	w = 0;
+      }
+    }
+  }
+
+  all_sent_waitcond_->wake_all();
+  return true;
+}
+
+
+/** Receive messages.
+ * Reads all data currently available without blocking.
+ * @param msgs complete messages are appended to this list, the caller
+ * owns the returned messages
+ * @exception ConnectionDiedException thrown if the connection has been
+ * closed or reading fails
+ */
+void
+FawkesNetworkServerClient::recv(std::list<FawkesNetworkMessage *> &msgs)
+{
+  for (;;) {
+    if (recv_length_ == recv_buffer_.size()) {
+      recv_buffer_.resize(recv_buffer_.size() * 2);
+    }
+
+    size_t space = recv_buffer_.size() - recv_length_;
+    ssize_t r = ::recv(fd(), &recv_buffer_[recv_length_], space, MSG_DONTWAIT);
+    if (r < 0) {
+      if (errno == EINTR)  continue;
+      if ((errno == EAGAIN) || (errno == EWOULDBLOCK))  break;
+      throw ConnectionDiedException("Read failed");
+    } else if (r == 0) {
+      throw ConnectionDiedException("Connection closed");
+    }
+
+    recv_length_ += r;
+    parse(msgs);
+
+    // the socket has been drained if the buffer was not filled
+    if ((size_t)r < space)  break;
+  }
+
+  // do not keep memory of a single large message forever
+  if ((recv_length_ == 0) && (recv_buffer_.size() > RECV_BUFFER_SIZE * 64)) {
+    std::vector<char>(RECV_BUFFER_SIZE).swap(recv_buffer_);
+  }
+}
+
+
+void
+FawkesNetworkServerClient::parse(std::list<FawkesNetworkMessage *> &msgs)
+{
+  const size_t header_size = sizeof(fawkes_message_header_t);
+
+  size_t pos = 0;
+  while (recv_length_ - pos >= header_size) {
+    fawkes_message_t msg;
+    memcpy(&msg.header, &recv_buffer_[pos], header_size);
+    size_t payload_size = ntohl(msg.header.payload_size);
+
+    if (recv_length_ - pos < header_size + payload_size) {
+      if (recv_buffer_.size() < header_size + payload_size) {
+	// make room for the complete message
+	memmove(&recv_buffer_[0], &recv_buffer_[pos], recv_length_ - pos);
+	recv_length_ -= pos;
+	pos = 0;
+	recv_buffer_.resize(header_size + payload_size);
+      }
+      break;
+    }
+
+    if (payload_size > 0) {
+      msg.payload = malloc(payload_size);
+      memcpy(msg.payload, &recv_buffer_[pos + header_size], payload_size);
+    } else {
+      msg.payload = NULL;
+    }
+    msgs.push_back(new FawkesNetworkMessage(clid_, msg));
+    pos += header_size + payload_size;
+  }
+
+  if (pos > 0) {
+    memmove(&recv_buffer_[0], &recv_buffer_[pos], recv_length_ - pos);
+    recv_length_ -= pos;
+  }
+}
+
+} // end namespace fawkes
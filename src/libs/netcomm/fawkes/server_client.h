@@ -0,0 +1,81 @@
+
+/***************************************************************************
+ *  server_client.h - Fawkes network client connection on the server
+ *
+ *  Created: Tue Oct 20 09:12:44 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#ifndef _NETCOMM_FAWKES_SERVER_CLIENT_H_
+#define _NETCOMM_FAWKES_SERVER_CLIENT_H_
+
+#include <atomic>
+#include <deque>
+#include <list>
+#include <vector>
+#include <cstddef>
+
+namespace fawkes {
+
+class StreamSocket;
+class FawkesNetworkMessage;
+class Mutex;
+class WaitCondition;
+
+class FawkesNetworkServerClient
+{
+ friend class FawkesNetworkServerIOThread;
+ public:
+  FawkesNetworkServerClient(unsigned int clid, StreamSocket *s,
+			    size_t max_send_queue_bytes);
+  ~FawkesNetworkServerClient();
+
+  unsigned int clid() const;
+  bool         alive() const;
+  void         connection_died();
+
+  bool enqueue(FawkesNetworkMessage *msg);
+  void wait_for_all_sent();
+
+ private:
+  int  fd() const;
+  bool flush();
+  void recv(std::list<FawkesNetworkMessage *> &msgs);
+  void parse(std::list<FawkesNetworkMessage *> &msgs);
+
+ private:
+  unsigned int       clid_;
+  std::atomic<bool>  alive_;
+  StreamSocket      *s_;
+
+  Mutex                            *send_mutex_;
+  WaitCondition                    *all_sent_waitcond_;
+  std::deque<FawkesNetworkMessage *> send_queue_;
+  size_t                            send_queue_bytes_;
+  size_t                            max_send_queue_bytes_;
+  size_t                            sent_offset_;
+  bool                              send_notified_;
+  bool                              write_armed_;
+
+  std::vector<char> recv_buffer_;
+  size_t            recv_length_;
+};
+
+} // end namespace fawkes
+
+#endif
@@ -0,0 +1,271 @@
+
+/***************************************************************************
+ *  server_io_thread.cpp - Fawkes network server I/O thread
+ *
+ *  Created: Tue Oct 20 10:03:17 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#include <netcomm/fawkes/server_io_thread.h>
+#include <netcomm/fawkes/server_client.h>
+#include <netcomm/fawkes/server_thread.h>
+#include <netcomm/fawkes/message.h>
+#include <netcomm/utils/exceptions.h>
+#include <core/threading/mutex.h>
+#include <core/threading/mutex_locker.h>
+#include <core/exception.h>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <list>
+#include <stdint.h>
+
+namespace fawkes {
+
+/// @cond INTERNALS
+/** Maximum number of events processed per wakeup. */
+#define MAX_EVENTS 64
+/// @endcond
+
+/** @class FawkesNetworkServerIOThread <netcomm/fawkes/server_io_thread.h>
+ * Fawkes network server I/O thread.
+ * Performs the socket I/O for a group of clients of the Fawkes network
+ * server. All client sockets are waited for with a single epoll instance.
+ * Received messages are passed to the server thread for dispatching,
+ * clients with queued outgoing messages are flushed once the socket is
+ * writable. The server thread distributes its clients among a small
+ * number of these threads instead of running two threads per client.
+ *
+ * @ingroup NetComm
+ * @author agent
+ */
+
+/** Constructor.
+ * @param parent server thread to dispatch received messages to
+ * @param index index of this I/O thread, used in the thread name
+ */
+FawkesNetworkServerIOThread::FawkesNetworkServerIOThread(FawkesNetworkServerThread *parent,
+							 unsigned int index)
+  : Thread("FawkesNetworkServerIOThread", Thread::OPMODE_CONTINUOUS)
+{
+  set_name("FawkesNetworkServerIOThread %u", index);
+  parent_ = parent;
+
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd_ == -1) {
+    throw Exception(errno, "Failed to create epoll instance");
+  }
+  event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (event_fd_ == -1) {
+    int err = errno;
+    ::close(epoll_fd_);
+    throw Exception(err, "Failed to create eventfd");
+  }
+
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.events   = EPOLLIN;
+  ev.data.u64 = 0;
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, event_fd_, &ev) == -1) {
+    int err = errno;
+    ::close(event_fd_);
+    ::close(epoll_fd_);
+    throw Exception(err, "Failed to add eventfd to epoll instance");
+  }
+
+  clients_mutex_ = new Mutex();
+  pending_mutex_ = new Mutex();
+}
+
+
+/** Destructor. */
+FawkesNetworkServerIOThread::~FawkesNetworkServerIOThread()
+{
+  ::close(event_fd_);
+  ::close(epoll_fd_);
+  delete clients_mutex_;
+  delete pending_mutex_;
+}
+
+
+/** Add a client.
+ * The thread starts to read from and write to the client's socket.
+ * The client remains owned by the caller.
+ * @param client client to add
+ */
+void
+FawkesNetworkServerIOThread::add_client(FawkesNetworkServerClient *client)
+{
+  MutexLocker lock(clients_mutex_);
+
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.events   = EPOLLIN | EPOLLRDHUP;
+  ev.data.u64 = client->clid();
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, client->fd(), &ev) == -1) {
+    throw Exception(errno, "Failed to add client %u to epoll instance",
+		    client->clid());
+  }
+  clients_[client->clid()] = client;
+}
+
+
+/** Remove a client.
+ * After this method returns the thread does not access the client anymore
+ * and it may be deleted.
+ * @param client client to remove
+ */
+void
+FawkesNetworkServerIOThread::remove_client(FawkesNetworkServerClient *client)
+{
+  MutexLocker lock(clients_mutex_);
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, client->fd(), NULL);
+  clients_.erase(client->clid());
+}
+
+
+/** Notify about outgoing messages.
+ * To be called if FawkesNetworkServerClient::enqueue() requested it.
+ * The client is flushed by this thread as soon as possible.
+ * @param client client which has messages queued
+ */
+void
+FawkesNetworkServerIOThread::notify_send(FawkesNetworkServerClient *client)
+{
+  MutexLocker lock(pending_mutex_);
+  bool signal = pending_sends_.empty();
+  pending_sends_.push_back(client->clid());
+  lock.unlock();
+
+  if (signal) {
+    uint64_t one = 1;
+    if (::write(event_fd_, &one, sizeof(one)) == -1) {
+      // counter overflow, thread has been signalled anyway
+    }
+  }
+}
+
+
+void
+FawkesNetworkServerIOThread::flush_client(FawkesNetworkServerClient *client)
+{
+  bool all_sent = client->flush();
+  if (all_sent == client->write_armed_) {
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events   = EPOLLIN | EPOLLRDHUP | (all_sent ? 0 : EPOLLOUT);
+    ev.data.u64 = client->clid();
+    epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, client->fd(), &ev);
+    client->write_armed_ = ! all_sent;
+  }
+}
+
+
+void
+FawkesNetworkServerIOThread::client_died(FawkesNetworkServerClient *client)
+{
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, client->fd(), NULL);
+  client->connection_died();
+}
+
+
+/** Thread loop.
+ * Waits for socket events, receives messages and flushes send queues.
+ */
+void
+FawkesNetworkServerIOThread::loop()
+{
+  struct epoll_event events[MAX_EVENTS];
+  int nfds = epoll_wait(epoll_fd_, events, MAX_EVENTS, -1);
+  if (nfds == -1)  return;
+
+  CancelState old_cancel_state;
+  set_cancel_state(CANCEL_DISABLED, &old_cancel_state);
+
+  std::list<FawkesNetworkMessage *> inbound;
+  bool wakeup_parent = false;
+
+  MutexLocker lock(clients_mutex_);
+  for (int i = 0; i < nfds; ++i) {
+    if (events[i].data.u64 == 0) {
+      uint64_t count;
+      if (::read(event_fd_, &count, sizeof(count)) == -1) {
+	// already reset
+      }
+      pending_mutex_->lock();
+      processing_sends_.swap(pending_sends_);
+      pending_mutex_->unlock();
+
+      for (unsigned int clid : processing_sends_) {
+	std::map<unsigned int, FawkesNetworkServerClient *>::iterator c = clients_.find(clid);
+	if ((c == clients_.end()) || ! c->second->alive())  continue;
+	try {
+	  flush_client(c->second);
+	} catch (ConnectionDiedException &e) {
+	  client_died(c->second);
+	  wakeup_parent = true;
+	}
+      }
+      processing_sends_.clear();
+      continue;
+    }
+
+    std::map<unsigned int, FawkesNetworkServerClient *>::iterator c =
+      clients_.find((unsigned int)events[i].data.u64);
+    if (c == clients_.end())  continue;
+    FawkesNetworkServerClient *client = c->second;
+    if (! client->alive()) {
+      // died while enqueuing, stop watching until removed by the server
+      epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, client->fd(), NULL);
+      continue;
+    }
+
+    try {
+      if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+	client->recv(inbound);
+      }
+      if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+	throw ConnectionDiedException("Connection closed");
+      }
+      if (events[i].events & EPOLLOUT) {
+	flush_client(client);
+      }
+    } catch (ConnectionDiedException &e) {
+      client_died(client);
+      wakeup_parent = true;
+    }
+  }
+  lock.unlock();
+
+  if (! inbound.empty()) {
+    for (FawkesNetworkMessage *m : inbound) {
+      parent_->dispatch(m);
+      m->unref();
+    }
+    wakeup_parent = true;
+  }
+
+  if (wakeup_parent)  parent_->wakeup();
+
+  set_cancel_state(old_cancel_state);
+}
+
+} // end namespace fawkes
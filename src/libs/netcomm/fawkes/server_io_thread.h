@@ -1,9 +1,9 @@
 
 /***************************************************************************
- *  client_thread.h - Thread to handle Fawkes network client
+ *  server_io_thread.h - Fawkes network server I/O thread
  *
- *  Created: Fri Nov 17 15:30:15 2006
- *  Copyright  2006  Tim Niemueller [www.niemueller.de]
+ *  Created: Tue Oct 20 10:03:17 2026
+ *  Copyright  2006-2026  Tim Niemueller [www.niemueller.de]
  *
  ****************************************************************************/
 
@@ -21,53 +21,51 @@
  *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
  */
 
-#ifndef _NETCOMM_FAWKES_CLIENT_THREAD_H_
-#define _NETCOMM_FAWKES_CLIENT_THREAD_H_
+#ifndef _NETCOMM_FAWKES_SERVER_IO_THREAD_H_
+#define _NETCOMM_FAWKES_SERVER_IO_THREAD_H_
 
 #include <core/threading/thread.h>
-#include <list>
+
+#include <map>
+#include <vector>
 
 namespace fawkes {
 
-class StreamSocket;
-class FawkesNetworkServerThread;
-class FawkesNetworkMessage;
-class FawkesNetworkMessageQueue;
-class WaitCondition;
 class Mutex;
-class FawkesNetworkServerClientSendThread;
+class FawkesNetworkServerThread;
+class FawkesNetworkServerClient;
 
-class FawkesNetworkServerClientThread : public Thread
+class FawkesNetworkServerIOThread : public Thread
 {
  public:
-  FawkesNetworkServerClientThread(StreamSocket *s, FawkesNetworkServerThread *parent);
-  ~FawkesNetworkServerClientThread();
+  FawkesNetworkServerIOThread(FawkesNetworkServerThread *parent, unsigned int index);
+  virtual ~FawkesNetworkServerIOThread();
 
-  virtual void once();
   virtual void loop();
 
-  unsigned int clid() const;
-  void         set_clid(unsigned int client_id);
-
-  bool alive() const;
-  void enqueue(FawkesNetworkMessage *msg);
-
-  void force_send();
-  void connection_died();
+  void add_client(FawkesNetworkServerClient *client);
+  void remove_client(FawkesNetworkServerClient *client);
+  void notify_send(FawkesNetworkServerClient *client);
 
  /** Stub to see name in backtrace for easier debugging. @see Thread::run() */
  protected: virtual void run() { Thread::run(); }
 
  private:
-  void recv();
+  void flush_client(FawkesNetworkServerClient *client);
+  void client_died(FawkesNetworkServerClient *client);
+
+ private:
+  FawkesNetworkServerThread *parent_;
+
+  int epoll_fd_;
+  int event_fd_;
 
-  unsigned int                _clid;
-  bool                        _alive;
-  StreamSocket               *_s;
-  FawkesNetworkServerThread  *_parent;
-  FawkesNetworkMessageQueue  *_inbound_queue;
+  Mutex *clients_mutex_;
+  std::map<unsigned int, FawkesNetworkServerClient *> clients_;
 
-  FawkesNetworkServerClientSendThread  *_send_slave;
+  Mutex *pending_mutex_;
+  std::vector<unsigned int> pending_sends_;
+  std::vector<unsigned int> processing_sends_;
 };
 
 } // end namespace fawkes
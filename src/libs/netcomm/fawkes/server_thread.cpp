@@ -22,7 +22,8 @@
  */
 
 #include <netcomm/fawkes/server_thread.h>
-#include <netcomm/fawkes/server_client_thread.h>
+#include <netcomm/fawkes/server_client.h>
+#include <netcomm/fawkes/server_io_thread.h>
 #include <netcomm/utils/acceptor_thread.h>
 #include <netcomm/fawkes/message.h>
 #include <netcomm/fawkes/handler.h>
@@ -33,14 +34,17 @@
 #include <core/threading/mutex_locker.h>
 #include <core/exception.h>
 
-#include <unistd.h>
+#include <algorithm>
 
 namespace fawkes {
 
 /** @class FawkesNetworkServerThread <netcomm/fawkes/server_thread.h>
  * Fawkes Network Thread.
  * Maintains a list of clients and reacts on events triggered by the clients.
- * Also runs the acceptor thread.
+ * Also runs the acceptor thread. The socket I/O of all clients is performed
+ * by a fixed number of FawkesNetworkServerIOThread instances, to which new
+ * clients are assigned round-robin. Messages received by these threads are
+ * dispatched to the handlers from this thread.
  *
  * @ingroup NetComm
  * @author Tim Niemueller
@@ -55,18 +59,28 @@ namespace fawkes {
  * :: to listen on any local address
  * @param fawkes_port port for Fawkes network protocol
  * @param thread_collector thread collector to register new threads with
+ * @param num_io_threads number of threads performing the client socket I/O
+ * @param max_send_queue_bytes maximum number of bytes queued for sending to
+ * a single client, if exceeded the client is disconnected
  */
 FawkesNetworkServerThread::FawkesNetworkServerThread(bool enable_ipv4, bool enable_ipv6,
                                                      const std::string &listen_ipv4, const std::string &listen_ipv6,
                                                      unsigned int fawkes_port,
-                                                     ThreadCollector *thread_collector)
+                                                     ThreadCollector *thread_collector,
+                                                     unsigned int num_io_threads,
+                                                     size_t max_send_queue_bytes)
   : Thread("FawkesNetworkServerThread", Thread::OPMODE_WAITFORWAKEUP)
 {
   this->thread_collector = thread_collector;
+  this->max_send_queue_bytes = max_send_queue_bytes;
   clients.clear();
   next_client_id = 1;
   inbound_messages = new FawkesNetworkMessageQueue();
 
+  for (unsigned int i = 0; i < std::max(1u, num_io_threads); ++i) {
+    io_threads.push_back(new FawkesNetworkServerIOThread(this, i));
+  }
+
   if (enable_ipv4) {
 	  acceptor_threads.push_back(new NetworkAcceptorThread(this, Socket::IPv4, listen_ipv4, fawkes_port,
 	                                                       "FawkesNetworkAcceptorThread"));
@@ -77,10 +91,16 @@ FawkesNetworkServerThread::FawkesNetworkServerThread(bool enable_ipv4, bool enab
   }
 		  
   if ( thread_collector ) {
+	  for (size_t i = 0; i < io_threads.size(); ++i) {
+		  thread_collector->add(io_threads[i]);
+	  }
 	  for (size_t i = 0; i < acceptor_threads.size(); ++i) {
 		  thread_collector->add(acceptor_threads[i]);
 	  }
   } else {
+	  for (size_t i = 0; i < io_threads.size(); ++i) {
+		  io_threads[i]->start();
+	  }
 	  for (size_t i = 0; i < acceptor_threads.size(); ++i) {
 		  acceptor_threads[i]->start();
 	  }
@@ -91,15 +111,6 @@ FawkesNetworkServerThread::FawkesNetworkServerThread(bool enable_ipv4, bool enab
 /** Destructor. */
 FawkesNetworkServerThread::~FawkesNetworkServerThread()
 {
-  for (cit = clients.begin(); cit != clients.end(); ++cit) {
-    if ( thread_collector ) {
-      thread_collector->remove((*cit).second);
-    } else {
-      (*cit).second->cancel();
-      (*cit).second->join();
-    }
-    delete (*cit).second;
-  }
   for (size_t i = 0; i < acceptor_threads.size(); ++i) {
 	  if ( thread_collector ) {
 		  thread_collector->remove(acceptor_threads[i]);
@@ -111,6 +122,22 @@ FawkesNetworkServerThread::~FawkesNetworkServerThread()
   }
   acceptor_threads.clear();
 
+  for (size_t i = 0; i < io_threads.size(); ++i) {
+	  if ( thread_collector ) {
+		  thread_collector->remove(io_threads[i]);
+	  } else {
+		  io_threads[i]->cancel();
+		  io_threads[i]->join();
+	  }
+	  delete io_threads[i];
+  }
+  io_threads.clear();
+
+  for (cit = clients.begin(); cit != clients.end(); ++cit) {
+    delete (*cit).second;
+  }
+  clients.clear();
+
   delete inbound_messages;
 }
 
@@ -122,16 +149,17 @@ FawkesNetworkServerThread::~FawkesNetworkServerThread()
 void
 FawkesNetworkServerThread::add_connection(StreamSocket *s) throw()
 {
-  FawkesNetworkServerClientThread *client = new FawkesNetworkServerClientThread(s, this);
-
   clients.lock();
-  client->set_clid(next_client_id);
-  if ( thread_collector ) {
-    thread_collector->add(client);
-  } else {
-    client->start();
-  }
   unsigned int cid = next_client_id++;
+  FawkesNetworkServerClient *client =
+    new FawkesNetworkServerClient(cid, s, max_send_queue_bytes);
+  try {
+    io_thread(cid)->add_client(client);
+  } catch (Exception &e) {
+    clients.unlock();
+    delete client;
+    return;
+  }
   clients[cid] = client;
   clients.unlock();
 
@@ -204,15 +232,9 @@ FawkesNetworkServerThread::loop()
 
 	  {
 		  MutexLocker clients_lock(clients.mutex());
-		  if ( thread_collector ) {
-			  thread_collector->remove(clients[clid]);
-		  } else {
-			  clients[clid]->cancel();
-			  clients[clid]->join();
-		  }
-		  usleep(5000);
+		  io_thread(clid)->remove_client(clients[clid]);
 		  delete clients[clid];
-      clients.erase(clid);
+		  clients.erase(clid);
 	  }
   }
 
@@ -233,18 +255,40 @@ FawkesNetworkServerThread::loop()
 }
 
 
-/** Force sending of all pending messages. */
+/** Force sending of all pending messages.
+ * Blocks until the send queues of all alive clients have been flushed.
+ */
 void
 FawkesNetworkServerThread::force_send()
 {
   clients.lock();
   for (cit = clients.begin(); cit != clients.end(); ++cit) {
-    (*cit).second->force_send();
+    (*cit).second->wait_for_all_sent();
   }
   clients.unlock();
 }
 
 
+FawkesNetworkServerIOThread *
+FawkesNetworkServerThread::io_thread(unsigned int clid) const
+{
+  return io_threads[clid % io_threads.size()];
+}
+
+
+void
+FawkesNetworkServerThread::enqueue(FawkesNetworkServerClient *client,
+				   FawkesNetworkMessage *msg)
+{
+  if ( client->enqueue(msg) ) {
+    io_thread(client->clid())->notify_send(client);
+  } else if ( ! client->alive() ) {
+    // send queue limit exceeded, have the client removed
+    wakeup();
+  }
+}
+
+
 /** Broadcast a message.
  * Method to broadcast a message to all connected clients. This method will take
  * ownership of the passed message. If you want to use if after enqueing it you
@@ -254,11 +298,12 @@ FawkesNetworkServerThread::force_send()
 void
 FawkesNetworkServerThread::broadcast(FawkesNetworkMessage *msg)
 {
+  msg->pack();
   clients.lock();
   for (cit = clients.begin(); cit != clients.end(); ++cit) {
     if ( (*cit).second->alive() ) {
       msg->ref();
-      (*cit).second->enqueue(msg);
+      enqueue((*cit).second, msg);
     }
   }
   clients.unlock();
@@ -315,7 +360,8 @@ FawkesNetworkServerThread::send(FawkesNetworkMessage *msg)
 	unsigned int clid = msg->clid();
   if ( clients.find(clid) != clients.end() ) {
     if ( clients[clid]->alive() ) {
-      clients[clid]->enqueue(msg);
+      msg->pack();
+      enqueue(clients[clid], msg);
     } else {
       throw Exception("Client %u not alive", clid);
     }
@@ -31,12 +31,14 @@
 
 #include <vector>
 #include <string>
+#include <cstddef>
 
 namespace fawkes {
 
 class ThreadCollector;
 class Mutex;
-class FawkesNetworkServerClientThread;
+class FawkesNetworkServerClient;
+class FawkesNetworkServerIOThread;
 class NetworkAcceptorThread;
 class FawkesNetworkHandler;
 class FawkesNetworkMessage;
@@ -52,7 +54,9 @@ class FawkesNetworkServerThread
   FawkesNetworkServerThread(bool enable_ipv4, bool enable_ipv6,
                             const std::string &listen_ipv4, const std::string &listen_ipv6,
                             unsigned int fawkes_port,
-                            ThreadCollector *thread_collector = 0);
+                            ThreadCollector *thread_collector = 0,
+                            unsigned int num_io_threads = 2,
+                            size_t max_send_queue_bytes = 16 * 1024 * 1024);
   virtual ~FawkesNetworkServerThread();
 
   virtual void loop();
@@ -80,21 +84,27 @@ class FawkesNetworkServerThread
 
   void force_send();
 
+ private:
+  FawkesNetworkServerIOThread * io_thread(unsigned int clid) const;
+  void enqueue(FawkesNetworkServerClient *client, FawkesNetworkMessage *msg);
+
  /** Stub to see name in backtrace for easier debugging. @see Thread::run() */
  protected: virtual void run() { Thread::run(); }
 
  private:
   ThreadCollector       *thread_collector;
   unsigned int           next_client_id;
+  size_t                 max_send_queue_bytes;
   std::vector<NetworkAcceptorThread *> acceptor_threads;
+  std::vector<FawkesNetworkServerIOThread *> io_threads;
 
   // key: component id,  value: handler
   LockMap<unsigned int, FawkesNetworkHandler *> handlers;
   LockMap<unsigned int, FawkesNetworkHandler *>::iterator hit;
 
-  // key: client id,     value: client thread
-  LockMap<unsigned int, FawkesNetworkServerClientThread *> clients;
-  LockMap<unsigned int, FawkesNetworkServerClientThread *>::iterator cit;
+  // key: client id,     value: client
+  LockMap<unsigned int, FawkesNetworkServerClient *> clients;
+  LockMap<unsigned int, FawkesNetworkServerClient *>::iterator cit;
 
   FawkesNetworkMessageQueue *inbound_messages;
 };
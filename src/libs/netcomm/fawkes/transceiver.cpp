@@ -28,6 +28,7 @@
 #include <netcomm/utils/exceptions.h>
 
 #include <netinet/in.h>
+#include <sys/uio.h>
 #include <cstdlib>
 
 namespace fawkes {
@@ -42,6 +43,10 @@ namespace fawkes {
  */
 
 /** Send messages.
+ * All messages currently in the queue are sent. Headers and payloads of
+ * up to SEND_MAX_MESSAGES messages are written with a single gathering
+ * write, such that a burst of small messages is transmitted in as few
+ * segments as possible.
  * @param s socket over which the data shall be transmitted.
  * @param msgq message queue that contains the messages that have to be sent
  * @exception ConnectionDiedException Thrown if any error occurs during the
@@ -53,14 +58,23 @@ FawkesNetworkTransceiver::send(StreamSocket *s, FawkesNetworkMessageQueue *msgq)
   msgq->lock();
   try {
     while ( ! msgq->empty() ) {
-      FawkesNetworkMessage *m = msgq->front();
-      m->pack();
-      const fawkes_message_t &f = m->fmsg();
-      unsigned int payload_size = m->payload_size();
-      s->write(&(f.header), sizeof(f.header));
-      s->write(f.payload, payload_size);
-      m->unref();
-      msgq->pop();
+      FawkesNetworkMessage *msgs[SEND_MAX_MESSAGES];
+      struct iovec iov[SEND_MAX_MESSAGES * 2];
+      unsigned int num_msgs = 0;
+      while ( ! msgq->empty() && (num_msgs < SEND_MAX_MESSAGES) ) {
+	FawkesNetworkMessage *m = msgq->front();
+	msgq->pop();
+	msgs[num_msgs++] = m;
+	m->pack();
+      }
+      int num_iov = gather(msgs, num_msgs, 0, iov);
+      try {
+	s->writev(iov, num_iov);
+      } catch (SocketException &e) {
+	for (unsigned int i = 0; i < num_msgs; ++i)  msgs[i]->unref();
+	throw;
+      }
+      for (unsigned int i = 0; i < num_msgs; ++i)  msgs[i]->unref();
     }
   } catch (SocketException &e) {
     msgq->unlock();
@@ -70,6 +84,48 @@ FawkesNetworkTransceiver::send(StreamSocket *s, FawkesNetworkMessageQueue *msgq)
 }
 
 
+/** Prepare gathering write of messages.
+ * Fills the given I/O vector with header and payload of each message,
+ * such that all messages can be written with a single writev() or
+ * sendmsg() call. Messages must have been packed. Empty payloads are
+ * omitted.
+ * @param msgs messages to write
+ * @param num_msgs number of messages in @p msgs
+ * @param offset number of bytes of the first message which have already
+ * been written and are skipped, must be less than its total size
+ * @param iov I/O vector to fill, must have room for 2 * num_msgs entries
+ * @return number of entries filled in @p iov
+ */
+unsigned int
+FawkesNetworkTransceiver::gather(FawkesNetworkMessage * const *msgs, unsigned int num_msgs,
+				 size_t offset, struct iovec *iov)
+{
+  unsigned int niov = 0;
+  size_t skip = offset;
+  for (unsigned int i = 0; i < num_msgs; ++i) {
+    const fawkes_message_t &f = msgs[i]->fmsg();
+    const size_t payload_size = msgs[i]->payload_size();
+    const size_t header_size  = sizeof(f.header);
+
+    if (skip < header_size) {
+      iov[niov].iov_base = (char *)&f.header + skip;
+      iov[niov].iov_len  = header_size - skip;
+      ++niov;
+      skip = 0;
+    } else {
+      skip -= header_size;
+    }
+    if (payload_size > 0) {
+      iov[niov].iov_base = (char *)f.payload + skip;
+      iov[niov].iov_len  = payload_size - skip;
+      ++niov;
+      skip = 0;
+    }
+  }
+  return niov;
+}
+
+
 /** Receive data.
  * This method receives all messages currently available from the network, or
  * a limited number depending on max_num_msgs. If max_num_msgs is 0 then all
@@ -26,17 +26,28 @@
 
 #include <core/exception.h>
 
+#include <cstddef>
+
+struct iovec;
+
 namespace fawkes {
 
 class StreamSocket;
+class FawkesNetworkMessage;
 class FawkesNetworkMessageQueue;
 
 class FawkesNetworkTransceiver
 {
  public:
+  /** Maximum number of messages written with a single system call. */
+  static const unsigned int SEND_MAX_MESSAGES = 64;
+
   static void send(StreamSocket *s, FawkesNetworkMessageQueue *msgq);
   static void recv(StreamSocket *s, FawkesNetworkMessageQueue *msgq,
 		   unsigned int max_num_msgs = 8);
+
+  static unsigned int gather(FawkesNetworkMessage * const *msgs, unsigned int num_msgs,
+			     size_t offset, struct iovec *iov);
 };
 
 } // end namespace fawkes
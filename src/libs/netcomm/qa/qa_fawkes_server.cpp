@@ -0,0 +1,396 @@
+/***************************************************************************
+ *  qa_fawkes_server.cpp - Fawkes QA for the Fawkes network server
+ *
+ *  Created: Mon Oct 19 14:02:17 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+/// @cond QA
+
+#include <netcomm/fawkes/server_thread.h>
+#include <netcomm/fawkes/handler.h>
+#include <netcomm/fawkes/message.h>
+#include <netcomm/socket/stream.h>
+#include <core/exception.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace fawkes;
+
+#define QA_PORT        5130
+#define QA_CID         1000
+#define MSG_ECHO       1
+#define MSG_BULK       2
+
+#define NUM_CLIENTS    48
+#define NUM_MESSAGES   100
+
+/* Echoes ECHO messages. A BULK message with two 32 bit values count and
+ * size makes it send count messages of size bytes, each starting with
+ * its sequence number followed by a pattern derived from it. */
+class QaEchoHandler : public FawkesNetworkHandler
+{
+ public:
+  QaEchoHandler() : FawkesNetworkHandler(QA_CID), hub(NULL),
+		    num_connected(0), num_disconnected(0) {}
+
+  virtual void handle_network_message(FawkesNetworkMessage *msg)
+  {
+    if (msg->msgid() == MSG_ECHO) {
+      void *payload = malloc(msg->payload_size());
+      memcpy(payload, msg->payload(), msg->payload_size());
+      try {
+	hub->send(msg->clid(), QA_CID, MSG_ECHO, payload, msg->payload_size());
+      } catch (Exception &e) {} // client gone
+    } else if ((msg->msgid() == MSG_BULK) && (msg->payload_size() == 8)) {
+      uint32_t *req = (uint32_t *)msg->payload();
+      uint32_t count = ntohl(req[0]), size = ntohl(req[1]);
+      try {
+	for (uint32_t i = 0; i < count; ++i) {
+	  unsigned char *payload = (unsigned char *)malloc(size);
+	  uint32_t seq = htonl(i);
+	  memcpy(payload, &seq, sizeof(seq));
+	  for (uint32_t j = sizeof(seq); j < size; ++j)  payload[j] = (i + j) & 0xff;
+	  hub->send(msg->clid(), QA_CID, MSG_BULK, payload, size);
+	}
+      } catch (Exception &e) {
+	// client disconnected or was dropped for exceeding its send queue
+      }
+    }
+  }
+
+  virtual void client_connected(unsigned int clid)    { ++num_connected; }
+  virtual void client_disconnected(unsigned int clid) { ++num_disconnected; }
+
+  FawkesNetworkHub          *hub;
+  std::atomic<unsigned int>  num_connected;
+  std::atomic<unsigned int>  num_disconnected;
+};
+
+
+static FawkesNetworkServerThread *
+start_server(QaEchoHandler &handler, size_t max_send_queue_bytes)
+{
+  FawkesNetworkServerThread *server =
+    new FawkesNetworkServerThread(true, false, "", "", QA_PORT, NULL,
+				  2, max_send_queue_bytes);
+  handler.hub = server;
+  server->add_handler(&handler);
+  server->start();
+  return server;
+}
+
+
+static void
+stop_server(FawkesNetworkServerThread *server, QaEchoHandler &handler)
+{
+  server->remove_handler(&handler);
+  server->cancel();
+  server->join();
+  delete server;
+}
+
+
+static StreamSocket *
+connect_client()
+{
+  StreamSocket *s = new StreamSocket(Socket::IPv4);
+  // acceptor thread may not be listening, yet
+  for (unsigned int i = 0; ; ++i) {
+    try {
+      s->connect("127.0.0.1", QA_PORT);
+      return s;
+    } catch (Exception &e) {
+      if (i == 50) {
+	delete s;
+	throw;
+      }
+      usleep(20000);
+    }
+  }
+}
+
+
+/* Write message in pieces of at most max_piece bytes. */
+static void
+write_message(Socket *s, unsigned short int msg_id, const void *payload,
+	      uint32_t payload_size, size_t max_piece)
+{
+  std::vector<char> buf(sizeof(fawkes_message_header_t) + payload_size);
+  fawkes_message_header_t header;
+  header.cid          = htons(QA_CID);
+  header.msg_id       = htons(msg_id);
+  header.payload_size = htonl(payload_size);
+  memcpy(&buf[0], &header, sizeof(header));
+  if (payload_size > 0)  memcpy(&buf[sizeof(header)], payload, payload_size);
+
+  for (size_t pos = 0; pos < buf.size(); pos += max_piece) {
+    s->write(&buf[pos], std::min(max_piece, buf.size() - pos));
+    if (max_piece < buf.size())  usleep(0);
+  }
+}
+
+
+static bool
+read_message(Socket *s, unsigned short int &msg_id, std::vector<char> &payload)
+{
+  fawkes_message_header_t header;
+  s->read(&header, sizeof(header));
+  if (ntohs(header.cid) != QA_CID) {
+    printf("Received message for component %u\n", ntohs(header.cid));
+    return false;
+  }
+  msg_id = ntohs(header.msg_id);
+  payload.resize(ntohl(header.payload_size));
+  if (! payload.empty())  s->read(&payload[0], payload.size());
+  return true;
+}
+
+
+static bool
+wait_disconnected(QaEchoHandler &handler)
+{
+  for (unsigned int i = 0; i < 250; ++i) {
+    if (handler.num_disconnected == handler.num_connected)  return true;
+    usleep(20000);
+  }
+  printf("%u clients connected, but only %u disconnects noticed\n",
+	 handler.num_connected.load(), handler.num_disconnected.load());
+  return false;
+}
+
+
+/* Many clients concurrently send messages in small pieces, each must
+ * receive exactly its own messages back, in order. */
+static bool
+test_many_clients()
+{
+  QaEchoHandler handler;
+  FawkesNetworkServerThread *server = start_server(handler, 16 * 1024 * 1024);
+
+  std::atomic<unsigned int> failures(0);
+  std::vector<std::thread> clients;
+  for (unsigned int c = 0; c < NUM_CLIENTS; ++c) {
+    clients.push_back(std::thread([c, &failures]() {
+      try {
+	StreamSocket *s = connect_client();
+	for (uint32_t i = 0; i < NUM_MESSAGES; ++i) {
+	  uint32_t payload[64];
+	  uint32_t len = 2 + (c + i) % 62;
+	  for (uint32_t j = 0; j < len; ++j)  payload[j] = htonl(c * 1000000 + i * 100 + j);
+	  // odd clients split messages into pieces of up to 5 bytes
+	  write_message(s, MSG_ECHO, payload, len * 4, (c % 2) ? 1 + i % 5 : 4096);
+	}
+	for (uint32_t i = 0; i < NUM_MESSAGES; ++i) {
+	  unsigned short int msg_id;
+	  std::vector<char> r;
+	  uint32_t len = 2 + (c + i) % 62;
+	  if (! read_message(s, msg_id, r) || (msg_id != MSG_ECHO) || (r.size() != len * 4)) {
+	    printf("Client %u: invalid reply %u\n", c, i);
+	    ++failures;
+	    break;
+	  }
+	  const uint32_t *p = (const uint32_t *)&r[0];
+	  for (uint32_t j = 0; j < len; ++j) {
+	    if (ntohl(p[j]) != c * 1000000 + i * 100 + j) {
+	      printf("Client %u: reply %u has wrong content\n", c, i);
+	      ++failures;
+	      break;
+	    }
+	  }
+	}
+	delete s;
+      } catch (Exception &e) {
+	printf("Client %u: %s\n", c, e.what_no_backtrace());
+	++failures;
+      }
+    }));
+  }
+  for (std::thread &t : clients)  t.join();
+
+  bool success = (failures == 0);
+  if (handler.num_connected != NUM_CLIENTS) {
+    printf("%u clients connected, expected %u\n",
+	   handler.num_connected.load(), NUM_CLIENTS);
+    success = false;
+  }
+  if (! wait_disconnected(handler))  success = false;
+
+  stop_server(server, handler);
+  return success;
+}
+
+
+/* A client requests far more data than fits into the socket buffers and
+ * reads it only later, the server must continue after partial writes
+ * without losing or reordering data. */
+static bool
+test_partial_writes()
+{
+  QaEchoHandler handler;
+  FawkesNetworkServerThread *server = start_server(handler, 64 * 1024 * 1024);
+
+  const uint32_t count = 2000, size = 16 * 1024 + 3;
+  bool success = true;
+  StreamSocket *s = connect_client();
+  uint32_t req[2] = { htonl(count), htonl(size) };
+  write_message(s, MSG_BULK, req, sizeof(req), 4096);
+  usleep(300000);
+
+  for (uint32_t i = 0; success && (i < count); ++i) {
+    unsigned short int msg_id;
+    std::vector<char> r;
+    if (! read_message(s, msg_id, r) || (msg_id != MSG_BULK) || (r.size() != size)) {
+      printf("Invalid bulk message %u\n", i);
+      success = false;
+      break;
+    }
+    uint32_t seq;
+    memcpy(&seq, &r[0], sizeof(seq));
+    if (ntohl(seq) != i) {
+      printf("Bulk message %u has sequence number %u\n", i, ntohl(seq));
+      success = false;
+      break;
+    }
+    for (uint32_t j = sizeof(seq); j < size; ++j) {
+      if ((unsigned char)r[j] != ((i + j) & 0xff)) {
+	printf("Bulk message %u corrupted at byte %u\n", i, j);
+	success = false;
+	break;
+      }
+    }
+  }
+
+  // the connection must still be usable
+  if (success) {
+    uint32_t payload = htonl(42);
+    write_message(s, MSG_ECHO, &payload, sizeof(payload), 4096);
+    unsigned short int msg_id;
+    std::vector<char> r;
+    if (! read_message(s, msg_id, r) || (msg_id != MSG_ECHO) || (r.size() != 4)) {
+      printf("No echo after bulk transfer\n");
+      success = false;
+    }
+  }
+  delete s;
+
+  if (! wait_disconnected(handler))  success = false;
+  stop_server(server, handler);
+  return success;
+}
+
+
+/* Clients disconnect at any time: right away, within a message, and while
+ * the server has data pending for them, or because they exceed the send
+ * queue limit. All of them must be noticed, other clients are served. */
+static bool
+test_disconnects()
+{
+  QaEchoHandler handler;
+  FawkesNetworkServerThread *server = start_server(handler, 256 * 1024);
+
+  bool success = true;
+  StreamSocket *good = connect_client();
+
+  for (unsigned int i = 0; i < 10; ++i) {
+    // connect and close right away
+    delete connect_client();
+
+    // close in the middle of a message
+    StreamSocket *s = connect_client();
+    fawkes_message_header_t header;
+    header.cid          = htons(QA_CID);
+    header.msg_id       = htons(MSG_ECHO);
+    header.payload_size = htonl(100);
+    s->write(&header, sizeof(header));
+    s->write("abc", 3);
+    delete s;
+
+    // close while the server sends data
+    s = connect_client();
+    uint32_t req[2] = { htonl(10), htonl(10000) };
+    write_message(s, MSG_BULK, req, sizeof(req), 4096);
+    delete s;
+  }
+
+  // never read, exceed the send queue limit
+  StreamSocket *stalled = connect_client();
+  uint32_t req[2] = { htonl(4000), htonl(10000) };
+  write_message(stalled, MSG_BULK, req, sizeof(req), 4096);
+
+  for (unsigned int i = 0; i < 250 && (handler.num_disconnected < 31); ++i) {
+    usleep(20000);
+  }
+  if (handler.num_disconnected != 31) {
+    printf("%u disconnects noticed, expected 31\n", handler.num_disconnected.load());
+    success = false;
+  }
+
+  uint32_t payload = htonl(23);
+  write_message(good, MSG_ECHO, &payload, sizeof(payload), 1);
+  unsigned short int msg_id;
+  std::vector<char> r;
+  if (! read_message(good, msg_id, r) || (msg_id != MSG_ECHO) || (r.size() != 4)) {
+    printf("Remaining client not served\n");
+    success = false;
+  }
+
+  delete stalled;
+  delete good;
+  if (! wait_disconnected(handler))  success = false;
+  stop_server(server, handler);
+  return success;
+}
+
+
+int
+main(int argc, char **argv)
+{
+  bool success = true;
+  try {
+    if (! test_many_clients()) {
+      printf("FAILED many clients\n");
+      success = false;
+    }
+    if (! test_partial_writes()) {
+      printf("FAILED partial writes\n");
+      success = false;
+    }
+    if (! test_disconnects()) {
+      printf("FAILED disconnects\n");
+      success = false;
+    }
+  } catch (Exception &e) {
+    printf("FAILED, exception:\n");
+    e.print_trace();
+    success = false;
+  }
+
+  if (success)  printf("PASSED\n");
+  return success ? 0 : 1;
+}
+
+/// @endcond
@@ -38,6 +38,7 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <string>
+#include <vector>
 #include <cstring>
 #include <cstdlib>
 // include <linux/in.h>
@@ -620,10 +621,13 @@ Socket::accept()
   //s->timeout = timeout;
 
   Socket *s = clone();
+  // clone() duplicated the listening socket, do not leak it
+  if ( s->sock_fd != -1 )  ::close(s->sock_fd);
   s->sock_fd = a_sock_fd;
 
   if ( s->client_addr != NULL ) {
     free(s->client_addr);
+    s->client_addr = NULL;
   }
   /*
   struct ::sockaddr_in  *tmp_client_addr_alloc = (struct ::sockaddr_in *)malloc(sizeof(struct ::sockaddr_in));
@@ -747,6 +751,58 @@ Socket::write(const void *buf, size_t count)
 }
 
 
+/** Write multiple buffers to the socket.
+ * Writes the buffers in the given order with as few system calls as
+ * possible. This method can only be used on streams.
+ * @param iov buffers to write
+ * @param iovcnt number of elements in iov
+ * @exception SocketException if the data could not be written or if a timeout occured.
+ */
+void
+Socket::writev(const struct iovec *iov, int iovcnt)
+{
+  if (sock_fd == -1) {
+    throw SocketException("Socket not initialized, call bind() or connect()");
+  }
+
+  // private copy, entries are adjusted on partial writes
+  std::vector<struct iovec> vec(iov, iov + iovcnt);
+  int first = 0;
+  struct timeval start, now;
+
+  gettimeofday(&start, NULL);
+
+  while ((first < iovcnt) && (vec[first].iov_len == 0))  ++first;
+  while (first < iovcnt) {
+    ssize_t retval = ::writev(sock_fd, &vec[first], iovcnt - first);
+    if (retval == -1) {
+      if (errno != EAGAIN) {
+        throw SocketException(errno, "Could not write data");
+      }
+    } else {
+      // skip completely written buffers and adjust the partially written one
+      size_t written = retval;
+      while ((first < iovcnt) && (written >= vec[first].iov_len)) {
+        written -= vec[first++].iov_len;
+      }
+      if (first < iovcnt) {
+        vec[first].iov_base = (char *)vec[first].iov_base + written;
+        vec[first].iov_len -= written;
+      }
+      // reset timeout
+      gettimeofday(&start, NULL);
+    }
+    if (first < iovcnt) {
+      gettimeofday(&now, NULL);
+      if (time_diff_sec(now, start) >= timeout) {
+        throw SocketException("Write timeout");
+      }
+      usleep(0);
+    }
+  }
+}
+
+
 /** Read from socket.
  * Read from the socket. This method can only be used on streams.
  * @param buf buffer to write from
@@ -975,6 +1031,19 @@ Socket::listening()
 }
 
 
+/** Get file descriptor.
+ * This is meant to integrate the socket with an event loop, e.g. epoll.
+ * Reading or writing the descriptor directly bypasses the timeout handling
+ * of this class.
+ * @return file descriptor of the socket, -1 if not initialized
+ */
+int
+Socket::fd() const
+{
+  return sock_fd;
+}
+
+
 /** Maximum Transfer Unit (MTU) of socket.
  * Note that this can only be retrieved of connected sockets!
  * @return MTU in bytes
@@ -30,6 +30,7 @@
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <netinet/in.h>
+#include <sys/uio.h>
 // just to be safe nobody else can do it
 #include <sys/signal.h>
 
@@ -107,6 +108,7 @@ class Socket
 
   virtual size_t       read(void *buf, size_t count, bool read_all = true);
   virtual void         write(const void *buf, size_t count);
+  virtual void         writev(const struct iovec *iov, int iovcnt);
   virtual void         send(void *buf, size_t buf_len);
   virtual void         send(void *buf, size_t buf_len,
 			    const struct sockaddr *to_addr, socklen_t addr_len);
@@ -126,6 +128,8 @@ class Socket
 
   virtual unsigned int mtu();
 
+  int                  fd() const;
+
   /** Accept connection.
    * This method works like accept() but it ensures that the returned socket is of
    * the given type.
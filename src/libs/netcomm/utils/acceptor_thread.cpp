@@ -25,12 +25,16 @@
 #include <netcomm/utils/incoming_connection_handler.h>
 #include <netcomm/socket/stream.h>
 
+#include <sys/socket.h>
+
 namespace fawkes {
 
 /** @class NetworkAcceptorThread <netcomm/utils/acceptor_thread.h>
  * Network Acceptor Thread.
  * Opens and maintains a server socket and waits for incoming connections. If
  * that happens NetworkConnectionHandler::add_connection() is called.
+ * The socket listens with the maximum backlog, connections of many clients
+ * connecting at once are queued rather than dropped by the kernel.
  *
  * @ingroup NetComm
  * @author Tim Niemueller
@@ -55,7 +59,7 @@ NetworkAcceptorThread::NetworkAcceptorThread(NetworkIncomingConnectionHandler *h
   try {
     socket_ = new StreamSocket();
     socket_->bind(port_);
-    socket_->listen();
+    socket_->listen(SOMAXCONN);
   } catch (SocketException &e) {
     throw;
   }
@@ -89,7 +93,7 @@ NetworkAcceptorThread::NetworkAcceptorThread(NetworkIncomingConnectionHandler *h
     } else {
 	    socket_->bind(port_, listen_addr.c_str());
     }
-    socket_->listen();
+    socket_->listen(SOMAXCONN);
   } catch (SocketException &e) {
     throw;
   }
@@ -115,7 +119,7 @@ NetworkAcceptorThread::NetworkAcceptorThread(NetworkIncomingConnectionHandler *h
   set_prepfin_conc_loop(true);
 
   try {
-    socket_->listen();
+    socket_->listen(SOMAXCONN);
   } catch (SocketException &e) {
     throw;
   }
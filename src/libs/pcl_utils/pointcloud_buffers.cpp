@@ -0,0 +1,138 @@
+
+/***************************************************************************
+ *  pointcloud_buffers.cpp - Versioned multi-buffer point cloud publication
+ *
+ *  Created: Sun Oct 18 14:02:11 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#include <pcl_utils/pointcloud_buffers.h>
+
+#include <ctime>
+
+namespace fawkes {
+  namespace pcl_utils {
+
+/** @class PointCloudBuffersBase <pcl_utils/pointcloud_buffers.h>
+ * Type-independent part of versioned point cloud buffers.
+ * Provides the sequence number and the means for consumers to wait for
+ * the publication of a new cloud.
+ * @author agent
+ */
+
+/** @class PointCloudBuffers <pcl_utils/pointcloud_buffers.h>
+ * Versioned multi-buffer point cloud.
+ * A producer requests a buffer with writable(), fills it, and makes it
+ * the current cloud with publish(). Consumers acquire() the current cloud
+ * and keep a consistent snapshot for as long as they hold the reference,
+ * the producer never writes to a buffer referenced by a consumer. No
+ * point data is copied for either side.
+ * @author agent
+ */
+
+/** Constructor. */
+PointCloudBuffersBase::PointCloudBuffersBase()
+  : seq_(0), closed_(false)
+{
+  mutex_    = new Mutex();
+  waitcond_ = new WaitCondition(mutex_);
+}
+
+
+/** Destructor. */
+PointCloudBuffersBase::~PointCloudBuffersBase()
+{
+  delete waitcond_;
+  delete mutex_;
+}
+
+
+/** Get sequence number of the current cloud.
+ * The sequence number is zero until the first cloud is published and
+ * incremented on each publication.
+ * @return sequence number
+ */
+unsigned long
+PointCloudBuffersBase::sequence() const
+{
+  return seq_.load(std::memory_order_acquire);
+}
+
+
+/** Wait for a cloud newer than the given sequence number.
+ * @param last_seq sequence number of the last cloud processed
+ * @param timeout_ms maximum time to wait in milliseconds, zero to wait
+ * indefinitely
+ * @return true if a newer cloud is available, false on timeout or if
+ * the buffers have been closed
+ */
+bool
+PointCloudBuffersBase::wait_for_sequence(unsigned long last_seq, unsigned int timeout_ms)
+{
+  MutexLocker lock(mutex_);
+  if (timeout_ms == 0) {
+    while (! closed_ && sequence() <= last_seq) {
+      waitcond_->wait();
+    }
+    return (sequence() > last_seq);
+  }
+
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  ts.tv_sec  += timeout_ms / 1000;
+  ts.tv_nsec += (timeout_ms % 1000) * 1000000;
+  if (ts.tv_nsec >= 1000000000) {
+    ts.tv_sec  += 1;
+    ts.tv_nsec -= 1000000000;
+  }
+
+  while (! closed_ && sequence() <= last_seq) {
+    if (! waitcond_->abstimed_wait(ts.tv_sec, ts.tv_nsec)) {
+      break;
+    }
+  }
+  return (sequence() > last_seq);
+}
+
+
+/** Close buffers.
+ * Called when the point cloud is removed. Wakes up all consumers blocked
+ * in wait_for_sequence(), no further cloud will be published.
+ */
+void
+PointCloudBuffersBase::close()
+{
+  MutexLocker lock(mutex_);
+  closed_ = true;
+  waitcond_->wake_all();
+}
+
+
+/** Increment sequence number and wake up waiting consumers.
+ * Must be called with the mutex locked.
+ * @return new sequence number
+ */
+unsigned long
+PointCloudBuffersBase::notify_published()
+{
+  unsigned long seq = seq_.fetch_add(1, std::memory_order_acq_rel) + 1;
+  waitcond_->wake_all();
+  return seq;
+}
+
+  } // end namespace pcl_utils
+} // end namespace fawkes
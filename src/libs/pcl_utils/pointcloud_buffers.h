@@ -0,0 +1,225 @@
+
+/***************************************************************************
+ *  pointcloud_buffers.h - Versioned multi-buffer point cloud publication
+ *
+ *  Created: Sun Oct 18 14:02:11 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#ifndef _LIBS_PCL_UTILS_POINTCLOUD_BUFFERS_H_
+#define _LIBS_PCL_UTILS_POINTCLOUD_BUFFERS_H_
+
+#include <core/exception.h>
+#include <core/utils/refptr.h>
+#include <core/threading/mutex.h>
+#include <core/threading/mutex_locker.h>
+#include <core/threading/wait_condition.h>
+
+#include <pcl/point_cloud.h>
+
+#include <vector>
+#include <atomic>
+
+namespace fawkes {
+  namespace pcl_utils {
+
+class PointCloudBuffersBase
+{
+ public:
+  PointCloudBuffersBase();
+  virtual ~PointCloudBuffersBase();
+
+  unsigned long  sequence() const;
+  bool wait_for_sequence(unsigned long last_seq, unsigned int timeout_ms = 0);
+  void close();
+
+  /** Publish the buffer last returned for writing.
+   * @return sequence number of the published cloud */
+  virtual unsigned long  publish() = 0;
+
+  /** Keep the cloud of the classic API up to date.
+   * Called when a consumer gets hold of the cloud through the classic
+   * (in-place updated) API. From then on each publication also copies
+   * the new cloud to it. */
+  virtual void  attach_legacy_consumer() = 0;
+
+ protected:
+  unsigned long notify_published();
+
+ protected:
+  /** Mutex protecting buffer slots and front index. */
+  Mutex                       *mutex_;
+  /** Wait condition signalled on each publication. */
+  WaitCondition               *waitcond_;
+
+ private:
+  std::atomic<unsigned long>   seq_;
+  bool                         closed_;
+};
+
+
+template <typename PointT>
+class PointCloudBuffers : public PointCloudBuffersBase
+{
+ public:
+  /** Shortcut for cloud type. */
+  typedef pcl::PointCloud<PointT> Cloud;
+
+  PointCloudBuffers(RefPtr<Cloud> compat, unsigned int num_buffers);
+  virtual ~PointCloudBuffers();
+
+  RefPtr<Cloud>  writable();
+  virtual unsigned long  publish();
+  virtual void  attach_legacy_consumer();
+  RefPtr<const Cloud>  acquire(unsigned long *seq = NULL) const;
+
+ private:
+  std::vector<RefPtr<Cloud> >  buffers_;
+  unsigned int                 front_;
+  int                          back_;
+  RefPtr<Cloud>                compat_;
+  bool                         legacy_consumer_;
+};
+
+
+/** Constructor.
+ * @param compat cloud registered with the storage adapter for consumers
+ * which use the classic PointCloudManager::get_pointcloud() API. It is
+ * only kept up to date once attach_legacy_consumer() has been called.
+ * @param num_buffers number of buffers to allocate initially, at least two
+ */
+template <typename PointT>
+PointCloudBuffers<PointT>::PointCloudBuffers(RefPtr<Cloud> compat, unsigned int num_buffers)
+  : front_(0), back_(-1), compat_(compat), legacy_consumer_(false)
+{
+  if (num_buffers < 2)  num_buffers = 2;
+  buffers_.resize(num_buffers);
+  for (unsigned int i = 0; i < num_buffers; ++i) {
+    buffers_[i] = RefPtr<Cloud>(new Cloud(**compat_));
+  }
+}
+
+
+/** Destructor. */
+template <typename PointT>
+PointCloudBuffers<PointT>::~PointCloudBuffers()
+{
+  buffers_.clear();
+}
+
+
+/** Get a buffer to write the next cloud to.
+ * The returned buffer is neither the currently published one nor held by
+ * any consumer, hence it can be overwritten without affecting readers. If
+ * all buffers are in use a new one is allocated in place of the oldest
+ * slot, the consumers keep their snapshot alive through their reference.
+ * Newly allocated buffers are initialized as a copy of the current front
+ * so that producers updating points in place keep working. Drop the
+ * reference once publish() has been called, otherwise the slot cannot be
+ * recycled.
+ * @return buffer to fill with the next cloud
+ */
+template <typename PointT>
+RefPtr<pcl::PointCloud<PointT> >
+PointCloudBuffers<PointT>::writable()
+{
+  MutexLocker lock(mutex_);
+  if (back_ >= 0) {
+    // handed out before but not yet published, hand out again
+    return buffers_[back_];
+  }
+
+  const unsigned int num_buffers = buffers_.size();
+  for (unsigned int i = 1; i < num_buffers; ++i) {
+    unsigned int b = (front_ + i) % num_buffers;
+    if (buffers_[b].use_count() == 1) {
+      back_ = b;
+      return buffers_[b];
+    }
+  }
+
+  // all buffers are held by consumers, replace the oldest one
+  back_ = (front_ + 1) % num_buffers;
+  buffers_[back_] = RefPtr<Cloud>(new Cloud(**buffers_[front_]));
+  return buffers_[back_];
+}
+
+
+/** Publish the buffer last returned by writable().
+ * This atomically makes the written buffer the current one, increments
+ * the sequence number and wakes up all consumers waiting for new data.
+ * @return sequence number of the published cloud
+ * @exception Exception thrown if writable() has not been called before
+ */
+template <typename PointT>
+unsigned long
+PointCloudBuffers<PointT>::publish()
+{
+  MutexLocker lock(mutex_);
+  if (back_ < 0) {
+    throw Exception("No point cloud buffer acquired for writing");
+  }
+  front_ = back_;
+  back_  = -1;
+
+  // consumers of the classic API expect updates in place
+  if (legacy_consumer_) {
+    **compat_ = **buffers_[front_];
+  }
+
+  return notify_published();
+}
+
+
+/** Keep the cloud of the classic API up to date.
+ * The cloud is updated right away and on every following publication.
+ * This cannot be undone, there is no way to tell when a consumer of the
+ * classic API has released the cloud.
+ */
+template <typename PointT>
+void
+PointCloudBuffers<PointT>::attach_legacy_consumer()
+{
+  MutexLocker lock(mutex_);
+  if (! legacy_consumer_) {
+    legacy_consumer_ = true;
+    if (sequence() > 0)  **compat_ = **buffers_[front_];
+  }
+}
+
+
+/** Acquire the current cloud.
+ * The returned cloud is guaranteed not to be modified by the producer for
+ * as long as the reference is held. No data is copied.
+ * @param seq if not NULL, upon return contains the sequence number of
+ * the returned cloud
+ * @return current cloud
+ */
+template <typename PointT>
+RefPtr<const pcl::PointCloud<PointT> >
+PointCloudBuffers<PointT>::acquire(unsigned long *seq) const
+{
+  MutexLocker lock(mutex_);
+  if (seq)  *seq = sequence();
+  return buffers_[front_];
+}
+
+
+  } // end namespace pcl_utils
+} // end namespace fawkes
+
+#endif
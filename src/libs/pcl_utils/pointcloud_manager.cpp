@@ -36,12 +36,45 @@ namespace fawkes {
  * @param id ID of point cloud to add, must be unique
  * @param cloud refptr to point cloud
  *
+ * @fn void PointCloudManager::add_pointcloud(const char *id, RefPtr<pcl::PointCloud<PointT> > cloud, unsigned int num_buffers)
+ * Add versioned point cloud.
+ * The point cloud is published with multiple buffers. The producer fills
+ * the buffer returned by writable_pointcloud() and calls
+ * publish_pointcloud() when done. Consumers use acquire_pointcloud() to
+ * get a consistent snapshot and wait_pointcloud() to be notified of new
+ * data. The passed cloud serves as template for the buffers and is still
+ * returned by get_pointcloud(). Once it has been retrieved that way, it
+ * is updated by copying on each publication.
+ * @param id ID of point cloud to add, must be unique
+ * @param cloud refptr to template point cloud
+ * @param num_buffers number of buffers to allocate initially
+ *
  * @fn const RefPtr<const pcl::PointCloud<PointT> > PointCloudManager::get_pointcloud(const char *id)
  * Get point cloud.
  * @param id ID of point cloud to retrieve
  * @return point cloud
  * @exception Exception thrown if point cloud for given ID does not exist
  *
+ * @fn RefPtr<pcl::PointCloud<PointT> > PointCloudManager::writable_pointcloud(const char *id)
+ * Get buffer to write next point cloud to.
+ * The buffer is not read by any consumer. Release the reference after
+ * calling publish_pointcloud() so that the buffer can be recycled.
+ * @param id ID of versioned point cloud
+ * @return buffer to fill
+ * @exception Exception thrown if no versioned point cloud for given ID
+ * exists or if it is of a different type
+ *
+ * @fn const RefPtr<const pcl::PointCloud<PointT> > PointCloudManager::acquire_pointcloud(const char *id, unsigned long *seq)
+ * Acquire current point cloud.
+ * For versioned point clouds the returned cloud is not modified for as
+ * long as the reference is held. For clouds added without buffers this
+ * is the same as get_pointcloud() and the sequence number is zero.
+ * @param id ID of point cloud to retrieve
+ * @param seq if not NULL, upon return contains the sequence number of the
+ * returned cloud
+ * @return point cloud
+ * @exception Exception thrown if point cloud for given ID does not exist
+ * or if it is of a different type
  */
 
 /** Constructor. */
@@ -73,6 +106,13 @@ PointCloudManager::remove_pointcloud(const char *id)
     delete clouds_[id];
     clouds_.erase(id);
   }
+
+  // waiting consumers still hold a reference
+  MutexLocker lock_buffers(buffers_.mutex());
+  if (buffers_.find(id) != buffers_.end()) {
+    buffers_[id]->close();
+    buffers_.erase(id);
+  }
 }
 
 /** Check if point cloud exists
@@ -115,6 +155,12 @@ PointCloudManager::get_pointcloud_list() const
 const fawkes::LockMap<std::string, pcl_utils::StorageAdapter *> &
 PointCloudManager::get_pointclouds() const
 {
+  // the storage adapters give access to the classic clouds
+  MutexLocker lock(buffers_.mutex());
+  LockMap<std::string, RefPtr<pcl_utils::PointCloudBuffersBase> >::const_iterator b;
+  for (b = buffers_.begin(); b != buffers_.end(); ++b) {
+    b->second->attach_legacy_consumer();
+  }
   return clouds_;
 }
 
@@ -135,9 +181,85 @@ PointCloudManager::get_storage_adapter(const char *id)
   if (clouds_.find(id) == clouds_.end()) {
     throw Exception("PointCloud '%s' unknown", id);
   }
+  attach_legacy_consumer(id);
   return clouds_[id];
 }
 
 
+/** Publish versioned point cloud.
+ * Makes the buffer last returned by writable_pointcloud() the current
+ * cloud and wakes up consumers waiting in wait_pointcloud().
+ * @param id ID of versioned point cloud
+ * @return sequence number of the published point cloud
+ * @exception Exception thrown if no versioned point cloud for given ID exists
+ */
+unsigned long
+PointCloudManager::publish_pointcloud(const char *id)
+{
+  return get_buffers(id)->publish();
+}
+
+
+/** Get sequence number of versioned point cloud.
+ * @param id ID of versioned point cloud
+ * @return sequence number of the current cloud, zero if none has been
+ * published, yet
+ * @exception Exception thrown if no versioned point cloud for given ID exists
+ */
+unsigned long
+PointCloudManager::pointcloud_sequence(const char *id)
+{
+  return get_buffers(id)->sequence();
+}
+
+
+/** Wait for next point cloud.
+ * Blocks until a point cloud with a sequence number larger than the given
+ * one has been published. Pass the sequence number retrieved with
+ * acquire_pointcloud() to wait for the successor of that cloud.
+ * @param id ID of versioned point cloud
+ * @param last_seq sequence number of last processed cloud
+ * @param timeout_ms maximum time to wait in milliseconds, zero to wait
+ * indefinitely
+ * @return true if a new point cloud is available, false on timeout
+ * @exception Exception thrown if no versioned point cloud for given ID exists
+ */
+bool
+PointCloudManager::wait_pointcloud(const char *id, unsigned long last_seq,
+                                   unsigned int timeout_ms)
+{
+  return get_buffers(id)->wait_for_sequence(last_seq, timeout_ms);
+}
+
+
+RefPtr<pcl_utils::PointCloudBuffersBase>
+PointCloudManager::get_buffers(const char *id)
+{
+  MutexLocker lock(buffers_.mutex());
+
+  if (buffers_.find(id) == buffers_.end()) {
+    throw Exception("No versioned point cloud with ID '%s' registered", id);
+  }
+  return buffers_[id];
+}
+
+
+/** Keep classic cloud of versioned point cloud up to date.
+ * Does nothing for clouds added without buffers.
+ * @param id ID of point cloud
+ */
+void
+PointCloudManager::attach_legacy_consumer(const char *id) const
+{
+  MutexLocker lock(buffers_.mutex());
+
+  LockMap<std::string, RefPtr<pcl_utils::PointCloudBuffersBase> >::const_iterator b =
+    buffers_.find(id);
+  if (b != buffers_.end()) {
+    b->second->attach_legacy_consumer();
+  }
+}
+
+
 
 } // end namespace fawkes
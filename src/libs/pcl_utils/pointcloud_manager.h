@@ -30,6 +30,7 @@
 #include <utils/time/time.h>
 
 #include <pcl_utils/storage_adapter.h>
+#include <pcl_utils/pointcloud_buffers.h>
 
 #include <vector>
 #include <string>
@@ -52,6 +53,9 @@ class PointCloudManager
 
   template <typename PointT>
     void add_pointcloud(const char *id, RefPtr<pcl::PointCloud<PointT> > cloud);
+  template <typename PointT>
+    void add_pointcloud(const char *id, RefPtr<pcl::PointCloud<PointT> > cloud,
+                        unsigned int num_buffers);
 
   void remove_pointcloud(const char *id);
 
@@ -59,6 +63,16 @@ class PointCloudManager
     const RefPtr<const pcl::PointCloud<PointT> > get_pointcloud(const char *id);
   bool exists_pointcloud(const char *id);
 
+  template <typename PointT>
+    RefPtr<pcl::PointCloud<PointT> > writable_pointcloud(const char *id);
+  unsigned long publish_pointcloud(const char *id);
+
+  template <typename PointT>
+    const RefPtr<const pcl::PointCloud<PointT> >
+    acquire_pointcloud(const char *id, unsigned long *seq = NULL);
+  unsigned long pointcloud_sequence(const char *id);
+  bool wait_pointcloud(const char *id, unsigned long last_seq, unsigned int timeout_ms = 0);
+
   /**  Check if point cloud of specified type exists.
    * @param id ID of point cloud to check
    * @return true if the point cloud exists, false otherwise
@@ -71,8 +85,15 @@ class PointCloudManager
   const fawkes::LockMap<std::string, pcl_utils::StorageAdapter *> &  get_pointclouds() const;
   const pcl_utils::StorageAdapter *  get_storage_adapter(const char *id);
 
+ private:
+  RefPtr<pcl_utils::PointCloudBuffersBase> get_buffers(const char *id);
+  void attach_legacy_consumer(const char *id) const;
+  template <typename PointT>
+    const RefPtr<const pcl::PointCloud<PointT> > find_pointcloud(const char *id);
+
  private:
   fawkes::LockMap<std::string, pcl_utils::StorageAdapter *>  clouds_;
+  fawkes::LockMap<std::string, RefPtr<pcl_utils::PointCloudBuffersBase> >  buffers_;
 };
 
 
@@ -90,9 +111,70 @@ PointCloudManager::add_pointcloud(const char *id,
   }
 }
 
+template <typename PointT>
+void
+PointCloudManager::add_pointcloud(const char *id,
+                                  RefPtr<pcl::PointCloud<PointT> > cloud,
+                                  unsigned int num_buffers)
+{
+  fawkes::MutexLocker lock(clouds_.mutex());
+  fawkes::MutexLocker lock_buffers(buffers_.mutex());
+
+  if (clouds_.find(id) == clouds_.end()) {
+    clouds_[id] = new pcl_utils::PointCloudStorageAdapter<PointT>(cloud);
+    buffers_[id] =
+      RefPtr<pcl_utils::PointCloudBuffersBase>(new pcl_utils::PointCloudBuffers<PointT>(cloud, num_buffers));
+  } else {
+    throw Exception("Cloud %s already registered", id);
+  }
+}
+
+template <typename PointT>
+RefPtr<pcl::PointCloud<PointT> >
+PointCloudManager::writable_pointcloud(const char *id)
+{
+  RefPtr<pcl_utils::PointCloudBuffers<PointT> > b =
+    RefPtr<pcl_utils::PointCloudBuffers<PointT> >::cast_dynamic(get_buffers(id));
+  if (! b) {
+    throw Exception("The buffered point cloud '%s' is of a different type", id);
+  }
+  return b->writable();
+}
+
+template <typename PointT>
+const RefPtr<const pcl::PointCloud<PointT> >
+PointCloudManager::acquire_pointcloud(const char *id, unsigned long *seq)
+{
+  buffers_.lock();
+  if (buffers_.find(id) == buffers_.end()) {
+    buffers_.unlock();
+    // not buffered, classic in-place updated cloud
+    if (seq)  *seq = 0;
+    return get_pointcloud<PointT>(id);
+  }
+  RefPtr<pcl_utils::PointCloudBuffersBase> bb = buffers_[id];
+  buffers_.unlock();
+
+  RefPtr<pcl_utils::PointCloudBuffers<PointT> > b =
+    RefPtr<pcl_utils::PointCloudBuffers<PointT> >::cast_dynamic(bb);
+  if (! b) {
+    throw Exception("The buffered point cloud '%s' is of a different type", id);
+  }
+  return b->acquire(seq);
+}
+
 template <typename PointT>
 const RefPtr<const pcl::PointCloud<PointT> >
 PointCloudManager::get_pointcloud(const char *id)
+{
+  const RefPtr<const pcl::PointCloud<PointT> > cloud = find_pointcloud<PointT>(id);
+  attach_legacy_consumer(id);
+  return cloud;
+}
+
+template <typename PointT>
+const RefPtr<const pcl::PointCloud<PointT> >
+PointCloudManager::find_pointcloud(const char *id)
 {
   fawkes::MutexLocker lock(clouds_.mutex());
 
@@ -121,7 +203,7 @@ bool
 PointCloudManager::exists_pointcloud(const char *id)
 {
   try {
-    const RefPtr<const pcl::PointCloud<PointT> > p = get_pointcloud<PointT>(id);
+    const RefPtr<const pcl::PointCloud<PointT> > p = find_pointcloud<PointT>(id);
     return true;
   } catch (Exception &e) {
     return false;
@@ -0,0 +1,249 @@
+/***************************************************************************
+ *  qa_pointcloud_buffers.cpp - QA for versioned point cloud buffers
+ *
+ *  Created: Sun Oct 18 23:12:40 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+/// @cond QA
+
+// Checks the front/back buffer swap, that acquired clouds stay untouched
+// while held, the classic API cloud update and wait_for_sequence() with
+// timeouts and after closing.
+
+#include <pcl_utils/pointcloud_buffers.h>
+#include <core/exception.h>
+
+#include <pcl/point_types.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <unistd.h>
+
+using namespace fawkes;
+using namespace fawkes::pcl_utils;
+
+typedef pcl::PointCloud<pcl::PointXYZ> Cloud;
+
+static void
+fill(RefPtr<Cloud> cloud, float marker)
+{
+  cloud->points.resize(1);
+  cloud->points[0].x = marker;
+}
+
+static float
+marker(RefPtr<const Cloud> cloud)
+{
+  return cloud->points.empty() ? -1.f : cloud->points[0].x;
+}
+
+static bool
+test_swap()
+{
+  RefPtr<Cloud> compat(new Cloud());
+  PointCloudBuffers<pcl::PointXYZ> b(compat, 2);
+  if (b.sequence() != 0) {
+    printf("Initial sequence is %lu, expected 0\n", b.sequence());
+    return false;
+  }
+
+  RefPtr<Cloud> w = b.writable();
+  if (*w == *b.acquire()) {
+    printf("Writable buffer is the published one\n");
+    return false;
+  }
+  if (*w != *b.writable()) {
+    printf("Writable buffer changed before publishing\n");
+    return false;
+  }
+  fill(w, 1.f);
+  w.clear();
+  if (b.publish() != 1) {
+    printf("First publication did not get sequence 1\n");
+    return false;
+  }
+
+  unsigned long seq = 0;
+  RefPtr<const Cloud> front = b.acquire(&seq);
+  if (seq != 1 || marker(front) != 1.f) {
+    printf("Acquired sequence %lu with marker %f, expected 1\n", seq, marker(front));
+    return false;
+  }
+
+  // the back buffer must never be the published front
+  w = b.writable();
+  if (*w == *front) {
+    printf("Writable buffer is the published one after swap\n");
+    return false;
+  }
+  fill(w, 2.f);
+  w.clear();
+  if (b.publish() != 2 || marker(b.acquire()) != 2.f) {
+    printf("Second publication not visible\n");
+    return false;
+  }
+
+  try {
+    b.publish();
+    printf("Publishing without writable() did not throw\n");
+    return false;
+  } catch (Exception &e) {} // expected
+
+  return true;
+}
+
+static bool
+test_snapshot()
+{
+  RefPtr<Cloud> compat(new Cloud());
+  PointCloudBuffers<pcl::PointXYZ> b(compat, 2);
+
+  RefPtr<Cloud> w = b.writable();
+  fill(w, 1.f);
+  w.clear();
+  b.publish();
+
+  // consumer holds snapshot while the producer keeps publishing, the
+  // held buffer must be replaced instead of overwritten
+  RefPtr<const Cloud> held = b.acquire();
+  for (unsigned int i = 2; i < 10; ++i) {
+    w = b.writable();
+    if (*w == *held) {
+      printf("Held snapshot handed out for writing\n");
+      return false;
+    }
+    fill(w, (float)i);
+    w.clear();
+    b.publish();
+    if (marker(held) != 1.f) {
+      printf("Held snapshot modified in round %u\n", i);
+      return false;
+    }
+    if (marker(b.acquire()) != (float)i) {
+      printf("Publication %u not visible\n", i);
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool
+test_legacy_consumer()
+{
+  RefPtr<Cloud> compat(new Cloud());
+  PointCloudBuffers<pcl::PointXYZ> b(compat, 2);
+
+  RefPtr<Cloud> w = b.writable();
+  fill(w, 1.f);
+  w.clear();
+  b.publish();
+
+  if (marker(compat) != -1.f) {
+    printf("Classic cloud updated without attached consumer\n");
+    return false;
+  }
+
+  b.attach_legacy_consumer();
+  if (marker(compat) != 1.f) {
+    printf("Classic cloud not updated on attach\n");
+    return false;
+  }
+
+  w = b.writable();
+  fill(w, 2.f);
+  w.clear();
+  b.publish();
+  if (marker(compat) != 2.f) {
+    printf("Classic cloud not updated on publication\n");
+    return false;
+  }
+  return true;
+}
+
+static bool
+test_wait()
+{
+  RefPtr<Cloud> compat(new Cloud());
+  PointCloudBuffers<pcl::PointXYZ> b(compat, 2);
+
+  if (b.wait_for_sequence(0, 20)) {
+    printf("Waiting succeeded without publication\n");
+    return false;
+  }
+
+  std::thread producer([&b]() {
+      usleep(20000);
+      RefPtr<Cloud> w = b.writable();
+      fill(w, 1.f);
+      w.clear();
+      b.publish();
+    });
+  bool published = b.wait_for_sequence(0, 5000);
+  producer.join();
+  if (! published || b.sequence() != 1) {
+    printf("Waiting for publication failed\n");
+    return false;
+  }
+
+  if (! b.wait_for_sequence(0, 0)) {
+    printf("Waiting for older sequence failed\n");
+    return false;
+  }
+
+  // closing wakes up consumers waiting without timeout
+  std::thread closer([&b]() {
+      usleep(20000);
+      b.close();
+    });
+  bool woken = ! b.wait_for_sequence(1, 0);
+  closer.join();
+  if (! woken || b.wait_for_sequence(1, 0)) {
+    printf("Closing did not end waiting\n");
+    return false;
+  }
+  return true;
+}
+
+int
+main(int argc, char **argv)
+{
+  bool success = true;
+  if (! test_swap()) {
+    printf("FAILED buffer swap\n");
+    success = false;
+  }
+  if (! test_snapshot()) {
+    printf("FAILED held snapshots\n");
+    success = false;
+  }
+  if (! test_legacy_consumer()) {
+    printf("FAILED classic API consumer\n");
+    success = false;
+  }
+  if (! test_wait()) {
+    printf("FAILED waiting for publications\n");
+    success = false;
+  }
+
+  if (success)  printf("PASSED\n");
+  return success ? 0 : 1;
+}
+
+/// @endcond
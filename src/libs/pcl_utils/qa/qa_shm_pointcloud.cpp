@@ -0,0 +1,224 @@
+/***************************************************************************
+ *  qa_shm_pointcloud.cpp - QA for shared memory point clouds
+ *
+ *  Created: Mon Oct 19 10:14:03 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+/// @cond QA
+
+// Publishes clouds through a shared memory segment and reads them back
+// through a second, read-only instance, once from raw points and once
+// from a cloud registered with the point cloud manager.
+
+#include <pcl_utils/shm_pointcloud.h>
+#include <pcl_utils/pcl_adapter.h>
+#include <pcl_utils/pointcloud_manager.h>
+#include <core/exception.h>
+
+#include <pcl/point_types.h>
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace fawkes;
+
+#define SHM_ID "qa-shm-pointcloud"
+
+typedef pcl::PointCloud<pcl::PointXYZ> Cloud;
+
+static PointCloudAdapter::V_PointFieldInfo
+xyz_fields()
+{
+  PointCloudAdapter::V_PointFieldInfo fields;
+  // datatype 7 is FLOAT32 in sensor_msgs::PointField
+  fields.push_back(PointCloudAdapter::PointFieldInfo("x", 0, 7, 1));
+  fields.push_back(PointCloudAdapter::PointFieldInfo("y", 4, 7, 1));
+  fields.push_back(PointCloudAdapter::PointFieldInfo("z", 8, 7, 1));
+  return fields;
+}
+
+static bool
+check_snapshot(const SharedMemoryPointCloud &reader, const std::vector<pcl::PointXYZ> &points,
+               unsigned int width, unsigned int height, bool is_dense, const Time &time)
+{
+  SharedMemoryPointCloud::Snapshot snap;
+  if (! reader.acquire(snap)) {
+    printf("No cloud available to reader\n");
+    return false;
+  }
+  if (snap.width != width || snap.height != height || snap.num_points != points.size()) {
+    printf("Read %ux%u cloud with %zu points, expected %ux%u with %zu\n",
+           snap.width, snap.height, snap.num_points, width, height, points.size());
+    return false;
+  }
+  if (snap.is_dense != is_dense) {
+    printf("Read is_dense %i, expected %i\n", snap.is_dense, is_dense);
+    return false;
+  }
+  if (snap.time != time) {
+    printf("Read capture time %s, expected %s\n", snap.time.str(), time.str());
+    return false;
+  }
+  const pcl::PointXYZ *p = (const pcl::PointXYZ *)snap.data;
+  for (size_t i = 0; i < points.size(); ++i) {
+    if (p[i].x != points[i].x || p[i].y != points[i].y || p[i].z != points[i].z) {
+      printf("Point %zu differs\n", i);
+      return false;
+    }
+  }
+  if (! reader.is_valid(snap)) {
+    printf("Snapshot invalid without further publication\n");
+    return false;
+  }
+  return true;
+}
+
+static bool
+test_raw()
+{
+  SharedMemoryPointCloud writer(SHM_ID, xyz_fields(), sizeof(pcl::PointXYZ), 100, 3);
+  writer.set_frame_id("/base_link");
+  SharedMemoryPointCloud reader(SHM_ID);
+
+  PointCloudAdapter::V_PointFieldInfo fields = reader.fields();
+  if (fields.size() != 3 || fields[2].name != "z" || fields[2].offset != 8) {
+    printf("Field descriptions not read back\n");
+    return false;
+  }
+  if (reader.frame_id() != "/base_link") {
+    printf("Read frame %s, expected /base_link\n", reader.frame_id().c_str());
+    return false;
+  }
+
+  SharedMemoryPointCloud::Snapshot snap;
+  if (reader.acquire(snap)) {
+    printf("Cloud available before first publication\n");
+    return false;
+  }
+
+  std::vector<pcl::PointXYZ> points(20);
+  for (unsigned int i = 0; i < points.size(); ++i) {
+    points[i].x = i;
+    points[i].y = -(float)i;
+    points[i].z = i * 0.5;
+  }
+
+  Time t1(1000, 1);
+  writer.publish(&points[0], 10, 2, /* is_dense */ true, t1);
+  if (! check_snapshot(reader, points, 10, 2, true, t1))  return false;
+
+  points.resize(5);
+  points[4].x = 42.;
+  Time t2(1000, 2);
+  writer.publish(&points[0], 5, 1, /* is_dense */ false, t2);
+  if (! check_snapshot(reader, points, 5, 1, false, t2))  return false;
+
+  // the slot of a snapshot is reused once num_slots - 1 further clouds
+  // have been published and the writer starts on the next one
+  reader.acquire(snap);
+  for (unsigned int i = 1; i < writer.num_slots(); ++i) {
+    writer.publish(&points[0], 5, 1, false, t2);
+  }
+  if (! reader.is_valid(snap)) {
+    printf("Snapshot invalid before its slot was reused\n");
+    return false;
+  }
+  writer.write_buffer();
+  if (reader.is_valid(snap)) {
+    printf("Snapshot still valid while its slot is written\n");
+    return false;
+  }
+  writer.publish(5, 1, false, t2);
+  return true;
+}
+
+static bool
+test_adapter()
+{
+  PointCloudManager manager;
+  PointCloudAdapter adapter(&manager, NULL);
+
+  RefPtr<Cloud> cloud(new Cloud());
+  cloud->header.frame_id = "/cam";
+  for (unsigned int i = 0; i < 6; ++i) {
+    pcl::PointXYZ p;
+    p.x = i;  p.y = i * 2;  p.z = i * 3;
+    cloud->points.push_back(p);
+  }
+  cloud->width    = 3;
+  cloud->height   = 2;
+  manager.add_pointcloud<pcl::PointXYZ>("adapter-cloud", cloud);
+
+  SharedMemoryPointCloud writer(SHM_ID, xyz_fields(), sizeof(pcl::PointXYZ), 100, 3);
+  SharedMemoryPointCloud reader(SHM_ID);
+
+  Time time;
+  for (unsigned int i = 0; i < 2; ++i) {
+    bool is_dense = (i == 0);
+    cloud->is_dense = is_dense;
+    writer.publish(&adapter, "adapter-cloud");
+
+    SharedMemoryPointCloud::Snapshot snap;
+    if (! reader.acquire(snap) || snap.num_points != 6 ||
+        snap.width != 3 || snap.height != 2)
+    {
+      printf("Cloud published through adapter not read back\n");
+      return false;
+    }
+    if (snap.is_dense != is_dense) {
+      printf("Read is_dense %i, expected %i from source cloud\n", snap.is_dense, is_dense);
+      return false;
+    }
+    if (reader.frame_id() != "/cam") {
+      printf("Read frame %s, expected /cam\n", reader.frame_id().c_str());
+      return false;
+    }
+    if (memcmp(snap.data, &cloud->points[0], 6 * sizeof(pcl::PointXYZ)) != 0) {
+      printf("Points published through adapter differ\n");
+      return false;
+    }
+  }
+  return true;
+}
+
+int
+main(int argc, char **argv)
+{
+  bool success = true;
+  try {
+    if (! test_raw()) {
+      printf("FAILED raw point round trip\n");
+      success = false;
+    }
+    if (! test_adapter()) {
+      printf("FAILED point cloud manager round trip\n");
+      success = false;
+    }
+  } catch (Exception &e) {
+    printf("FAILED, exception:\n");
+    e.print_trace();
+    success = false;
+  }
+
+  if (success)  printf("PASSED\n");
+  return success ? 0 : 1;
+}
+
+/// @endcond
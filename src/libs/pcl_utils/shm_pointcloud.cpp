@@ -0,0 +1,733 @@
+
+/***************************************************************************
+ *  shm_pointcloud.cpp - shared memory point cloud transport
+ *
+ *  Created: Sun Oct 18 16:21:47 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#include <pcl_utils/shm_pointcloud.h>
+#include <core/exception.h>
+#include <utils/system/console_colors.h>
+
+#include <iostream>
+#include <memory>
+#include <cstring>
+#include <cstdio>
+
+using namespace std;
+
+namespace fawkes {
+
+/** @class SharedMemoryPointCloud <pcl_utils/shm_pointcloud.h>
+ * Shared memory point cloud.
+ * Makes point clouds available to other processes without serialization.
+ * The segment holds a number of publication slots. A single writer fills
+ * the slot following the latest publication, either directly through
+ * write_buffer() or by copying an existing cloud, and then publishes it.
+ * Readers acquire() the latest slot and access the points in place. No
+ * locks are involved, each slot carries a sequence counter which is odd
+ * while the slot is written. Readers check with is_valid() after
+ * processing whether the writer has reused the slot in the meantime,
+ * which happens once it published num_slots - 1 further clouds and
+ * starts writing the next one.
+ *
+ * The field descriptions of the points are stored in the segment using
+ * the information provided by PointCloudAdapter::get_info().
+ * @author agent
+ */
+
+/** Write Constructor.
+ * Create a new shared memory segment for the given point cloud ID. Use
+ * this constructor to publish point clouds.
+ * @param pointcloud_id point cloud ID
+ * @param fields field descriptions, e.g. from PointCloudAdapter::get_info()
+ * @param point_size size in bytes of a single point
+ * @param max_points maximum number of points of a cloud
+ * @param num_slots number of publication slots
+ */
+SharedMemoryPointCloud::SharedMemoryPointCloud(const char *pointcloud_id,
+                                               const PointCloudAdapter::V_PointFieldInfo &fields,
+                                               unsigned int point_size,
+                                               unsigned int max_points,
+                                               unsigned int num_slots)
+  : SharedMemory(FAWKES_SHM_POINTCLOUD_MAGIC_TOKEN,
+                 /* read-only */ false,
+                 /* create */ true,
+                 /* destroy on delete */ true)
+{
+  if (num_slots < 2 || num_slots > POINTCLOUD_MAX_SLOTS) {
+    throw Exception("Number of slots must be in [2,%u]", POINTCLOUD_MAX_SLOTS);
+  }
+  if (fields.size() > POINTCLOUD_MAX_FIELDS) {
+    throw Exception("Point type has too many fields (%zu > %u)",
+                    fields.size(), POINTCLOUD_MAX_FIELDS);
+  }
+  constructor(new SharedMemoryPointCloudHeader(pointcloud_id, fields, point_size,
+                                               max_points, num_slots));
+}
+
+
+/** Read Constructor.
+ * Open an existing shared memory point cloud read-only.
+ * @param pointcloud_id ID of point cloud to open
+ */
+SharedMemoryPointCloud::SharedMemoryPointCloud(const char *pointcloud_id)
+  : SharedMemory(FAWKES_SHM_POINTCLOUD_MAGIC_TOKEN,
+                 /* read-only */ true,
+                 /* create */ false,
+                 /* destroy on delete */ false)
+{
+  PointCloudAdapter::V_PointFieldInfo no_fields;
+  constructor(new SharedMemoryPointCloudHeader(pointcloud_id, no_fields, 0, 0, 0));
+}
+
+
+void
+SharedMemoryPointCloud::constructor(SharedMemoryPointCloudHeader *header)
+{
+  pointcloud_id_ = header->pointcloud_id();
+  write_slot_    = -1;
+  priv_header_   = header;
+  _header        = priv_header_;
+  try {
+    attach();
+    raw_header_ = priv_header_->raw_header();
+  } catch (Exception &e) {
+    e.append("SharedMemoryPointCloud: could not attach to '%s'", pointcloud_id_.c_str());
+    delete priv_header_;
+    throw;
+  }
+  if (! raw_header_) {
+    delete priv_header_;
+    throw Exception("SharedMemoryPointCloud: no segment for '%s'", pointcloud_id_.c_str());
+  }
+}
+
+
+/** Destructor. */
+SharedMemoryPointCloud::~SharedMemoryPointCloud()
+{
+  delete priv_header_;
+}
+
+
+char *
+SharedMemoryPointCloud::slot_data(unsigned int slot) const
+{
+  return (char *)_memptr + (size_t)slot * raw_header_->max_points * raw_header_->point_size;
+}
+
+
+/** Get point cloud ID.
+ * @return point cloud ID
+ */
+const char *
+SharedMemoryPointCloud::pointcloud_id() const
+{
+  return pointcloud_id_.c_str();
+}
+
+
+/** Get coordinate frame ID.
+ * @return frame ID
+ */
+std::string
+SharedMemoryPointCloud::frame_id() const
+{
+  return std::string(raw_header_->frame_id,
+                     strnlen(raw_header_->frame_id, POINTCLOUD_FRAME_ID_MAX_LENGTH));
+}
+
+
+/** Get size of a single point.
+ * @return point size in bytes
+ */
+unsigned int
+SharedMemoryPointCloud::point_size() const
+{
+  return raw_header_->point_size;
+}
+
+
+/** Get maximum number of points per cloud.
+ * @return maximum number of points
+ */
+unsigned int
+SharedMemoryPointCloud::max_points() const
+{
+  return raw_header_->max_points;
+}
+
+
+/** Get number of publication slots.
+ * @return number of slots
+ */
+unsigned int
+SharedMemoryPointCloud::num_slots() const
+{
+  return raw_header_->num_slots;
+}
+
+
+/** Get field descriptions.
+ * @return field descriptions of a point
+ */
+PointCloudAdapter::V_PointFieldInfo
+SharedMemoryPointCloud::fields() const
+{
+  PointCloudAdapter::V_PointFieldInfo rv;
+  for (unsigned int i = 0; i < raw_header_->num_fields; ++i) {
+    const SharedMemoryPointCloud_field_t &f = raw_header_->fields[i];
+    rv.push_back(PointCloudAdapter::PointFieldInfo(
+                   std::string(f.name, strnlen(f.name, POINTCLOUD_FIELD_NAME_MAX_LENGTH)),
+                   f.offset, f.datatype, f.count));
+  }
+  return rv;
+}
+
+
+/** Set coordinate frame ID.
+ * @param frame_id new frame ID
+ */
+void
+SharedMemoryPointCloud::set_frame_id(const char *frame_id)
+{
+  if (_is_read_only) {
+    throw Exception("Point cloud is read-only. Not setting frame ID.");
+  }
+  strncpy(raw_header_->frame_id, frame_id, POINTCLOUD_FRAME_ID_MAX_LENGTH - 1);
+}
+
+
+/** Get buffer to write next cloud to.
+ * The buffer can hold max_points() points and is not visible to
+ * readers until publish() is called. Repeated calls before publishing
+ * return the same buffer.
+ * @return pointer to point data of next slot
+ */
+void *
+SharedMemoryPointCloud::write_buffer()
+{
+  if (_is_read_only) {
+    throw Exception("Point cloud is read-only. Cannot write.");
+  }
+
+  if (write_slot_ < 0) {
+    write_slot_ = (raw_header_->latest_slot + 1) % raw_header_->num_slots;
+    SharedMemoryPointCloud_slot_t &s = raw_header_->slots[write_slot_];
+    // mark as being written before touching the data
+    __atomic_store_n(&s.seq, s.seq | 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+  }
+  return slot_data(write_slot_);
+}
+
+
+/** Publish the cloud written to write_buffer().
+ * @param width width of cloud
+ * @param height height of cloud
+ * @param is_dense true if the cloud is dense
+ * @param time capture time of cloud
+ * @return sequence number of the published cloud
+ */
+uint64_t
+SharedMemoryPointCloud::publish(unsigned int width, unsigned int height, bool is_dense,
+                                const fawkes::Time &time)
+{
+  if (_is_read_only) {
+    throw Exception("Point cloud is read-only. Cannot publish.");
+  }
+  if ((size_t)width * height > raw_header_->max_points) {
+    throw Exception("Point cloud of %ux%u exceeds %u points", width, height,
+                    raw_header_->max_points);
+  }
+
+  write_buffer();
+
+  SharedMemoryPointCloud_slot_t &s = raw_header_->slots[write_slot_];
+  s.width             = width;
+  s.height            = height;
+  s.num_points        = width * height;
+  s.is_dense          = is_dense ? 1 : 0;
+  s.capture_time_sec  = time.get_sec();
+  s.capture_time_usec = time.get_usec();
+
+  uint64_t seq = raw_header_->seq + 1;
+  __atomic_store_n(&s.seq, seq * 2, __ATOMIC_RELEASE);
+  __atomic_store_n(&raw_header_->latest_slot, (uint32_t)write_slot_, __ATOMIC_RELEASE);
+  __atomic_store_n(&raw_header_->seq, seq, __ATOMIC_RELEASE);
+  write_slot_ = -1;
+
+  return seq;
+}
+
+
+/** Copy and publish a cloud.
+ * @param points pointer to width * height points of point_size() bytes
+ * @param width width of cloud
+ * @param height height of cloud
+ * @param is_dense true if the cloud is dense
+ * @param time capture time of cloud
+ * @return sequence number of the published cloud
+ */
+uint64_t
+SharedMemoryPointCloud::publish(const void *points, unsigned int width, unsigned int height,
+                                bool is_dense, const fawkes::Time &time)
+{
+  if ((size_t)width * height > raw_header_->max_points) {
+    throw Exception("Point cloud of %ux%u exceeds %u points", width, height,
+                    raw_header_->max_points);
+  }
+  memcpy(write_buffer(), points, (size_t)width * height * raw_header_->point_size);
+  return publish(width, height, is_dense, time);
+}
+
+
+/** Publish a cloud registered with the point cloud manager.
+ * Frame ID, capture time and whether the cloud is dense are taken from
+ * the registered cloud.
+ * @param adapter adapter to retrieve cloud data from
+ * @param id ID of point cloud in the point cloud manager
+ * @return sequence number of the published cloud
+ */
+uint64_t
+SharedMemoryPointCloud::publish(PointCloudAdapter *adapter, const std::string &id)
+{
+  std::string frame_id;
+  bool is_dense;
+  unsigned int width, height;
+  fawkes::Time time;
+  PointCloudAdapter::V_PointFieldInfo pfi;
+  void *data;
+  size_t point_size, num_points;
+  adapter->get_data_and_info(id, frame_id, is_dense, width, height, time, pfi,
+                             &data, point_size, num_points);
+
+  if (point_size != raw_header_->point_size) {
+    throw Exception("Point size mismatch for '%s' (%zu vs. %u)", id.c_str(),
+                    point_size, raw_header_->point_size);
+  }
+  if (strncmp(raw_header_->frame_id, frame_id.c_str(), POINTCLOUD_FRAME_ID_MAX_LENGTH) != 0) {
+    set_frame_id(frame_id.c_str());
+  }
+  return publish(data, width, height, is_dense, time);
+}
+
+
+/** Get sequence number of the latest publication.
+ * @return sequence number, zero if no cloud has been published
+ */
+uint64_t
+SharedMemoryPointCloud::sequence() const
+{
+  return __atomic_load_n(&raw_header_->seq, __ATOMIC_ACQUIRE);
+}
+
+
+/** Acquire latest cloud.
+ * The point data is not copied, the snapshot refers to the publication
+ * slot in shared memory. Call is_valid() after processing to check that
+ * the data has not been overwritten meanwhile.
+ * @param snapshot upon return contains information about the latest cloud
+ * @return true if a cloud is available, false if none has been published
+ */
+bool
+SharedMemoryPointCloud::acquire(Snapshot &snapshot) const
+{
+  while (true) {
+    uint64_t seq = __atomic_load_n(&raw_header_->seq, __ATOMIC_ACQUIRE);
+    if (seq == 0)  return false;
+
+    uint32_t slot = __atomic_load_n(&raw_header_->latest_slot, __ATOMIC_ACQUIRE);
+    const SharedMemoryPointCloud_slot_t &s = raw_header_->slots[slot];
+
+    uint64_t s1 = __atomic_load_n(&s.seq, __ATOMIC_ACQUIRE);
+    if (s1 & 1)  continue;
+
+    snapshot.slot       = slot;
+    snapshot.seq        = s1 / 2;
+    snapshot.width      = s.width;
+    snapshot.height     = s.height;
+    snapshot.num_points = s.num_points;
+    snapshot.is_dense   = (s.is_dense == 1);
+    snapshot.time.set_time(s.capture_time_sec, s.capture_time_usec);
+    snapshot.data       = slot_data(slot);
+
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&s.seq, __ATOMIC_RELAXED) == s1)  return true;
+  }
+}
+
+
+/** Check if snapshot is still valid.
+ * @param snapshot snapshot retrieved with acquire()
+ * @return true if the slot still holds the cloud of the snapshot, false if
+ * the writer has started to overwrite it
+ */
+bool
+SharedMemoryPointCloud::is_valid(const Snapshot &snapshot) const
+{
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  return (__atomic_load_n(&raw_header_->slots[snapshot.slot].seq, __ATOMIC_RELAXED)
+          == snapshot.seq * 2);
+}
+
+
+/** List all shared memory segments that contain a point cloud. */
+void
+SharedMemoryPointCloud::list()
+{
+  SharedMemoryPointCloudLister lister;
+  SharedMemoryPointCloudHeader h;
+
+  SharedMemory::list(FAWKES_SHM_POINTCLOUD_MAGIC_TOKEN, &h, &lister);
+}
+
+
+/** Erase orphaned shared memory segments that contain point clouds.
+ * @param use_lister if true a lister is used to print the shared memory segments
+ * to stdout while cleaning up.
+ */
+void
+SharedMemoryPointCloud::cleanup(bool use_lister)
+{
+  SharedMemoryPointCloudHeader h;
+  std::unique_ptr<SharedMemoryPointCloudLister> lister;
+  if (use_lister)  lister.reset(new SharedMemoryPointCloudLister());
+
+  SharedMemory::erase_orphaned(FAWKES_SHM_POINTCLOUD_MAGIC_TOKEN, &h, lister.get());
+}
+
+
+/** Check point cloud availability.
+ * @param pointcloud_id point cloud ID to check
+ * @return true if shared memory segment with requested point cloud exists
+ */
+bool
+SharedMemoryPointCloud::exists(const char *pointcloud_id)
+{
+  PointCloudAdapter::V_PointFieldInfo no_fields;
+  SharedMemoryPointCloudHeader h(pointcloud_id, no_fields, 0, 0, 0);
+  return SharedMemory::exists(FAWKES_SHM_POINTCLOUD_MAGIC_TOKEN, &h);
+}
+
+
+/** Erase a specific shared memory segment that contains a point cloud.
+ * @param pointcloud_id ID of point cloud to wipe
+ */
+void
+SharedMemoryPointCloud::wipe(const char *pointcloud_id)
+{
+  PointCloudAdapter::V_PointFieldInfo no_fields;
+  SharedMemoryPointCloudHeader h(pointcloud_id, no_fields, 0, 0, 0);
+  SharedMemory::erase(FAWKES_SHM_POINTCLOUD_MAGIC_TOKEN, &h, NULL);
+}
+
+
+/** @class SharedMemoryPointCloud::Snapshot <pcl_utils/shm_pointcloud.h>
+ * Reader view of a published point cloud.
+ */
+
+/** Constructor. */
+SharedMemoryPointCloud::Snapshot::Snapshot()
+  : slot(0), seq(0), width(0), height(0), num_points(0), is_dense(false), data(NULL)
+{
+}
+
+
+/** @class SharedMemoryPointCloudHeader <pcl_utils/shm_pointcloud.h>
+ * Shared memory point cloud header.
+ */
+
+/** Constructor. */
+SharedMemoryPointCloudHeader::SharedMemoryPointCloudHeader()
+  : point_size_(0), max_points_(0), num_slots_(0), header_(NULL)
+{
+}
+
+
+/** Constructor.
+ * @param pointcloud_id point cloud ID
+ * @param fields field descriptions
+ * @param point_size size of a point in bytes
+ * @param max_points maximum number of points per slot
+ * @param num_slots number of publication slots
+ */
+SharedMemoryPointCloudHeader::SharedMemoryPointCloudHeader(const char *pointcloud_id,
+                                                           const PointCloudAdapter::V_PointFieldInfo &fields,
+                                                           unsigned int point_size,
+                                                           unsigned int max_points,
+                                                           unsigned int num_slots)
+  : pointcloud_id_(pointcloud_id), fields_(fields),
+    point_size_(point_size), max_points_(max_points), num_slots_(num_slots),
+    header_(NULL)
+{
+}
+
+
+/** Copy constructor.
+ * @param h header to copy
+ */
+SharedMemoryPointCloudHeader::SharedMemoryPointCloudHeader(const SharedMemoryPointCloudHeader *h)
+  : pointcloud_id_(h->pointcloud_id_), fields_(h->fields_),
+    point_size_(h->point_size_), max_points_(h->max_points_), num_slots_(h->num_slots_),
+    header_(h->header_)
+{
+}
+
+
+/** Destructor. */
+SharedMemoryPointCloudHeader::~SharedMemoryPointCloudHeader()
+{
+}
+
+
+SharedMemoryHeader *
+SharedMemoryPointCloudHeader::clone() const
+{
+  return new SharedMemoryPointCloudHeader(this);
+}
+
+
+size_t
+SharedMemoryPointCloudHeader::size()
+{
+  return sizeof(SharedMemoryPointCloud_header_t);
+}
+
+
+size_t
+SharedMemoryPointCloudHeader::data_size()
+{
+  if (header_ == NULL) {
+    return (size_t)num_slots_ * max_points_ * point_size_;
+  } else {
+    return (size_t)header_->num_slots * header_->max_points * header_->point_size;
+  }
+}
+
+
+bool
+SharedMemoryPointCloudHeader::matches(void *memptr)
+{
+  SharedMemoryPointCloud_header_t *h = (SharedMemoryPointCloud_header_t *)memptr;
+
+  if (pointcloud_id_.empty()) {
+    return true;
+  } else if (strncmp(h->pointcloud_id, pointcloud_id_.c_str(), POINTCLOUD_ID_MAX_LENGTH) == 0) {
+    if ( (point_size_ == 0) ||
+         ((h->point_size == point_size_) && (h->max_points == max_points_) &&
+          (h->num_slots == num_slots_)) )
+    {
+      return true;
+    } else {
+      throw Exception("Inconsistent point cloud '%s' found in memory",
+                      pointcloud_id_.c_str());
+    }
+  } else {
+    return false;
+  }
+}
+
+
+bool
+SharedMemoryPointCloudHeader::operator==(const SharedMemoryHeader &s) const
+{
+  const SharedMemoryPointCloudHeader *h = dynamic_cast<const SharedMemoryPointCloudHeader *>(&s);
+  if ( ! h ) {
+    return false;
+  } else {
+    return ( (pointcloud_id_ == h->pointcloud_id_) &&
+             (point_size_ == h->point_size_) &&
+             (max_points_ == h->max_points_) &&
+             (num_slots_ == h->num_slots_) );
+  }
+}
+
+
+/** Create if dimensions have been supplied.
+ * @return true if point size, number of points and slots are non-zero
+ */
+bool
+SharedMemoryPointCloudHeader::create()
+{
+  return ((point_size_ > 0) && (max_points_ > 0) && (num_slots_ > 0));
+}
+
+
+void
+SharedMemoryPointCloudHeader::initialize(void *memptr)
+{
+  SharedMemoryPointCloud_header_t *header = (SharedMemoryPointCloud_header_t *)memptr;
+  memset(memptr, 0, sizeof(SharedMemoryPointCloud_header_t));
+
+  strncpy(header->pointcloud_id, pointcloud_id_.c_str(), POINTCLOUD_ID_MAX_LENGTH - 1);
+  header->point_size  = point_size_;
+  header->max_points  = max_points_;
+  header->num_slots   = num_slots_;
+  header->num_fields  = fields_.size();
+  for (unsigned int i = 0; i < fields_.size() && i < POINTCLOUD_MAX_FIELDS; ++i) {
+    strncpy(header->fields[i].name, fields_[i].name.c_str(),
+            POINTCLOUD_FIELD_NAME_MAX_LENGTH - 1);
+    header->fields[i].offset   = fields_[i].offset;
+    header->fields[i].datatype = fields_[i].datatype;
+    header->fields[i].count    = fields_[i].count;
+  }
+  // start such that the first publication goes to slot 0
+  header->latest_slot = num_slots_ - 1;
+
+  header_ = header;
+}
+
+
+void
+SharedMemoryPointCloudHeader::set(void *memptr)
+{
+  header_ = (SharedMemoryPointCloud_header_t *)memptr;
+}
+
+
+void
+SharedMemoryPointCloudHeader::reset()
+{
+  header_ = NULL;
+}
+
+
+/** Get point cloud ID.
+ * @return point cloud ID
+ */
+const char *
+SharedMemoryPointCloudHeader::pointcloud_id() const
+{
+  if (header_)  return header_->pointcloud_id;
+  else          return pointcloud_id_.c_str();
+}
+
+
+/** Get point size.
+ * @return size of a single point in bytes
+ */
+unsigned int
+SharedMemoryPointCloudHeader::point_size() const
+{
+  if (header_)  return header_->point_size;
+  else          return point_size_;
+}
+
+
+/** Get maximum number of points.
+ * @return maximum number of points per slot
+ */
+unsigned int
+SharedMemoryPointCloudHeader::max_points() const
+{
+  if (header_)  return header_->max_points;
+  else          return max_points_;
+}
+
+
+/** Get number of slots.
+ * @return number of publication slots
+ */
+unsigned int
+SharedMemoryPointCloudHeader::num_slots() const
+{
+  if (header_)  return header_->num_slots;
+  else          return num_slots_;
+}
+
+
+/** Get raw header.
+ * @return raw header
+ */
+SharedMemoryPointCloud_header_t *
+SharedMemoryPointCloudHeader::raw_header()
+{
+  return header_;
+}
+
+
+/** @class SharedMemoryPointCloudLister <pcl_utils/shm_pointcloud.h>
+ * Shared memory point cloud lister.
+ */
+
+/** Constructor. */
+SharedMemoryPointCloudLister::SharedMemoryPointCloudLister()
+{
+}
+
+
+/** Destructor. */
+SharedMemoryPointCloudLister::~SharedMemoryPointCloudLister()
+{
+}
+
+
+void
+SharedMemoryPointCloudLister::print_header()
+{
+  cout << endl << cgreen << "Fawkes Shared Memory Segments - Point Clouds" << cnormal << endl
+       << "========================================================================================" << endl
+       << cdarkgray;
+  printf ("%-24s %-10s %-10s %-10s %-6s %-8s %-5s %-10s %s\n",
+          "PointCloud ID", "ShmID", "Semaphore", "Bytes", "PSize", "Points", "Slots",
+          "Sequence", "State");
+  cout << cnormal
+       << "----------------------------------------------------------------------------------------" << endl;
+}
+
+
+void
+SharedMemoryPointCloudLister::print_footer()
+{
+}
+
+
+void
+SharedMemoryPointCloudLister::print_no_segments()
+{
+  cout << "No point cloud shared memory segments found" << endl;
+}
+
+
+void
+SharedMemoryPointCloudLister::print_no_orphaned_segments()
+{
+  cout << "No orphaned point cloud shared memory segments found" << endl;
+}
+
+
+void
+SharedMemoryPointCloudLister::print_info(const SharedMemoryHeader *header,
+                                         int shm_id, int semaphore,
+                                         unsigned int mem_size,
+                                         const void *memptr)
+{
+  SharedMemoryPointCloudHeader *h = (SharedMemoryPointCloudHeader *)header;
+  SharedMemoryPointCloud_header_t *rh = h->raw_header();
+
+  printf("%-24s %-10d %-10d %-10u %-6u %-8u %-5u %-10llu %s%s\n",
+         h->pointcloud_id(), shm_id, semaphore, mem_size, h->point_size(),
+         h->max_points(), h->num_slots(),
+         rh ? (unsigned long long)rh->seq : 0ULL,
+         (SharedMemory::is_swapable(shm_id) ? "S" : ""),
+         (SharedMemory::is_destroyed(shm_id) ? "D" : ""));
+}
+
+} // end namespace fawkes
@@ -0,0 +1,208 @@
+
+/***************************************************************************
+ *  shm_pointcloud.h - shared memory point cloud transport
+ *
+ *  Created: Sun Oct 18 16:21:47 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#ifndef _LIBS_PCL_UTILS_SHM_POINTCLOUD_H_
+#define _LIBS_PCL_UTILS_SHM_POINTCLOUD_H_
+
+#include <pcl_utils/pcl_adapter.h>
+#include <utils/ipc/shm.h>
+#include <utils/ipc/shm_lister.h>
+#include <utils/time/time.h>
+
+#include <string>
+#include <stdint.h>
+
+// Magic token to identify Fawkes shared memory point clouds
+#define FAWKES_SHM_POINTCLOUD_MAGIC_TOKEN "Fawkes PointCloud"
+
+/** Maximum length of point cloud ID (not including null-termination) */
+#define POINTCLOUD_ID_MAX_LENGTH 64
+/** Maximum length of coordinate frame ID (not including null-termination) */
+#define POINTCLOUD_FRAME_ID_MAX_LENGTH 64
+/** Maximum length of a point field name (not including null-termination) */
+#define POINTCLOUD_FIELD_NAME_MAX_LENGTH 16
+/** Maximum number of fields per point */
+#define POINTCLOUD_MAX_FIELDS 16
+/** Maximum number of publication slots per segment */
+#define POINTCLOUD_MAX_SLOTS 8
+
+namespace fawkes {
+
+/** Shared memory description of a point field. */
+typedef struct {
+  char      name[POINTCLOUD_FIELD_NAME_MAX_LENGTH]; /**< field name */
+  uint32_t  offset;    /**< offset from start of point struct */
+  uint32_t  datatype;  /**< data type, see sensor_msgs::PointField */
+  uint32_t  count;     /**< number of elements in field */
+} SharedMemoryPointCloud_field_t;
+
+/** Shared memory meta data of a single publication slot. */
+typedef struct {
+  uint64_t  seq;               /**< twice the sequence number of the cloud stored in
+                                * the slot, odd while the slot is being written */
+  uint32_t  width;             /**< width of cloud */
+  uint32_t  height;            /**< height of cloud */
+  uint32_t  num_points;        /**< number of valid points */
+  uint32_t  is_dense;          /**< 1 if cloud is dense, 0 otherwise */
+  int64_t   capture_time_sec;  /**< capture time, seconds since the epoch */
+  int64_t   capture_time_usec; /**< capture time, microseconds part */
+} SharedMemoryPointCloud_slot_t;
+
+/** Shared memory header struct for point clouds. */
+typedef struct {
+  char          pointcloud_id[POINTCLOUD_ID_MAX_LENGTH];  /**< point cloud ID */
+  char          frame_id[POINTCLOUD_FRAME_ID_MAX_LENGTH]; /**< coordinate frame ID */
+  uint32_t      point_size;  /**< size of a single point in bytes */
+  uint32_t      max_points;  /**< maximum number of points per slot */
+  uint32_t      num_slots;   /**< number of publication slots */
+  uint32_t      num_fields;  /**< number of valid field descriptions */
+  SharedMemoryPointCloud_field_t fields[POINTCLOUD_MAX_FIELDS]; /**< field descriptions */
+  uint64_t      seq;         /**< sequence number of latest publication */
+  uint32_t      latest_slot; /**< slot of latest publication */
+  uint32_t      reserved;    /**< reserved for future use */
+  SharedMemoryPointCloud_slot_t slots[POINTCLOUD_MAX_SLOTS]; /**< slot meta data */
+} SharedMemoryPointCloud_header_t;
+
+
+class SharedMemoryPointCloudHeader
+: public SharedMemoryHeader
+{
+ public:
+  SharedMemoryPointCloudHeader();
+  SharedMemoryPointCloudHeader(const char *pointcloud_id,
+                               const PointCloudAdapter::V_PointFieldInfo &fields,
+                               unsigned int point_size, unsigned int max_points,
+                               unsigned int num_slots);
+  SharedMemoryPointCloudHeader(const SharedMemoryPointCloudHeader *h);
+  virtual ~SharedMemoryPointCloudHeader();
+
+  virtual SharedMemoryHeader *  clone() const;
+  virtual bool         matches(void *memptr);
+  virtual size_t       size();
+  virtual bool         create();
+  virtual void         initialize(void *memptr);
+  virtual void         set(void *memptr);
+  virtual void         reset();
+  virtual size_t       data_size();
+  virtual bool         operator==(const SharedMemoryHeader &s) const;
+
+  const char *         pointcloud_id() const;
+  unsigned int         point_size() const;
+  unsigned int         max_points() const;
+  unsigned int         num_slots() const;
+
+  SharedMemoryPointCloud_header_t * raw_header();
+
+ private:
+  std::string                          pointcloud_id_;
+  PointCloudAdapter::V_PointFieldInfo  fields_;
+  unsigned int                         point_size_;
+  unsigned int                         max_points_;
+  unsigned int                         num_slots_;
+
+  SharedMemoryPointCloud_header_t     *header_;
+};
+
+
+class SharedMemoryPointCloudLister
+: public SharedMemoryLister
+{
+ public:
+  SharedMemoryPointCloudLister();
+  virtual ~SharedMemoryPointCloudLister();
+
+  virtual void print_header();
+  virtual void print_footer();
+  virtual void print_no_segments();
+  virtual void print_no_orphaned_segments();
+  virtual void print_info(const SharedMemoryHeader *header,
+                          int shm_id, int semaphore,
+                          unsigned int mem_size,
+                          const void *memptr);
+};
+
+
+class SharedMemoryPointCloud : public SharedMemory
+{
+ public:
+  /** Point cloud in a publication slot as seen by a reader. */
+  class Snapshot {
+   public:
+    Snapshot();
+
+    unsigned int  slot;        ///< slot the cloud is stored in
+    uint64_t      seq;         ///< sequence number of the cloud
+    unsigned int  width;       ///< width of cloud
+    unsigned int  height;      ///< height of cloud
+    size_t        num_points;  ///< number of valid points
+    bool          is_dense;    ///< true if cloud is dense
+    fawkes::Time  time;        ///< capture time
+    const void   *data;        ///< pointer to point data in shared memory
+  };
+
+  SharedMemoryPointCloud(const char *pointcloud_id,
+                         const PointCloudAdapter::V_PointFieldInfo &fields,
+                         unsigned int point_size, unsigned int max_points,
+                         unsigned int num_slots = 3);
+  SharedMemoryPointCloud(const char *pointcloud_id);
+  virtual ~SharedMemoryPointCloud();
+
+  const char *   pointcloud_id() const;
+  std::string    frame_id() const;
+  unsigned int   point_size() const;
+  unsigned int   max_points() const;
+  unsigned int   num_slots() const;
+  PointCloudAdapter::V_PointFieldInfo fields() const;
+
+  // writer API
+  void           set_frame_id(const char *frame_id);
+  void *         write_buffer();
+  uint64_t       publish(unsigned int width, unsigned int height, bool is_dense,
+                         const fawkes::Time &time);
+  uint64_t       publish(const void *points, unsigned int width, unsigned int height,
+                         bool is_dense, const fawkes::Time &time);
+  uint64_t       publish(PointCloudAdapter *adapter, const std::string &id);
+
+  // reader API
+  uint64_t       sequence() const;
+  bool           acquire(Snapshot &snapshot) const;
+  bool           is_valid(const Snapshot &snapshot) const;
+
+  static void    list();
+  static void    cleanup(bool use_lister = true);
+  static bool    exists(const char *pointcloud_id);
+  static void    wipe(const char *pointcloud_id);
+
+ private:
+  void           constructor(SharedMemoryPointCloudHeader *header);
+  char *         slot_data(unsigned int slot) const;
+
+ private:
+  SharedMemoryPointCloudHeader    *priv_header_;
+  SharedMemoryPointCloud_header_t *raw_header_;
+  std::string                      pointcloud_id_;
+  int                              write_slot_;
+};
+
+} // end namespace fawkes
+
+#endif
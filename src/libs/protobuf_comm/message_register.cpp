@@ -38,6 +38,9 @@
 
 #include <google/protobuf/compiler/importer.h>
 #include <google/protobuf/dynamic_message.h>
+#if GOOGLE_PROTOBUF_VERSION >= 3000000
+#  include <google/protobuf/arena.h>
+#endif
 #include <netinet/in.h>
 #include <sys/types.h>
 #include <dirent.h>
@@ -224,6 +227,26 @@ MessageRegister::key_from_desc(const google::protobuf::Descriptor *desc)
  */
 std::shared_ptr<google::protobuf::Message>
 MessageRegister::new_message_for(uint16_t component_id, uint16_t msg_type)
+{
+  return new_message_for(component_id, msg_type, std::shared_ptr<google::protobuf::Arena>());
+}
+
+
+/** Create a new message instance on an arena.
+ * Allocating several messages, for example all messages of one received
+ * datagram, on the same arena replaces many small heap allocations by a
+ * few larger blocks. The returned pointer keeps the arena alive, it is
+ * destroyed once all messages allocated on it have been released.
+ * @param component_id ID of component this message type belongs to
+ * @param msg_type message type
+ * @param arena arena to allocate message on, if NULL or if arenas are not
+ * supported by the protobuf version the message is allocated on the heap
+ * @return new instance of a protobuf message that has been registered
+ * for the given message type.
+ */
+std::shared_ptr<google::protobuf::Message>
+MessageRegister::new_message_for(uint16_t component_id, uint16_t msg_type,
+				 std::shared_ptr<google::protobuf::Arena> arena)
 {
   KeyType key(component_id, msg_type);
 
@@ -239,6 +262,13 @@ MessageRegister::new_message_for(uint16_t component_id, uint16_t msg_type)
     throw std::runtime_error(msg);
   }
 
+#if GOOGLE_PROTOBUF_VERSION >= 3000000
+  if (arena) {
+    google::protobuf::Message *m = message_by_comp_type_[key]->New(arena.get());
+    // aliasing constructor, message is owned by the arena
+    return std::shared_ptr<google::protobuf::Message>(arena, m);
+  }
+#endif
   google::protobuf::Message *m = message_by_comp_type_[key]->New();
   return std::shared_ptr<google::protobuf::Message>(m);
 }
@@ -321,13 +351,32 @@ MessageRegister::serialize(uint16_t component_id, uint16_t msg_type,
  */
 std::shared_ptr<google::protobuf::Message>
 MessageRegister::deserialize(frame_header_t &frame_header, message_header_t &message_header, void *data)
+{
+  return deserialize(frame_header, message_header, data, std::shared_ptr<google::protobuf::Arena>());
+}
+
+
+/** Deserialize message on an arena.
+ * @param frame_header incoming message's frame header
+ * @param message_header incoming message's message header
+ * @param data incoming message's data buffer
+ * @param arena arena to allocate message on, see new_message_for()
+ * @return new instance of a protobuf message type that has been registered
+ * for the given type.
+ * @exception std::runtime_error thrown if anything goes wrong when
+ * deserializing the message, e.g. if no protobuf message has been registered
+ * for the given component ID and message type.
+ */
+std::shared_ptr<google::protobuf::Message>
+MessageRegister::deserialize(frame_header_t &frame_header, message_header_t &message_header,
+			     void *data, std::shared_ptr<google::protobuf::Arena> arena)
 {
   uint16_t comp_id   = ntohs(message_header.component_id);
   uint16_t msg_type  = ntohs(message_header.msg_type);
   size_t   data_size = ntohl(frame_header.payload_size) - sizeof(message_header);
 
   std::shared_ptr<google::protobuf::Message> m =
-    new_message_for(comp_id, msg_type);
+    new_message_for(comp_id, msg_type, arena);
   if (! m->ParseFromArray(data, data_size)) {
     throw std::runtime_error("Failed to parse message");
   }
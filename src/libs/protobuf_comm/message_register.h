@@ -54,6 +54,7 @@
 
 namespace google {
   namespace protobuf {
+    class Arena;
     namespace compiler {
       class Importer;
       class DiskSourceTree;
@@ -129,6 +130,10 @@ class MessageRegister : boost::noncopyable
   std::shared_ptr<google::protobuf::Message>
   new_message_for(uint16_t component_id, uint16_t msg_type);
 
+  std::shared_ptr<google::protobuf::Message>
+  new_message_for(uint16_t component_id, uint16_t msg_type,
+		  std::shared_ptr<google::protobuf::Arena> arena);
+
   std::shared_ptr<google::protobuf::Message>
   new_message_for(const std::string &full_name);
 
@@ -142,6 +147,11 @@ class MessageRegister : boost::noncopyable
 	      message_header_t &message_header,
 	      void *data);
 
+  std::shared_ptr<google::protobuf::Message>
+  deserialize(frame_header_t &frame_header,
+	      message_header_t &message_header,
+	      void *data, std::shared_ptr<google::protobuf::Arena> arena);
+
   /** Mapping from message type to load error message. */
   typedef std::multimap<std::string, std::string> LoadFailMap;
 
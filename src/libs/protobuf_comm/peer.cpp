@@ -37,7 +37,19 @@
 #include <protobuf_comm/crypto.h>
 
 #include <boost/lexical_cast.hpp>
+#if GOOGLE_PROTOBUF_VERSION >= 3000000
+#  include <google/protobuf/arena.h>
+#endif
 #include <ifaddrs.h>
+#include <sys/socket.h>
+#include <cerrno>
+
+/// Maximum number of unused queue entries kept for re-use
+#define QUEUE_ENTRY_POOL_SIZE   64
+/// Maximum number of datagrams sent with a single system call
+#define SEND_BATCH_DATAGRAMS    16
+/// Maximum number of datagrams received with a single system call
+#define RECV_BATCH_DATAGRAMS     8
 
 using namespace boost::asio;
 using namespace boost::system;
@@ -58,7 +70,7 @@ namespace protobuf_comm {
 ProtobufBroadcastPeer::ProtobufBroadcastPeer(const std::string address, unsigned short port)
   : io_service_(), resolver_(io_service_),
     socket_(io_service_, ip::udp::endpoint(ip::udp::v4(), port)),
-    resolve_retry_timer_(io_service_)
+    resolve_retry_timer_(io_service_), batch_timer_(io_service_)
 {
   message_register_ = new MessageRegister();
   own_message_register_ = true;
@@ -79,7 +91,7 @@ ProtobufBroadcastPeer::ProtobufBroadcastPeer(const std::string address,
 					     unsigned short recv_on_port)
   : io_service_(), resolver_(io_service_),
     socket_(io_service_, ip::udp::endpoint(ip::udp::v4(), recv_on_port)),
-    resolve_retry_timer_(io_service_)
+    resolve_retry_timer_(io_service_), batch_timer_(io_service_)
 {
   message_register_ = new MessageRegister();
   own_message_register_ = true;
@@ -95,7 +107,7 @@ ProtobufBroadcastPeer::ProtobufBroadcastPeer(const std::string address, unsigned
 					     std::vector<std::string> &proto_path)
   : io_service_(), resolver_(io_service_),
     socket_(io_service_, ip::udp::endpoint(ip::udp::v4(), port)),
-    resolve_retry_timer_(io_service_)
+    resolve_retry_timer_(io_service_), batch_timer_(io_service_)
 {
   message_register_ = new MessageRegister(proto_path);
   own_message_register_ = true;
@@ -118,7 +130,7 @@ ProtobufBroadcastPeer::ProtobufBroadcastPeer(const std::string address,
 					     std::vector<std::string> &proto_path)
   : io_service_(), resolver_(io_service_),
     socket_(io_service_, ip::udp::endpoint(ip::udp::v4(), recv_on_port)),
-    resolve_retry_timer_(io_service_)
+    resolve_retry_timer_(io_service_), batch_timer_(io_service_)
 {
   message_register_ = new MessageRegister(proto_path);
   own_message_register_ = true;
@@ -135,7 +147,7 @@ ProtobufBroadcastPeer::ProtobufBroadcastPeer(const std::string address, unsigned
 					     MessageRegister *mr)
   : io_service_(), resolver_(io_service_),
     socket_(io_service_, ip::udp::endpoint(ip::udp::v4(), port)),
-    resolve_retry_timer_(io_service_),
+    resolve_retry_timer_(io_service_), batch_timer_(io_service_),
     message_register_(mr), own_message_register_(false)
 {
   ctor(address, port);
@@ -153,7 +165,7 @@ ProtobufBroadcastPeer::ProtobufBroadcastPeer(const std::string address,
 					     const std::string crypto_key, const std::string cipher)
   : io_service_(), resolver_(io_service_),
     socket_(io_service_, ip::udp::endpoint(ip::udp::v4(), recv_on_port)),
-    resolve_retry_timer_(io_service_)
+    resolve_retry_timer_(io_service_), batch_timer_(io_service_)
 {
   ctor(address, send_to_port, crypto_key, cipher);
   message_register_ = new MessageRegister();
@@ -174,7 +186,7 @@ ProtobufBroadcastPeer::ProtobufBroadcastPeer(const std::string address,
 					     const std::string crypto_key, const std::string cipher)
   : io_service_(), resolver_(io_service_),
     socket_(io_service_, ip::udp::endpoint(ip::udp::v4(), recv_on_port)),
-    resolve_retry_timer_(io_service_),
+    resolve_retry_timer_(io_service_), batch_timer_(io_service_),
     message_register_(mr), own_message_register_(false)
 {
   ctor(address, send_to_port, crypto_key, cipher);
@@ -190,7 +202,7 @@ ProtobufBroadcastPeer::ProtobufBroadcastPeer(const std::string address, unsigned
 					     const std::string crypto_key, const std::string cipher)
   : io_service_(), resolver_(io_service_),
     socket_(io_service_, ip::udp::endpoint(ip::udp::v4(), port)),
-    resolve_retry_timer_(io_service_)
+    resolve_retry_timer_(io_service_), batch_timer_(io_service_)
 {
   ctor(address, port, crypto_key, cipher);
   message_register_ = new MessageRegister();
@@ -209,7 +221,7 @@ ProtobufBroadcastPeer::ProtobufBroadcastPeer(const std::string address, unsigned
 					     const std::string crypto_key, const std::string cipher)
   : io_service_(), resolver_(io_service_),
     socket_(io_service_, ip::udp::endpoint(ip::udp::v4(), port)),
-    resolve_retry_timer_(io_service_),
+    resolve_retry_timer_(io_service_), batch_timer_(io_service_),
     message_register_(mr), own_message_register_(false)
 {
   ctor(address, port, crypto_key, cipher);
@@ -233,7 +245,7 @@ ProtobufBroadcastPeer::ProtobufBroadcastPeer(const std::string address,
 					     frame_header_version_t header_version)
   : io_service_(), resolver_(io_service_),
     socket_(io_service_, ip::udp::endpoint(ip::udp::v4(), recv_on_port)),
-    resolve_retry_timer_(io_service_),
+    resolve_retry_timer_(io_service_), batch_timer_(io_service_),
     message_register_(mr), own_message_register_(false)
 {
   ctor(address, send_to_port, "", "", header_version);
@@ -261,10 +273,16 @@ ProtobufBroadcastPeer::ctor(const std::string &address, unsigned int send_to_por
   send_to_address_ = address;
   send_to_port_    = send_to_port;
   
-  in_data_size_ = max_packet_length;
+  // large enough for batched datagrams, see set_batching()
+  in_data_size_ = max_datagram_length;
   in_data_ = malloc(in_data_size_);
   enc_in_data_ = NULL;
 
+  batch_max_size_     = 0;
+  batch_max_delay_ms_ = 0;
+  batch_queued_bytes_ = 0;
+  batch_timer_active_ = false;
+
   socket_.set_option(socket_base::broadcast(true));
   socket_.set_option(socket_base::reuse_address(true));
   determine_local_endpoints();
@@ -283,10 +301,18 @@ ProtobufBroadcastPeer::ctor(const std::string &address, unsigned int send_to_por
 ProtobufBroadcastPeer::~ProtobufBroadcastPeer()
 {
 	resolve_retry_timer_.cancel();
+  batch_timer_.cancel();
   if (asio_thread_.joinable()) {
     io_service_.stop();
     asio_thread_.join();
   }
+  while (! outbound_queue_.empty()) {
+    delete outbound_queue_.front();
+    outbound_queue_.pop_front();
+  }
+  for (QueueEntry *entry : entry_pool_) {
+    delete entry;
+  }
   free(in_data_);
   if (enc_in_data_)  free(enc_in_data_);
   if (own_message_register_) {
@@ -367,6 +393,40 @@ ProtobufBroadcastPeer::set_filter_self(bool filter)
 }
 
 
+/** Enable batching of outgoing messages.
+ * Messages are no longer sent immediately, but collected for at most
+ * @p max_delay_ms milliseconds and then sent as consecutive frames in as
+ * few datagrams of at most @p max_datagram_size bytes as possible. This
+ * considerably reduces the number of packets and system calls if many
+ * small messages are sent at a high rate. Each frame is encoded (and
+ * encrypted) exactly as if it was sent on its own, but receivers must be
+ * able to handle multiple frames per datagram. Older versions of this
+ * class reject such datagrams, therefore batching is disabled by default.
+ * Batching requires the V2 frame header.
+ * @param max_datagram_size maximum size of a datagram in bytes, should not
+ * exceed the path MTU minus IP and UDP headers, at most max_datagram_length.
+ * Zero disables batching.
+ * @param max_delay_ms maximum time in milliseconds a message is delayed
+ */
+void
+ProtobufBroadcastPeer::set_batching(size_t max_datagram_size, unsigned int max_delay_ms)
+{
+  if (max_datagram_size > 0 && frame_header_version_ == PB_FRAME_V1) {
+    throw std::runtime_error("Batching only available with V2+ frame header");
+  }
+  if (max_datagram_size > max_datagram_length) {
+    throw std::runtime_error("Batch datagram size exceeds maximum datagram length");
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(outbound_mutex_);
+    batch_max_size_     = max_datagram_size;
+    batch_max_delay_ms_ = max_delay_ms;
+  }
+  start_send();
+}
+
+
 /** ASIO thread runnable. */
 void
 ProtobufBroadcastPeer::run_asio()
@@ -419,106 +479,217 @@ void
 ProtobufBroadcastPeer::handle_recv(const boost::system::error_code& error,
 				   size_t bytes_rcvd)
 {
-  const size_t expected_min_size =
-    (frame_header_version_ == PB_FRAME_V1)
-    ? sizeof(frame_header_v1_t) : (sizeof(frame_header_t) + sizeof(message_header_t));
+  if (! error) {
+    process_datagram(in_endpoint_,
+		     (unsigned char *)(crypto_buf_ ? enc_in_data_ : in_data_), bytes_rcvd);
+    recv_more();
+  } else {
+    sig_recv_error_(in_endpoint_, "General receiving error or truncated message");
+  }
 
-  if (!error && bytes_rcvd >= expected_min_size ) {
-    frame_header_t frame_header;
-    size_t header_size;
-    if (frame_header_version_ == PB_FRAME_V1) {
-      frame_header_v1_t *frame_header_v1 = static_cast<frame_header_v1_t *>(in_data_);
-      frame_header.header_version = PB_FRAME_V1;
-      frame_header.cipher         = PB_ENCRYPTION_NONE;
-      frame_header.payload_size   = frame_header_v1->payload_size;
-      header_size  = sizeof(frame_header_v1_t);
+  start_recv();
+}
+
+
+/** Receive further pending datagrams.
+ * Once woken up for an incoming datagram, fetch others which might have
+ * arrived meanwhile with a single system call, rather than going through
+ * the I/O service for each one of them.
+ */
+void
+ProtobufBroadcastPeer::recv_more()
+{
+#ifdef __linux__
+  // slots must hold encrypted datagrams, cf. setup_crypto()
+  const size_t slot_size = 2 * in_data_size_;
+  if (in_batch_data_.empty()) {
+    in_batch_data_.resize(RECV_BATCH_DATAGRAMS * slot_size);
+  }
+
+  struct mmsghdr          msgs[RECV_BATCH_DATAGRAMS];
+  struct iovec            iov[RECV_BATCH_DATAGRAMS];
+  struct sockaddr_storage addrs[RECV_BATCH_DATAGRAMS];
+  memset(msgs, 0, sizeof(msgs));
+
+  for (unsigned int i = 0; i < RECV_BATCH_DATAGRAMS; ++i) {
+    iov[i].iov_base = &in_batch_data_[i * slot_size];
+    iov[i].iov_len  = crypto_buf_ ? enc_in_data_size_ : in_data_size_;
+    msgs[i].msg_hdr.msg_iov     = &iov[i];
+    msgs[i].msg_hdr.msg_iovlen  = 1;
+    msgs[i].msg_hdr.msg_name    = &addrs[i];
+    msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+  }
+
+  int num_rcvd = recvmmsg(socket_.native_handle(), msgs, RECV_BATCH_DATAGRAMS,
+			  MSG_DONTWAIT, NULL);
+
+  for (int i = 0; i < num_rcvd; ++i) {
+    ip::udp::endpoint endpoint;
+    if (msgs[i].msg_hdr.msg_namelen > endpoint.capacity()) continue;
+    memcpy(endpoint.data(), &addrs[i], msgs[i].msg_hdr.msg_namelen);
+    endpoint.resize(msgs[i].msg_hdr.msg_namelen);
+
+    if (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+      sig_recv_error_(endpoint, "General receiving error or truncated message");
     } else {
-      memcpy(&frame_header, crypto_buf_ ? enc_in_data_ : in_data_, sizeof(frame_header_t));
-      header_size  = sizeof(frame_header_t);
+      process_datagram(endpoint, (unsigned char *)iov[i].iov_base, msgs[i].msg_len);
+    }
+  }
+#endif
+}
 
-      if (crypto_buf_) {
-	sig_rcvd_raw_(in_endpoint_, frame_header,
-		      (unsigned char *)enc_in_data_ + sizeof(frame_header_t),
-		      bytes_rcvd - sizeof(frame_header_t));
-      } else {
-	sig_rcvd_raw_(in_endpoint_, frame_header,
-		      (unsigned char *)in_data_ + sizeof(frame_header_t),
-		      bytes_rcvd - sizeof(frame_header_t));
-      }
 
-      if (sig_rcvd_.num_slots() > 0) {
-	if (! crypto_buf_ && (frame_header.cipher != PB_ENCRYPTION_NONE)) {
-	  sig_recv_error_(in_endpoint_, "Received encrypted message but encryption is disabled");
-	} else if (crypto_buf_ && (frame_header.cipher  == PB_ENCRYPTION_NONE)) {
-	  sig_recv_error_(in_endpoint_, "Received plain text message but encryption is enabled");
-	} else {
-
-	  if (crypto_buf_ && (frame_header.cipher != PB_ENCRYPTION_NONE)) {
-	    // we need to decrypt first
-	    try {
-	      memcpy(in_data_, enc_in_data_, sizeof(frame_header_t));
-	      size_t to_decrypt = bytes_rcvd - sizeof(frame_header_t);
-	      bytes_rcvd = crypto_dec_->decrypt(frame_header.cipher,
-						(unsigned char *)enc_in_data_ + sizeof(frame_header_t), to_decrypt,
-						(unsigned char *)in_data_ + sizeof(frame_header_t), in_data_size_);
-	      frame_header.payload_size = htonl(bytes_rcvd);
-	      bytes_rcvd += sizeof(frame_header_t);
-	    } catch (std::runtime_error &e) {
-	      sig_recv_error_(in_endpoint_, std::string("Decryption fail: ") + e.what());
-	      bytes_rcvd = 0;
-	    }
-	  }
-	}
-      } // else nobody cares about deserialized message
+/** Process a received datagram.
+ * A datagram contains a single frame if sent by a V1 peer or a peer with
+ * batching disabled, or several consecutive frames otherwise.
+ * @param endpoint endpoint the datagram was received from
+ * @param data datagram data, possibly encrypted
+ * @param bytes_rcvd size of datagram in bytes
+ */
+void
+ProtobufBroadcastPeer::process_datagram(ip::udp::endpoint &endpoint,
+					unsigned char *data, size_t bytes_rcvd)
+{
+  // all messages of a datagram share one arena
+  std::shared_ptr<google::protobuf::Arena> arena;
+
+  if (frame_header_version_ == PB_FRAME_V1) {
+    if (bytes_rcvd < sizeof(frame_header_v1_t)) {
+      sig_recv_error_(endpoint, "General receiving error or truncated message");
+      return;
+    }
+
+    if (sig_rcvd_.num_slots() == 0)  return;
+
+    frame_header_v1_t *frame_header_v1 = reinterpret_cast<frame_header_v1_t *>(data);
+    size_t payload_size = ntohl(frame_header_v1->payload_size);
+    if (bytes_rcvd != sizeof(frame_header_v1_t) + payload_size) {
+      sig_recv_error_(endpoint, "Invalid number of bytes received");
+      return;
     }
 
+    if (filter_self_ &&
+	std::binary_search(local_endpoints_.begin(), local_endpoints_.end(), endpoint))
+    {
+      return;
+    }
+
+    frame_header_t frame_header;
+    frame_header.header_version = PB_FRAME_V1;
+    frame_header.cipher         = PB_ENCRYPTION_NONE;
+    // message register expects payload size to include message header
+    frame_header.payload_size   = htonl(payload_size + sizeof(message_header_t));
+
+    message_header_t message_header;
+    message_header.component_id = frame_header_v1->component_id;
+    message_header.msg_type     = frame_header_v1->msg_type;
+
+    uint16_t comp_id  = ntohs(message_header.component_id);
+    uint16_t msg_type = ntohs(message_header.msg_type);
+
+    try {
+      std::shared_ptr<google::protobuf::Message> m =
+	message_register_->deserialize(frame_header, message_header,
+				       data + sizeof(frame_header_v1_t));
+      sig_rcvd_(endpoint, comp_id, msg_type, m);
+    } catch (std::runtime_error &e) {
+      sig_recv_error_(endpoint, std::string("Deserialization fail: ") + e.what());
+    }
+    return;
+  }
+
+  size_t offset = 0;
+  do {
+    size_t remaining = bytes_rcvd - offset;
+    if (remaining < sizeof(frame_header_t) + sizeof(message_header_t)) {
+      sig_recv_error_(endpoint, "General receiving error or truncated message");
+      return;
+    }
+
+    frame_header_t frame_header;
+    memcpy(&frame_header, data + offset, sizeof(frame_header_t));
     size_t payload_size = ntohl(frame_header.payload_size);
+    if (payload_size > remaining - sizeof(frame_header_t)) {
+      sig_recv_error_(endpoint, "Invalid number of bytes received");
+      return;
+    }
 
-    if (sig_rcvd_.num_slots() > 0) {
-      if (bytes_rcvd == (header_size + payload_size)) {
-	if (! filter_self_ ||
-	    ! std::binary_search(local_endpoints_.begin(), local_endpoints_.end(), in_endpoint_))
-	{
-	  void *data;
-	  message_header_t message_header;
-
-	  if (frame_header_version_ == PB_FRAME_V1) {
-	    frame_header_v1_t *frame_header_v1 = static_cast<frame_header_v1_t *>(in_data_);
-	    message_header.component_id = frame_header_v1->component_id;
-	    message_header.msg_type     = frame_header_v1->msg_type;
-	    data = (char *)in_data_ + sizeof(frame_header_v1_t);
-	    // message register expects payload size to include message header
-	    frame_header.payload_size = htonl(ntohl(frame_header.payload_size) + sizeof(message_header_t));
-	  } else {
-	    message_header_t *msg_header =
-	    static_cast<message_header_t *>((void*)((char *)in_data_ + sizeof(frame_header_t)));
-	    message_header.component_id = msg_header->component_id;
-	    message_header.msg_type     = msg_header->msg_type;
-	    data = (char *)in_data_ + sizeof(frame_header_t) + sizeof(message_header_t);
-	  }
-
-	  uint16_t comp_id  = ntohs(message_header.component_id);
-	  uint16_t msg_type = ntohs(message_header.msg_type);
-
-	  try {
-	    std::shared_ptr<google::protobuf::Message> m =
-	      message_register_->deserialize(frame_header, message_header, data);
-
-	    sig_rcvd_(in_endpoint_, comp_id, msg_type, m);
-	  } catch (std::runtime_error &e) {
-	    sig_recv_error_(in_endpoint_, std::string("Deserialization fail: ") + e.what());
-	  }
-	}
-      } else {
-	sig_recv_error_(in_endpoint_, "Invalid number of bytes received");
-      }
-    } // else nobody cares (no one registered to signal)
+    process_frame(endpoint, frame_header, data + offset + sizeof(frame_header_t),
+		  payload_size, arena);
 
-  } else {
-    sig_recv_error_(in_endpoint_, "General receiving error or truncated message");
+    offset += sizeof(frame_header_t) + payload_size;
+  } while (offset < bytes_rcvd);
+}
+
+
+/** Process a single V2 frame.
+ * @param endpoint endpoint the frame was received from
+ * @param frame_header frame header
+ * @param payload frame payload, possibly encrypted
+ * @param payload_size size of @p payload in bytes
+ * @param arena arena to allocate messages on, created on first use
+ */
+void
+ProtobufBroadcastPeer::process_frame(ip::udp::endpoint &endpoint, frame_header_t &frame_header,
+				     unsigned char *payload, size_t payload_size,
+				     std::shared_ptr<google::protobuf::Arena> &arena)
+{
+  sig_rcvd_raw_(endpoint, frame_header, payload, payload_size);
+
+  // nobody cares about deserialized message
+  if (sig_rcvd_.num_slots() == 0)  return;
+
+  if (! crypto_buf_ && (frame_header.cipher != PB_ENCRYPTION_NONE)) {
+    sig_recv_error_(endpoint, "Received encrypted message but encryption is disabled");
+    return;
+  } else if (crypto_buf_ && (frame_header.cipher  == PB_ENCRYPTION_NONE)) {
+    sig_recv_error_(endpoint, "Received plain text message but encryption is enabled");
+    return;
   }
 
-  start_recv();
+  if (crypto_buf_) {
+    // we need to decrypt first
+    try {
+      payload_size = crypto_dec_->decrypt(frame_header.cipher, payload, payload_size,
+					  (unsigned char *)in_data_, in_data_size_);
+      payload = (unsigned char *)in_data_;
+      frame_header.payload_size = htonl(payload_size);
+    } catch (std::runtime_error &e) {
+      sig_recv_error_(endpoint, std::string("Decryption fail: ") + e.what());
+      return;
+    }
+  }
+
+  if (payload_size < sizeof(message_header_t)) {
+    sig_recv_error_(endpoint, "Invalid number of bytes received");
+    return;
+  }
+
+  if (filter_self_ &&
+      std::binary_search(local_endpoints_.begin(), local_endpoints_.end(), endpoint))
+  {
+    return;
+  }
+
+  message_header_t message_header;
+  memcpy(&message_header, payload, sizeof(message_header_t));
+
+  uint16_t comp_id  = ntohs(message_header.component_id);
+  uint16_t msg_type = ntohs(message_header.msg_type);
+
+#if GOOGLE_PROTOBUF_VERSION >= 3000000
+  if (! arena)  arena = std::make_shared<google::protobuf::Arena>();
+#endif
+
+  try {
+    std::shared_ptr<google::protobuf::Message> m =
+      message_register_->deserialize(frame_header, message_header,
+				     payload + sizeof(message_header_t), arena);
+
+    sig_rcvd_(endpoint, comp_id, msg_type, m);
+  } catch (std::runtime_error &e) {
+    sig_recv_error_(endpoint, std::string("Deserialization fail: ") + e.what());
+  }
 }
 
 
@@ -526,10 +697,9 @@ void
 ProtobufBroadcastPeer::handle_sent(const boost::system::error_code& error,
 				   size_t bytes_transferred, QueueEntry *entry)
 {
-  delete entry;
-
   {
     std::lock_guard<std::mutex> lock(outbound_mutex_);
+    release_entry(entry);
     outbound_active_ = false;
   }
 
@@ -541,6 +711,82 @@ ProtobufBroadcastPeer::handle_sent(const boost::system::error_code& error,
 }
 
 
+/** Get a queue entry.
+ * Re-uses a previously released entry if possible. This avoids allocating
+ * the entry and, since buffers keep their capacity, the serialization buffer.
+ * @return queue entry
+ */
+QueueEntry *
+ProtobufBroadcastPeer::acquire_entry()
+{
+  QueueEntry *entry = NULL;
+  {
+    std::lock_guard<std::mutex> lock(outbound_mutex_);
+    if (! entry_pool_.empty()) {
+      entry = entry_pool_.back();
+      entry_pool_.pop_back();
+    }
+  }
+
+  if (! entry)  return new QueueEntry();
+
+  entry->frame_header.header_version = PB_FRAME_V2;
+  entry->frame_header.cipher         = PB_ENCRYPTION_NONE;
+  entry->serialized_message.clear();
+  entry->encrypted_message.clear();
+  return entry;
+}
+
+
+/** Release a queue entry.
+ * Must be called with the outbound mutex locked.
+ * @param entry entry to release, may no longer be used
+ */
+void
+ProtobufBroadcastPeer::release_entry(QueueEntry *entry)
+{
+  if (entry_pool_.size() < QUEUE_ENTRY_POOL_SIZE) {
+    entry_pool_.push_back(entry);
+  } else {
+    delete entry;
+  }
+}
+
+
+/** Append entry to outbound queue and trigger sending.
+ * @param entry entry to send
+ */
+void
+ProtobufBroadcastPeer::enqueue(QueueEntry *entry)
+{
+  bool flush = false, start_timer = false;
+  {
+    std::lock_guard<std::mutex> lock(outbound_mutex_);
+    outbound_queue_.push_back(entry);
+
+    if (batch_max_size_ > 0) {
+      for (const boost::asio::const_buffer &b : entry->buffers) {
+	batch_queued_bytes_ += boost::asio::buffer_size(b);
+      }
+      if (batch_queued_bytes_ >= batch_max_size_) {
+	flush = true;
+      } else if (! batch_timer_active_) {
+	batch_timer_active_ = start_timer = true;
+      }
+    } else {
+      flush = true;
+    }
+  }
+
+  if (flush) {
+    start_send();
+  } else if (start_timer) {
+    // timers are not thread-safe, only use from ASIO thread
+    io_service_.post(boost::bind(&ProtobufBroadcastPeer::start_batch_timer, this));
+  }
+}
+
+
 /** Send a message to other peers.
  * @param component_id ID of the component to address
  * @param msg_type numeric message type
@@ -550,12 +796,18 @@ void
 ProtobufBroadcastPeer::send(uint16_t component_id, uint16_t msg_type,
 			    google::protobuf::Message &m)
 {
-  QueueEntry *entry = new QueueEntry();
-  message_register_->serialize(component_id, msg_type, m,
-			       entry->frame_header, entry->message_header,
-			       entry->serialized_message);
+  QueueEntry *entry = acquire_entry();
+  try {
+    message_register_->serialize(component_id, msg_type, m,
+				 entry->frame_header, entry->message_header,
+				 entry->serialized_message);
+  } catch (...) {
+    delete entry;
+    throw;
+  }
 
   if (entry->serialized_message.size() > max_packet_length) {
+    delete entry;
     throw std::runtime_error("Serialized message too big");
   }
 
@@ -571,12 +823,8 @@ ProtobufBroadcastPeer::send(uint16_t component_id, uint16_t msg_type,
     entry->buffers[1] = boost::asio::buffer(&entry->message_header, sizeof(message_header_t));
   }
   entry->buffers[2] = boost::asio::buffer(entry->serialized_message);
- 
-  {
-    std::lock_guard<std::mutex> lock(outbound_mutex_);
-    outbound_queue_.push(entry);
-  }
-  start_send();
+
+  enqueue(entry);
 }
 
 /** Send a raw message.
@@ -590,19 +838,15 @@ void
 ProtobufBroadcastPeer::send_raw(const frame_header_t &frame_header,
 				const void *data, size_t data_size)
 {
-  QueueEntry *entry = new QueueEntry();
+  QueueEntry *entry = acquire_entry();
   entry->frame_header = frame_header;
-  entry->serialized_message = std::string(reinterpret_cast<const char *>(data), data_size);
+  entry->serialized_message.assign(reinterpret_cast<const char *>(data), data_size);
 
   entry->buffers[0] = boost::asio::buffer(&entry->frame_header, sizeof(frame_header_t));
   entry->buffers[1] = boost::asio::const_buffer();
   entry->buffers[2] = boost::asio::buffer(entry->serialized_message);
 
-  {
-    std::lock_guard<std::mutex> lock(outbound_mutex_);
-    outbound_queue_.push(entry);
-  }
-  start_send();  
+  enqueue(entry);
 }
 
 
@@ -678,42 +922,197 @@ ProtobufBroadcastPeer::start_send()
   std::lock_guard<std::mutex> lock(outbound_mutex_);
   if (outbound_queue_.empty() || outbound_active_ || ! outbound_ready_)  return;
 
+  if (batch_max_size_ > 0) {
+    io_service_.post(boost::bind(&ProtobufBroadcastPeer::send_batch, this));
+    return;
+  }
+
   outbound_active_ = true;
 
   QueueEntry *entry = outbound_queue_.front();
-  outbound_queue_.pop();
+  outbound_queue_.pop_front();
 
-  if (crypto_) {
-    size_t plain_size = boost::asio::buffer_size(entry->buffers[1])
-      + boost::asio::buffer_size(entry->buffers[2]);
-    size_t enc_size   = crypto_enc_->encrypted_buffer_size(plain_size);
+  if (crypto_)  encrypt_entry(entry);
 
-    std::string plain_buf = std::string(plain_size, '\0');
+  socket_.async_send_to(entry->buffers, outbound_endpoint_,
+			boost::bind(&ProtobufBroadcastPeer::handle_sent, this,
+				    boost::asio::placeholders::error,
+				    boost::asio::placeholders::bytes_transferred,
+				    entry));
+}
+
+
+/** Encrypt queue entry.
+ * Replaces message header and payload by their encryption.
+ * Must be called with the outbound mutex locked.
+ * @param entry entry to encrypt
+ */
+void
+ProtobufBroadcastPeer::encrypt_entry(QueueEntry *entry)
+{
+  size_t plain_size = boost::asio::buffer_size(entry->buffers[1])
+    + boost::asio::buffer_size(entry->buffers[2]);
+  size_t enc_size   = crypto_enc_->encrypted_buffer_size(plain_size);
 
-    plain_buf.replace(0,
-		      boost::asio::buffer_size(entry->buffers[1]),
-		      boost::asio::buffer_cast<const char *>(entry->buffers[1]),
-		      boost::asio::buffer_size(entry->buffers[1]));
+  std::string plain_buf = std::string(plain_size, '\0');
 
-    plain_buf.replace(boost::asio::buffer_size(entry->buffers[1]),
-		      boost::asio::buffer_size(entry->buffers[2]),
-		      boost::asio::buffer_cast<const char *>(entry->buffers[2]),
-		      boost::asio::buffer_size(entry->buffers[2]));
+  plain_buf.replace(0,
+		    boost::asio::buffer_size(entry->buffers[1]),
+		    boost::asio::buffer_cast<const char *>(entry->buffers[1]),
+		    boost::asio::buffer_size(entry->buffers[1]));
 
-    entry->encrypted_message.resize(enc_size);
-    crypto_enc_->encrypt(plain_buf, entry->encrypted_message);
+  plain_buf.replace(boost::asio::buffer_size(entry->buffers[1]),
+		    boost::asio::buffer_size(entry->buffers[2]),
+		    boost::asio::buffer_cast<const char *>(entry->buffers[2]),
+		    boost::asio::buffer_size(entry->buffers[2]));
+
+  entry->encrypted_message.resize(enc_size);
+  crypto_enc_->encrypt(plain_buf, entry->encrypted_message);
+
+  entry->frame_header.payload_size = htonl(entry->encrypted_message.size());
+  entry->frame_header.cipher       = crypto_enc_->cipher_id();
+  entry->buffers[1] = boost::asio::buffer(entry->encrypted_message);
+  entry->buffers[2] = boost::asio::const_buffer();
+}
 
-    entry->frame_header.payload_size = htonl(entry->encrypted_message.size());
-    entry->frame_header.cipher       = crypto_enc_->cipher_id();
-    entry->buffers[1] = boost::asio::buffer(entry->encrypted_message);
-    entry->buffers[2] = boost::asio::const_buffer();
+
+/** Start timer to send batch after maximum delay. */
+void
+ProtobufBroadcastPeer::start_batch_timer()
+{
+  batch_timer_.expires_from_now(boost::posix_time::milliseconds(batch_max_delay_ms_));
+  batch_timer_.async_wait(boost::bind(&ProtobufBroadcastPeer::handle_batch_timer, this,
+				      boost::asio::placeholders::error));
+}
+
+
+void
+ProtobufBroadcastPeer::handle_batch_timer(const boost::system::error_code &ec)
+{
+  if (ec == boost::asio::error::operation_aborted)  return;
+
+  {
+    std::lock_guard<std::mutex> lock(outbound_mutex_);
+    batch_timer_active_ = false;
   }
+  send_batch();
+}
 
-  socket_.async_send_to(entry->buffers, outbound_endpoint_,
-			boost::bind(&ProtobufBroadcastPeer::handle_sent, this,
-				    boost::asio::placeholders::error,
-				    boost::asio::placeholders::bytes_transferred,
-				    entry));
+
+/** Send queued messages in batches.
+ * Packs consecutive frames into datagrams of at most the configured size
+ * and hands multiple datagrams to the kernel at once. Only called from
+ * the ASIO thread.
+ */
+void
+ProtobufBroadcastPeer::send_batch()
+{
+  bool send_failed = false;
+  bool retry_later = false;
+  bool more = false;
+
+  {
+    std::lock_guard<std::mutex> lock(outbound_mutex_);
+    if (outbound_queue_.empty() || outbound_active_ || ! outbound_ready_)  return;
+
+    struct msghdr  msgs[SEND_BATCH_DATAGRAMS];
+    unsigned int   entries_per_msg[SEND_BATCH_DATAGRAMS];
+    std::vector<struct iovec> iov;
+    // reserve to keep iovec addresses stable
+    iov.reserve(outbound_queue_.size() * 3);
+    memset(msgs, 0, sizeof(msgs));
+
+    unsigned int num_msgs = 0;
+    size_t e = 0;
+    while (e < outbound_queue_.size() && num_msgs < SEND_BATCH_DATAGRAMS) {
+      size_t iov_start = iov.size();
+      size_t datagram_size = 0;
+      unsigned int num_entries = 0;
+
+      for (; e < outbound_queue_.size(); ++e) {
+	QueueEntry *entry = outbound_queue_[e];
+	// entries remain queued if sending has to be retried
+	if (crypto_ && entry->encrypted_message.empty())  encrypt_entry(entry);
+
+	size_t entry_size = 0;
+	for (const boost::asio::const_buffer &b : entry->buffers) {
+	  entry_size += boost::asio::buffer_size(b);
+	}
+	if (num_entries > 0 && datagram_size + entry_size > batch_max_size_)  break;
+
+	for (const boost::asio::const_buffer &b : entry->buffers) {
+	  if (boost::asio::buffer_size(b) == 0)  continue;
+	  struct iovec v;
+	  v.iov_base = const_cast<void *>(boost::asio::buffer_cast<const void *>(b));
+	  v.iov_len  = boost::asio::buffer_size(b);
+	  iov.push_back(v);
+	}
+	datagram_size += entry_size;
+	num_entries   += 1;
+      }
+
+      msgs[num_msgs].msg_name    = outbound_endpoint_.data();
+      msgs[num_msgs].msg_namelen = outbound_endpoint_.size();
+      msgs[num_msgs].msg_iov     = &iov[iov_start];
+      msgs[num_msgs].msg_iovlen  = iov.size() - iov_start;
+      entries_per_msg[num_msgs]  = num_entries;
+      num_msgs += 1;
+    }
+
+    unsigned int num_sent = 0;
+#ifdef __linux__
+    struct mmsghdr mmsgs[SEND_BATCH_DATAGRAMS];
+    memset(mmsgs, 0, sizeof(mmsgs));
+    for (unsigned int i = 0; i < num_msgs; ++i)  mmsgs[i].msg_hdr = msgs[i];
+    int rv = sendmmsg(socket_.native_handle(), mmsgs, num_msgs, MSG_DONTWAIT);
+    if (rv >= 0)  num_sent = rv;
+#else
+    int rv = 0;
+    for (; num_sent < num_msgs; ++num_sent) {
+      if ((rv = sendmsg(socket_.native_handle(), &msgs[num_sent], MSG_DONTWAIT)) == -1) break;
+    }
+#endif
+    if (rv == -1) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+	retry_later = true;
+      } else {
+	// drop failed datagram, otherwise we would retry it forever
+	send_failed = true;
+	num_sent += 1;
+      }
+    }
+
+    for (unsigned int i = 0; i < num_sent; ++i) {
+      for (unsigned int j = 0; j < entries_per_msg[i]; ++j) {
+	release_entry(outbound_queue_.front());
+	outbound_queue_.pop_front();
+      }
+    }
+
+    batch_queued_bytes_ = 0;
+    for (QueueEntry *entry : outbound_queue_) {
+      for (const boost::asio::const_buffer &b : entry->buffers) {
+	batch_queued_bytes_ += boost::asio::buffer_size(b);
+      }
+    }
+
+    if (! outbound_queue_.empty()) {
+      if (retry_later) {
+	if (! batch_timer_active_)  batch_timer_active_ = true;
+	else                        retry_later = false;
+      } else {
+	more = true;
+      }
+    }
+  }
+
+  if (send_failed)  sig_send_error_("Sending message failed");
+
+  if (retry_later) {
+    start_batch_timer();
+  } else if (more) {
+    io_service_.post(boost::bind(&ProtobufBroadcastPeer::send_batch, this));
+  }
 }
 
 
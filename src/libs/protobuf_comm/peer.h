@@ -48,6 +48,8 @@
 #include <thread>
 #include <mutex>
 #include <queue>
+#include <deque>
+#include <vector>
 
 namespace protobuf_comm {
 
@@ -58,7 +60,10 @@ class ProtobufBroadcastPeer
 {
  public:
   /** Anonymus enum for constants. */
-  enum { max_packet_length = 1024 /**< maximum packet length in bytes */ };
+  enum {
+    max_packet_length   = 1024, /**< maximum packet length in bytes */
+    max_datagram_length = 9000  /**< maximum length of a batched datagram in bytes */
+  };
 
   ProtobufBroadcastPeer(const std::string address, unsigned short port);
   ProtobufBroadcastPeer(const std::string address, unsigned short send_to_port,
@@ -84,6 +89,7 @@ class ProtobufBroadcastPeer
   ~ProtobufBroadcastPeer();
 
   void set_filter_self(bool filter);
+  void set_batching(size_t max_datagram_size, unsigned int max_delay_ms);
 
   void send(uint16_t component_id, uint16_t msg_type,
 	    google::protobuf::Message &m);
@@ -159,6 +165,19 @@ class ProtobufBroadcastPeer
   void run_asio();
   void start_send();
   void start_recv();
+  void enqueue(QueueEntry *entry);
+  QueueEntry * acquire_entry();
+  void release_entry(QueueEntry *entry);
+  void encrypt_entry(QueueEntry *entry);
+  void start_batch_timer();
+  void handle_batch_timer(const boost::system::error_code &ec);
+  void send_batch();
+  void recv_more();
+  void process_datagram(boost::asio::ip::udp::endpoint &endpoint,
+			unsigned char *data, size_t bytes_rcvd);
+  void process_frame(boost::asio::ip::udp::endpoint &endpoint, frame_header_t &frame_header,
+		     unsigned char *payload, size_t payload_size,
+		     std::shared_ptr<google::protobuf::Arena> &arena);
   void start_resolve();
   void retry_resolve(const boost::system::error_code &ec);
   void handle_resolve(const boost::system::error_code& err,
@@ -172,6 +191,7 @@ class ProtobufBroadcastPeer
   boost::asio::ip::udp::resolver  resolver_;
   boost::asio::ip::udp::socket    socket_;
   boost::asio::deadline_timer     resolve_retry_timer_;
+  boost::asio::deadline_timer     batch_timer_;
 
   std::list<boost::asio::ip::udp::endpoint>  local_endpoints_;
 
@@ -183,10 +203,16 @@ class ProtobufBroadcastPeer
   std::string  send_to_address_;
   unsigned int send_to_port_;
 
-  std::queue<QueueEntry *> outbound_queue_;
-  std::mutex               outbound_mutex_;
-  bool                     outbound_active_;
-  bool                     outbound_ready_;
+  std::deque<QueueEntry *>  outbound_queue_;
+  std::mutex                outbound_mutex_;
+  bool                      outbound_active_;
+  bool                      outbound_ready_;
+  std::vector<QueueEntry *> entry_pool_;
+
+  size_t        batch_max_size_;
+  unsigned int  batch_max_delay_ms_;
+  size_t        batch_queued_bytes_;
+  bool          batch_timer_active_;
   
   boost::asio::ip::udp::endpoint outbound_endpoint_;
   boost::asio::ip::udp::endpoint in_endpoint_;
@@ -195,6 +221,7 @@ class ProtobufBroadcastPeer
   void *         enc_in_data_;
   size_t         in_data_size_;
   size_t         enc_in_data_size_;
+  std::vector<unsigned char>  in_batch_data_;
 
   bool           filter_self_;
 
@@ -0,0 +1,198 @@
+/***************************************************************************
+ *  qa_peer_batching.cpp - protobuf_comm broadcast peer batching test
+ *
+ *  Created: Sun Oct 18 23:41:17 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * - Neither the name of the authors nor the names of its contributors
+ *   may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Sends many small messages from a batching peer to a second peer over
+// the loopback interface. Enough datagrams are produced to require
+// several sendmmsg() and recvmmsg() calls. The sendmmsg() call is
+// intercepted to make the kernel accept only part of a batch, or none
+// at all, from time to time. All messages must arrive exactly once and
+// in the order they were sent.
+
+#include <protobuf_comm/peer.h>
+
+#include <boost/lexical_cast.hpp>
+#include <msgs/Person.pb.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include <cerrno>
+#include <cstdio>
+#include <dlfcn.h>
+#include <sys/socket.h>
+
+using namespace protobuf_comm;
+using namespace llsf_msgs;
+
+/// @cond QA
+
+#ifdef __linux__
+static unsigned int num_sendmmsg_calls = 0;
+static unsigned int num_partial_sends  = 0;
+static unsigned int num_refused_sends  = 0;
+
+// Interposes the C library function, the peer library resolves it to
+// this definition since the executable comes first in symbol lookup.
+extern "C" int
+sendmmsg(int sockfd, struct mmsghdr *msgvec, unsigned int vlen, int flags)
+{
+  typedef int (*sendmmsg_func_t)(int, struct mmsghdr *, unsigned int, int);
+  static sendmmsg_func_t real_sendmmsg = (sendmmsg_func_t)dlsym(RTLD_NEXT, "sendmmsg");
+
+  unsigned int call = ++num_sendmmsg_calls;
+  if (call % 5 == 0) {
+    // socket buffer full
+    ++num_refused_sends;
+    errno = EAGAIN;
+    return -1;
+  }
+  if (call % 3 == 0 && vlen > 2) {
+    // kernel accepted only the first datagrams
+    ++num_partial_sends;
+    vlen = 2;
+  }
+  return real_sendmmsg(sockfd, msgvec, vlen, flags);
+}
+#endif
+
+static std::mutex              mutex;
+static std::condition_variable cond;
+static std::vector<int>        received_ids;
+static unsigned int            num_errors = 0;
+
+void
+handle_message(boost::asio::ip::udp::endpoint &sender,
+	       uint16_t component_id, uint16_t msg_type,
+	       std::shared_ptr<google::protobuf::Message> msg)
+{
+  std::shared_ptr<Person> p;
+  if ((p = std::dynamic_pointer_cast<Person>(msg))) {
+    std::lock_guard<std::mutex> lock(mutex);
+    received_ids.push_back(p->id());
+    cond.notify_all();
+  }
+}
+
+void
+handle_recv_error(boost::asio::ip::udp::endpoint &endpoint, std::string msg)
+{
+  printf("Receive error: %s\n", msg.c_str());
+  std::lock_guard<std::mutex> lock(mutex);
+  ++num_errors;
+}
+
+void
+handle_send_error(std::string msg)
+{
+  printf("Send error: %s\n", msg.c_str());
+  std::lock_guard<std::mutex> lock(mutex);
+  ++num_errors;
+}
+
+int
+main(int argc, char **argv)
+{
+  unsigned short port_a = 1235;
+  unsigned short port_b = 1236;
+  int num_messages = 1000;
+  if (argc >= 2) {
+    num_messages = boost::lexical_cast<int>(argv[1]);
+  }
+
+  ProtobufBroadcastPeer *sender   = new ProtobufBroadcastPeer("127.0.0.1", port_b, port_a);
+  ProtobufBroadcastPeer *receiver = new ProtobufBroadcastPeer("127.0.0.1", port_a, port_b);
+
+  sender->message_register().add_message_type<Person>(1, 2);
+  receiver->message_register().add_message_type<Person>(1, 2);
+  receiver->set_filter_self(false);
+
+  receiver->signal_received().connect(handle_message);
+  receiver->signal_recv_error().connect(handle_recv_error);
+  sender->signal_send_error().connect(handle_send_error);
+
+  // small datagrams, a few frames each, flushed often
+  sender->set_batching(256, 5);
+
+  for (int i = 0; i < num_messages; ++i) {
+    Person p;
+    p.set_id(i);
+    p.set_name("Tim Niemueller");
+    p.set_email("niemueller@kbsg.rwth-aachen.de");
+    sender->send(1, 2, p);
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    cond.wait_for(lock, std::chrono::seconds(10),
+		  [num_messages]() { return (int)received_ids.size() >= num_messages; });
+  }
+
+  delete sender;
+  delete receiver;
+
+  int rv = 0;
+  if ((int)received_ids.size() != num_messages) {
+    printf("FAILED: received %zu of %i messages\n", received_ids.size(), num_messages);
+    rv = 1;
+  }
+  for (size_t i = 0; i < received_ids.size(); ++i) {
+    if (received_ids[i] != (int)i) {
+      printf("FAILED: message %zu has ID %i, out of order or duplicate\n", i, received_ids[i]);
+      rv = 1;
+      break;
+    }
+  }
+  if (num_errors > 0) {
+    printf("FAILED: %u errors\n", num_errors);
+    rv = 1;
+  }
+#ifdef __linux__
+  printf("%u sendmmsg() calls, %u partial, %u refused\n",
+	 num_sendmmsg_calls, num_partial_sends, num_refused_sends);
+  if (num_partial_sends == 0 || num_refused_sends == 0) {
+    printf("FAILED: partial sends not exercised\n");
+    rv = 1;
+  }
+#endif
+  if (rv == 0)  printf("All %i messages received in order\n", num_messages);
+
+  // Delete all global objects allocated by libprotobuf
+  google::protobuf::ShutdownProtobufLibrary();
+  return rv;
+}
+
+/// @endcond
@@ -25,12 +25,70 @@
 #include <core/threading/mutex_locker.h>
 #include <utils/time/time.h>
 
+#include <algorithm>
+#include <unordered_map>
+#include <pthread.h>
 #include <string.h>
 
 using namespace std;
 
 namespace fawkes {
 
+/// @cond INTERNALS
+namespace {
+
+/** Registry of interned component names.
+ * IDs are never released, the number of distinct components is small. */
+struct ComponentRegistry {
+  Mutex mutex;
+  unordered_map<string, unsigned int> ids;
+  vector<string> names;
+
+  ComponentRegistry() : names(1) {}
+};
+
+ComponentRegistry &
+component_registry()
+{
+  static ComponentRegistry registry;
+  return registry;
+}
+
+/** Most recently looked up component of the calling thread. */
+thread_local string         cached_component_name;
+thread_local unsigned int   cached_component_id = 0;
+
+template <typename T>
+inline T
+value_at(const vector<T> &v, unsigned int i)
+{
+  return (i < v.size()) ? v[i] : T();
+}
+
+inline void
+ensure_size(vector<unsigned int> &v, unsigned int i)
+{
+  if (v.size() <= i)  v.resize(i + 1, 0);
+}
+
+inline bool
+contains(const vector<unsigned int> &v, unsigned int id)
+{
+  return std::find(v.begin(), v.end(), id) != v.end();
+}
+
+inline bool
+remove(vector<unsigned int> &v, unsigned int id)
+{
+  vector<unsigned int>::iterator it = std::find(v.begin(), v.end(), id);
+  if (it == v.end())  return false;
+  v.erase(it);
+  return true;
+}
+
+} // end anonymous namespace
+/// @endcond
+
 
 /** @class SyncPoint <syncpoint/syncpoint.h>
  * The SyncPoint class.
@@ -42,6 +100,11 @@ namespace fawkes {
  * Thread W wait()s for the SyncPoint to be emitted.
  * Once thread E is done, it emit()s the SyncPoint, which wakes up thread W.
  *
+ * Components are identified by name in the public API. Internally, names
+ * are interned to small integer IDs, which index the per-component state.
+ * Thereby, emit() and wait() do not need to look up or copy strings and
+ * the call history is recorded without locking or allocating memory.
+ *
  * @author Till Hofmann
  * @see SyncPointManager
  */
@@ -58,20 +121,24 @@ namespace fawkes {
 SyncPoint::SyncPoint(string identifier, MultiLogger *logger,
   uint max_waittime_sec /* = 0 */, uint max_waittime_nsec /* = 0 */)
     : identifier_(identifier),
-      emit_calls_(CircularBuffer<SyncPointCall>(1000)),
-      wait_for_one_calls_(CircularBuffer<SyncPointCall>(1000)),
-      wait_for_all_calls_(CircularBuffer<SyncPointCall>(1000)),
+      emit_calls_(1000),
+      wait_for_one_calls_(1000),
+      wait_for_all_calls_(1000),
       creation_time_(Time()),
       mutex_(new Mutex()),
       mutex_next_wait_(new Mutex()),
+      next_wait_locked_(false),
       mutex_wait_for_one_(new Mutex()),
       cond_wait_for_one_(new WaitCondition(mutex_wait_for_one_)),
       mutex_wait_for_all_(new Mutex()),
       cond_wait_for_all_(new WaitCondition(mutex_wait_for_all_)),
       wait_for_all_timer_running_(false),
+      wait_for_all_timer_owner_(0),
       max_waittime_sec_(max_waittime_sec),
       max_waittime_nsec_(max_waittime_nsec),
       logger_(logger),
+      num_pending_(0),
+      emit_locker_(0),
       last_emitter_reset_(Time(0l))
 {
   if (identifier.empty()) {
@@ -155,21 +222,37 @@ SyncPoint::emit(const std::string & component)
 void
 SyncPoint::emit(const std::string & component, bool remove_from_pending)
 {
-  mutex_next_wait_->stopby();
+  emit(component_id(component), component, remove_from_pending);
+}
+
+/** Wake up all components which are waiting for this SyncPoint
+ * @param id The interned ID of the component emitting the SyncPoint
+ * @param component The identifier of the component emitting the SyncPoint
+ * @param remove_from_pending if set to true, the component will be removed
+ *        from the pending emitters for this syncpoint
+ */
+void
+SyncPoint::emit(unsigned int id, const std::string & component,
+  bool remove_from_pending)
+{
+  if (next_wait_locked_) {
+    mutex_next_wait_->stopby();
+  }
   MutexLocker ml(mutex_);
-  if (!watchers_.count(component)) {
+  if (!value_at(watching_, id)) {
     throw SyncPointNonWatcherCalledEmitException(component.c_str(),
         get_identifier().c_str());
   }
 
-  // unlock all wait_for_one waiters
-  watchers_wait_for_one_.clear();
-  mutex_wait_for_one_->lock();
-  cond_wait_for_one_->wake_all();
-  mutex_wait_for_one_->unlock();
-
+  // unlock all wait_for_one waiters, if there are any
+  if (!watchers_wait_for_one_.empty()) {
+    watchers_wait_for_one_.clear();
+    mutex_wait_for_one_->lock();
+    cond_wait_for_one_->wake_all();
+    mutex_wait_for_one_->unlock();
+  }
 
-  if (!emitters_.count(component)) {
+  if (!value_at(emitter_count_, id)) {
     throw SyncPointNonEmitterCalledEmitException(component.c_str(),
       get_identifier().c_str());
   }
@@ -180,31 +263,31 @@ SyncPoint::emit(const std::string & component, bool remove_from_pending)
    * 2. only erase the component once; it may be registered multiple times
    */
   bool pred_remove_from_pending = false;
-  if (remove_from_pending) {
-    multiset<string>::iterator it_pending = pending_emitters_.find(component);
-    if (it_pending != pending_emitters_.end()) {
-      pending_emitters_.erase(it_pending);
-      if (predecessor_) {
-        if (last_emitter_reset_ <= predecessor_->last_emitter_reset_) {
-          pred_remove_from_pending = true;
-        }
+  if (remove_from_pending && is_pending(id)) {
+    pending_count_[id]--;
+    num_pending_--;
+    if (predecessor_) {
+      if (last_emitter_reset_ <= predecessor_->last_emitter_reset_) {
+        pred_remove_from_pending = true;
       }
+    }
 
-      // unlock all wait_for_all waiters if all pending emitters have emitted
-      if (pending_emitters_.empty()) {
+    // unlock all wait_for_all waiters if all pending emitters have emitted
+    if (num_pending_ == 0) {
+      if (!watchers_wait_for_all_.empty()) {
         watchers_wait_for_all_.clear();
         mutex_wait_for_all_->lock();
         cond_wait_for_all_->wake_all();
         mutex_wait_for_all_->unlock();
-        reset_emitters();
       }
+      reset_emitters();
     }
   }
 
-  emit_calls_.push_back(SyncPointCall(component));
+  emit_calls_.record(id, Time());
 
   if (predecessor_) {
-    predecessor_->emit(component, pred_remove_from_pending);
+    predecessor_->emit(id, component, pred_remove_from_pending);
   }
 }
 
@@ -237,14 +320,15 @@ SyncPoint::wait(const std::string & component,
   uint wait_nsec /* = 0 */)
 {
 
+  const unsigned int id = component_id(component);
   MutexLocker ml(mutex_);
 
-  std::set<std::string> *watchers;
+  std::vector<unsigned int> *watchers;
   WaitCondition *cond;
-  CircularBuffer<SyncPointCall> *calls;
+  SyncPointCallHistory *calls;
   Mutex *mutex_cond;
   bool *timer_running;
-  string *timer_owner;
+  unsigned int *timer_owner;
   // set watchers, cond and calls depending of the Wakeup type
   if (type == WAIT_FOR_ONE) {
     watchers = &watchers_wait_for_one_;
@@ -264,11 +348,11 @@ SyncPoint::wait(const std::string & component,
   }
 
   // check if calling component is registered for this SyncPoint
-  if (!watchers_.count(component)) {
+  if (!value_at(watching_, id)) {
     throw SyncPointNonWatcherCalledWaitException(component.c_str(), get_identifier().c_str());
   }
   // check if calling component is not already waiting
-  if (watchers->count(component)) {
+  if (contains(*watchers, id)) {
     throw SyncPointMultipleWaitCallsException(component.c_str(), get_identifier().c_str());
   }
 
@@ -278,7 +362,7 @@ SyncPoint::wait(const std::string & component,
    */
   bool need_to_wait = !emitters_.empty() || type == WAIT_FOR_ONE;
   if (need_to_wait) {
-    watchers->insert(component);
+    watchers->push_back(id);
   }
 
   /* Check if emitters are currently waiting for this component.
@@ -288,9 +372,10 @@ SyncPoint::wait(const std::string & component,
    */
   Time start;
   mutex_cond->lock();
-  if (emit_locker_ == component) {
+  if (emit_locker_ == id) {
+    emit_locker_ = 0;
+    next_wait_locked_ = false;
     mutex_next_wait_->unlock();
-    emit_locker_ = "";
   }
   if (need_to_wait) {
     if (type == WAIT_FOR_ONE) {
@@ -312,7 +397,7 @@ SyncPoint::wait(const std::string & component,
         pthread_cleanup_pop(1);
       } else {
         *timer_running = true;
-        *timer_owner = component;
+        *timer_owner = id;
         if (wait_sec != 0 || wait_nsec != 0) {
           max_waittime_sec_ = wait_sec;
           max_waittime_nsec_ = wait_nsec;
@@ -339,8 +424,7 @@ SyncPoint::wait(const std::string & component,
     mutex_cond->unlock();
   }
   Time wait_time = Time() - start;
-  ml.relock();
-  calls->push_back(SyncPointCall(component, start, wait_time));
+  calls->record(id, start, wait_time.in_usec());
 }
 
 /** Wait for a single emitter.
@@ -393,10 +477,11 @@ SyncPoint::reltime_wait_for_all(const string & component, uint wait_sec,
 void
 SyncPoint::unwait(const string & component)
 {
+  const unsigned int id = component_id(component);
   MutexLocker ml(mutex_);
-  watchers_wait_for_one_.erase(component);
-  watchers_wait_for_all_.erase(component);
-  if (wait_for_all_timer_owner_ == component) {
+  remove(watchers_wait_for_one_, id);
+  remove(watchers_wait_for_all_, id);
+  if (wait_for_all_timer_owner_ == id) {
     // TODO: this lets the other waiting components wait indefinitely, even on
     // a timed wait.
     wait_for_all_timer_running_ = false;
@@ -416,7 +501,8 @@ SyncPoint::lock_until_next_wait(const string & component)
 {
   MutexLocker ml(mutex_);
   if (mutex_next_wait_->try_lock()) {
-    emit_locker_ = component;
+    emit_locker_ = component_id(component);
+    next_wait_locked_ = true;
   } else {
     logger_->log_warn("SyncPoints", "%s tried to call lock_until_next_wait, "
         "but another component already did the same. Ignoring.",
@@ -431,9 +517,14 @@ SyncPoint::lock_until_next_wait(const string & component)
 void
 SyncPoint::register_emitter(const string & component)
 {
+  const unsigned int id = component_id(component);
   MutexLocker ml(mutex_);
   emitters_.insert(component);
-  pending_emitters_.insert(component);
+  ensure_size(emitter_count_, id);
+  ensure_size(pending_count_, id);
+  emitter_count_[id]++;
+  pending_count_[id]++;
+  num_pending_++;
   if (predecessor_) {
     predecessor_->register_emitter(component);
   }
@@ -453,8 +544,9 @@ SyncPoint::unregister_emitter(const string & component, bool emit_if_pending) {
 	  // component is not an emitter
 	  return;
   }
+  const unsigned int id = component_id(component);
   MutexLocker ml(mutex_);
-  if (emit_if_pending && is_pending(component)) {
+  if (emit_if_pending && is_pending(id)) {
     ml.unlock();
     emit(component);
     ml.relock();
@@ -462,6 +554,7 @@ SyncPoint::unregister_emitter(const string & component, bool emit_if_pending) {
 
   // erase a single element from the set of emitters
   emitters_.erase(it_emitter);
+  emitter_count_[id]--;
   if (predecessor_) {
     // never emit the predecessor if it's pending; it is already emitted above
     predecessor_->unregister_emitter(component, false);
@@ -497,10 +590,26 @@ SyncPoint::is_watcher(const string & component) const {
 pair<set<string>::iterator,bool>
 SyncPoint::add_watcher(string watcher)
 {
+  const unsigned int id = component_id(watcher);
   MutexLocker ml(mutex_);
+  if (watching_.size() <= id)  watching_.resize(id + 1, false);
+  watching_[id] = true;
   return watchers_.insert(watcher);
 }
 
+/** Remove a watcher from the watch list
+ *  @param watcher the watcher to remove
+ *  @return true if the watcher was removed, false if it was not watching
+ */
+bool
+SyncPoint::remove_watcher(const std::string & watcher)
+{
+  const unsigned int id = component_id(watcher);
+  MutexLocker ml(mutex_);
+  if (id < watching_.size())  watching_[id] = false;
+  return watchers_.erase(watcher) > 0;
+}
+
 /**
  * @return all watchers of the SyncPoint
  */
@@ -516,11 +625,10 @@ SyncPoint::get_watchers() const {
  */
 CircularBuffer<SyncPointCall>
 SyncPoint::get_wait_calls(WakeupType type /* = WAIT_FOR_ONE */) const {
-  MutexLocker ml(mutex_);
   if (type == WAIT_FOR_ONE) {
-    return wait_for_one_calls_;
+    return wait_for_one_calls_.get_calls();
   } else if (type == WAIT_FOR_ALL) {
-    return wait_for_all_calls_;
+    return wait_for_all_calls_.get_calls();
   } else {
     throw SyncPointInvalidTypeException();
   }
@@ -540,8 +648,7 @@ SyncPoint::get_emitters() const
  */
 CircularBuffer<SyncPointCall>
 SyncPoint::get_emit_calls() const {
-  MutexLocker ml(mutex_);
-  return emit_calls_;
+  return emit_calls_.get_calls();
 }
 
 /**
@@ -555,24 +662,69 @@ SyncPoint::watcher_is_waiting(std::string watcher, WakeupType type) const
 {
   switch (type) {
     case SyncPoint::WAIT_FOR_ONE:
-      return watchers_wait_for_one_.count(watcher);
+      return contains(watchers_wait_for_one_, component_id(watcher));
     case SyncPoint::WAIT_FOR_ALL:
-      return watchers_wait_for_all_.count(watcher);
+      return contains(watchers_wait_for_all_, component_id(watcher));
     default:
       throw Exception("Unknown watch type %u for syncpoint %s",
                       type, identifier_);
   }
 }
 
+/** Get the interned ID of a component.
+ * The ID is assigned on the first call for the given name and stays valid for
+ * the lifetime of the process. IDs are never 0.
+ * @param component the name of the component
+ * @return the ID of the component
+ */
+unsigned int
+SyncPoint::component_id(const std::string & component)
+{
+  if (cached_component_id != 0 && cached_component_name == component) {
+    return cached_component_id;
+  }
+  ComponentRegistry &registry = component_registry();
+  MutexLocker ml(&registry.mutex);
+  unordered_map<string, unsigned int>::iterator it = registry.ids.find(component);
+  unsigned int id;
+  if (it != registry.ids.end()) {
+    id = it->second;
+  } else {
+    id = registry.names.size();
+    registry.names.push_back(component);
+    registry.ids[component] = id;
+  }
+  ml.unlock();
+  cached_component_name = component;
+  cached_component_id = id;
+  return id;
+}
+
+/** Get the name of an interned component.
+ * @param component_id the ID of the component as returned by component_id()
+ * @return the name of the component, empty string if the ID is unknown
+ */
+std::string
+SyncPoint::component_name(unsigned int component_id)
+{
+  ComponentRegistry &registry = component_registry();
+  MutexLocker ml(&registry.mutex);
+  if (component_id < registry.names.size()) {
+    return registry.names[component_id];
+  }
+  return "";
+}
+
 void
 SyncPoint::reset_emitters() {
   last_emitter_reset_ = Time();
-  pending_emitters_ = emitters_;
+  pending_count_ = emitter_count_;
+  num_pending_ = emitters_.size();
 }
 
 bool
-SyncPoint::is_pending(string component) {
-  return pending_emitters_.count(component) > 0;
+SyncPoint::is_pending(unsigned int id) const {
+  return value_at(pending_count_, id) > 0;
 }
 
 void
@@ -583,7 +735,11 @@ SyncPoint::handle_default(string component, WakeupType type)
       "Time limit: %f sec.",
       get_identifier().c_str(),
       max_waittime_sec_ + static_cast<float>(max_waittime_nsec_)/1000000000.f);
-  bad_components_.insert(pending_emitters_.begin(), pending_emitters_.end());
+  for (unsigned int id = 0; id < pending_count_.size(); id++) {
+    if (pending_count_[id] > 0) {
+      bad_components_.insert(component_name(id));
+    }
+  }
   if (bad_components_.size() > 1) {
     string bad_components_string = "";
     for (set<string>::const_iterator it = bad_components_.begin();
@@ -603,8 +759,9 @@ SyncPoint::handle_default(string component, WakeupType type)
         component.c_str());
   }
 
-  watchers_wait_for_all_.erase(component);
-  watchers_wait_for_one_.erase(component);
+  const unsigned int id = component_id(component);
+  remove(watchers_wait_for_all_, id);
+  remove(watchers_wait_for_one_, id);
 }
 
 void
@@ -24,6 +24,7 @@
 
 #include <interface/interface.h>
 #include <syncpoint/syncpoint_call.h>
+#include <syncpoint/syncpoint_call_history.h>
 #include <core/threading/mutex.h>
 #include <core/threading/wait_condition.h>
 #include <utils/time/time.h>
@@ -36,6 +37,8 @@
 #include <set>
 #include <map>
 #include <string>
+#include <vector>
+#include <atomic>
 
 namespace fawkes {
 
@@ -102,6 +105,9 @@ class SyncPoint
     CircularBuffer<SyncPointCall> get_emit_calls() const;
     bool watcher_is_waiting(std::string watcher, WakeupType type) const;
 
+    static unsigned int component_id(const std::string & component);
+    static std::string component_name(unsigned int component_id);
+
 
     /**
      * allow Syncpoint Manager to edit
@@ -110,6 +116,7 @@ class SyncPoint
 
   protected:
     std::pair<std::set<std::string>::iterator,bool> add_watcher(std::string watcher);
+    bool remove_watcher(const std::string & watcher);
     /** send a signal to all waiting threads */
     virtual void emit(const std::string & component, bool remove_from_pending);
 
@@ -118,17 +125,17 @@ class SyncPoint
     const std::string identifier_;
     /** Set of all components which use this SyncPoint */
     std::set<std::string> watchers_;
-    /** Set of all components which are currently waiting for a single emitter */
-    std::set<std::string> watchers_wait_for_one_;
-    /** Set of all components which are currently waiting on the barrier */
-    std::set<std::string> watchers_wait_for_all_;
-
-    /** A buffer of the most recent emit calls. */
-    CircularBuffer<SyncPointCall> emit_calls_;
-    /** A buffer of the most recent wait calls of type WAIT_FOR_ONE. */
-    CircularBuffer<SyncPointCall> wait_for_one_calls_;
-    /** A buffer of the most recent wait calls of type WAIT_FOR_ALL. */
-    CircularBuffer<SyncPointCall> wait_for_all_calls_;
+    /** IDs of all components which are currently waiting for a single emitter */
+    std::vector<unsigned int> watchers_wait_for_one_;
+    /** IDs of all components which are currently waiting on the barrier */
+    std::vector<unsigned int> watchers_wait_for_all_;
+
+    /** A history of the most recent emit calls. */
+    SyncPointCallHistory emit_calls_;
+    /** A history of the most recent wait calls of type WAIT_FOR_ONE. */
+    SyncPointCallHistory wait_for_one_calls_;
+    /** A history of the most recent wait calls of type WAIT_FOR_ALL. */
+    SyncPointCallHistory wait_for_all_calls_;
     /** Time when this SyncPoint was created */
     const Time creation_time_;
 
@@ -136,6 +143,8 @@ class SyncPoint
     Mutex *mutex_;
     /** Mutex used to allow lock_until_next_wait */
     Mutex *mutex_next_wait_;
+    /** true while mutex_next_wait_ is locked by lock_until_next_wait */
+    std::atomic<bool> next_wait_locked_;
     /** Mutex used for cond_wait_for_one_ */
     Mutex *mutex_wait_for_one_;
     /** WaitCondition which is used for wait_for_one() */
@@ -146,8 +155,8 @@ class SyncPoint
     WaitCondition *cond_wait_for_all_;
     /** true if the wait for all timer is running */
     bool wait_for_all_timer_running_;
-    /** the component that started the wait-for-all timer */
-    std::string wait_for_all_timer_owner_;
+    /** ID of the component that started the wait-for-all timer */
+    unsigned int wait_for_all_timer_owner_;
     /** maximum waiting time in secs */
     uint max_waittime_sec_;
     /** maximum waiting time in nsecs */
@@ -157,8 +166,10 @@ class SyncPoint
     MultiLogger *logger_;
 
   private:
+    void emit(unsigned int id, const std::string & component,
+      bool remove_from_pending);
     void reset_emitters();
-    bool is_pending(std::string component);
+    bool is_pending(unsigned int id) const;
     void handle_default(std::string component, WakeupType type);
     void cleanup();
 
@@ -172,11 +183,18 @@ class SyncPoint
     std::set<RefPtr<SyncPoint>, SyncPointSetLessThan > successors_;
 
     std::multiset<std::string> emitters_;
-    std::multiset<std::string> pending_emitters_;
+
+    /* Hot path state indexed by interned component ID: whether the component
+     * is a watcher, how often it registered as emitter, and how often it still
+     * needs to emit until the barrier is complete */
+    std::vector<bool> watching_;
+    std::vector<unsigned int> emitter_count_;
+    std::vector<unsigned int> pending_count_;
+    unsigned int num_pending_;
 
     std::set<std::string> bad_components_;
 
-    std::string emit_locker_;
+    unsigned int emit_locker_;
 
     Time last_emitter_reset_;
 };
@@ -0,0 +1,108 @@
+/***************************************************************************
+ *  syncpoint_call_history.cpp - Lock-free history of SyncPoint calls
+ *
+ *  Created: Wed Oct 21 10:41:12 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#include <syncpoint/syncpoint_call_history.h>
+#include <syncpoint/syncpoint.h>
+
+namespace fawkes {
+
+/** @class SyncPointCallHistory <syncpoint/syncpoint_call_history.h>
+ * A fixed-size history of the most recent calls to a SyncPoint.
+ * Recording a call neither locks nor allocates memory, it only stores the
+ * interned component ID and the timestamps in a preallocated ring. Each
+ * entry is guarded by a sequence number, entries which are overwritten
+ * while a copy of the history is created are skipped.
+ * @author agent
+ * @see SyncPoint
+ * @see SyncPointCall
+ */
+
+/** Constructor.
+ * @param size the maximum number of calls to keep
+ */
+SyncPointCallHistory::SyncPointCallHistory(unsigned int size)
+  : size_(size),
+    entries_(new Entry[size]),
+    next_(0)
+{
+  for (unsigned int i = 0; i < size_; i++) {
+    entries_[i].seq = 0;
+  }
+}
+
+/** Destructor. */
+SyncPointCallHistory::~SyncPointCallHistory()
+{
+  delete[] entries_;
+}
+
+/** Record a call.
+ * This may be called concurrently by multiple threads.
+ * @param component_id the interned ID of the calling component
+ * @param call_time the time of the call
+ * @param wait_usec the time in microseconds the caller had to wait
+ */
+void
+SyncPointCallHistory::record(unsigned int component_id, const Time &call_time,
+  long wait_usec)
+{
+  unsigned long n = next_.fetch_add(1, std::memory_order_relaxed);
+  Entry &e = entries_[n % size_];
+  // odd sequence numbers mark an entry which is currently written
+  e.seq.store(2 * n + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  e.component_id.store(component_id, std::memory_order_relaxed);
+  e.call_sec.store(call_time.get_sec(), std::memory_order_relaxed);
+  e.call_usec.store(call_time.get_usec(), std::memory_order_relaxed);
+  e.wait_usec.store(wait_usec, std::memory_order_relaxed);
+  e.seq.store(2 * n + 2, std::memory_order_release);
+}
+
+/** Get the recorded calls.
+ * @return a buffer with the recorded calls, oldest call first
+ */
+CircularBuffer<SyncPointCall>
+SyncPointCallHistory::get_calls() const
+{
+  CircularBuffer<SyncPointCall> calls(size_);
+  unsigned long end = next_.load(std::memory_order_acquire);
+  unsigned long begin = (end > size_) ? end - size_ : 0;
+  for (unsigned long n = begin; n < end; n++) {
+    const Entry &e = entries_[n % size_];
+    if (e.seq.load(std::memory_order_acquire) != 2 * n + 2) {
+      continue;
+    }
+    unsigned int component_id = e.component_id.load(std::memory_order_relaxed);
+    long call_sec  = e.call_sec.load(std::memory_order_relaxed);
+    long call_usec = e.call_usec.load(std::memory_order_relaxed);
+    long wait_usec = e.wait_usec.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (e.seq.load(std::memory_order_relaxed) != 2 * n + 2) {
+      continue;
+    }
+    calls.push_back(SyncPointCall(SyncPoint::component_name(component_id),
+      Time(call_sec, call_usec),
+      Time(wait_usec / 1000000, wait_usec % 1000000)));
+  }
+  return calls;
+}
+
+} // namespace fawkes
@@ -0,0 +1,61 @@
+/***************************************************************************
+ *  syncpoint_call_history.h - Lock-free history of SyncPoint calls
+ *
+ *  Created: Wed Oct 21 10:41:12 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#ifndef _SYNCPOINT_SYNCPOINT_CALL_HISTORY_H_
+#define _SYNCPOINT_SYNCPOINT_CALL_HISTORY_H_
+
+#include <syncpoint/syncpoint_call.h>
+#include <core/utils/circular_buffer.h>
+
+#include <atomic>
+
+namespace fawkes {
+
+class SyncPointCallHistory
+{
+  public:
+    SyncPointCallHistory(unsigned int size);
+    ~SyncPointCallHistory();
+
+    void record(unsigned int component_id, const Time &call_time,
+      long wait_usec = 0);
+    CircularBuffer<SyncPointCall> get_calls() const;
+
+  private:
+    SyncPointCallHistory(const SyncPointCallHistory &other);
+    SyncPointCallHistory & operator=(const SyncPointCallHistory &other);
+
+    struct Entry {
+      std::atomic<unsigned long> seq;
+      std::atomic<unsigned int>  component_id;
+      std::atomic<long>          call_sec;
+      std::atomic<long>          call_usec;
+      std::atomic<long>          wait_usec;
+    };
+
+    const unsigned int size_;
+    Entry *entries_;
+    std::atomic<unsigned long> next_;
+};
+
+} // namespace fawkes
+
+#endif
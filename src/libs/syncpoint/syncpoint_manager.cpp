@@ -180,7 +180,7 @@ SyncPointManager::release_syncpoint_no_lock(const std::string & component,
     return;
   }
   (*sp_it)->unwait(component);
-  if (!(*sp_it)->watchers_.erase(component)) {
+  if (!(*sp_it)->remove_watcher(component)) {
     throw SyncPointReleasedByNonWatcherException(component.c_str(),
         sync_point->get_identifier().c_str());
   }
@@ -1297,3 +1297,72 @@ TEST_F(SyncPointManagerTest, ReleaseBarrierWaiter)
   sp = manager->get_syncpoint("component 1", "/test");
   EXPECT_NO_THROW(sp->reltime_wait_for_all("component 1", 0, 1000000));
 }
+
+/** struct used for the emit throughput benchmark */
+struct emitter_thread_params {
+    /** SyncPoint to emit */
+    RefPtr<SyncPoint> sp;
+    /** Name of the component */
+    string component;
+    /** Number of emit calls the thread should make */
+    uint num_emits;
+};
+
+/** emit a SyncPoint repeatedly */
+void * start_emitter_thread(void * data) {
+  emitter_thread_params *params = (emitter_thread_params *)data;
+  for (uint i = 0; i < params->num_emits; i++) {
+    params->sp->emit(params->component);
+  }
+  pthread_exit(NULL);
+}
+
+/** Benchmark the emit throughput of multiple emitters on a SyncPoint with
+ *  predecessors, i.e., every emit call also emits three more SyncPoints.
+ *  Also check that the call history is complete and bounded.
+ */
+TEST_F(SyncPointManagerTest, EmitThroughput)
+{
+  const uint num_threads = 4;
+  const uint num_emits = 100000;
+  string sp_identifier = "/test/sp/1";
+  pthread_t threads[num_threads];
+  emitter_thread_params params[num_threads];
+  RefPtr<SyncPoint> sp;
+  for (uint i = 0; i < num_threads; i++) {
+    char *comp;
+    asprintf(&comp, "emitter %u", i);
+    params[i].component = comp;
+    free(comp);
+    params[i].num_emits = num_emits;
+    params[i].sp = manager->get_syncpoint(params[i].component, sp_identifier);
+    params[i].sp->register_emitter(params[i].component);
+    sp = params[i].sp;
+  }
+
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (uint i = 0; i < num_threads; i++) {
+    pthread_create(&threads[i], &attrs, start_emitter_thread, &params[i]);
+  }
+  for (uint i = 0; i < num_threads; i++) {
+    ASSERT_EQ(0, pthread_join(threads[i], NULL));
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double duration = (end.tv_sec - start.tv_sec)
+    + (end.tv_nsec - start.tv_nsec) / 1000000000.;
+  printf("%u threads emitted %u times each in %f sec (%.0f emits/sec)\n",
+    num_threads, num_emits, duration, num_threads * num_emits / duration);
+
+  CircularBuffer<SyncPointCall> calls = sp->get_emit_calls();
+  EXPECT_EQ(1000u, calls.size());
+  for (CircularBuffer<SyncPointCall>::const_iterator it = calls.begin();
+      it != calls.end(); it++) {
+    EXPECT_EQ(0u, it->get_caller().compare(0, 8, "emitter "));
+  }
+
+  for (uint i = 0; i < num_threads; i++) {
+    params[i].sp->unregister_emitter(params[i].component, false);
+    manager->release_syncpoint(params[i].component, params[i].sp);
+  }
+}
@@ -0,0 +1,118 @@
+
+/***************************************************************************
+ *  qa_clock_bench.cpp - Benchmark for Clock time retrieval
+ *
+ *  Created: Sun Oct 18 11:02:45 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+/// @cond QA
+
+// Measures the cost of the different ways to get the current time and
+// checks that the monotonic clock never goes backwards.
+
+#include <utils/time/clock.h>
+#include <utils/time/time.h>
+#include <utils/time/wait.h>
+
+#include <cstdio>
+#include <cstdlib>
+
+using namespace fawkes;
+
+#define NUM_CALLS 2000000
+
+static volatile long sink = 0;
+
+static void
+print_result(const char *what, long long start_nsec)
+{
+  double duration = Clock::monotonic_nsec() - start_nsec;
+  printf("%-24s %7.1f ns per call\n", what, duration / NUM_CALLS);
+}
+
+int
+main(int argc, char **argv)
+{
+  Clock *clock = Clock::instance();
+  long long start;
+  int rv = 0;
+
+  start = Clock::monotonic_nsec();
+  for (unsigned int i = 0; i < NUM_CALLS; ++i) {
+    sink += clock->now().get_usec();
+  }
+  print_result("Clock::now()", start);
+
+  Time t(clock);
+  start = Clock::monotonic_nsec();
+  for (unsigned int i = 0; i < NUM_CALLS; ++i) {
+    clock->get_time(t);
+    sink += t.get_usec();
+  }
+  print_result("Clock::get_time()", start);
+
+  start = Clock::monotonic_nsec();
+  for (unsigned int i = 0; i < NUM_CALLS; ++i) {
+    t.stamp_systime();
+    sink += t.get_usec();
+  }
+  print_result("Time::stamp_systime()", start);
+
+  timeval tv;
+  start = Clock::monotonic_nsec();
+  for (unsigned int i = 0; i < NUM_CALLS; ++i) {
+    Clock::get_monotonic(&tv);
+    sink += tv.tv_usec;
+  }
+  print_result("Clock::get_monotonic()", start);
+
+  long long last = Clock::monotonic_nsec();
+  start = last;
+  for (unsigned int i = 0; i < NUM_CALLS; ++i) {
+    long long now = Clock::monotonic_nsec();
+    if (now < last) {
+      printf("FAILED: monotonic clock went backwards by %lld ns\n", last - now);
+      rv = 1;
+    }
+    last = now;
+  }
+  print_result("Clock::monotonic_nsec()", start);
+
+  start = Clock::monotonic_nsec();
+  for (unsigned int i = 0; i < NUM_CALLS; ++i) {
+    Time copy(t);
+    sink += copy.get_usec();
+  }
+  print_result("Time copy", start);
+
+  start = Clock::monotonic_nsec();
+  TimeWait::wait_systime(20000);
+  long long waited = Clock::monotonic_nsec() - start;
+  printf("TimeWait::wait_systime(20 ms) waited %.2f ms\n", waited / 1000000.);
+  if (waited < 20000000LL) {
+    printf("FAILED: waited less than requested\n");
+    rv = 2;
+  }
+
+  Clock::finalize();
+  if (rv == 0)  printf("PASSED\n");
+  return rv;
+}
+
+/// @endcond
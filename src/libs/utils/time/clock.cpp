@@ -27,6 +27,7 @@
 #include <core/exception.h>
 
 #include <cstdlib>
+#include <ctime>
 
 namespace fawkes {
 
@@ -35,6 +36,14 @@ namespace fawkes {
  * It is implemented as a singleton to ensure that there is only
  * one object. So-called TimeSources can be registered at the Clock
  * their current time can be retrieved through the Clock.
+ *
+ * Besides the system and external time the clock provides access to the
+ * monotonic system clock. It is not affected by changes of the system
+ * time, e.g. by NTP, and should be used to measure durations and for
+ * timeouts. Its values are only meaningful relative to each other. They
+ * are therefore not available through the time source selector and must
+ * not be stored in a Time, which would mix them with system or external
+ * time stamps.
  * @author Daniel Beck, Tim Niemueller
  */
 
@@ -262,14 +271,44 @@ Clock::get_systime(Time *time) const
 }
 
 
+/** Get the monotonic system time.
+ * The time is measured from an unspecified starting point, usually the
+ * system boot. On Linux this is read through the vDSO without a system call.
+ * The result is truncated to microseconds, use monotonic_nsec() for the
+ * full resolution. Do not assign the result to a Time.
+ * @param tv upon return contains the monotonic time
+ */
+void
+Clock::get_monotonic(struct timeval *tv)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  tv->tv_sec  = ts.tv_sec;
+  tv->tv_usec = ts.tv_nsec / 1000;
+}
+
+
+/** Get the monotonic system time in nanoseconds.
+ * @return nanoseconds since an unspecified starting point
+ * @see get_monotonic()
+ */
+long long
+Clock::monotonic_nsec()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
 /** Get the current time.
  * @return current time
  */
 Time
 Clock::now() const
 {
-  Time t(_instance);
-  return t.stamp();
+  // the constructor already reads the current time
+  return Time(_instance);
 }
 
 
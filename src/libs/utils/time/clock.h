@@ -68,6 +68,9 @@ class Clock
   void get_systime(Time &time) const;
   void get_systime(Time *time) const;
 
+  static void      get_monotonic(struct timeval *tv);
+  static long long monotonic_nsec();
+
   Time  now() const;
   float elapsed(Time *t) const;
   float sys_elapsed(Time *t) const;
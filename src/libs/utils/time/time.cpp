@@ -50,6 +50,15 @@ const Time TIME_MIN = Time(0, 1);
 
 /** @class Time <utils/time/time.h>
  * A class for handling time.
+ * The time is stored as plain timeval. Creating, copying and assigning
+ * times does not allocate memory, only str() allocates a buffer for the
+ * string representation on first use. The buffer is not shared with copies.
+ *
+ * A time holds a system or external clock time stamp with microsecond
+ * resolution, get_nsec() is derived from it. Readings of the monotonic
+ * clock have a different starting point and are not stored in a Time,
+ * durations with nanosecond resolution are taken with
+ * Clock::monotonic_nsec() instead.
  * @author Daniel Beck
  * @author Tim Niemueller
  *
@@ -186,12 +195,7 @@ Time::Time(const Time &t)
   time_.tv_sec  = t.time_.tv_sec;
   time_.tv_usec = t.time_.tv_usec;
   clock_        = t.clock_;
-  if (t.timestr_) {
-    timestr_ = (char *)malloc(TIMESTR_SIZE);
-    strncpy(timestr_, t.timestr_, TIMESTR_SIZE);
-  } else {
-    timestr_ = NULL;
-  }
+  timestr_      = NULL;
 }
 
 
@@ -203,12 +207,7 @@ Time::Time(const Time *t)
   time_.tv_sec  = t->time_.tv_sec;
   time_.tv_usec = t->time_.tv_usec;
   clock_        = t->clock_;
-  if (t->timestr_) {
-    timestr_ = (char *)malloc(TIMESTR_SIZE);
-    strncpy(timestr_, t->timestr_, TIMESTR_SIZE);
-  } else {
-    timestr_ = NULL;
-  }
+  timestr_      = NULL;
 }
 
 
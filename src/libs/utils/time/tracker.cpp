@@ -22,6 +22,7 @@
  */
 
 #include <utils/time/tracker.h>
+#include <utils/time/clock.h>
 #include <core/exceptions/software.h>
 #include <core/exceptions/system.h>
 
@@ -53,6 +54,9 @@ namespace fawkes {
  * a specific point in time and then stop it after the sub-task is done to measure
  * only this very task. This can be done by using pingStart() and pingEnd().
  *
+ * Times are taken from the monotonic system clock, measurements are therefore
+ * not disturbed by changes of the system time.
+ *
  * @author Tim Niemueller
  */
 
@@ -121,8 +125,9 @@ TimeTracker::reset(std::string comment)
   }
   times_.clear();
   comments_.clear();
-  gettimeofday(&start_time, NULL);
-  gettimeofday(&last_time, NULL);
+  Clock::get_monotonic(&start_time);
+  Clock::get_monotonic(&last_time);
+  gettimeofday(&start_systime, NULL);
 }
 
 
@@ -135,7 +140,7 @@ void
 TimeTracker::ping(std::string comment)
 {
   timeval *t = (timeval *)malloc(sizeof(timeval));
-  gettimeofday(t, NULL);
+  Clock::get_monotonic(t);
   times_.push_back(t);
   if (!comment.empty()) {
     comments_[ times_.size() - 1 ] = comment;
@@ -191,7 +196,7 @@ void
 TimeTracker::ping(unsigned int cls)
 {
   timeval *t = (timeval *)malloc(sizeof(timeval));
-  gettimeofday(t, NULL);
+  Clock::get_monotonic(t);
 
   long sec  = t->tv_sec - last_time.tv_sec;
   long usec = t->tv_usec - last_time.tv_usec;
@@ -227,7 +232,7 @@ TimeTracker::ping_start(unsigned int cls)
   if (cls >= class_times_.size()) return;
 
   timeval *t = (timeval *)malloc(sizeof(timeval));
-  gettimeofday(t, NULL);
+  Clock::get_monotonic(t);
 
   if (cls < class_times_.size()) {
     class_times_[cls].push_back(t);
@@ -253,7 +258,7 @@ TimeTracker::ping_end(unsigned int cls)
   if (cls >= class_times_.size()) return;
 
   timeval t2;
-  gettimeofday(&t2, NULL);
+  Clock::get_monotonic(&t2);
 
   timeval *t1 = class_times_[cls].back();
 
@@ -327,7 +332,7 @@ TimeTracker::print_to_stdout()
     suseconds_t last_usec = start_time.tv_usec;
     char time_string[26];
 
-    ctime_r(&(start_time.tv_sec), time_string);
+    ctime_r(&(start_systime.tv_sec), time_string);
     for (j = 26; j > 0; --j) {
       if (time_string[j] == '\n') {
 	time_string[j] = 0;
@@ -341,7 +346,7 @@ TimeTracker::print_to_stdout()
     }
     cout << endl
 	 << "==================================================================" << endl
-	 << "Initialized: " << time_string << " (" << start_time.tv_sec << ")" << endl << endl;
+	 << "Initialized: " << time_string << " (" << start_systime.tv_sec << ")" << endl << endl;
 
     for (time_it_ = times_.begin(); time_it_ != times_.end(); ++time_it_) {
       char tmp[10];
@@ -371,14 +376,17 @@ TimeTracker::print_to_stdout()
       last_sec  = (*time_it_)->tv_sec;
       last_usec = (*time_it_)->tv_usec;
 
-      ctime_r(&(*time_it_)->tv_sec, time_string);
+      // monotonic times are printed as system time relative to the start
+      time_t systime_sec = start_systime.tv_sec + diff_sec_start +
+	(start_systime.tv_usec + diff_usec_start) / 1000000;
+      ctime_r(&systime_sec, time_string);
       for (j = 26; j > 0; --j) {
 	if (time_string[j] == '\n') {
 	  time_string[j] = 0;
 	  break;
 	}
       }
-      cout << time_string << " (" << (*time_it_)->tv_sec << ")" << endl;
+      cout << time_string << " (" << systime_sec << ")" << endl;
       cout << "Diff to start: " << diff_sec_start << " sec and " << diff_usec_start
 	   << " usec  (which are "
 	   << diff_msec_start << " msec)" << endl;
@@ -61,6 +61,7 @@ class TimeTracker {
 
  private:
   timeval start_time;
+  timeval start_systime;
   timeval last_time;
   std::vector<std::vector<struct timeval *> >    class_times_;
   std::vector<std::string>                       class_names_;
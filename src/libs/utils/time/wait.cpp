@@ -37,8 +37,10 @@ namespace fawkes {
  * methods) or it can be used to reach a desired minimum loop time. For this instantiate
  * the class and call mark_start() at the beginning of the loop and wait() at the end.
  * wait() will then suspend the thread as long as needed to have the desired minimum
- * loop time. The TimeWait utility will use the current clock time. Thus it may wait
- * for a given amount of say simulated time.
+ * loop time. If an external time source is the clock's default the TimeWait utility
+ * will use the current clock time. Thus it may wait for a given amount of say
+ * simulated time. Otherwise, and always for the *_systime() methods, the monotonic
+ * system clock is used, waiting is then not affected by changes of the system time.
  * @author Tim Niemueller
  */
 
@@ -51,8 +53,9 @@ TimeWait::TimeWait(Clock *clock, long int desired_loop_time_usec)
   desired_loop_time_ = desired_loop_time_usec;
   clock_ = clock;
   until_ = new Time();
-  until_systime_ = new Time();
   now_ = new Time();
+  until_monotonic_ = 0;
+  use_clock_ = false;
 }
 
 
@@ -60,7 +63,6 @@ TimeWait::TimeWait(Clock *clock, long int desired_loop_time_usec)
 TimeWait::~TimeWait()
 {
   delete until_;
-  delete until_systime_;
   delete now_;
 }
 
@@ -69,10 +71,12 @@ TimeWait::~TimeWait()
 void
 TimeWait::mark_start()
 {
-  clock_->get_time(until_);
-  *until_ += desired_loop_time_;
-  clock_->get_systime(until_systime_);
-  *until_systime_ += desired_loop_time_;
+  use_clock_ = clock_->is_ext_default_timesource();
+  if (use_clock_) {
+    clock_->get_time(until_);
+    *until_ += desired_loop_time_;
+  }
+  until_monotonic_ = Clock::monotonic_nsec() + desired_loop_time_ * 1000LL;
 }
 
 
@@ -80,6 +84,11 @@ TimeWait::mark_start()
 void
 TimeWait::wait()
 {
+  if (! use_clock_) {
+    wait_monotonic_until(until_monotonic_);
+    return;
+  }
+
   clock_->get_time(now_);
   // we want to release run status at least shortly
   usleep(0);
@@ -99,15 +108,23 @@ TimeWait::wait()
 void
 TimeWait::wait_systime()
 {
-  clock_->get_systime(now_);
+  wait_monotonic_until(until_monotonic_);
+}
+
+
+/** Wait until the monotonic clock reached the given time.
+ * @param until_nsec monotonic time in nanoseconds to wait for
+ */
+void
+TimeWait::wait_monotonic_until(long long until_nsec)
+{
   // we want to release run status at least shortly
   usleep(0);
 
-  long int remaining_usec = (*until_systime_ - *now_).in_usec();
-  while ( remaining_usec > 0 ) {
-    usleep(remaining_usec);
-    clock_->get_systime(now_);
-    remaining_usec = (*until_systime_ - *now_).in_usec();
+  long long remaining_nsec = until_nsec - Clock::monotonic_nsec();
+  while ( remaining_nsec > 0 ) {
+    usleep((remaining_nsec + 999) / 1000);
+    remaining_nsec = until_nsec - Clock::monotonic_nsec();
   }
 }
 
@@ -115,20 +132,18 @@ TimeWait::wait_systime()
 /** Wait at least usec microseconds.
  * Think of this as an uninterruptible usleep(). This method will not return before
  * *at least* usec microseconds have passed. It may be longer but never less.
- * Time is tracked in system time scale (real time).
+ * Time is tracked with the monotonic system clock (real time).
  * @param usec number of microseconds to wait at least
  */
 void
 TimeWait::wait_systime(long int usec)
 {
   if ( usec < 0 ) return;
-  struct timeval start, now;
-  long int remaining_usec = usec;
-  gettimeofday(&start, NULL);
+  long long until_nsec = Clock::monotonic_nsec() + usec * 1000LL;
+  long long remaining_nsec = usec * 1000LL;
   do {
-    usleep(remaining_usec);
-    gettimeofday(&now, NULL);
-  } while ((remaining_usec = usec - time_diff_usec(now, start)) > 0);
+    usleep((remaining_nsec + 999) / 1000);
+  } while ((remaining_nsec = until_nsec - Clock::monotonic_nsec()) > 0);
 }
 
 /** Wait at least usec microseconds.
@@ -137,6 +152,7 @@ TimeWait::wait_systime(long int usec)
  * Time is tracked in the current Clock time scale. This may be simulated time
  * or real time. It is assumed that the (simulated time) is at worst slower, but never
  * faster than real time. Thus 1 microsecond real time is at least 1 microsecond clock time.
+ * Without an external default time source this is the same as wait_systime().
  * @param usec number of microseconds to wait at least
  */
 void
@@ -144,6 +160,10 @@ TimeWait::wait(long int usec)
 {
   if ( usec < 0 ) return;
   Clock *clock = Clock::instance();
+  if (! clock->is_ext_default_timesource()) {
+    wait_systime(usec);
+    return;
+  }
   struct timeval start, now;
   long int remaining_usec = usec;
   clock->get_time(&start);
@@ -41,11 +41,15 @@ class TimeWait {
   static void wait(long int usec);
   static void wait_systime(long int usec);
 
+ private:
+  static void wait_monotonic_until(long long until_nsec);
+
  private:
   Clock *clock_;
   Time  *until_;
-  Time  *until_systime_;
   Time  *now_;
+  long long until_monotonic_;
+  bool      use_clock_;
   long int desired_loop_time_;
 };
 
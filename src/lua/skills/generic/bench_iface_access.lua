@@ -0,0 +1,99 @@
+
+----------------------------------------------------------------------------
+--  bench_iface_access.lua - Benchmark interface data access from Lua
+--
+--  Created: Sun Oct 18 15:21:07 2026
+--  Copyright  2026  agent
+--
+----------------------------------------------------------------------------
+
+--  This program is free software; you can redistribute it and/or modify
+--  it under the terms of the GNU General Public License as published by
+--  the Free Software Foundation; either version 2 of the License, or
+--  (at your option) any later version.
+--
+--  This program is distributed in the hope that it will be useful,
+--  but WITHOUT ANY WARRANTY; without even the implied warranty of
+--  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+--  GNU Library General Public License for more details.
+--
+--  Read the full text in the LICENSE.GPL file in the doc directory.
+
+-- Initialize module
+module(..., skillenv.module_init)
+
+-- Crucial skill information
+name               = "bench_iface_access"
+fsm                = SkillHSM:new{name=name, start="BENCH"}
+depends_skills     = nil
+depends_interfaces = {
+   {v = "laser", type = "Laser1080Interface", id = "Laser urg"}
+}
+
+documentation      = [==[Benchmark reading interface data from Lua.
+Reads all beams of a laser interface through the tolua++ accessors and,
+when running on LuaJIT, through the FFI data pointer and prints the time
+per scan for both. Both methods must yield the same sum of distances.
+
+bench_iface_access{runs=100}
+
+Parameters:
+runs: number of times to read the full scan, defaults to 100
+]==]
+
+-- Initialize as skill module
+skillenv.skill_module(_M)
+
+local NUM_BEAMS = 1080
+
+local function bench(runs, read_scan)
+   local start = fawkes.Time:new()
+   local sum = 0
+   for r = 1, runs do
+      sum = read_scan()
+   end
+   local duration = fawkes.Time:new() - start
+   return duration * 1000. / runs, sum
+end
+
+fsm:define_states{ export_to=_M,
+   closure={laser=laser},
+   {"BENCH", JumpState},
+}
+
+fsm:add_transitions{
+   {"BENCH", "FAILED", precond="not laser:has_writer()", desc="no laser writer"},
+   {"BENCH", "FAILED", cond="vars.mismatch", desc="results differ"},
+   {"BENCH", "FINAL", cond=true}
+}
+
+function BENCH:init()
+   local runs = self.fsm.vars.runs or 100
+
+   local tolua_msec, tolua_sum = bench(runs, function ()
+      local sum = 0
+      for i = 0, NUM_BEAMS - 1 do
+         sum = sum + laser:distances(i)
+      end
+      return sum
+   end)
+   printf("tolua++: %8.3f ms per scan (sum %f)", tolua_msec, tolua_sum)
+
+   if laser.ffi_data then
+      local data = laser:ffi_data()
+      local ffi_msec, ffi_sum = bench(runs, function ()
+         local sum = 0
+         for i = 0, NUM_BEAMS - 1 do
+            sum = sum + data.distances[i]
+         end
+         return sum
+      end)
+      printf("FFI:     %8.3f ms per scan (sum %f, %.1fx faster)",
+             ffi_msec, ffi_sum, tolua_msec / ffi_msec)
+      -- invalid beams may be NaN, then both sums are NaN
+      local both_nan = (ffi_sum ~= ffi_sum) and (tolua_sum ~= tolua_sum)
+      self.fsm.vars.mismatch = (ffi_sum ~= tolua_sum) and not both_nan
+   else
+      printf("FFI:     not available, not running on LuaJIT")
+   end
+end
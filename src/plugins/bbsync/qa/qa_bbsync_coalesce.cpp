@@ -0,0 +1,183 @@
+/***************************************************************************
+ *  qa_bbsync_coalesce.cpp - QA for coalesced BlackBoard synchronization
+ *
+ *  Created: Mon Oct 19 16:12:40 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+/// @cond QA
+
+#include "../sync_listener.h"
+
+#include <blackboard/local.h>
+#include <blackboard/bbconfig.h>
+#include <interfaces/TestInterface.h>
+#include <logging/console.h>
+#include <core/exception.h>
+
+#include <cstdio>
+
+using namespace fawkes;
+
+#define NUM_CHANGES 100
+
+/* Source interface written on one blackboard, mirrored by the listener
+ * into a target interface on another blackboard. */
+class SyncSetup
+{
+ public:
+  SyncSetup(Logger *logger, bool coalesce)
+  {
+    src_bb = new LocalBlackBoard(BLACKBOARD_MEMSIZE);
+    dst_bb = new LocalBlackBoard(BLACKBOARD_MEMSIZE);
+    src_writer = src_bb->open_for_writing<TestInterface>("qa");
+    src_reader = src_bb->open_for_reading<TestInterface>("qa");
+    dst_writer = dst_bb->open_for_writing<TestInterface>("qa");
+    dst_reader = dst_bb->open_for_reading<TestInterface>("qa");
+    listener = new SyncInterfaceListener(logger, src_reader, dst_writer,
+					 src_bb, dst_bb, coalesce);
+    // discard the initial copy made by the constructor
+    SyncInterfaceListener::Stats stats = SyncInterfaceListener::Stats();
+    listener->collect_stats(stats);
+  }
+
+  ~SyncSetup()
+  {
+    delete listener;
+    dst_bb->close(dst_reader);
+    dst_bb->close(dst_writer);
+    src_bb->close(src_reader);
+    src_bb->close(src_writer);
+    delete dst_bb;
+    delete src_bb;
+  }
+
+  void write_changes(unsigned int n)
+  {
+    for (unsigned int i = 1; i <= n; ++i) {
+      src_writer->set_test_int(i);
+      src_writer->write();
+    }
+  }
+
+  bool check_stats(unsigned long long sent, unsigned long long dropped)
+  {
+    SyncInterfaceListener::Stats stats = SyncInterfaceListener::Stats();
+    listener->collect_stats(stats);
+    if ((stats.updates_sent != sent) || (stats.updates_dropped != dropped)) {
+      printf("%llu updates sent and %llu dropped, expected %llu and %llu\n",
+	     stats.updates_sent, stats.updates_dropped, sent, dropped);
+      return false;
+    }
+    if (stats.latency_count != sent) {
+      printf("%llu latencies for %llu updates\n", stats.latency_count, sent);
+      return false;
+    }
+    return true;
+  }
+
+  bool check_value(int expected)
+  {
+    dst_reader->read();
+    if (dst_reader->test_int() != expected) {
+      printf("Mirrored value is %i, expected %i\n", dst_reader->test_int(), expected);
+      return false;
+    }
+    return true;
+  }
+
+  BlackBoard            *src_bb;
+  BlackBoard            *dst_bb;
+  TestInterface         *src_writer;
+  TestInterface         *src_reader;
+  TestInterface         *dst_writer;
+  TestInterface         *dst_reader;
+  SyncInterfaceListener *listener;
+};
+
+
+/* N changes within one cycle are mirrored as one update with the latest
+ * data, the other N - 1 are counted as dropped. */
+static bool
+test_coalesce(Logger *logger)
+{
+  SyncSetup s(logger, true);
+  bool success = true;
+
+  s.write_changes(NUM_CHANGES);
+  if (! s.check_value(0))  success = false;
+
+  s.listener->flush();
+  if (! s.check_stats(1, NUM_CHANGES - 1))  success = false;
+  if (! s.check_value(NUM_CHANGES))  success = false;
+
+  // nothing changed, nothing to mirror
+  s.listener->flush();
+  if (! s.check_stats(0, 0))  success = false;
+
+  // a single change in the next cycle is not dropped
+  s.src_writer->set_test_int(-1);
+  s.src_writer->write();
+  s.listener->flush();
+  if (! s.check_stats(1, 0))  success = false;
+  if (! s.check_value(-1))  success = false;
+
+  return success;
+}
+
+
+/* Without coalescing every change is mirrored right away. */
+static bool
+test_immediate(Logger *logger)
+{
+  SyncSetup s(logger, false);
+  bool success = true;
+
+  s.write_changes(NUM_CHANGES);
+  if (! s.check_value(NUM_CHANGES))  success = false;
+  s.listener->flush();
+  if (! s.check_stats(NUM_CHANGES, 0))  success = false;
+
+  return success;
+}
+
+
+int
+main(int argc, char **argv)
+{
+  ConsoleLogger logger;
+  bool success = true;
+  try {
+    if (! test_coalesce(&logger)) {
+      printf("FAILED coalescing changes within one cycle\n");
+      success = false;
+    }
+    if (! test_immediate(&logger)) {
+      printf("FAILED immediate mirroring\n");
+      success = false;
+    }
+  } catch (Exception &e) {
+    printf("FAILED, exception:\n");
+    e.print_trace();
+    success = false;
+  }
+
+  if (success)  printf("PASSED\n");
+  return success ? 0 : 1;
+}
+
+/// @endcond
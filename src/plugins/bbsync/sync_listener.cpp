@@ -23,8 +23,12 @@
 #include "sync_listener.h"
 
 #include <blackboard/blackboard.h>
+#include <core/threading/mutex.h>
+#include <core/threading/mutex_locker.h>
 #include <logging/logger.h>
 
+#include <cstring>
+
 using namespace fawkes;
 
 /** @class SyncInterfaceListener "sync_listener.h"
@@ -32,6 +36,12 @@ using namespace fawkes;
  * This class synchronizes two interfaces, a reading and a writing instance
  * of the same type. To accomplish this it listens for data changed and message
  * events and forwards them as appropriate to "the other side".
+ *
+ * In coalescing mode a data change only marks the listener as dirty. The
+ * data is mirrored once when flush() is called, all changes in between are
+ * combined into a single update. This bounds the rate at which updates are
+ * sent to a peer independent of the rate at which the interface is written.
+ * Messages are always forwarded immediately.
  * @author Tim Niemueller
  */
 
@@ -45,12 +55,15 @@ using namespace fawkes;
  * created on
  * @param writer_bb the BlackBoard instance the writing instance has been
  * created on
+ * @param coalesce true to mirror data only on flush(), false to mirror
+ * every change immediately
  */
 SyncInterfaceListener::SyncInterfaceListener(fawkes::Logger *logger,
 					     fawkes::Interface *reader,
 					     fawkes::Interface *writer,
 					     fawkes::BlackBoard *reader_bb,
-					     fawkes::BlackBoard *writer_bb)
+					     fawkes::BlackBoard *writer_bb,
+					     bool coalesce)
   : BlackBoardInterfaceListener("SyncInterfaceListener(%s-%s)", writer->uid(), reader->id())
 {
   logger_    = logger;
@@ -58,10 +71,15 @@ SyncInterfaceListener::SyncInterfaceListener(fawkes::Logger *logger,
   writer_    = writer;
   reader_bb_ = reader_bb;
   writer_bb_ = writer_bb;
+  coalesce_  = coalesce;
+  mutex_     = new Mutex();
+  dirty_     = true;
+  memset(&stats_, 0, sizeof(stats_));
 
   bbil_add_data_interface(reader_);
   bbil_add_message_interface(writer_);
-  bb_interface_data_changed(reader_);
+  // initial copy, later updates are triggered by data changes
+  flush();
 
   reader_bb_->register_listener(this, BlackBoard::BBIL_FLAG_DATA);
   writer_bb_->register_listener(this, BlackBoard::BBIL_FLAG_MESSAGES);
@@ -73,6 +91,62 @@ SyncInterfaceListener::~SyncInterfaceListener()
 {
   reader_bb_->unregister_listener(this);
   writer_bb_->unregister_listener(this);
+  delete mutex_;
+}
+
+
+/** Mirror pending data change.
+ * Copies the data of the reading instance to the writing instance if it
+ * changed since the last call. In coalescing mode this must be called
+ * periodically, otherwise it is a no-op after construction.
+ */
+void
+SyncInterfaceListener::flush()
+{
+  MutexLocker lock(mutex_);
+  if (! dirty_)  return;
+  dirty_ = false;
+  fawkes::Time first_change(first_change_);
+  lock.unlock();
+
+  try {
+    reader_->read();
+    writer_->copy_values(reader_);
+    writer_->write();
+  } catch (Exception &e) {
+    logger_->log_error(bbil_name(), "Exception when mirroring data");
+    logger_->log_error(bbil_name(), e);
+    return;
+  }
+
+  fawkes::Time now;
+  double latency = now - &first_change;
+  lock.relock();
+  stats_.updates_sent += 1;
+  stats_.bytes_sent   += writer_->datasize();
+  stats_.latency_count += 1;
+  stats_.latency_sum  += latency;
+  if (latency > stats_.latency_max)  stats_.latency_max = latency;
+}
+
+
+/** Collect statistics.
+ * Adds the statistics gathered since the last call to the given struct
+ * and resets them. For the latency the maximum is merged.
+ * @param stats statistics to add to
+ */
+void
+SyncInterfaceListener::collect_stats(Stats &stats)
+{
+  MutexLocker lock(mutex_);
+  stats.updates_sent       += stats_.updates_sent;
+  stats.updates_dropped    += stats_.updates_dropped;
+  stats.messages_forwarded += stats_.messages_forwarded;
+  stats.bytes_sent         += stats_.bytes_sent;
+  stats.latency_count      += stats_.latency_count;
+  stats.latency_sum        += stats_.latency_sum;
+  if (stats_.latency_max > stats.latency_max)  stats.latency_max = stats_.latency_max;
+  memset(&stats_, 0, sizeof(stats_));
 }
 
 
@@ -88,6 +162,10 @@ SyncInterfaceListener::bb_interface_message_received(Interface *interface,
       m->ref();
       reader_->msgq_enqueue(m);
       message->set_id(m->id());
+      mutex_->lock();
+      stats_.messages_forwarded += 1;
+      stats_.bytes_sent         += m->datasize();
+      mutex_->unlock();
       m->unref();
       return false;
     } else {
@@ -106,18 +184,19 @@ SyncInterfaceListener::bb_interface_message_received(Interface *interface,
 void
 SyncInterfaceListener::bb_interface_data_changed(Interface *interface) throw()
 {
-  try {
-    if ( interface == reader_ ) {
-      //logger_->log_debug(bbil_name(), "Copying data");
-      reader_->read();
-      writer_->copy_values(reader_);
-      writer_->write();
+  if ( interface == reader_ ) {
+    MutexLocker lock(mutex_);
+    if (dirty_) {
+      // an earlier change has not been mirrored, yet, it is superseded
+      stats_.updates_dropped += 1;
     } else {
-      // Don't know why we were called, let 'em enqueue
-      logger_->log_error(bbil_name(), "Data changed for unknown interface");
+      dirty_ = true;
+      first_change_.stamp();
     }
-  } catch (Exception &e) {
-    logger_->log_error(bbil_name(), "Exception when data changed");
-    logger_->log_error(bbil_name(), e);
+    lock.unlock();
+    if (! coalesce_)  flush();
+  } else {
+    // Don't know why we were called, let 'em enqueue
+    logger_->log_error(bbil_name(), "Data changed for unknown interface");
   }
 }
@@ -24,21 +24,38 @@
 #define _PLUGINS_BBSYNC_SYNC_LISTENER_H_
 
 #include <blackboard/interface_listener.h>
+#include <utils/time/time.h>
 
 namespace fawkes {
   class BlackBoard;
   class Logger;
+  class Mutex;
 }
 
 class SyncInterfaceListener
 : public fawkes::BlackBoardInterfaceListener
 {
  public:
+  /** Synchronization statistics. */
+  typedef struct {
+    unsigned long long updates_sent;		/**< data updates written */
+    unsigned long long updates_dropped;	/**< coalesced data updates */
+    unsigned long long messages_forwarded;	/**< messages forwarded */
+    unsigned long long bytes_sent;		/**< data and message bytes */
+    unsigned long long latency_count;	/**< updates in latency_sum */
+    double             latency_sum;		/**< sum of update latencies; sec */
+    double             latency_max;		/**< maximum update latency; sec */
+  } Stats;
+
   SyncInterfaceListener(fawkes::Logger *logger,
 			fawkes::Interface *reader, fawkes::Interface *writer,
-			fawkes::BlackBoard *reader_bb, fawkes::BlackBoard *writer_bb);
+			fawkes::BlackBoard *reader_bb, fawkes::BlackBoard *writer_bb,
+			bool coalesce = false);
   virtual ~SyncInterfaceListener();
 
+  void flush();
+  void collect_stats(Stats &stats);
+
   virtual bool bb_interface_message_received(fawkes::Interface *interface, fawkes::Message *message) throw();
   virtual void bb_interface_data_changed(fawkes::Interface *interface) throw();
 
@@ -50,6 +67,12 @@ class SyncInterfaceListener
 
   fawkes::BlackBoard *writer_bb_;
   fawkes::BlackBoard *reader_bb_;
+
+  bool                coalesce_;
+  fawkes::Mutex      *mutex_;
+  bool                dirty_;
+  fawkes::Time        first_change_;
+  Stats               stats_;
 };
 
 
@@ -23,16 +23,31 @@
 #include "sync_thread.h"
 
 #include <blackboard/remote.h>
+#include <core/threading/mutex.h>
 #include <core/threading/mutex_locker.h>
 #include <utils/time/wait.h>
+#include <interfaces/BBSyncLinkInterface.h>
 
+#include <algorithm>
+#include <cmath>
 #include <cstring>
+#include <vector>
 
 using namespace std;
 using namespace fawkes;
 
+/// @cond INTERNALS
+/** Interval in which link statistics are published; msec. */
+#define STATS_INTERVAL 1000
+/// @endcond
+
 /** @class BlackBoardSynchronizationThread "sync_thread.h"
  * Thread to synchronize two BlackBoards.
+ * If a sync rate is configured, data changes are coalesced and mirrored
+ * at most at that rate. The data of all interfaces which changed during a
+ * cycle is then written in one go, the updates are sent to the peer in a
+ * single batch. Statistics of the link are published in a
+ * BBSyncLinkInterface with the ID "BBSync <peer>".
  * @author Tim Niemueller
  */
 
@@ -54,37 +69,50 @@ BlackBoardSynchronizationThread::BlackBoardSynchronizationThread(std::string &bb
   peer_cfg_prefix_   = peer_cfg_prefix;
   peer_              = peer;
 
-  remote_bb_ = NULL;
+  remote_bb_   = NULL;
+  flush_mutex_ = new Mutex();
 }
 
 
 /** Destructor. */
 BlackBoardSynchronizationThread::~BlackBoardSynchronizationThread()
 {
+  delete flush_mutex_;
 }
 
 void
 BlackBoardSynchronizationThread::init()
 {
   logger->log_debug(name(), "Initializing");
-  unsigned int check_interval = 0;
+  check_interval_ = 0;
   try {
     host_ = config->get_string((peer_cfg_prefix_ + "host").c_str());
     port_ = config->get_uint((peer_cfg_prefix_ + "port").c_str());
 
-    check_interval = config->get_uint((bbsync_cfg_prefix_ + "check_interval").c_str());
+    check_interval_ = config->get_uint((bbsync_cfg_prefix_ + "check_interval").c_str());
   } catch (Exception &e) {
     e.append("Host or port not specified for peer");
     throw;
   }
 
   try {
-    check_interval = config->get_uint((peer_cfg_prefix_ + "check_interval").c_str());
+    check_interval_ = config->get_uint((peer_cfg_prefix_ + "check_interval").c_str());
     logger->log_debug(name(), "Peer check interval set, overriding default.");
   } catch (Exception &e) {
     logger->log_debug(name(), "No per-peer check interval set, using default");
   }
 
+  sync_rate_ = 0.;
+  try {
+    sync_rate_ = config->get_float((bbsync_cfg_prefix_ + "sync_rate").c_str());
+  } catch (Exception &e) {} // ignore, we stick with the default
+  try {
+    sync_rate_ = config->get_float((peer_cfg_prefix_ + "sync_rate").c_str());
+  } catch (Exception &e) {} // ignore, we stick with the default
+  if (sync_rate_ < 0.) {
+    throw Exception("Invalid sync rate %f for peer %s", sync_rate_, peer_.c_str());
+  }
+
   read_config_combos(peer_cfg_prefix_ + "reading/", /* writing */ false);
   read_config_combos(peer_cfg_prefix_ + "writing/", /* writing */ true);
 
@@ -97,12 +125,27 @@ BlackBoardSynchronizationThread::init()
   wsl_local_  = new SyncWriterInterfaceListener(this, logger, (peer_ + "/local").c_str());
   wsl_remote_ = new SyncWriterInterfaceListener(this, logger, (peer_ + "/remote").c_str());
 
+  memset(&stats_, 0, sizeof(stats_));
+  link_if_ = blackboard->open_for_writing<BBSyncLinkInterface>(("BBSync " + peer_).c_str());
+  link_if_->set_peer(peer_.c_str());
+  link_if_->set_sync_rate(sync_rate_);
+  link_if_->write();
+
   if (! check_connection()) {
     logger->log_warn(name(), "Remote peer not reachable, will keep trying");
   }
 
-  logger->log_debug(name(), "Checking for remote aliveness every %u ms", check_interval);
-  timewait_ = new TimeWait(clock, check_interval * 1000);
+  if (sync_rate_ > 0.) {
+    logger->log_debug(name(), "Mirroring changes at %.1f Hz", sync_rate_);
+    loop_usec_ = (long int)roundf(1000000. / sync_rate_);
+  } else {
+    loop_usec_ = std::min(check_interval_, (unsigned int)STATS_INTERVAL) * 1000;
+  }
+
+  logger->log_debug(name(), "Checking for remote aliveness every %u ms", check_interval_);
+  timewait_   = new TimeWait(clock, loop_usec_);
+  last_check_ = new Time(clock);
+  last_stats_ = new Time(clock);
 }
 
 
@@ -111,8 +154,11 @@ BlackBoardSynchronizationThread::finalize()
 {
 
   delete timewait_;
+  delete last_check_;
+  delete last_stats_;
 
   close_interfaces();
+  blackboard->close(link_if_);
 
   delete wsl_local_;
   delete wsl_remote_;
@@ -125,11 +171,81 @@ void
 BlackBoardSynchronizationThread::loop()
 {
   timewait_->mark_start();
-  check_connection();
+
+  if (sync_rate_ > 0.)  flush_listeners();
+
+  // allow for half a cycle of jitter, the loop might wake up slightly early
+  Time now(clock);
+  double slack_msec = loop_usec_ / 2000.;
+  if ((now - last_check_) * 1000. + slack_msec >= check_interval_) {
+    check_connection();
+    *last_check_ = now;
+  }
+  if ((now - last_stats_) * 1000. + slack_msec >= STATS_INTERVAL) {
+    publish_stats();
+    *last_stats_ = now;
+  }
+
   timewait_->wait_systime();
 }
 
 
+/** Mirror all pending changes.
+ * The listeners are copied out so that the interfaces lock is not held
+ * while writing to the remote blackboard. The flush mutex keeps
+ * writer_removed() from deleting a listener in the meantime.
+ */
+void
+BlackBoardSynchronizationThread::flush_listeners()
+{
+  MutexLocker flush_lock(flush_mutex_);
+
+  std::vector<SyncInterfaceListener *> pending;
+  interfaces_.lock();
+  SyncListenerMap::iterator s;
+  for (s = sync_listeners_.begin(); s != sync_listeners_.end(); ++s) {
+    if (s->second)  pending.push_back(s->second);
+  }
+  interfaces_.unlock();
+
+  std::vector<SyncInterfaceListener *>::iterator p;
+  for (p = pending.begin(); p != pending.end(); ++p) {
+    (*p)->flush();
+  }
+}
+
+
+/** Collect listener statistics and write them to the link interface. */
+void
+BlackBoardSynchronizationThread::publish_stats()
+{
+  MutexLocker lock(interfaces_.mutex());
+  SyncListenerMap::iterator s;
+  for (s = sync_listeners_.begin(); s != sync_listeners_.end(); ++s) {
+    if (s->second)  s->second->collect_stats(stats_);
+  }
+  SyncInterfaceListener::Stats stats = stats_;
+  // latencies are reported per period, counters are accumulated
+  stats_.latency_count = 0;
+  stats_.latency_sum   = 0.;
+  stats_.latency_max   = 0.;
+  lock.unlock();
+
+  link_if_->set_connected(remote_bb_ && remote_bb_->is_alive());
+  link_if_->set_updates_sent(stats.updates_sent);
+  link_if_->set_updates_dropped(stats.updates_dropped);
+  link_if_->set_messages_forwarded(stats.messages_forwarded);
+  link_if_->set_bytes_sent(stats.bytes_sent);
+  if (stats.latency_count > 0) {
+    link_if_->set_latency_avg(stats.latency_sum / stats.latency_count);
+  } else {
+    link_if_->set_latency_avg(0.);
+  }
+  link_if_->set_latency_max(stats.latency_max);
+  link_if_->write();
+}
+
+
 bool
 BlackBoardSynchronizationThread::check_connection()
 {
@@ -240,7 +356,7 @@ BlackBoardSynchronizationThread::open_interfaces()
     if (iface_writer) {
       logger->log_debug(name(), "Creating sync listener");
       sync_listener = new SyncInterfaceListener(logger, iface_reader, iface_writer,
-						reader_bb, writer_bb);
+						reader_bb, writer_bb, sync_rate_ > 0.);
     }
     sync_listeners_[iface_reader] = sync_listener;
 
@@ -256,14 +372,15 @@ BlackBoardSynchronizationThread::open_interfaces()
 void
 BlackBoardSynchronizationThread::close_interfaces()
 {
+  MutexLocker lock(interfaces_.mutex());
   SyncListenerMap::iterator s;
   for (s = sync_listeners_.begin(); s != sync_listeners_.end(); ++s) {
     if (s->second) {
       logger->log_debug(name(), "Closing sync listener %s", s->second->bbil_name());
+      s->second->collect_stats(stats_);
       delete s->second;
     }
   }
-  MutexLocker lock(interfaces_.mutex());
   InterfaceMap::iterator i;
   for (i = interfaces_.begin(); i != interfaces_.end(); ++i) {
     logger->log_debug(name(), "Closing %s reading interface %s",
@@ -319,7 +436,7 @@ BlackBoardSynchronizationThread::writer_added(fawkes::Interface *interface) thro
 			ii.combo->writer_id.c_str());
 
       sync_listener = new SyncInterfaceListener(logger, interface, iface,
-						ii.reader_bb, ii.writer_bb);
+						ii.reader_bb, ii.writer_bb, sync_rate_ > 0.);
 
       sync_listeners_[interface] = sync_listener;
       ii.writer = iface;
@@ -343,6 +460,8 @@ BlackBoardSynchronizationThread::writer_added(fawkes::Interface *interface) thro
 void
 BlackBoardSynchronizationThread::writer_removed(fawkes::Interface *interface) throw()
 {
+  // wait for a running flush, it might use the listener deleted below
+  MutexLocker flush_lock(flush_mutex_);
   MutexLocker lock(interfaces_.mutex());
 
   if (! interfaces_[interface].writer) {
@@ -353,6 +472,7 @@ BlackBoardSynchronizationThread::writer_removed(fawkes::Interface *interface) th
 
     InterfaceInfo &ii = interfaces_[interface];
     try {
+      sync_listeners_[interface]->collect_stats(stats_);
       delete sync_listeners_[interface];
       sync_listeners_[interface] = NULL;
 
@@ -38,7 +38,9 @@
 #include <utility>
 
 namespace fawkes {
+  class Mutex;
   class TimeWait;
+  class BBSyncLinkInterface;
 }
 
 class BlackBoardSynchronizationThread
@@ -125,6 +127,8 @@ class BlackBoardSynchronizationThread
   void read_config_combos(std::string prefix, bool writing);
   void open_interfaces();
   void close_interfaces();
+  void flush_listeners();
+  void publish_stats();
 
  private:
   std::string   bbsync_cfg_prefix_;
@@ -134,7 +138,17 @@ class BlackBoardSynchronizationThread
   std::string   host_;
   unsigned int  port_;
 
+  float         sync_rate_;
+  unsigned int  check_interval_;
+  long int      loop_usec_;
+
+  fawkes::Mutex       *flush_mutex_;
   fawkes::TimeWait    *timewait_;
+  fawkes::Time        *last_check_;
+  fawkes::Time        *last_stats_;
+
+  fawkes::BBSyncLinkInterface *link_if_;
+  SyncInterfaceListener::Stats stats_;
 
   fawkes::BlackBoard  *remote_bb_;
 
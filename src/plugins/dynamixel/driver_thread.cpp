@@ -38,6 +38,11 @@
 #include <algorithm>
 #include <cstring>
 
+/// @cond INTERNALS
+/** Interval in seconds at which the cycle time is reported. */
+#define CYCLE_REPORT_INTERVAL_SEC 10.
+/// @endcond
+
 using namespace fawkes;
 
 /** @class DynamixelDriverThread "driver_thread.h"
@@ -200,6 +205,11 @@ DynamixelDriverThread::init()
     }
   }
 
+  cycle_time_sum_ = 0.;
+  cycle_time_max_ = 0.;
+  num_cycles_     = 0;
+  last_cycle_report_.stamp();
+
   blackboard->register_listener(this);
 }
 
@@ -762,83 +772,80 @@ DynamixelDriverThread::has_fresh_data()
 void
 DynamixelDriverThread::loop()
 {
+  fawkes::Time cycle_start;
+
+  // Gather all pending commands and send them with one SYNC_WRITE
+  // packet per register for all servos, see DynamixelChain::flush_queued_values()
   for (auto &sp : servos_) {
     unsigned int servo_id = sp.first;
     Servo &s = sp.second;
-    if (s.enable) {
-      s.value_rwlock->lock_for_write();
-      s.enable  = false;
-      s.value_rwlock->unlock();
-      ScopedRWLock lock(chain_rwlock_);
-      chain_->set_led_enabled(servo_id, true);
-      chain_->set_torque_enabled(servo_id, true);
-      if (s.led_enable || s.led_disable || s.velo_pending || s.move_pending || s.mode_set_pending || s.recover_pending) usleep(3000);
-    } else if (s.disable) {
-      s.value_rwlock->lock_for_write();
-      s.disable = false;
-      s.value_rwlock->unlock();
-      ScopedRWLock lock(chain_rwlock_);
-      chain_->set_torque_enabled(servo_id, false);
-      if (s.led_enable || s.led_disable || s.velo_pending || s.move_pending || s.mode_set_pending || s.recover_pending) usleep(3000);
+
+    s.value_rwlock->lock_for_write();
+    bool enable = s.enable, disable = s.disable;
+    bool led_enable = s.led_enable, led_disable = s.led_disable;
+    bool velo_pending = s.velo_pending, move_pending = s.move_pending;
+    bool recover_pending = s.recover_pending;
+    unsigned int vel = s.vel, torque_limit = s.torque_limit;
+    float target_angle = s.target_angle;
+    s.enable = s.disable = s.led_enable = s.led_disable = false;
+    s.velo_pending = s.move_pending = s.recover_pending = false;
+    s.value_rwlock->unlock();
+
+    ScopedRWLock lock(chain_rwlock_);
+    if (enable) {
+      chain_->queue_table_value(servo_id, DynamixelChain::P_LED, 1);
+      chain_->queue_table_value(servo_id, DynamixelChain::P_TORQUE_ENABLE, 1);
+    } else if (disable) {
+      chain_->queue_table_value(servo_id, DynamixelChain::P_TORQUE_ENABLE, 0);
     }
 
-    if (s.led_enable) {
-      s.value_rwlock->lock_for_write();
-      s.led_enable = false;
-      s.value_rwlock->unlock();    
-      ScopedRWLock lock(chain_rwlock_);
-      chain_->set_led_enabled(servo_id, true);
-      if (s.velo_pending || s.move_pending || s.mode_set_pending || s.recover_pending) usleep(3000);
-    } else if (s.led_disable) {
-      s.value_rwlock->lock_for_write();
-      s.led_disable = false;
-      s.value_rwlock->unlock();    
-      ScopedRWLock lock(chain_rwlock_);
-      chain_->set_led_enabled(servo_id, false);    
-      if (s.velo_pending || s.move_pending || s.mode_set_pending || s.recover_pending) usleep(3000);
+    if (led_enable) {
+      chain_->queue_table_value(servo_id, DynamixelChain::P_LED, 1);
+    } else if (led_disable) {
+      chain_->queue_table_value(servo_id, DynamixelChain::P_LED, 0);
     }
 
-    if (s.velo_pending) {
-      s.value_rwlock->lock_for_write();
-      s.velo_pending = false;
-      unsigned int vel  = s.vel;
-      s.value_rwlock->unlock();
-      ScopedRWLock lock(chain_rwlock_);
-      chain_->set_goal_speed(servo_id, vel);
-      if (s.move_pending || s.mode_set_pending || s.recover_pending) usleep(3000);
+    if (velo_pending) {
+      chain_->queue_table_value(servo_id, DynamixelChain::P_GOAL_SPEED_L, vel, true);
     }
 
-    if (s.move_pending) {
-      s.value_rwlock->lock_for_write();
-      s.move_pending    = false;
-      float target_angle  = s.target_angle;
-      s.value_rwlock->unlock();
+    if (move_pending) {
       exec_goto_angle(servo_id, target_angle);
-      if (s.mode_set_pending || s.recover_pending) usleep(3000);
     }
 
-    if (s.mode_set_pending) {
-      s.value_rwlock->lock_for_write();
-      s.mode_set_pending  = false;
-      exec_set_mode(servo_id, s.new_mode);
-      s.value_rwlock->unlock();
-      if (s.recover_pending) usleep(3000);
+    if (recover_pending) {
+      chain_->queue_table_value(servo_id, DynamixelChain::P_TORQUE_LIMIT_L, torque_limit, true);
     }
+  }
+
+  try {
+    ScopedRWLock lock(chain_rwlock_);
+    if (chain_->has_queued_values())  chain_->flush_queued_values();
+  } catch (Exception &e) {
+    logger->log_warn(name(), "Failed to send commands to servos, exception follows");
+    logger->log_warn(name(), e);
+  }
 
-    if (s.recover_pending) {
+  // Mode changes write the angle limits in the EEPROM area, they are
+  // rare and sent individually after all other commands
+  for (auto &sp : servos_) {
+    Servo &s = sp.second;
+    if (s.mode_set_pending) {
       s.value_rwlock->lock_for_write();
-      s.recover_pending = false;
-      chain_->set_torque_limit(servo_id, s.torque_limit);
+      s.mode_set_pending  = false;
+      exec_set_mode(sp.first, s.new_mode);
       s.value_rwlock->unlock();
     }
+  }
 
+  for (auto &sp : servos_) {
     try {
       ScopedRWLock lock(chain_rwlock_, ScopedRWLock::LOCK_READ);
-      chain_->read_table_values(servo_id);
+      chain_->read_status_values(sp.first);
 
       MutexLocker lock_fresh_data(fresh_data_mutex_);
       fresh_data_ = true;
-      s.time.stamp();
+      sp.second.time.stamp();
     } catch (Exception &e) {
       // usually just a timeout, too noisy
       //logger_->log_warn(name(), "Error while reading table values from servos, exception follows");
@@ -848,12 +855,30 @@ DynamixelDriverThread::loop()
 
   update_waitcond_->wake_all();
 
+  fawkes::Time cycle_end;
+  float cycle_time = cycle_end - &cycle_start;
+  cycle_time_sum_ += cycle_time;
+  cycle_time_max_  = std::max(cycle_time_max_, cycle_time);
+  num_cycles_     += 1;
+  if ((cycle_end - &last_cycle_report_) >= CYCLE_REPORT_INTERVAL_SEC) {
+    float cycle_time_avg = cycle_time_sum_ / num_cycles_;
+    logger->log_debug(name(), "%u servos, cycle time avg %.2f ms, max %.2f ms, "
+		      "achievable control rate %.1f Hz", (unsigned int)servos_.size(),
+		      cycle_time_avg * 1000., cycle_time_max_ * 1000., 1. / cycle_time_avg);
+    last_cycle_report_ = cycle_end;
+    cycle_time_sum_    = 0.;
+    cycle_time_max_    = 0.;
+    num_cycles_        = 0;
+  }
+
   // Wakeup ourselves for faster updates
   wakeup();
 }
 
 
 /** Execute angle motion.
+ * The goal position is queued and sent with the next flush of the chain.
+ * The chain lock must be held for writing.
  * @param angle_rad angle in rad to move to
  */
 void
@@ -871,8 +896,7 @@ DynamixelDriverThread::exec_goto_angle(unsigned int servo_id, float angle_rad)
     return;
   }
 
-  ScopedRWLock lock(chain_rwlock_);
-  chain_->goto_position(servo_id, pos);
+  chain_->queue_table_value(servo_id, DynamixelChain::P_GOAL_POSITION_L, pos, true);
 }
 
 
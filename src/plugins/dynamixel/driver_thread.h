@@ -156,6 +156,11 @@ class DynamixelDriverThread
 
   bool fresh_data_;
   fawkes::Mutex *fresh_data_mutex_;
+
+  fawkes::Time  last_cycle_report_;
+  float         cycle_time_sum_;
+  float         cycle_time_max_;
+  unsigned int  num_cycles_;
 };
 
 #endif
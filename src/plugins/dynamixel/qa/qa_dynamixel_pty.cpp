@@ -0,0 +1,322 @@
+
+/***************************************************************************
+ *  qa_dynamixel_pty.cpp - QA for DynamixelChain on a simulated servo bus
+ *
+ *  Created: Thu Oct 22 14:37:09 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+/// @cond QA
+
+// Simulates a chain of servos on a pseudo terminal and compares the
+// per-servo command/read cycle of the old driver loop with queued
+// SYNC_WRITE commands and status-only reads. The simulation delays each
+// packet by its transmission time at 57600 baud, the resulting cycle
+// times are therefore comparable to a real bus.
+
+#include "../servo_chain.h"
+#include <core/threading/thread.h>
+#include <core/threading/mutex.h>
+#include <core/threading/mutex_locker.h>
+#include <utils/time/time.h>
+
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <poll.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace fawkes;
+
+#define NUM_SERVOS   6
+#define NUM_CYCLES   50
+#define BAUDRATE     57600
+
+class SimulatedServoBus : public Thread
+{
+ public:
+  SimulatedServoBus(int fd)
+    : Thread("SimulatedServoBus", Thread::OPMODE_CONTINUOUS)
+  {
+    fd_ = fd;
+    num_packets_ = 0;
+    memset(table_, 0, sizeof(table_));
+    for (unsigned int id = 1; id <= NUM_SERVOS; ++id) {
+      unsigned char *t = table_[id];
+      t[DynamixelChain::P_MODEL_NUMBER_L]    = 12; // AX-12
+      t[DynamixelChain::P_ID]                = id;
+      t[DynamixelChain::P_CCW_ANGLE_LIMIT_L] = 0xFF;
+      t[DynamixelChain::P_CCW_ANGLE_LIMIT_H] = 0x03;
+      t[DynamixelChain::P_MAX_TORQUE_L]      = 0xFF;
+      t[DynamixelChain::P_MAX_TORQUE_H]      = 0x03;
+      t[DynamixelChain::P_RETURN_LEVEL]      = DynamixelChain::SRL_RESPOND_ALL;
+      t[DynamixelChain::P_PRESENT_VOLTAGE]   = 120;
+      t[DynamixelChain::P_PRESENT_TEMPERATURE] = 40;
+    }
+  }
+
+  virtual void loop()
+  {
+    unsigned char packet[260];
+    if (! read_packet(packet))  return;
+
+    unsigned char id   = packet[2];
+    unsigned char len  = packet[3];
+    unsigned char inst = packet[4];
+    unsigned char *params = &packet[5];
+    unsigned char plength = len - 2;
+
+    MutexLocker lock(&mutex_);
+    ++num_packets_;
+
+    switch (inst) {
+    case 0x01: // PING
+      if (id <= NUM_SERVOS && id > 0)  reply(id, NULL, 0);
+      else if (id == DynamixelChain::BROADCAST_ID) {
+	for (unsigned int i = 1; i <= NUM_SERVOS; ++i)  reply(i, NULL, 0);
+      }
+      break;
+
+    case 0x02: // READ
+      if (id > 0 && id <= NUM_SERVOS)  reply(id, &table_[id][params[0]], params[1]);
+      break;
+
+    case 0x03: // WRITE
+      for (unsigned int i = 1; i <= NUM_SERVOS; ++i) {
+	if ((id == i) || (id == DynamixelChain::BROADCAST_ID)) {
+	  write(i, params[0], &params[1], plength - 1);
+	}
+      }
+      if ((id > 0) && (id <= NUM_SERVOS) &&
+	  (table_[id][DynamixelChain::P_RETURN_LEVEL] == DynamixelChain::SRL_RESPOND_ALL))
+      {
+	reply(id, NULL, 0);
+      }
+      break;
+
+    case 0x83: // SYNC_WRITE
+      {
+	unsigned char addr = params[0], length = params[1];
+	sync_write_addrs_.push_back(addr);
+	for (unsigned int o = 2; o + length < plength; o += length + 1) {
+	  if (params[o] > 0 && params[o] <= NUM_SERVOS) {
+	    write(params[o], addr, &params[o + 1], length);
+	  }
+	}
+      }
+      break;
+    }
+  }
+
+  unsigned int num_packets()
+  {
+    MutexLocker lock(&mutex_);
+    return num_packets_;
+  }
+
+  std::vector<unsigned char> sync_write_addrs()
+  {
+    MutexLocker lock(&mutex_);
+    return sync_write_addrs_;
+  }
+
+  unsigned int value(unsigned char id, unsigned char addr)
+  {
+    MutexLocker lock(&mutex_);
+    return table_[id][addr] | (table_[id][addr + 1] << 8);
+  }
+
+ private:
+  bool read_bytes(unsigned char *buf, unsigned int n)
+  {
+    unsigned int r = 0;
+    while (r < n) {
+      struct pollfd pfd = { fd_, POLLIN, 0 };
+      if (poll(&pfd, 1, 100) <= 0)  return false;
+      ssize_t rv = ::read(fd_, buf + r, n - r);
+      if (rv <= 0)  return false;
+      r += rv;
+    }
+    return true;
+  }
+
+  bool read_packet(unsigned char *packet)
+  {
+    if (! read_bytes(packet, 4))  return false;
+    while ((packet[0] != 0xFF) || (packet[1] != 0xFF)) {
+      memmove(packet, packet + 1, 3);
+      if (! read_bytes(packet + 3, 1))  return false;
+    }
+    if (! read_bytes(packet + 4, packet[3]))  return false;
+    wire_delay(4 + packet[3]);
+    return true;
+  }
+
+  void write(unsigned char id, unsigned char addr, const unsigned char *data, unsigned int n)
+  {
+    for (unsigned int i = 0; i < n && addr + i < DYNAMIXEL_CONTROL_TABLE_LENGTH; ++i) {
+      table_[id][addr + i] = data[i];
+    }
+    // servo reaches its goal immediately
+    table_[id][DynamixelChain::P_PRESENT_POSITION_L] = table_[id][DynamixelChain::P_GOAL_POSITION_L];
+    table_[id][DynamixelChain::P_PRESENT_POSITION_H] = table_[id][DynamixelChain::P_GOAL_POSITION_H];
+  }
+
+  void reply(unsigned char id, const unsigned char *data, unsigned char n)
+  {
+    unsigned char packet[260];
+    packet[0] = 0xFF;
+    packet[1] = 0xFF;
+    packet[2] = id;
+    packet[3] = n + 2;
+    packet[4] = 0; // no error
+    unsigned int checksum = id + n + 2;
+    for (unsigned int i = 0; i < n; ++i) {
+      packet[5 + i] = data[i];
+      checksum += data[i];
+    }
+    packet[5 + n] = ~(checksum & 0xFF);
+    wire_delay(6 + n);
+    if (::write(fd_, packet, 6 + n) != 6 + n) {
+      printf("Simulated bus failed to reply\n");
+    }
+  }
+
+  void wire_delay(unsigned int bytes)
+  {
+    // 8N1: 10 bits per byte
+    usleep(bytes * 10 * 1000000 / BAUDRATE);
+  }
+
+ private:
+  int fd_;
+  Mutex mutex_;
+  unsigned int num_packets_;
+  std::vector<unsigned char> sync_write_addrs_;
+  unsigned char table_[DYNAMIXEL_MAX_NUM_SERVOS][DYNAMIXEL_CONTROL_TABLE_LENGTH];
+};
+
+
+static void
+print_result(const char *what, double duration, unsigned int num_packets)
+{
+  double cycle_time = duration / NUM_CYCLES;
+  printf("%-12s cycle time %6.2f ms, %5.1f Hz, %5.1f packets per cycle\n",
+	 what, cycle_time * 1000., 1. / cycle_time, (float)num_packets / NUM_CYCLES);
+}
+
+
+int
+main(int argc, char **argv)
+{
+  int master = posix_openpt(O_RDWR | O_NOCTTY);
+  if ((master == -1) || (grantpt(master) != 0) || (unlockpt(master) != 0)) {
+    printf("Failed to create pseudo terminal\n");
+    return 1;
+  }
+  struct termios param;
+  tcgetattr(master, &param);
+  cfmakeraw(&param);
+  tcsetattr(master, TCSANOW, &param);
+
+  SimulatedServoBus bus(master);
+  bus.start();
+
+  int rv = 0;
+  try {
+    DynamixelChain chain(ptsname(master), 100);
+    std::vector<unsigned int> servos;
+    for (unsigned int i = 1; i <= NUM_SERVOS; ++i)  servos.push_back(i);
+    DynamixelChain::DeviceList devl = chain.discover(100, servos);
+    printf("Found %zu servos on %s\n", devl.size(), ptsname(master));
+
+    chain.set_status_return_level(DynamixelChain::BROADCAST_ID,
+				  DynamixelChain::SRL_RESPOND_READ);
+
+    // per servo packets, as sent by the driver loop before
+    unsigned int packets_start = bus.num_packets();
+    Time start;
+    for (unsigned int c = 0; c < NUM_CYCLES; ++c) {
+      for (unsigned char id : devl) {
+	chain.set_goal_speed(id, 100 + c);
+	usleep(3000);
+	chain.goto_position(id, 200 + c + id);
+	chain.read_table_values(id);
+      }
+    }
+    print_result("Per servo:", Time() - &start, bus.num_packets() - packets_start);
+
+    // queued and flushed with one SYNC_WRITE per register, the position
+    // is queued first but the speed must still be written before it
+    packets_start = bus.num_packets();
+    start.stamp();
+    for (unsigned int c = 0; c < NUM_CYCLES; ++c) {
+      for (unsigned char id : devl) {
+	chain.queue_table_value(id, DynamixelChain::P_GOAL_POSITION_L, 500 + c + id, true);
+	chain.queue_table_value(id, DynamixelChain::P_GOAL_SPEED_L, 300 + c, true);
+      }
+      chain.flush_queued_values();
+      for (unsigned char id : devl) {
+	chain.read_status_values(id);
+      }
+    }
+    unsigned int num_packets = bus.num_packets() - packets_start;
+    print_result("Batched:", Time() - &start, num_packets);
+
+    if (num_packets != NUM_CYCLES * (2 + devl.size())) {
+      printf("FAILED: expected %zu packets, got %u\n",
+	     NUM_CYCLES * (2 + devl.size()), num_packets);
+      rv = 2;
+    }
+    std::vector<unsigned char> addrs = bus.sync_write_addrs();
+    for (unsigned int i = 0; i + 1 < addrs.size(); i += 2) {
+      if ((addrs[i] != DynamixelChain::P_GOAL_SPEED_L) ||
+	  (addrs[i + 1] != DynamixelChain::P_GOAL_POSITION_L))
+      {
+	printf("FAILED: goal position written before goal speed\n");
+	rv = 4;
+	break;
+      }
+    }
+    for (unsigned char id : devl) {
+      unsigned int goal = 500 + NUM_CYCLES - 1 + id;
+      if ((bus.value(id, DynamixelChain::P_GOAL_POSITION_L) != goal) ||
+	  (bus.value(id, DynamixelChain::P_GOAL_SPEED_L) != 300 + NUM_CYCLES - 1) ||
+	  (chain.get_position(id) != goal) || (chain.get_goal_position(id) != goal))
+      {
+	printf("FAILED: servo %u has wrong values\n", id);
+	rv = 3;
+      }
+    }
+  } catch (Exception &e) {
+    e.print_trace();
+    rv = 1;
+  }
+
+  bus.cancel();
+  bus.join();
+  ::close(master);
+
+  if (rv == 0)  printf("PASSED\n");
+  return rv;
+}
+
+/// @endcond
@@ -37,6 +37,7 @@
 #include <cstring>
 #include <cstdlib>
 #include <cstdarg>
+#include <algorithm>
 
 const unsigned char DynamixelChain::BROADCAST_ID             = 0xfe; /**< BROADCAST_ID */
 const unsigned int  DynamixelChain::MAX_POSITION             = 0x3ff; /**< MAX_POSITION */
@@ -140,6 +141,13 @@ using namespace fawkes;
  * servo_chain->set_status_return_level(DynamixelChain::BROADCAST_ID, DynamixelChain::SRL_RESPOND_READ);
  * @endcode
  *
+ * When controlling several servos at a high rate, queue the values with
+ * queue_table_value() and send them with flush_queued_values(). All queued
+ * values for the same register are sent to all servos with a single
+ * SYNC_WRITE packet, instead of one WRITE packet per servo and register.
+ * Use read_status_values() to only read the volatile part of the control
+ * table.
+ *
  * @author Tim Niemueller
  */
 
@@ -168,6 +176,7 @@ DynamixelChain::DynamixelChain(const char *device_file,
   min_voltage_                 = min_voltage;
   max_voltage_                 = max_voltage;
   memset(control_table_, 0, DYNAMIXEL_MAX_NUM_SERVOS * DYNAMIXEL_CONTROL_TABLE_LENGTH);
+  memset(error_, 0, sizeof(error_));
   try {
     open();
   } catch (Exception &e) {
@@ -458,6 +467,10 @@ DynamixelChain::recv(const unsigned char exp_length, unsigned int timeout_ms)
   }
 
   ibuffer_length_ = plength+2 + 4;
+
+  if (ibuffer_[PACKET_OFFSET_ID] < DYNAMIXEL_MAX_NUM_SERVOS) {
+    error_[ibuffer_[PACKET_OFFSET_ID]] = ibuffer_[PACKET_OFFSET_ERROR];
+  }
 }
 
 
@@ -611,6 +624,23 @@ DynamixelChain::finish_read_table_values()
 }
 
 
+/** Read the volatile table values for given servo.
+ * This reads the RAM area of the control table, starting at P_TORQUE_ENABLE
+ * up to and including P_PUNCH_H. It contains all values which change while
+ * the servo is operating, like the present position, speed, load,
+ * temperature and the torque limit which is reset on an alarm shutdown.
+ * The EEPROM area only changes if written by this class and is therefore
+ * not read again. This transfers about half the data of read_table_values()
+ * and is intended to be called for all servos in every control cycle.
+ * @param id servo ID, not the broadcast ID
+ */
+void
+DynamixelChain::read_status_values(unsigned char id)
+{
+  read_table_value(id, P_TORQUE_ENABLE, P_PUNCH_H - P_TORQUE_ENABLE + 1);
+}
+
+
 /** Read a table value.
  * This will read the given value(s) and write the output to the control table
  * (in memory, not in the servo), such that the appropriate get method will return
@@ -719,6 +749,142 @@ DynamixelChain::write_table_values(unsigned char id, unsigned char start_addr,
 }
 
 
+/** Queue a table value for writing.
+ * The value is not sent immediately, but with the next call to
+ * flush_queued_values(). If a value has already been queued for the same
+ * servo and address it is replaced.
+ * @param id servo ID, not the broadcast ID
+ * @param addr start addr, one of the P_* constants.
+ * @param value value to write
+ * @param double_byte if true, will assume value to be a two-byte value, otherwise
+ * it is considered as a one-byte value.
+ */
+void
+DynamixelChain::queue_table_value(unsigned char id, unsigned char addr,
+				  unsigned int value, bool double_byte)
+{
+  assert_valid_id(id);
+
+  unsigned char length = double_byte ? 2 : 1;
+  for (QueuedValue &q : queued_values_) {
+    if ((q.id == id) && (q.addr == addr) && (q.length == length)) {
+      q.value = value;
+      return;
+    }
+  }
+
+  QueuedValue q;
+  q.id     = id;
+  q.addr   = addr;
+  q.length = length;
+  q.value  = value;
+  queued_values_.push_back(q);
+}
+
+
+/** Check if values are queued for writing.
+ * @return true if flush_queued_values() would send data, false otherwise
+ */
+bool
+DynamixelChain::has_queued_values() const
+{
+  return ! queued_values_.empty();
+}
+
+
+/** Write all queued table values.
+ * Queued values are grouped by address and length. Each group is sent to
+ * all affected servos with a single SYNC_WRITE instruction to the broadcast
+ * ID. Groups which do not fit into a single packet are split. Servos do not
+ * reply to SYNC_WRITE, therefore this does not wait for any response.
+ * Groups are sent in a fixed order: torque enable and LED, goal speed,
+ * goal position, torque limit, all other registers by address. A servo
+ * thus moves with the new speed if speed and position are queued together.
+ * The queue is empty afterwards, even if sending failed.
+ * @return number of packets sent
+ */
+unsigned int
+DynamixelChain::flush_queued_values()
+{
+  if (queued_values_.empty())  return 0;
+
+  std::vector<QueuedValue> values;
+  values.swap(queued_values_);
+  std::stable_sort(values.begin(), values.end(),
+		   [](const QueuedValue &a, const QueuedValue &b) {
+		     unsigned int pa = flush_priority(a.addr), pb = flush_priority(b.addr);
+		     if (pa != pb)  return pa < pb;
+		     return (a.addr < b.addr) || ((a.addr == b.addr) && (a.length < b.length));
+		   });
+
+  unsigned int num_packets = 0;
+  unsigned char data[sizeof(obuffer_)];
+  std::vector<QueuedValue>::iterator g = values.begin();
+  while (g != values.end()) {
+    const unsigned char addr   = g->addr;
+    const unsigned char length = g->length;
+    // packet length must fit into one byte, minus instruction, checksum and addr/len
+    const unsigned int max_servos = (0xFF - 2 - 2) / (length + 1);
+
+    unsigned int num_servos = 0;
+    while ((g != values.end()) && (g->addr == addr) && (g->length == length)
+	   && (num_servos < max_servos))
+    {
+      unsigned char *d = &data[num_servos * (length + 1)];
+      d[0] = g->id;
+      d[1] = g->value & 0xFF;
+      control_table_[g->id][addr] = d[1];
+      if (length == 2) {
+	d[2] = (g->value >> 8) & 0xFF;
+	control_table_[g->id][addr + 1] = d[2];
+      }
+      ++num_servos;
+      ++g;
+    }
+
+    send_sync_write(addr, length, data, num_servos);
+    ++num_packets;
+  }
+
+  return num_packets;
+}
+
+
+/** Get order in which queued values are flushed.
+ * @param addr register address
+ * @return priority, registers with lower values are written first
+ */
+unsigned int
+DynamixelChain::flush_priority(unsigned char addr)
+{
+  if ((addr == P_TORQUE_ENABLE) || (addr == P_LED))  return 0;
+  if (addr == P_GOAL_SPEED_L)     return 1;
+  if (addr == P_GOAL_POSITION_L)  return 2;
+  if (addr == P_TORQUE_LIMIT_L)   return 3;
+  return 4;
+}
+
+
+/** Send SYNC_WRITE instruction.
+ * @param addr start address to write to on all servos
+ * @param length number of bytes to write per servo
+ * @param data per servo the ID followed by \p length data bytes
+ * @param num_servos number of servos in \p data
+ */
+void
+DynamixelChain::send_sync_write(unsigned char addr, unsigned char length,
+				const unsigned char *data, unsigned int num_servos)
+{
+  unsigned int  plength = num_servos * (length + 1) + 2;
+  unsigned char param[plength];
+  param[0] = addr;
+  param[1] = length;
+  memcpy(&param[2], data, plength - 2);
+
+  send(BROADCAST_ID, INST_SYNC_WRITE, param, plength);
+}
+
+
 /** Assert that the ID is valid.
  * @exception Exception thrown if \p id is the broadcast ID
  * @exception OutOfBoundsException thrown if the number is greater than the
@@ -860,12 +1026,13 @@ DynamixelChain::get_delay_time(unsigned char id, bool refresh)
 
 /** Get error flags set by the servo
  * @param id servo ID, not the broadcast ID
- * @return error flags
+ * @return error flags of the last status packet received from the servo
  */
 unsigned char
 DynamixelChain::get_error(unsigned char id)
 {
-  return ibuffer_[PACKET_OFFSET_ERROR];
+  assert_valid_id(id);
+  return error_[id];
 }
 
 
@@ -59,6 +59,12 @@ class DynamixelChain
 			unsigned char addr, unsigned char read_length);
   void          start_read_table_values(unsigned char id);
   void          finish_read_table_values();
+  void          read_status_values(unsigned char id);
+
+  void          queue_table_value(unsigned char id, unsigned char addr,
+				  unsigned int value, bool double_byte = false);
+  bool          has_queued_values() const;
+  unsigned int  flush_queued_values();
 
   void          goto_position(unsigned char id, unsigned int value);
   void          goto_positions(unsigned int num_positions, ...);
@@ -224,6 +230,9 @@ class DynamixelChain
 	    const unsigned char *params, const unsigned char plength);
   void recv(const unsigned char exp_length, unsigned int timeout_ms = 0xFFFFFFFF);
   void assert_valid_id(unsigned char id);
+  void send_sync_write(unsigned char addr, unsigned char length,
+		       const unsigned char *data, unsigned int num_servos);
+  static unsigned int flush_priority(unsigned char addr);
   unsigned int merge_twobyte_value(unsigned int id,
 				   unsigned char ind_l, unsigned char ind_h);
   unsigned int get_value(unsigned int id, bool refresh,
@@ -255,6 +264,17 @@ class DynamixelChain
   int           ibuffer_length_;
 
   char          control_table_[DYNAMIXEL_MAX_NUM_SERVOS][DYNAMIXEL_CONTROL_TABLE_LENGTH];
+  unsigned char error_[DYNAMIXEL_MAX_NUM_SERVOS];
+
+  /// @cond INTERNALS
+  struct QueuedValue {
+    unsigned char id;
+    unsigned char addr;
+    unsigned char length;
+    unsigned int  value;
+  };
+  /// @endcond
+  std::vector<QueuedValue> queued_values_;
 
 };
 
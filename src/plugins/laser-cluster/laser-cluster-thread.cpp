@@ -21,6 +21,7 @@
 
 #include "laser-cluster-thread.h"
 #include "cluster_colors.h"
+#include "scan_clusters.h"
 
 #include <pcl_utils/utils.h>
 #include <pcl_utils/comparisons.h>
@@ -107,6 +108,24 @@ LaserClusterThread::init()
   cfg_cluster_min_size_      = config->get_uint(cfg_prefix_+"clustering/min_size");
   cfg_cluster_max_size_      = config->get_uint(cfg_prefix_+"clustering/max_size");
   cfg_input_pcl_             = config->get_string(cfg_prefix_+"input_cloud");
+
+  cfg_scan_order_  = false;
+  cfg_wrap_around_ = false;
+  try {
+    std::string mode = config->get_string(cfg_prefix_+"clustering/mode");
+    if (mode == "scan-order") {
+      cfg_scan_order_ = true;
+    } else if (mode != "kdtree") {
+      logger->log_warn(name(), "Invalid clustering mode '%s', using kdtree", mode.c_str());
+    }
+  } catch (Exception &e) {} // ignored, use default
+  try {
+    cfg_wrap_around_ = config->get_bool(cfg_prefix_+"clustering/wrap_around");
+  } catch (Exception &e) {} // ignored, use default
+  if (cfg_scan_order_ && cfg_line_removal_) {
+    logger->log_warn(name(), "Line removal does not retain scan order, disabling");
+    cfg_line_removal_ = false;
+  }
   cfg_result_frame_          = config->get_string(cfg_prefix_+"result_frame");
 
   cfg_use_bbox_   = false;
@@ -207,6 +226,8 @@ LaserClusterThread::init()
   }
   clusters_labeled_ = pcl_utils::cloudptr_from_refptr(fclusters_labeled_);
 
+  scan_cloud_.reset(new Cloud());
+
   seg_.setOptimizeCoefficients(true);
   seg_.setModelType(pcl::SACMODEL_LINE);
   seg_.setMethodType(pcl::SAC_RANSAC);
@@ -230,6 +251,7 @@ void
 LaserClusterThread::finalize()
 {
   input_.reset();
+  scan_cloud_.reset();
   clusters_.reset();
   clusters_labeled_.reset();
 
@@ -320,16 +342,34 @@ LaserClusterThread::loop()
     return;
   }
 
-  CloudPtr noline_cloud(new Cloud());
+  CloudPtr noline_cloud;
 
-  // Erase non-finite points
-  pcl::PassThrough<PointType> passthrough;
-  if (current_max_x_ > 0.) {
-    passthrough.setFilterFieldName("x");
-    passthrough.setFilterLimits(cfg_bbox_min_x_, current_max_x_);
+  if (cfg_scan_order_) {
+    // Erase non-finite points, the order of the remaining ones is
+    // kept and the cloud is re-used to avoid allocations
+    noline_cloud = scan_cloud_;
+    noline_cloud->points.clear();
+    for (const PointType &p : input_->points) {
+      if (std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z) &&
+	  (current_max_x_ <= 0. || (p.x >= cfg_bbox_min_x_ && p.x <= current_max_x_)))
+      {
+	noline_cloud->points.push_back(p);
+      }
+    }
+    noline_cloud->width  = noline_cloud->points.size();
+    noline_cloud->height = 1;
+  } else {
+    noline_cloud.reset(new Cloud());
+
+    // Erase non-finite points
+    pcl::PassThrough<PointType> passthrough;
+    if (current_max_x_ > 0.) {
+      passthrough.setFilterFieldName("x");
+      passthrough.setFilterLimits(cfg_bbox_min_x_, current_max_x_);
+    }
+    passthrough.setInputCloud(input_);
+    passthrough.filter(*noline_cloud);
   }
-  passthrough.setInputCloud(input_);
-  passthrough.filter(*noline_cloud);
 
   //logger->log_info(name(), "[L %u] total: %zu   finite: %zu",
   //		     loop_count_, input_->points.size(), noline_cloud->points.size());
@@ -394,7 +434,7 @@ LaserClusterThread::loop()
     }
   }
 
-  {
+  if (! cfg_scan_order_) {
     CloudPtr tmp_cloud(new Cloud());
     // Erase non-finite points
     pcl::PassThrough<PointType> passthrough;
@@ -436,7 +476,12 @@ LaserClusterThread::loop()
   //		   loop_count_, noline_cloud->points.size());
 
   std::vector<pcl::PointIndices> cluster_indices;
-  if (noline_cloud->points.size() > 0) {
+  ScanClusterCentroids cluster_centroids;
+  if (cfg_scan_order_) {
+    scan_order_clusters(*noline_cloud, cfg_cluster_tolerance_,
+			cfg_cluster_min_size_, cfg_cluster_max_size_,
+			cfg_wrap_around_, cluster_indices, cluster_centroids);
+  } else if (noline_cloud->points.size() > 0) {
     // Creating the KdTree object for the search method of the extraction
     pcl::search::KdTree<PointType>::Ptr
       kdtree_cl(new pcl::search::KdTree<PointType>());
@@ -449,30 +494,20 @@ LaserClusterThread::loop()
     ec.setSearchMethod(kdtree_cl);
     ec.setInputCloud(noline_cloud);
     ec.extract(cluster_indices);
+  } else {
+    //logger->log_info(name(), "Filter left no points for clustering");
+  }
 
-    //logger->log_info(name(), "Found %zu clusters", cluster_indices.size());
-
-    unsigned int i = 0;
-    for (auto cluster : cluster_indices) {
-      //Eigen::Vector4f centroid;
-      //pcl::compute3DCentroid(*noline_cloud, cluster.indices, centroid);
-
-      //logger->log_info(name(), "  Cluster %u with %zu points at (%f, %f, %f)",
-      //	         i, cluster.indices.size(), centroid.x(), centroid.y(), centroid.z());
-
-      // color points of cluster
-      for (auto ci : cluster.indices) {
-	ColorPointType &out_point = clusters_->points[ci];
-	out_point.r = ignored_cluster_color[0];
-	out_point.g = ignored_cluster_color[1];;
-	out_point.b = ignored_cluster_color[2];;
-      }
+  //logger->log_info(name(), "Found %zu clusters", cluster_indices.size());
 
-      ++i;
+  // color points of all clusters, selected ones are re-colored below
+  for (const pcl::PointIndices &cluster : cluster_indices) {
+    for (auto ci : cluster.indices) {
+      ColorPointType &out_point = clusters_->points[ci];
+      out_point.r = ignored_cluster_color[0];
+      out_point.g = ignored_cluster_color[1];
+      out_point.b = ignored_cluster_color[2];
     }
-
-  } else {
-    //logger->log_info(name(), "Filter left no points for clustering");
   }
 
 
@@ -481,7 +516,11 @@ LaserClusterThread::loop()
 
     for (unsigned int i = 0; i < cluster_indices.size(); ++i) {
       Eigen::Vector4f centroid;
-      pcl::compute3DCentroid(*noline_cloud, cluster_indices[i].indices, centroid);
+      if (cfg_scan_order_) {
+	centroid = cluster_centroids[i];
+      } else {
+	pcl::compute3DCentroid(*noline_cloud, cluster_indices[i].indices, centroid);
+      }
       if ( !cfg_use_bbox_ ||
 	   ((centroid.x() >= cfg_bbox_min_x_) && (centroid.x() <= cfg_bbox_max_x_) &&
 	    (centroid.y() >= cfg_bbox_min_y_) && (centroid.y() <= cfg_bbox_max_y_)))
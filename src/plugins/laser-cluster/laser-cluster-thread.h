@@ -98,6 +98,7 @@ class LaserClusterThread
   fawkes::RefPtr<pcl::PointCloud<ColorPointType> > fclusters_;
   fawkes::RefPtr<pcl::PointCloud<LabelPointType> > fclusters_labeled_;
   CloudConstPtr input_;
+  CloudPtr scan_cloud_;
   pcl::PointCloud<ColorPointType>::Ptr clusters_;
   pcl::PointCloud<LabelPointType>::Ptr clusters_labeled_;
 
@@ -127,6 +128,8 @@ class LaserClusterThread
   float        cfg_cluster_tolerance_;
   unsigned int cfg_cluster_min_size_;
   unsigned int cfg_cluster_max_size_;
+  bool         cfg_scan_order_;
+  bool         cfg_wrap_around_;
   std::string  cfg_input_pcl_;
   std::string  cfg_result_frame_;
   float        cfg_bbox_min_x_;
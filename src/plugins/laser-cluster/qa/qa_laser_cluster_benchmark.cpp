@@ -0,0 +1,150 @@
+
+/***************************************************************************
+ *  qa_laser_cluster_benchmark.cpp - Compare laser-cluster clustering modes
+ *
+ *  Created: Mon Oct 19 11:08:21 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+/// @cond QA
+
+// Runs the kdtree and scan-order clustering modes of the laser-cluster
+// plugin on recorded scans given as PCD files (e.g. written with
+// pcl_recorder from the laser-pointclouds output) or on a synthetic
+// 360 degree scan if no file is given.
+
+#include "../scan_clusters.h"
+
+#include <pcl/point_types.h>
+#include <pcl/io/pcd_io.h>
+#include <pcl/search/kdtree.h>
+#include <pcl/segmentation/extract_clusters.h>
+#include <pcl/common/centroid.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+typedef pcl::PointXYZ PointType;
+typedef pcl::PointCloud<PointType> Cloud;
+
+static const float        TOLERANCE   = 0.1;
+static const unsigned int MIN_SIZE    = 5;
+static const unsigned int MAX_SIZE    = 5000;
+static const unsigned int NUM_RUNS    = 100;
+
+static double
+elapsed(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void
+synthesize_scan(Cloud &cloud)
+{
+  // room of 8x6 m with three round obstacles, laser in the center
+  const unsigned int num_beams = 1440;
+  const float obstacles[3][3] = { {1.5, 0.5, 0.2}, {-2., -1., 0.3}, {0.5, -2., 0.15} };
+
+  for (unsigned int i = 0; i < num_beams; ++i) {
+    const float a = 2 * M_PI * i / num_beams;
+    const float dx = cosf(a), dy = sinf(a);
+    float r = std::min(fabsf(4. / (fabsf(dx) > 1e-6 ? dx : 1e-6)),
+		       fabsf(3. / (fabsf(dy) > 1e-6 ? dy : 1e-6)));
+    for (unsigned int o = 0; o < 3; ++o) {
+      // ray-circle intersection
+      const float b = dx * obstacles[o][0] + dy * obstacles[o][1];
+      const float c = obstacles[o][0] * obstacles[o][0] + obstacles[o][1] * obstacles[o][1]
+	- obstacles[o][2] * obstacles[o][2];
+      const float disc = b * b - c;
+      if (disc >= 0. && b - sqrtf(disc) > 0.)  r = std::min(r, b - sqrtf(disc));
+    }
+    cloud.points.push_back(PointType(r * dx, r * dy, 0.));
+  }
+}
+
+int
+main(int argc, char **argv)
+{
+  std::vector<Cloud::Ptr> scans;
+  if (argc > 1) {
+    for (int i = 1; i < argc; ++i) {
+      Cloud::Ptr in(new Cloud());
+      if (pcl::io::loadPCDFile(argv[i], *in) != 0) {
+	printf("Failed to load %s\n", argv[i]);
+	return 1;
+      }
+      // laser-cluster only works on finite points, keep scan order
+      Cloud::Ptr scan(new Cloud());
+      for (const PointType &p : in->points) {
+	if (pcl::isFinite(p))  scan->points.push_back(p);
+      }
+      scans.push_back(scan);
+    }
+  } else {
+    Cloud::Ptr scan(new Cloud());
+    synthesize_scan(*scan);
+    scans.push_back(scan);
+  }
+
+  size_t num_kdtree = 0, num_scan_order = 0;
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (unsigned int r = 0; r < NUM_RUNS; ++r) {
+    for (const Cloud::Ptr &scan : scans) {
+      std::vector<pcl::PointIndices> cluster_indices;
+      pcl::search::KdTree<PointType>::Ptr kdtree(new pcl::search::KdTree<PointType>());
+      kdtree->setInputCloud(scan);
+      pcl::EuclideanClusterExtraction<PointType> ec;
+      ec.setClusterTolerance(TOLERANCE);
+      ec.setMinClusterSize(MIN_SIZE);
+      ec.setMaxClusterSize(MAX_SIZE);
+      ec.setSearchMethod(kdtree);
+      ec.setInputCloud(scan);
+      ec.extract(cluster_indices);
+      for (const pcl::PointIndices &c : cluster_indices) {
+	Eigen::Vector4f centroid;
+	pcl::compute3DCentroid(*scan, c.indices, centroid);
+      }
+      if (r == 0)  num_kdtree += cluster_indices.size();
+    }
+  }
+  double kdtree_sec = elapsed(start);
+
+  start = std::chrono::steady_clock::now();
+  for (unsigned int r = 0; r < NUM_RUNS; ++r) {
+    for (const Cloud::Ptr &scan : scans) {
+      std::vector<pcl::PointIndices> cluster_indices;
+      ScanClusterCentroids centroids;
+      scan_order_clusters(*scan, TOLERANCE, MIN_SIZE, MAX_SIZE, /* wrap around */ true,
+			  cluster_indices, centroids);
+      if (r == 0)  num_scan_order += cluster_indices.size();
+    }
+  }
+  double scan_order_sec = elapsed(start);
+
+  const double num_total = (double)NUM_RUNS * scans.size();
+  printf("%-12s %10.1f us/scan  (%zu clusters)\n", "kdtree",
+	 kdtree_sec * 1e6 / num_total, num_kdtree);
+  printf("%-12s %10.1f us/scan  (%zu clusters)\n", "scan-order",
+	 scan_order_sec * 1e6 / num_total, num_scan_order);
+
+  return 0;
+}
+
+/// @endcond
@@ -0,0 +1,112 @@
+
+/***************************************************************************
+ *  scan_clusters.h - cluster ordered laser scans in a single pass
+ *
+ *  Created: Mon Oct 19 10:12:08 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#ifndef _PLUGINS_LASER_CLUSTER_SCAN_CLUSTERS_H_
+#define _PLUGINS_LASER_CLUSTER_SCAN_CLUSTERS_H_
+
+#include <pcl/point_cloud.h>
+#include <pcl/PointIndices.h>
+#include <Eigen/Core>
+#include <Eigen/StdVector>
+
+#include <vector>
+
+/** Vector of cluster centroids. */
+typedef std::vector<Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f> >
+  ScanClusterCentroids;
+
+/** Extract clusters from an ordered scan.
+ * Instead of searching neighbors in a KD-tree like
+ * pcl::EuclideanClusterExtraction, this walks the points once in
+ * scan order and starts a new cluster whenever two consecutive points
+ * are further apart than the tolerance. This is equivalent for 2D laser
+ * scans as long as objects are not occluded partially by others closer
+ * to the sensor, and takes linear time without any setup.
+ * The centroids are accumulated while walking the scan.
+ * @param cloud input cloud, points must be finite and in scan order
+ * @param tolerance maximum distance of consecutive points in a cluster
+ * @param min_size minimum number of points in a cluster
+ * @param max_size maximum number of points in a cluster
+ * @param wrap_around if true, the last and the first cluster are merged
+ * if the last and first point are within the tolerance, e.g. for 360 degree
+ * scans
+ * @param clusters upon return contains the indices of points of the clusters
+ * @param centroids upon return contains the centroid of each cluster, the
+ * fourth element is set to one like pcl::compute3DCentroid() does.
+ */
+template <class PointType>
+void
+scan_order_clusters(const pcl::PointCloud<PointType> &cloud,
+		    float tolerance, unsigned int min_size, unsigned int max_size,
+		    bool wrap_around,
+		    std::vector<pcl::PointIndices> &clusters,
+		    ScanClusterCentroids &centroids)
+{
+  clusters.clear();
+  centroids.clear();
+
+  const size_t num_points = cloud.points.size();
+  if (num_points == 0)  return;
+
+  const float tolerance_sq = tolerance * tolerance;
+  auto gap = [&cloud, tolerance_sq](size_t i, size_t j) -> bool {
+    const PointType &p1 = cloud.points[i];
+    const PointType &p2 = cloud.points[j];
+    const float dx = p1.x - p2.x, dy = p1.y - p2.y, dz = p1.z - p2.z;
+    return (dx * dx + dy * dy + dz * dz) > tolerance_sq;
+  };
+
+  // start at a gap, so that a cluster crossing the end of the
+  // scan is found as one. Without any gap, the scan is a closed contour.
+  size_t begin = 0;
+  if (wrap_around && num_points > 1 && ! gap(num_points - 1, 0)) {
+    for (size_t i = 1; i < num_points; ++i) {
+      if (gap(i - 1, i)) {
+	begin = i;
+	break;
+      }
+    }
+  }
+
+  pcl::PointIndices current;
+  Eigen::Vector3f sum(Eigen::Vector3f::Zero());
+  auto finish = [&]() {
+    const size_t size = current.indices.size();
+    if (size >= min_size && size <= max_size) {
+      centroids.push_back(Eigen::Vector4f(sum[0] / size, sum[1] / size, sum[2] / size, 1.));
+      clusters.push_back(current);
+    }
+    current.indices.clear();
+    sum.setZero();
+  };
+
+  for (size_t n = 0; n < num_points; ++n) {
+    const size_t i = (begin + n) % num_points;
+    if (n > 0 && gap((i + num_points - 1) % num_points, i))  finish();
+
+    const PointType &p = cloud.points[i];
+    sum += Eigen::Vector3f(p.x, p.y, p.z);
+    current.indices.push_back(i);
+  }
+  finish();
+}
+
+#endif
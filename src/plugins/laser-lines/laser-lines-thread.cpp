@@ -237,12 +237,22 @@ LaserLinesThread::loop()
   else {
     //logger->log_info(name(), "[L %u] total: %zu   finite: %zu",
     //		     loop_count_, input_->points.size(), in_cloud->points.size());
-    std::vector<LineInfo> linfos =
+    std::vector<LineInfo> linfos;
+    if (cfg_scan_order_) {
+      linfos =
+        calc_lines_scan_order<PointType>(input_,
+                                         cfg_segm_min_inliers_, cfg_segm_distance_threshold_,
+                                         cfg_cluster_tolerance_,
+                                         cfg_min_length_, cfg_max_length_,
+                                         cfg_min_dist_, cfg_max_dist_);
+    } else {
+      linfos =
         calc_lines<PointType>(input_,
                               cfg_segm_min_inliers_, cfg_segm_max_iterations_,
                               cfg_segm_distance_threshold_, cfg_segm_sample_max_dist_,
                               cfg_cluster_tolerance_, cfg_cluster_quota_,
                               cfg_min_length_, cfg_max_length_, cfg_min_dist_, cfg_max_dist_);
+    }
 
 
     TIMETRACK_INTER(ttc_extract_lines_, ttc_clustering_);
@@ -276,6 +286,16 @@ LaserLinesThread::read_config()
     config->get_float(CFG_PREFIX"line_cluster_tolerance");
   cfg_cluster_quota_ =
     config->get_float(CFG_PREFIX"line_cluster_quota");
+  std::string extraction_method = "ransac";
+  try {
+    extraction_method = config->get_string(CFG_PREFIX"line_extraction_method");
+  } catch (Exception &e) {} // ignored, use default
+  if (extraction_method != "ransac" && extraction_method != "scan-order") {
+    logger->log_warn(name(), "Unknown line extraction method '%s', using ransac",
+		     extraction_method.c_str());
+  }
+  cfg_scan_order_ = (extraction_method == "scan-order");
+
   cfg_moving_avg_enabled_ =
     config->get_bool(CFG_PREFIX"moving_avg_enabled");
   cfg_moving_avg_window_size_ =
@@ -161,6 +161,7 @@ class LaserLinesThread
   float        cfg_switch_tolerance_;
   float        cfg_cluster_tolerance_;
   float        cfg_cluster_quota_;
+  bool         cfg_scan_order_;
   float        cfg_min_dist_;
   float        cfg_max_dist_;
   bool         cfg_moving_avg_enabled_;
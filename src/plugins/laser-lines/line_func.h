@@ -40,6 +40,13 @@
 #include <pcl/common/transforms.h>
 #include <pcl/common/distances.h>
 
+#include <Eigen/Eigenvalues>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include <cmath>
+
 /** Calculate length of line from associated points.
  * The unit depends on the units of the input data.
  * @param cloud_line point cloud with points from which the line model was
@@ -319,4 +326,283 @@ calc_lines(typename pcl::PointCloud<PointType>::ConstPtr input,
 }
 
 
+/// @cond INTERNALS
+/** Index range of a line segment candidate in scan order. */
+typedef struct {
+  size_t begin;	///< index of first point
+  size_t end;	///< index after last point
+} ScanRange;
+/// @endcond
+
+
+/** Fit a line to a range of points using total least squares.
+ * The line passes through the centroid of the points and its direction
+ * is the principal axis of their scatter matrix, i.e. the sum of squared
+ * perpendicular distances is minimized.
+ * @param cloud point cloud
+ * @param idx indices of points in @p cloud in scan order
+ * @param range range within @p idx to fit line to
+ * @param centroid upon return contains the centroid of the points
+ * @param direction upon return contains the unit direction of the line
+ * @return maximum distance of any point in the range to the line
+ */
+template <class PointType>
+float
+fit_line_tls(const pcl::PointCloud<PointType> &cloud, const std::vector<int> &idx,
+	     const ScanRange &range,
+	     Eigen::Vector3f &centroid, Eigen::Vector3f &direction)
+{
+  const float n = range.end - range.begin;
+
+  centroid.setZero();
+  for (size_t i = range.begin; i < range.end; ++i) {
+    centroid += cloud.points[idx[i]].getVector3fMap();
+  }
+  centroid /= n;
+
+  Eigen::Matrix3f scatter(Eigen::Matrix3f::Zero());
+  for (size_t i = range.begin; i < range.end; ++i) {
+    const Eigen::Vector3f d(cloud.points[idx[i]].getVector3fMap() - centroid);
+    scatter += d * d.transpose();
+  }
+
+  // eigenvalues are sorted in increasing order
+  Eigen::SelfAdjointEigenSolver<Eigen::Matrix3f> solver(scatter);
+  direction = solver.eigenvectors().col(2).normalized();
+
+  float max_dist = 0.;
+  for (size_t i = range.begin; i < range.end; ++i) {
+    const Eigen::Vector3f d(cloud.points[idx[i]].getVector3fMap() - centroid);
+    max_dist = std::max(max_dist, (d - direction.dot(d) * direction).norm());
+  }
+  return max_dist;
+}
+
+
+/** Calculate a number of lines from an ordered point cloud.
+ * This is an alternative to calc_lines() for clouds which retain the
+ * order of the beams of a 2D laser scan, such as the clouds provided by
+ * the laser-pointclouds plugin. It does not use random sampling, search
+ * trees or intermediate point clouds.
+ *
+ * The finite points are first divided into contiguous segments whenever
+ * two consecutive points are further apart than the cluster tolerance.
+ * A segment wrapping around the end of a 360 degree scan is joined.
+ * Each segment is then split recursively at the point furthest from the
+ * chord between its end points while that distance exceeds the
+ * distance threshold (split). Afterwards, neighboring parts are joined
+ * again if a total least squares fit of both still stays within the
+ * threshold (merge). Parts with enough points are turned into lines
+ * using the same length and distance criteria as calc_lines().
+ * Lines are returned in order of decreasing number of points, like
+ * the RANSAC based extraction finds them.
+ * @param input input point cloud from which to extract lines, points
+ * must be in scan order
+ * @param min_inliers minimum number of points on a line to consider it
+ * @param distance_threshold maximum distance of point to line to account it to a line
+ * @param cluster_tolerance maximum distance of two consecutive points
+ * on a line
+ * @param min_length minimum length of line to consider it
+ * @param max_length maximum length of a line to consider it
+ * @param min_dist minimum distance from frame origin to closest point on line to consider it
+ * @param max_dist maximum distance from frame origin to closest point on line to consider it
+ * @param remaining_cloud if passed with a valid cloud will be assigned the remaining
+ * points, that is points which have not been accounted to a line, upon return
+ * @return vector of info about detected lines
+ */
+template <class PointType>
+std::vector<LineInfo>
+calc_lines_scan_order(typename pcl::PointCloud<PointType>::ConstPtr input,
+		      unsigned int min_inliers, float distance_threshold,
+		      float cluster_tolerance,
+		      float min_length, float max_length, float min_dist, float max_dist,
+		      typename pcl::PointCloud<PointType>::Ptr remaining_cloud =
+		        typename pcl::PointCloud<PointType>::Ptr())
+{
+  const pcl::PointCloud<PointType> &cloud = *input;
+  std::vector<LineInfo> linfos;
+
+  // indices of finite points in scan order
+  std::vector<int> idx;
+  idx.reserve(cloud.points.size());
+  for (size_t i = 0; i < cloud.points.size(); ++i) {
+    const PointType &p = cloud.points[i];
+    if (std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z)) {
+      idx.push_back(i);
+    }
+  }
+
+  const float tolerance_sq = cluster_tolerance * cluster_tolerance;
+  auto gap = [&cloud, &idx, tolerance_sq](size_t i, size_t j) -> bool {
+    return (cloud.points[idx[i]].getVector3fMap() -
+	    cloud.points[idx[j]].getVector3fMap()).squaredNorm() > tolerance_sq;
+  };
+
+  // start at a gap so that a segment crossing the scan end stays in one
+  // piece. If there is none, the scan is a closed contour, start at the
+  // point furthest from the first point, which is a corner.
+  if (idx.size() > 1 && ! gap(idx.size() - 1, 0)) {
+    size_t start = 0;
+    for (size_t i = 1; i < idx.size(); ++i) {
+      if (gap(i - 1, i)) {
+	start = i;
+	break;
+      }
+    }
+    if (start == 0) {
+      const Eigen::Vector3f first(cloud.points[idx[0]].getVector3fMap());
+      float start_dist = 0.;
+      for (size_t i = 1; i < idx.size(); ++i) {
+	const float dist = (cloud.points[idx[i]].getVector3fMap() - first).squaredNorm();
+	if (dist > start_dist) {
+	  start_dist = dist;
+	  start = i;
+	}
+      }
+    }
+    std::rotate(idx.begin(), idx.begin() + start, idx.end());
+  }
+
+  // split segments at gaps and at points furthest from the chord
+  std::vector<ScanRange> parts;
+  std::vector<ScanRange> stack;
+  size_t seg_begin = 0;
+  for (size_t i = 1; i <= idx.size(); ++i) {
+    if (i < idx.size() && ! gap(i - 1, i))  continue;
+
+    stack.push_back(ScanRange{seg_begin, i});
+    seg_begin = i;
+
+    while (! stack.empty()) {
+      ScanRange r = stack.back();
+      stack.pop_back();
+
+      const Eigen::Vector3f a(cloud.points[idx[r.begin]].getVector3fMap());
+      const Eigen::Vector3f b(cloud.points[idx[r.end - 1]].getVector3fMap());
+      Eigen::Vector3f dir(b - a);
+      const float chord_length = dir.norm();
+      if (chord_length > 0.)  dir /= chord_length;
+
+      size_t split = r.begin;
+      float  split_dist = 0.;
+      for (size_t j = r.begin + 1; j + 1 < r.end; ++j) {
+	const Eigen::Vector3f d(cloud.points[idx[j]].getVector3fMap() - a);
+	const float dist = (d - dir.dot(d) * dir).norm();
+	if (dist > split_dist) {
+	  split_dist = dist;
+	  split = j;
+	}
+      }
+
+      if (split_dist > distance_threshold) {
+	// process left part first to keep parts in scan order
+	stack.push_back(ScanRange{split, r.end});
+	stack.push_back(ScanRange{r.begin, split});
+      } else {
+	parts.push_back(r);
+      }
+    }
+  }
+
+  // merge neighboring collinear parts
+  std::vector<ScanRange> lines;
+  Eigen::Vector3f centroid, direction;
+  for (const ScanRange &r : parts) {
+    if (! lines.empty() && lines.back().end == r.begin && ! gap(r.begin - 1, r.begin)) {
+      ScanRange merged{lines.back().begin, r.end};
+      if (fit_line_tls(cloud, idx, merged, centroid, direction) <= distance_threshold) {
+	lines.back() = merged;
+	continue;
+      }
+    }
+    lines.push_back(r);
+  }
+
+  // most supported lines first
+  std::stable_sort(lines.begin(), lines.end(),
+		   [](const ScanRange &r1, const ScanRange &r2) {
+		     return (r1.end - r1.begin) > (r2.end - r2.begin);
+		   });
+
+  std::vector<bool> on_line;
+  if (remaining_cloud)  on_line.resize(idx.size(), false);
+
+  for (const ScanRange &r : lines) {
+    if (r.end - r.begin < std::max(min_inliers, 2u))  break;
+
+    fit_line_tls(cloud, idx, r, centroid, direction);
+
+    if (remaining_cloud) {
+      std::fill(on_line.begin() + r.begin, on_line.begin() + r.end, true);
+    }
+
+    // end points are the extreme projections onto the line
+    float k_min = std::numeric_limits<float>::max();
+    float k_max = std::numeric_limits<float>::lowest();
+    for (size_t i = r.begin; i < r.end; ++i) {
+      const float k = direction.dot(cloud.points[idx[i]].getVector3fMap() - centroid);
+      k_min = std::min(k_min, k);
+      k_max = std::max(k_max, k);
+    }
+    const float length = k_max - k_min;
+
+    if (length == 0 ||
+	(min_length >= 0 && length < min_length) ||
+	(max_length >= 0 && length > max_length))
+    {
+      continue;
+    }
+
+    LineInfo info;
+    info.point_on_line  = centroid;
+    info.line_direction = direction;
+    info.length         = length;
+
+    Eigen::Vector3f P = centroid - centroid.dot(direction) * direction;
+    Eigen::Vector3f x_axis(1,0,0);
+    info.bearing = acosf(x_axis.dot(P) / P.norm());
+    // we also want to encode the direction of the angle
+    if (P[1] < 0)  info.bearing = fabs(info.bearing)*-1.;
+
+    info.base_point = P;
+    float dist = info.base_point.norm();
+
+    if ((min_dist >= 0. && dist < min_dist) ||
+	(max_dist >= 0. && dist > max_dist))
+    {
+      continue;
+    }
+
+    // the direction vector points from end point 1 to end point 2
+    info.end_point_1 = centroid + k_min * direction;
+    info.end_point_2 = centroid + k_max * direction;
+
+    // the only allocation per line, the cloud is kept with the line info
+    info.cloud.reset(new pcl::PointCloud<pcl::PointXYZ>());
+    info.cloud->points.resize(r.end - r.begin);
+    for (size_t i = r.begin; i < r.end; ++i) {
+      const Eigen::Vector3f pv(cloud.points[idx[i]].getVector3fMap());
+      const Eigen::Vector3f proj(P + direction.dot(pv - P) * direction);
+      pcl::PointXYZ &pp = info.cloud->points[i - r.begin];
+      pp.x = proj[0]; pp.y = proj[1]; pp.z = proj[2];
+    }
+    info.cloud->width  = info.cloud->points.size();
+    info.cloud->height = 1;
+
+    linfos.push_back(info);
+  }
+
+  if (remaining_cloud) {
+    remaining_cloud->points.clear();
+    for (size_t i = 0; i < idx.size(); ++i) {
+      if (! on_line[i])  remaining_cloud->points.push_back(cloud.points[idx[i]]);
+    }
+    remaining_cloud->width  = remaining_cloud->points.size();
+    remaining_cloud->height = 1;
+  }
+
+  return linfos;
+}
+
+
 #endif
@@ -0,0 +1,120 @@
+/***************************************************************************
+ *  qa_laser_lines_scan_order.cpp - Test scan-order line extraction
+ *
+ *  Created: Mon Oct 19 00:04:52 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+/// @cond QA
+
+// Runs the scan-order and the RANSAC line extraction of the laser-lines
+// plugin on a synthetic 1440 beam scan of a rectangular room taken off
+// its center. The scan-order extraction must yield the four walls.
+// Parameters are the defaults of cfg/conf.d/laser-lines.yaml.
+
+#include "../line_func.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+typedef pcl::PointXYZ PointType;
+typedef pcl::PointCloud<PointType> Cloud;
+
+static const unsigned int NUM_BEAMS  = 1440;
+static const unsigned int NUM_RUNS   = 100;
+static const float        ROOM_X     = 8.;
+static const float        ROOM_Y     = 6.;
+static const float        LASER_X    = 0.7;
+static const float        LASER_Y    = -0.4;
+
+static double
+elapsed(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void
+synthesize_scan(Cloud &cloud)
+{
+  for (unsigned int i = 0; i < NUM_BEAMS; ++i) {
+    const float a = 2 * M_PI * i / NUM_BEAMS;
+    const float dx = cosf(a), dy = sinf(a);
+    // distance to the walls hit in x and y direction
+    const float wx = (dx > 0 ? ROOM_X / 2 - LASER_X : -ROOM_X / 2 - LASER_X);
+    const float wy = (dy > 0 ? ROOM_Y / 2 - LASER_Y : -ROOM_Y / 2 - LASER_Y);
+    float r = std::min(fabsf(dx) > 1e-6 ? wx / dx : INFINITY,
+		       fabsf(dy) > 1e-6 ? wy / dy : INFINITY);
+    cloud.points.push_back(PointType(r * dx, r * dy, 0.));
+  }
+  cloud.width  = cloud.points.size();
+  cloud.height = 1;
+}
+
+int
+main(int argc, char **argv)
+{
+  Cloud::Ptr scan(new Cloud());
+  synthesize_scan(*scan);
+
+  std::vector<LineInfo> scan_order_lines, ransac_lines;
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (unsigned int r = 0; r < NUM_RUNS; ++r) {
+    scan_order_lines =
+      calc_lines_scan_order<PointType>(scan, 20, 0.1, 0.2, 0.8, -1, 0.1, -1);
+  }
+  double scan_order_sec = elapsed(start) / NUM_RUNS;
+
+  start = std::chrono::steady_clock::now();
+  for (unsigned int r = 0; r < NUM_RUNS; ++r) {
+    ransac_lines =
+      calc_lines<PointType>(scan, 20, 250, 0.1, 0.25, 0.2, 0.1, 0.8, -1, 0.1, -1);
+  }
+  double ransac_sec = elapsed(start) / NUM_RUNS;
+
+  printf("scan-order: %zu lines in %8.1f us\n", scan_order_lines.size(), scan_order_sec * 1e6);
+  printf("ransac:     %zu lines in %8.1f us\n", ransac_lines.size(), ransac_sec * 1e6);
+
+  int rv = 0;
+  if (scan_order_lines.size() != 4) {
+    printf("FAILED: expected 4 walls, got %zu lines\n", scan_order_lines.size());
+    rv = 1;
+  }
+
+  // each wall is found once, with about its full length
+  unsigned int num_x_walls = 0, num_y_walls = 0;
+  for (const LineInfo &l : scan_order_lines) {
+    const bool along_x = fabsf(l.line_direction[0]) > fabsf(l.line_direction[1]);
+    const float expected = along_x ? ROOM_X : ROOM_Y;
+    printf("  line length %5.2f  bearing %6.3f  direction (%5.2f, %5.2f)\n",
+	   l.length, l.bearing, l.line_direction[0], l.line_direction[1]);
+    if (along_x)  ++num_x_walls;
+    else          ++num_y_walls;
+    if (fabsf(l.length - expected) > 0.25) {
+      printf("FAILED: line length %f, expected %f\n", l.length, expected);
+      rv = 1;
+    }
+  }
+  if (num_x_walls != 2 || num_y_walls != 2) {
+    printf("FAILED: %u walls along x, %u along y\n", num_x_walls, num_y_walls);
+    rv = 1;
+  }
+
+  return rv;
+}
+
+/// @endcond
@@ -31,6 +31,9 @@
 
 using namespace fawkes;
 
+/// Number of buffers per cloud for versioned publication
+#define CLOUD_BUFFERS 3
+
 /** @class LaserPointCloudThread "tf_thread.h"
  * Thread to exchange transforms between Fawkes and ROS.
  * This threads connects to Fawkes and ROS to read and write transforms.
@@ -78,7 +81,7 @@ LaserPointCloudThread::init()
     mapping.cloud->header.frame_id = (*i)->frame();
     mapping.cloud->height = 1;
     mapping.cloud->width = 360;
-    pcl_manager->add_pointcloud(mapping.id.c_str(), mapping.cloud);
+    pcl_manager->add_pointcloud(mapping.id.c_str(), mapping.cloud, CLOUD_BUFFERS);
     bbil_add_reader_interface(*i);
     bbil_add_writer_interface(*i);
     mappings_.push_back(mapping);
@@ -96,7 +99,7 @@ LaserPointCloudThread::init()
     mapping.cloud->header.frame_id = (*j)->frame();
     mapping.cloud->height = 1;
     mapping.cloud->width = 720;
-    pcl_manager->add_pointcloud(mapping.id.c_str(), mapping.cloud);
+    pcl_manager->add_pointcloud(mapping.id.c_str(), mapping.cloud, CLOUD_BUFFERS);
     bbil_add_reader_interface(*j);
     bbil_add_writer_interface(*j);
     mappings_.push_back(mapping);
@@ -115,7 +118,7 @@ LaserPointCloudThread::init()
     mapping.cloud->header.frame_id = (*k)->frame();
     mapping.cloud->height = 1;
     mapping.cloud->width = 1080;
-    pcl_manager->add_pointcloud(mapping.id.c_str(), mapping.cloud);
+    pcl_manager->add_pointcloud(mapping.id.c_str(), mapping.cloud, CLOUD_BUFFERS);
     bbil_add_reader_interface(*k);
     bbil_add_writer_interface(*k);
     mappings_.push_back(mapping);
@@ -170,32 +173,37 @@ LaserPointCloudThread::loop()
     if (! m->interface->changed()) {
       continue;
     }
+    RefPtr<pcl::PointCloud<pcl::PointXYZ> > cloud =
+      pcl_manager->writable_pointcloud<pcl::PointXYZ>(m->id.c_str());
+
     if (m->size == 360) {
-      m->cloud->header.frame_id = m->interface_typed.as360->frame();
+      cloud->header.frame_id = m->interface_typed.as360->frame();
       float *distances = m->interface_typed.as360->distances();
       for (unsigned int i = 0; i < 360; ++i) {
-        m->cloud->points[i].x = distances[i] * cos_angles360[i];
-        m->cloud->points[i].y = distances[i] * sin_angles360[i];
+        cloud->points[i].x = distances[i] * cos_angles360[i];
+        cloud->points[i].y = distances[i] * sin_angles360[i];
       }
 
     } else if (m->size == 720) {
-      m->cloud->header.frame_id = m->interface_typed.as720->frame();
+      cloud->header.frame_id = m->interface_typed.as720->frame();
       float *distances = m->interface_typed.as720->distances();
       for (unsigned int i = 0; i < 720; ++i) {
-        m->cloud->points[i].x = distances[i] * cos_angles720[i];
-        m->cloud->points[i].y = distances[i] * sin_angles720[i];
+        cloud->points[i].x = distances[i] * cos_angles720[i];
+        cloud->points[i].y = distances[i] * sin_angles720[i];
       }
 
     } else if (m->size == 1080) {
-      m->cloud->header.frame_id = m->interface_typed.as1080->frame();
+      cloud->header.frame_id = m->interface_typed.as1080->frame();
       float *distances = m->interface_typed.as1080->distances();
       for (unsigned int i = 0; i < 1080; ++i) {
-        m->cloud->points[i].x = distances[i] * cos_angles1080[i];
-        m->cloud->points[i].y = distances[i] * sin_angles1080[i];
+        cloud->points[i].x = distances[i] * cos_angles1080[i];
+        cloud->points[i].y = distances[i] * sin_angles1080[i];
       }
     }
 
-    pcl_utils::set_time(m->cloud, *(m->interface->timestamp()));
+    pcl_utils::set_time(cloud, *(m->interface->timestamp()));
+    cloud.reset();
+    pcl_manager->publish_pointcloud(m->id.c_str());
   }
 }
 
@@ -225,7 +233,7 @@ LaserPointCloudThread::bb_interface_created(const char *type, const char *id) th
       mapping.cloud->points.resize(360);
       mapping.cloud->header.frame_id = lif->frame();
       mapping.cloud->width = 360;
-      pcl_manager->add_pointcloud(mapping.id.c_str(), mapping.cloud);
+      pcl_manager->add_pointcloud(mapping.id.c_str(), mapping.cloud, CLOUD_BUFFERS);
     } catch (Exception &e) {
       logger->log_warn(name(), "Failed to add pointcloud %s: %s",
                        mapping.id.c_str(), e.what());
@@ -250,7 +258,7 @@ LaserPointCloudThread::bb_interface_created(const char *type, const char *id) th
       mapping.cloud->points.resize(720);
       mapping.cloud->header.frame_id = lif->frame();
       mapping.cloud->width = 720;
-      pcl_manager->add_pointcloud(mapping.id.c_str(), mapping.cloud);
+      pcl_manager->add_pointcloud(mapping.id.c_str(), mapping.cloud, CLOUD_BUFFERS);
     } catch (Exception &e) {
       logger->log_warn(name(), "Failed to add pointcloud %s: %s",
                        mapping.id.c_str(), e.what());
@@ -275,7 +283,7 @@ LaserPointCloudThread::bb_interface_created(const char *type, const char *id) th
       mapping.cloud->points.resize(1080);
       mapping.cloud->header.frame_id = lif->frame();
       mapping.cloud->width = 1080;
-      pcl_manager->add_pointcloud(mapping.id.c_str(), mapping.cloud);
+      pcl_manager->add_pointcloud(mapping.id.c_str(), mapping.cloud, CLOUD_BUFFERS);
     } catch (Exception &e) {
       logger->log_warn(name(), "Failed to add pointcloud %s: %s",
                        mapping.id.c_str(), e.what());
@@ -21,9 +21,10 @@
 
 #include "acquisition_thread.h"
 
-#include <core/threading/mutex.h>
+#include <utils/time/time.h>
 
 #include <limits>
+#include <algorithm>
 #include <cstring>
 #include <cstdlib>
 
@@ -32,6 +33,15 @@ using namespace fawkes;
 /** @class LaserAcquisitionThread "acquisition_thread.h"
  * Laser acqusition thread.
  * Interface for different laser types.
+ *
+ * Scans are handed to the sensor thread through a triple buffer. The
+ * acquisition thread always writes to its own back buffer, accessible via
+ * _distances, _echoes, and _timestamp, and calls publish_scan() once a scan
+ * is complete. Publishing exchanges the back buffer with the most recently
+ * published buffer in a single atomic operation, it never waits for the
+ * sensor thread. The sensor thread calls fetch_new_data() to get the newest
+ * published scan, scans published in the meantime are overwritten. Each
+ * scan is numbered with a sequence number to detect such skipped scans.
  * @author Tim Niemueller
  *
  * @fn void LaserAcquisitionThread::pre_init(fawkes::Configuration *config, fawkes::Logger *logger) = 0;
@@ -43,21 +53,17 @@ using namespace fawkes;
  * @param logger logger instance
  */
 
-/** @var fawkes::Mutex * LaserAcquisitionThread::_data_mutex
- * Lock while writing to distances or echoes array or marking new data
- */
-
-/** @var bool LaserAcquisitionThread::_new_data
- * Set to true in your loop if new data is available. Set to false automatically
- * in get_distance_data() and get_echoes_data().
- */
-
 /** @var float * LaserAcquisitionThread::_distances
- * Allocate a float array and copy your distance values measured in meters here.
+ * Distance values of the scan currently being acquired, measured in meters.
+ * Allocate with alloc_distances(). The array changes on each call to
+ * publish_scan(), never keep a copy of the pointer. After publishing it
+ * contains the values of the scan just published.
  */
 
 /** @var float * LaserAcquisitionThread::_echoes
- * Allocate a float array and copy your echo values here.
+ * Echo values of the scan currently being acquired.
+ * Allocate with alloc_echoes(). The array changes on each call to
+ * publish_scan(), never keep a copy of the pointer.
  */
 
 /** @var unsigned int LaserAcquisitionThread::_distances_size
@@ -69,7 +75,8 @@ using namespace fawkes;
  */
 
 /** @var fawkes::Time * LaserAcquisitionThread::_timestamp
- * Time when the most recent data was received.
+ * Time when the scan currently being acquired was recorded.
+ * Changes on each call to publish_scan() like _distances.
  */
 
 
@@ -79,9 +86,18 @@ using namespace fawkes;
 LaserAcquisitionThread::LaserAcquisitionThread(const char *thread_name)
   : Thread(thread_name, Thread::OPMODE_CONTINUOUS)
 {
-  _data_mutex = new Mutex();
-  _timestamp  = new Time();
-  _new_data   = false;
+  for (unsigned int i = 0; i < NUM_BUFFERS; ++i) {
+    buffers_[i].distances = NULL;
+    buffers_[i].echoes    = NULL;
+    buffers_[i].timestamp = new Time();
+    buffers_[i].seq       = 0;
+  }
+  back_     = 0;
+  middle_   = 1;
+  front_    = 2;
+  next_seq_ = 0;
+
+  _timestamp = buffers_[back_].timestamp;
   _distances = NULL;
   _echoes = NULL;
   _distances_size = 0;
@@ -90,57 +106,49 @@ LaserAcquisitionThread::LaserAcquisitionThread(const char *thread_name)
 
 LaserAcquisitionThread::~LaserAcquisitionThread()
 {
-  delete _data_mutex;
-  delete _timestamp;
+  for (unsigned int i = 0; i < NUM_BUFFERS; ++i) {
+    free(buffers_[i].distances);
+    free(buffers_[i].echoes);
+    delete buffers_[i].timestamp;
+  }
 }
 
 
-/** Lock data if fresh.
- * If new data has been received since get_distance_data() or get_echo_data()
- * was called last the data is locked, no new data can arrive until you call
- * unlock(), otherwise the lock is immediately released after checking.
- * @return true if the lock was acquired and there is new data, false otherwise
+/** Fetch newest scan.
+ * If a scan has been published since the last call the newest one becomes
+ * available through get_distance_data(), get_echo_data(), get_timestamp(),
+ * and get_scan_seq(). The data remains valid and unchanged until the next
+ * call. This never blocks the acquisition thread. Must only be called from
+ * a single (the sensor) thread.
+ * @return true if a new scan is available, false otherwise
  */
 bool
-LaserAcquisitionThread::lock_if_new_data()
+LaserAcquisitionThread::fetch_new_data()
 {
-  _data_mutex->lock();
-  if (_new_data) {
-    return true;
-  } else {
-    _data_mutex->unlock();
-    return false;
-  }
-}
-
+  if (! (middle_.load(std::memory_order_relaxed) & BUFFER_FRESH))  return false;
 
-/** Unlock data, */
-void
-LaserAcquisitionThread::unlock()
-{
-  _data_mutex->unlock();
+  front_ = middle_.exchange(front_, std::memory_order_acq_rel) & BUFFER_INDEX_MASK;
+  return true;
 }
 
 
 /** Get distance data.
- * @return Float array with distance values
+ * @return Float array with distance values of the fetched scan
  */
 const float *
 LaserAcquisitionThread::get_distance_data()
 {
-  _new_data = false;
-  return _distances;
+  return buffers_[front_].distances;
 }
 
 
 /** Get echo data.
- * @return Float array with echo values
+ * @return Float array with echo values of the fetched scan
  */
 const float *
 LaserAcquisitionThread::get_echo_data()
 {
-  _new_data = false;
-  return _echoes;
+  return buffers_[front_].echoes;
 }
 
 
@@ -165,70 +173,115 @@ LaserAcquisitionThread::get_echo_data_size()
 
 
 /** Get timestamp of data
- * @return most recent data time
+ * @return time when the fetched scan was recorded
  */
 const fawkes::Time *
 LaserAcquisitionThread::get_timestamp()
 {
-  return _timestamp;
+  return buffers_[front_].timestamp;
+}
+
+
+/** Get sequence number of data.
+ * Scans are numbered consecutively starting at 1 when published. A gap
+ * between two fetched scans means that scans have been skipped.
+ * @return sequence number of the fetched scan, 0 if none has been fetched
+ */
+unsigned int
+LaserAcquisitionThread::get_scan_seq()
+{
+  return buffers_[front_].seq;
 }
 
 
 /** Allocate distances array.
  * Call this from a laser acqusition thread implementation to properly
- * initialize the distances array.
+ * initialize the distances array. Must not be called while the sensor
+ * thread is running. The arrays are freed on destruction.
  * @param num_distances number of distances to allocate the array for
  */
 void
 LaserAcquisitionThread::alloc_distances(unsigned int num_distances)
 {
-  if (_distances)  free(_distances);
-
   _distances_size = num_distances;
-  _distances      = (float *)malloc(sizeof(float) * _distances_size);
-  std::fill_n(_distances, _distances_size,
-              std::numeric_limits<float>::quiet_NaN());
+  for (unsigned int i = 0; i < NUM_BUFFERS; ++i) {
+    free(buffers_[i].distances);
+    buffers_[i].distances = (float *)malloc(sizeof(float) * _distances_size);
+    std::fill_n(buffers_[i].distances, _distances_size,
+                std::numeric_limits<float>::quiet_NaN());
+  }
+  _distances = buffers_[back_].distances;
 }
 
 
 /** Allocate echoes array.
  * Call this from a laser acqusition thread implementation to properly
- * initialize the echoes array.
+ * initialize the echoes array. Must not be called while the sensor
+ * thread is running. The arrays are freed on destruction.
  * @param num_echoes number of echoes to allocate the array for
  */
 void
 LaserAcquisitionThread::alloc_echoes(unsigned int num_echoes)
 {
-  if (_echoes)  free(_echoes);
-
   _echoes_size = num_echoes;
-  _echoes      = (float *)malloc(sizeof(float) * _echoes_size);
-  memset(_echoes, 0, sizeof(float) * _echoes_size);
+  for (unsigned int i = 0; i < NUM_BUFFERS; ++i) {
+    free(buffers_[i].echoes);
+    buffers_[i].echoes = (float *)malloc(sizeof(float) * _echoes_size);
+    memset(buffers_[i].echoes, 0, sizeof(float) * _echoes_size);
+  }
+  _echoes = buffers_[back_].echoes;
 }
 
 
-/** Reset all distance values to NaN. */
+/** Reset all distance values of the current scan to NaN.
+ * Call publish_scan() to publish the reset values.
+ */
 void
 LaserAcquisitionThread::reset_distances()
 {
-  _data_mutex->lock();
   if (! _distances)  return;
 
-  for (size_t i = 0; i < _distances_size; ++i) {
-    _distances[i] = std::numeric_limits<float>::quiet_NaN();
-  }
-  _new_data = true;
-  _data_mutex->unlock();
+  std::fill_n(_distances, _distances_size, std::numeric_limits<float>::quiet_NaN());
 }
 
 
-/** Reset all distance values to NaN. */
+/** Reset all echo values of the current scan to NaN. */
 void
 LaserAcquisitionThread::reset_echoes()
 {
   if (! _echoes)  return;
 
-  for (size_t i = 0; i < _echoes_size; ++i) {
-    _echoes[i] = std::numeric_limits<float>::quiet_NaN();
+  std::fill_n(_echoes, _echoes_size, std::numeric_limits<float>::quiet_NaN());
+}
+
+
+/** Publish the current scan.
+ * Call this from the acquisition thread once _distances, _echoes, and
+ * _timestamp hold a complete scan. Afterwards these point to a different
+ * buffer, which is initialized with a copy of the published scan so that
+ * implementations updating only a part of the values per scan continue to
+ * work. This never blocks.
+ */
+void
+LaserAcquisitionThread::publish_scan()
+{
+  ScanBuffer &published = buffers_[back_];
+  published.seq = ++next_seq_;
+
+  back_ = middle_.exchange(back_ | BUFFER_FRESH, std::memory_order_acq_rel)
+    & BUFFER_INDEX_MASK;
+
+  // the sensor thread only reads from the published buffer, copying is safe
+  ScanBuffer &next = buffers_[back_];
+  if (_distances) {
+    memcpy(next.distances, published.distances, sizeof(float) * _distances_size);
   }
+  if (_echoes) {
+    memcpy(next.echoes, published.echoes, sizeof(float) * _echoes_size);
+  }
+  *next.timestamp = *published.timestamp;
+
+  _distances = next.distances;
+  _echoes    = next.echoes;
+  _timestamp = next.timestamp;
 }
@@ -28,8 +28,9 @@
 #include <aspect/configurable.h>
 #include <aspect/clock.h>
 
+#include <atomic>
+
 namespace fawkes {
-  class Mutex;
   class Configuration;
   class Logger;
   class Time;
@@ -45,8 +46,7 @@ class LaserAcquisitionThread
   LaserAcquisitionThread(const char *thread_name);
   virtual ~LaserAcquisitionThread();
 
-  bool lock_if_new_data();
-  void unlock();
+  bool fetch_new_data();
 
   virtual void   pre_init(fawkes::Configuration *config,
 			  fawkes::Logger *logger) = 0;
@@ -54,6 +54,7 @@ class LaserAcquisitionThread
   const float *  get_distance_data();
   const float *  get_echo_data();
   const fawkes::Time *   get_timestamp();
+  unsigned int   get_scan_seq();
 
   unsigned int   get_distance_data_size();
   unsigned int   get_echo_data_size();
@@ -66,18 +67,36 @@ class LaserAcquisitionThread
   void alloc_echoes(unsigned int num_echoes);
   void reset_distances();
   void reset_echoes();
+  void publish_scan();
 
  protected:
-  fawkes::Mutex    *_data_mutex;
   fawkes::Time     *_timestamp;
 
-  bool    _new_data;
   float  *_distances;
   float  *_echoes;
 
   unsigned int  _distances_size;
   unsigned int  _echoes_size;
 
+ private:
+  /// @cond INTERNALS
+  typedef struct {
+    float        *distances;
+    float        *echoes;
+    fawkes::Time *timestamp;
+    unsigned int  seq;
+  } ScanBuffer;
+  /// @endcond
+
+  static const unsigned int NUM_BUFFERS = 3;
+  static const unsigned int BUFFER_INDEX_MASK = 0x3;
+  static const unsigned int BUFFER_FRESH = 0x4;
+
+  ScanBuffer                 buffers_[NUM_BUFFERS];
+  unsigned int               back_;
+  unsigned int               front_;
+  std::atomic<unsigned int>  middle_;
+  unsigned int               next_seq_;
 };
 
 
@@ -23,7 +23,6 @@
 
 #include "lase_edl_aqt.h"
 
-#include <core/threading/mutex.h>
 
 #include <vector>
 #include <cstdlib>
@@ -278,18 +277,14 @@ LaseEdlAcquisitionThread::init()
     }
   }
 
-  _distances  = (float *)malloc(sizeof(float) * number_of_values_);
-  _echoes     = (float *)malloc(sizeof(float) * number_of_values_);
+  alloc_distances(number_of_values_);
+  alloc_echoes(number_of_values_);
 }
 
 
 void
 LaseEdlAcquisitionThread::finalize()
 {
-  free(_distances);
-  free(_echoes);
-  _distances = _echoes = NULL;
-
   logger->log_debug("LaseEdlAcquisitionThread", "Resetting laser");
   DO_RESET(RESETLEVEL_HALT_IDLE);
 }
@@ -653,8 +648,6 @@ LaseEdlAcquisitionThread::process_profiles()
   register int dist_index = (int)roundf(cfg_mount_rotation_ * 16 / cfg_angle_step_);
   register int echo_index = dist_index;
 
-  _data_mutex->lock();
-  _new_data = true;
   _timestamp->stamp();
 
   // see which data is requested
@@ -688,7 +681,7 @@ LaseEdlAcquisitionThread::process_profiles()
     }
   }
 
-  _data_mutex->unlock();
+  publish_scan();
 
   free(real_response);
   free(expected_response);
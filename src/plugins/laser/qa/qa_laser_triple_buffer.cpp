@@ -0,0 +1,131 @@
+
+/***************************************************************************
+ *  qa_laser_triple_buffer.cpp - QA for the laser scan triple buffer
+ *
+ *  Created: Sun Oct 25 11:12:40 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+/// @cond QA
+
+// A writer thread publishes two million scans as fast as possible. Each
+// scan has all beams, echoes and the timestamp set to its sequence number.
+// The reader fetches concurrently and checks every fetched scan for
+// consistency, i.e. that it was never modified while being read and
+// never mixes data of two scans.
+
+#include "../acquisition_thread.h"
+#include <utils/time/time.h>
+
+#include <cstdio>
+#include <unistd.h>
+
+using namespace fawkes;
+
+#define NUM_SCANS  2000000
+#define NUM_BEAMS  360
+
+class SyntheticAcquisitionThread : public LaserAcquisitionThread
+{
+ public:
+  SyntheticAcquisitionThread()
+    : LaserAcquisitionThread("SyntheticAcquisitionThread")
+  {
+    alloc_distances(NUM_BEAMS);
+    alloc_echoes(NUM_BEAMS);
+    scan_ = 0;
+  }
+
+  virtual void pre_init(Configuration *config, Logger *logger) {}
+
+  virtual void loop()
+  {
+    if (scan_ == NUM_SCANS) {
+      usleep(1000);
+      return;
+    }
+
+    ++scan_;
+    for (unsigned int i = 0; i < NUM_BEAMS; ++i) {
+      _distances[i] = scan_;
+      _echoes[i]    = scan_;
+    }
+    _timestamp->set_time(scan_, 0);
+    publish_scan();
+  }
+
+ private:
+  unsigned int scan_;
+};
+
+
+int
+main(int argc, char **argv)
+{
+  SyntheticAcquisitionThread aqt;
+
+  unsigned int fetched = 0, inconsistent = 0, out_of_order = 0;
+  unsigned int last_seq = 0;
+
+  Time start;
+  aqt.start();
+  while (last_seq < NUM_SCANS) {
+    if (! aqt.fetch_new_data()) {
+      // let the writer run on machines with a single core
+      usleep(0);
+      continue;
+    }
+
+    const unsigned int seq = aqt.get_scan_seq();
+    const float *distances = aqt.get_distance_data();
+    const float *echoes    = aqt.get_echo_data();
+    bool consistent = (aqt.get_timestamp()->get_sec() == (long int)seq);
+    for (unsigned int i = 0; consistent && (i < NUM_BEAMS); ++i) {
+      consistent = (distances[i] == seq) && (echoes[i] == seq);
+    }
+    // check again at the end, catches a buffer written while reading it
+    consistent = consistent && (distances[0] == seq) && (aqt.get_scan_seq() == seq);
+
+    if (! consistent)      ++inconsistent;
+    if (seq <= last_seq)   ++out_of_order;
+    last_seq = seq;
+    ++fetched;
+  }
+  Time end;
+  aqt.cancel();
+  aqt.join();
+
+  printf("Published %u scans in %.2f sec, fetched %u, skipped %u\n",
+	 NUM_SCANS, end - &start, fetched, NUM_SCANS - fetched);
+
+  int rv = 0;
+  if (inconsistent > 0) {
+    printf("FAILED: %u inconsistent scans\n", inconsistent);
+    rv = 1;
+  }
+  if (out_of_order > 0) {
+    printf("FAILED: %u scans out of order\n", out_of_order);
+    rv = 2;
+  }
+  if (aqt.fetch_new_data()) {
+    printf("FAILED: new data after the last scan\n");
+    rv = 3;
+  }
+  if (rv == 0)  printf("PASSED\n");
+  return rv;
+}
+
+/// @endcond
@@ -33,6 +33,8 @@ using namespace fawkes;
  * Laser sensor thread.
  * This thread integrates into the Fawkes main loop at the sensor hook and
  * publishes new data when available from the LaserAcquisitionThread.
+ * Only the newest scan is published, scans acquired in the meantime are
+ * counted as skipped and reported on finalization.
  * @author Tim Niemueller
  */
 
@@ -62,6 +64,10 @@ LaserSensorThread::init()
   laser720_if_ = NULL;
   laser1080_if_ = NULL;
 
+  last_seq_ = 0;
+  num_published_ = 0;
+  num_skipped_ = 0;
+
   bool main_sensor  = false;
 
   cfg_frame_ = config->get_string((cfg_prefix_ + "frame").c_str());
@@ -102,6 +108,11 @@ LaserSensorThread::init()
 void
 LaserSensorThread::finalize()
 {
+  if (num_skipped_ > 0) {
+    logger->log_info(name(), "Published %u scans, skipped %u scans",
+		     num_published_, num_skipped_);
+  }
+
   blackboard->close(laser360_if_);
   blackboard->close(laser720_if_);
   blackboard->close(laser1080_if_);
@@ -110,7 +121,12 @@ LaserSensorThread::finalize()
 void
 LaserSensorThread::loop()
 {
-  if ( aqt_->lock_if_new_data() ) {
+  if ( aqt_->fetch_new_data() ) {
+    unsigned int seq = aqt_->get_scan_seq();
+    if (last_seq_ != 0)  num_skipped_ += seq - last_seq_ - 1;
+    last_seq_ = seq;
+    ++num_published_;
+
     if (num_values_ == 360) {
       laser360_if_->set_timestamp(aqt_->get_timestamp());
       laser360_if_->set_distances(aqt_->get_distance_data());
@@ -124,6 +140,5 @@ LaserSensorThread::loop()
       laser1080_if_->set_distances(aqt_->get_distance_data());
       laser1080_if_->write();
     }
-    aqt_->unlock();
   }
 }
@@ -65,6 +65,9 @@ class LaserSensorThread
   LaserAcquisitionThread *aqt_;
 
   unsigned int            num_values_;
+  unsigned int            last_seq_;
+  unsigned int            num_published_;
+  unsigned int            num_skipped_;
 
   std::string             cfg_name_;
   std::string             cfg_frame_;
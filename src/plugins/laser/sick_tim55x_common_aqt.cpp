@@ -318,7 +318,6 @@ SickTiM55xCommonAcquisitionThread::parse_datagram(const unsigned char *datagram,
   // This is already determined above in number_of_data
 
   // 26..26 + n - 1: Data_1 .. Data_n
-  _data_mutex->lock();
   _timestamp->stamp();
 
   int start_idx = (int)roundf(rad2deg(angle_min) / angle_increment_deg);
@@ -353,14 +352,12 @@ SickTiM55xCommonAcquisitionThread::parse_datagram(const unsigned char *datagram,
     }
   }
 
-  _new_data = true;
-
   float time_increment = scan_time * angle_increment / (2.0 * M_PI);
 
   *_timestamp -= (double)number_of_data * time_increment;
   *_timestamp += cfg_time_offset_;
 
-  _data_mutex->unlock();
+  publish_scan();
 
   // 26 + n: RSSI data included
   // IF RSSI not included:
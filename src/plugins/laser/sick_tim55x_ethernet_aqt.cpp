@@ -87,12 +87,6 @@ SickTiM55xEthernetAcquisitionThread::init()
 void
 SickTiM55xEthernetAcquisitionThread::finalize()
 {
-  free(_distances);
-  _distances = NULL;
-
-  free(_echoes);
-  _echoes = NULL;
-
   delete socket_mutex_;
 }
 
@@ -131,10 +125,8 @@ SickTiM55xEthernetAcquisitionThread::loop()
 	} else {
 	  logger->log_warn(name(), "Data read error: %s\n", ec_.message().c_str());
 	}
-	_data_mutex->lock();
 	_timestamp->stamp();
-	_new_data = true;
-	_data_mutex->unlock();
+	publish_scan();
 	close_device();
 
       } else {
@@ -150,6 +142,9 @@ SickTiM55xEthernetAcquisitionThread::loop()
 	  } catch (Exception &e) {
 	    logger->log_warn(name(), "Failed to parse datagram, resyncing, exception follows");
 	    logger->log_warn(name(), e);
+	    // publish the reset scan, as after a read error
+	    _timestamp->stamp();
+	    publish_scan();
 	    resync();
 	  }
 	}
@@ -118,12 +118,6 @@ SickTiM55xUSBAcquisitionThread::finalize()
   }
   libusb_exit(usb_ctx_);
 
-  free(_distances);
-  _distances = NULL;
-
-  free(_echoes);
-  _echoes = NULL;
-
   delete usb_mutex_;
 }
 
@@ -152,6 +146,8 @@ SickTiM55xUSBAcquisitionThread::loop()
       }
       reset_distances();
       reset_echoes();
+      _timestamp->stamp();
+      publish_scan();
       return;
     } else {
       recv_buf[actual_length] = 0;
@@ -165,6 +161,9 @@ SickTiM55xUSBAcquisitionThread::loop()
       } catch (Exception &e) {
 	logger->log_warn(name(), "Failed to parse datagram, resyncing, exception follows");
 	logger->log_warn(name(), e);
+	// publish the reset scan, as after a read error
+	_timestamp->stamp();
+	publish_scan();
 	resync();
       }
     }
@@ -22,7 +22,6 @@
 
 #include "urg_aqt.h"
 
-#include <core/threading/mutex.h>
 #include <utils/time/wait.h>
 
 #include <urg/UrgCtrl.h>
@@ -299,8 +298,6 @@ HokuyoUrgAcquisitionThread::init()
 void
 HokuyoUrgAcquisitionThread::finalize()
 {
-  free(_distances);
-  _distances = NULL;
   delete timer_;
 
   ctrl_->stop();
@@ -322,9 +319,6 @@ HokuyoUrgAcquisitionThread::loop()
   int num_values = ctrl_->capture(values);
   if (num_values > 0) {
     //logger->log_debug(name(), "Captured %i values", num_values);
-    _data_mutex->lock();
-
-    _new_data = true;
     _timestamp->stamp();
     *_timestamp += cfg_time_offset_;
     for (unsigned int a = 0; a < 360; ++a) {
@@ -390,7 +384,7 @@ HokuyoUrgAcquisitionThread::loop()
         }
       }
     }
-    _data_mutex->unlock();
+    publish_scan();
   //} else {
     //logger->log_warn(name(), "No new scan available, ignoring");
   }
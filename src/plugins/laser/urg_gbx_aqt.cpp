@@ -22,7 +22,6 @@
 
 #include "urg_gbx_aqt.h"
 
-#include <core/threading/mutex.h>
 
 #ifdef HAVE_URG_GBX_9_11
 #  include <hokuyo_aist/hokuyo_aist.h>
@@ -166,9 +165,6 @@ HokuyoUrgGbxAcquisitionThread::init()
 void
 HokuyoUrgGbxAcquisitionThread::finalize()
 {
-  free(_distances);
-  _distances = NULL;
-
   logger->log_debug(name(), "Stopping laser");
 #ifdef HAVE_URG_GBX_9_11
   laser_->SetPower(false);
@@ -215,9 +211,6 @@ HokuyoUrgGbxAcquisitionThread::loop()
   const uint32_t *ranges = data_->ranges();
 #endif
 
-  _data_mutex->lock();
-
-  _new_data = true;
   _timestamp->stamp();
   for (unsigned int a = 0; a < 360; ++a) {
     unsigned int frontrel_idx = front_idx_ + roundf(a * step_per_angle_);
@@ -227,5 +220,5 @@ HokuyoUrgGbxAcquisitionThread::loop()
       _distances[a] = ranges[idx] / 1000.f;
     }
   }
-  _data_mutex->unlock();
+  publish_scan();
 }
@@ -285,6 +285,7 @@ LuaAgentContinuousExecutionThread::LuaThread::LuaThread(fawkes::LuaContext *lua)
 {
   set_prepfin_conc_loop(true);
   lua_ = lua;
+  lua_execute_ = lua_->add_entry_point("agentenv.execute");
   failed_ = false;
 }
 
@@ -296,7 +297,7 @@ LuaAgentContinuousExecutionThread::LuaThread::loop()
   while (!failed_) {
     try {
       // Stack:
-      lua_->do_string("agentenv.execute()");
+      lua_->call_entry_point(lua_execute_);
     } catch (Exception &e) {
       failed_ = true;
       logger->log_error(name(), "execute() failed, exception follows");
@@ -93,6 +93,7 @@ class LuaAgentContinuousExecutionThread
     bool failed() { return failed_; }
    private:
     fawkes::LuaContext  *lua_;
+    unsigned int         lua_execute_;
     bool failed_;
   };
 
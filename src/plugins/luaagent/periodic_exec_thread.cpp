@@ -158,6 +158,8 @@ LuaAgentPeriodicExecutionThread::init()
     lua_ifi_->push_interfaces();
 
     lua_->set_start_script(LUADIR"/luaagent/fawkes/start.lua");
+
+    lua_execute_ = lua_->add_entry_point("agentenv.execute");
   } catch (Exception &e) {
     init_failure_cleanup();
     throw;
@@ -232,7 +234,7 @@ LuaAgentPeriodicExecutionThread::loop()
 
   try {
     // Stack:
-    lua_->do_string("agentenv.execute()");
+    lua_->call_entry_point(lua_execute_);
   } catch (Exception &e) {
     logger->log_error("LuaAgentPeriodicExecutionThread", "Execution of %s.execute() failed, exception follows",
 		      cfg_agent_.c_str());
@@ -85,6 +85,7 @@ class LuaAgentPeriodicExecutionThread
   fawkes::SkillerDebugInterface *agdbg_if_;
 
   fawkes::LuaContext  *lua_;
+  unsigned int         lua_execute_;
   fawkes::LuaInterfaceImporter  *lua_ifi_;
 };
 
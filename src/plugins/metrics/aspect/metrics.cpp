@@ -23,13 +23,35 @@
 
 namespace fawkes {
 
-/** @class MetricsAspect <plugins/metrics/aspect/metrics_supplier.h>
+/** @class MetricsAspect <plugins/metrics/aspect/metrics.h>
  * Thread aspect to provide metrics.
+ * Threads can either implement a MetricsSupplier which creates the metric
+ * families on request, or register metrics with the metrics_registry and
+ * update them in place. The latter only costs an atomic operation per
+ * update and is preferable for metrics updated at a high rate.
 
  * @ingroup Aspects
  * @author Tim Niemueller
  */
 
+/** @var MetricsRegistry * MetricsAspect::metrics_registry
+ * Registry for metrics of this thread.
+ * The registered metrics are exported while the thread is running. They
+ * can be registered and updated at any time, e.g. in the constructor or
+ * in init(), and remain valid until the thread is destroyed.
+ */
+
+/** Constructor.
+ * Use this constructor if the thread only uses the metrics_registry.
+ */
+MetricsAspect::MetricsAspect()
+{
+  add_aspect("MetricsAspect");
+  metrics_supplier_ = NULL;
+  metrics_registry  = new MetricsRegistry();
+}
+
+
 /** Constructor.
  * @param metrics_supplier metrics supplier
  */
@@ -37,17 +59,19 @@ MetricsAspect::MetricsAspect(MetricsSupplier *metrics_supplier)
 {
   add_aspect("MetricsAspect");
   metrics_supplier_ = metrics_supplier;
+  metrics_registry  = new MetricsRegistry();
 }
 
 
-/** Virtual empty destructor. */
+/** Virtual destructor. */
 MetricsAspect::~MetricsAspect()
 {
+  delete metrics_registry;
 }
 
 
 /** Get metrics supplier of this thread.
- * @return metrics supplier
+ * @return metrics supplier, may be NULL
  */
 MetricsSupplier *
 MetricsAspect::get_metrics_supplier() const
@@ -25,6 +25,7 @@
 #define _PLUGINS_METRICS_ASPECT_METRICS_H_
 
 #include <aspect/aspect.h>
+#include <plugins/metrics/aspect/metrics_registry.h>
 
 namespace fawkes {
 
@@ -36,9 +37,13 @@ class MetricsAspect : public virtual Aspect
 	friend MetricsAspectIniFin;
 
  public:
+	MetricsAspect();
 	MetricsAspect(MetricsSupplier *metrics_supplier) __attribute__((nonnull));
 	virtual ~MetricsAspect();
 
+ protected:
+	MetricsRegistry *  metrics_registry;
+
  private:
 	MetricsSupplier *  get_metrics_supplier() const;
 	
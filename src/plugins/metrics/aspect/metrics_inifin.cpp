@@ -57,7 +57,10 @@ MetricsAspectIniFin::init(Thread *thread)
 					  "has not. ", thread->name());
   }
   
-  metrics_mgr_->add_supplier(metrics_thread->get_metrics_supplier());
+  if (metrics_thread->get_metrics_supplier()) {
+    metrics_mgr_->add_supplier(metrics_thread->get_metrics_supplier());
+  }
+  metrics_mgr_->add_supplier(metrics_thread->metrics_registry);
 }
 
 void
@@ -71,7 +74,10 @@ MetricsAspectIniFin::finalize(Thread *thread)
 					"has not. ", thread->name());
   }
 
-  metrics_mgr_->remove_supplier(metrics_thread->get_metrics_supplier());
+  if (metrics_thread->get_metrics_supplier()) {
+    metrics_mgr_->remove_supplier(metrics_thread->get_metrics_supplier());
+  }
+  metrics_mgr_->remove_supplier(metrics_thread->metrics_registry);
 }
 
 
@@ -0,0 +1,486 @@
+
+/***************************************************************************
+ *  metrics_registry.cpp - In-process metrics registry
+ *
+ *  Created: Fri Oct 23 09:12:37 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#include <plugins/metrics/aspect/metrics_registry.h>
+#include <core/threading/mutex.h>
+#include <core/threading/mutex_locker.h>
+#include <core/exception.h>
+#include <utils/misc/string_split.h>
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace fawkes {
+
+/** @class MetricsRegistry <plugins/metrics/aspect/metrics_registry.h>
+ * Registry for metrics updated in-process.
+ * Metrics in the registry are updated with atomic operations and without
+ * taking any lock, which makes them suitable for instrumenting hot loops.
+ * Counters and gauges are a single atomic value. Histograms are split into
+ * NUM_SHARDS shards, each thread always updates the same shard so that
+ * threads recording the same histogram rarely contend on a cache line.
+ * Each shard and its buckets occupy separate cache lines. Shards are
+ * merged when the metrics are collected.
+ *
+ * Names, help texts and labels are converted to the exported metric family
+ * once on registration. Collecting the metrics only updates the values of
+ * these cached families. The exposition formats are written to buffers
+ * kept per family, append_text() and append_protobuf() reuse them and the
+ * constant parts of the text format on every scrape instead of copying
+ * the families as metrics() does.
+ *
+ * Metrics are owned by the registry and valid until it is destroyed.
+ * Requesting a metric with the same name and labels again returns the
+ * existing instance. Labels are given as comma-separated list of
+ * key=value pairs, the same format used by the metric interfaces.
+ * @author agent
+ */
+
+/** @class MetricsRegistry::Counter <plugins/metrics/aspect/metrics_registry.h>
+ * Monotonically increasing counter.
+ * @author agent
+ */
+
+/** @class MetricsRegistry::Gauge <plugins/metrics/aspect/metrics_registry.h>
+ * Gauge which can be set to arbitrary values.
+ * @author agent
+ */
+
+/** @class MetricsRegistry::Histogram <plugins/metrics/aspect/metrics_registry.h>
+ * Histogram with fixed bucket upper bounds.
+ * @author agent
+ */
+
+/** Constructor.
+ * @param upper_bounds bucket upper bounds
+ */
+MetricsRegistry::Histogram::Histogram(const std::vector<double> &upper_bounds)
+	: upper_bounds_(upper_bounds)
+{
+	std::sort(upper_bounds_.begin(), upper_bounds_.end());
+
+	// each shard's buckets start on their own cache line
+	const size_t per_line = 64 / sizeof(std::atomic<uint64_t>);
+	const size_t stride   = (upper_bounds_.size() + per_line - 1) / per_line * per_line;
+
+	void *shards_mem = NULL, *buckets_mem = NULL;
+	if ((posix_memalign(&shards_mem, 64, NUM_SHARDS * sizeof(Shard)) != 0) ||
+	    (posix_memalign(&buckets_mem, 64,
+	                    std::max<size_t>(1, NUM_SHARDS * stride) * sizeof(std::atomic<uint64_t>)) != 0))
+	{
+		free(shards_mem);
+		throw Exception("Failed to allocate histogram shards");
+	}
+	shards_  = (Shard *)shards_mem;
+	buckets_ = (std::atomic<uint64_t> *)buckets_mem;
+
+	for (unsigned int i = 0; i < NUM_SHARDS; ++i) {
+		new (&shards_[i]) Shard();
+		shards_[i].count   = 0;
+		shards_[i].sum     = 0.;
+		shards_[i].buckets = &buckets_[i * stride];
+		for (size_t b = 0; b < stride; ++b) {
+			new (&shards_[i].buckets[b]) std::atomic<uint64_t>(0);
+		}
+	}
+}
+
+/** Destructor. */
+MetricsRegistry::Histogram::~Histogram()
+{
+	free(buckets_);
+	free(shards_);
+}
+
+
+/** Constructor. */
+MetricsRegistry::MetricsRegistry()
+{
+	mutex_ = new Mutex();
+}
+
+
+/** Destructor. */
+MetricsRegistry::~MetricsRegistry()
+{
+	for (auto &f : families_) {
+		for (void *d : f.data) {
+			switch (f.family.type()) {
+			case io::prometheus::client::COUNTER:   delete (Counter *)d;   break;
+			case io::prometheus::client::GAUGE:     delete (Gauge *)d;     break;
+			case io::prometheus::client::HISTOGRAM: delete (Histogram *)d; break;
+			default: break;
+			}
+		}
+	}
+	delete mutex_;
+}
+
+
+/** Get shard index for the calling thread.
+ * @return shard index, the same for all calls from a thread
+ */
+unsigned int
+MetricsRegistry::shard_index()
+{
+	static std::atomic<unsigned int> next_shard(0);
+	static thread_local unsigned int shard =
+		next_shard.fetch_add(1, std::memory_order_relaxed) % NUM_SHARDS;
+	return shard;
+}
+
+
+io::prometheus::client::Metric *
+MetricsRegistry::add_metric(const std::string &name, const std::string &help,
+                            io::prometheus::client::MetricType type,
+                            const std::string &labels, Family *&family, int &index)
+{
+	family = NULL;
+	for (auto &f : families_) {
+		if (f.family.name() == name) {
+			if (f.family.type() != type) {
+				throw Exception("Metric %s already registered with different type", name.c_str());
+			}
+			family = &f;
+			break;
+		}
+	}
+	if (! family) {
+		families_.push_back(Family());
+		family = &families_.back();
+		family->family.set_name(name);
+		family->family.set_help(help);
+		family->family.set_type(type);
+
+		const char *typestr = "untyped";
+		switch (type) {
+		case io::prometheus::client::COUNTER:   typestr = "counter";   break;
+		case io::prometheus::client::GAUGE:     typestr = "gauge";     break;
+		case io::prometheus::client::HISTOGRAM: typestr = "histogram"; break;
+		default: break;
+		}
+		family->text_header =
+			"\n# HELP " + name + " " + help + "\n# TYPE " + name + " " + typestr + "\n";
+	}
+
+	io::prometheus::client::Metric m;
+	std::vector<std::string> labelv = str_split(labels, ',');
+	for (const std::string &l : labelv) {
+		std::vector<std::string> key_value = str_split(l, '=');
+		if (key_value.size() != 2) {
+			throw Exception("Invalid label '%s' for metric %s", l.c_str(), name.c_str());
+		}
+		io::prometheus::client::LabelPair *lp = m.add_label();
+		lp->set_name(key_value[0]);
+		lp->set_value(key_value[1]);
+	}
+
+	for (index = 0; index < family->family.metric_size(); ++index) {
+		const io::prometheus::client::Metric &em = family->family.metric(index);
+		if (em.label_size() != m.label_size())  continue;
+		bool equal = true;
+		for (int l = 0; equal && l < m.label_size(); ++l) {
+			equal = (em.label(l).name() == m.label(l).name()) &&
+				(em.label(l).value() == m.label(l).value());
+		}
+		if (equal)  return family->family.mutable_metric(index);
+	}
+
+	io::prometheus::client::Metric *rm = family->family.add_metric();
+	rm->Swap(&m);
+	family->data.push_back(NULL);
+	family->text_prefixes.clear();
+	return rm;
+}
+
+
+/** Get counter.
+ * @param name metric name
+ * @param help help text describing the metric
+ * @param labels labels of this instance as key=value,key=value
+ * @return counter, owned by the registry
+ * @exception Exception thrown if a metric of another type has the same name
+ * or the labels are invalid
+ */
+MetricsRegistry::Counter *
+MetricsRegistry::counter(const std::string &name, const std::string &help,
+                         const std::string &labels)
+{
+	MutexLocker lock(mutex_);
+	Family *f;
+	int index;
+	io::prometheus::client::Metric *m =
+		add_metric(name, help, io::prometheus::client::COUNTER, labels, f, index);
+	if (! f->data[index]) {
+		m->mutable_counter()->set_value(0.);
+		f->data[index] = new Counter();
+	}
+	return (Counter *)f->data[index];
+}
+
+
+/** Get gauge.
+ * @param name metric name
+ * @param help help text describing the metric
+ * @param labels labels of this instance as key=value,key=value
+ * @return gauge, owned by the registry
+ * @exception Exception thrown if a metric of another type has the same name
+ * or the labels are invalid
+ */
+MetricsRegistry::Gauge *
+MetricsRegistry::gauge(const std::string &name, const std::string &help,
+                       const std::string &labels)
+{
+	MutexLocker lock(mutex_);
+	Family *f;
+	int index;
+	io::prometheus::client::Metric *m =
+		add_metric(name, help, io::prometheus::client::GAUGE, labels, f, index);
+	if (! f->data[index]) {
+		m->mutable_gauge()->set_value(0.);
+		f->data[index] = new Gauge();
+	}
+	return (Gauge *)f->data[index];
+}
+
+
+/** Get histogram.
+ * If the histogram already exists the given bucket bounds are ignored.
+ * @param name metric name
+ * @param help help text describing the metric
+ * @param upper_bounds bucket upper bounds, need not be sorted
+ * @param labels labels of this instance as key=value,key=value
+ * @return histogram, owned by the registry
+ * @exception Exception thrown if a metric of another type has the same name
+ * or the labels are invalid
+ */
+MetricsRegistry::Histogram *
+MetricsRegistry::histogram(const std::string &name, const std::string &help,
+                           const std::vector<double> &upper_bounds,
+                           const std::string &labels)
+{
+	MutexLocker lock(mutex_);
+	Family *f;
+	int index;
+	io::prometheus::client::Metric *m =
+		add_metric(name, help, io::prometheus::client::HISTOGRAM, labels, f, index);
+	if (! f->data[index]) {
+		Histogram *h = new Histogram(upper_bounds);
+		io::prometheus::client::Histogram *ph = m->mutable_histogram();
+		for (double b : h->upper_bounds_) {
+			ph->add_bucket()->set_upper_bound(b);
+		}
+		f->data[index] = h;
+	}
+	return (Histogram *)f->data[index];
+}
+
+
+void
+MetricsRegistry::update_values(Family &f)
+{
+	for (int i = 0; i < f.family.metric_size(); ++i) {
+		io::prometheus::client::Metric *m = f.family.mutable_metric(i);
+		switch (f.family.type()) {
+		case io::prometheus::client::COUNTER:
+			m->mutable_counter()->set_value(((Counter *)f.data[i])->value());
+			break;
+
+		case io::prometheus::client::GAUGE:
+			m->mutable_gauge()->set_value(((Gauge *)f.data[i])->value());
+			break;
+
+		case io::prometheus::client::HISTOGRAM:
+			{
+				Histogram *h = (Histogram *)f.data[i];
+				io::prometheus::client::Histogram *ph = m->mutable_histogram();
+				uint64_t count = 0;
+				double   sum   = 0.;
+				for (unsigned int s = 0; s < NUM_SHARDS; ++s) {
+					count += h->shards_[s].count.load(std::memory_order_relaxed);
+					sum   += h->shards_[s].sum.load(std::memory_order_relaxed);
+				}
+				uint64_t cumulative = 0;
+				for (size_t b = 0; b < h->upper_bounds_.size(); ++b) {
+					for (unsigned int s = 0; s < NUM_SHARDS; ++s) {
+						cumulative += h->shards_[s].buckets[b].load(std::memory_order_relaxed);
+					}
+					ph->mutable_bucket(b)->set_cumulative_count(cumulative);
+				}
+				// shards are read one after another, keep the result consistent
+				ph->set_sample_count(std::max(count, cumulative));
+				ph->set_sample_sum(sum);
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+}
+
+
+void
+MetricsRegistry::update_text(Family &f)
+{
+	// The text format follows the one of the metrics request processor.
+	// Everything except the values is only formatted once.
+	const std::string &name = f.family.name();
+	if (f.text_prefixes.empty()) {
+		for (int i = 0; i < f.family.metric_size(); ++i) {
+			const io::prometheus::client::Metric &m = f.family.metric(i);
+			std::string labels;
+			for (int l = 0; l < m.label_size(); ++l) {
+				labels += (l == 0) ? " {" : ",";
+				labels += m.label(l).name() + "=" + m.label(l).value();
+			}
+			if (! labels.empty())  labels += "}";
+
+			if (f.family.type() == io::prometheus::client::HISTOGRAM) {
+				const io::prometheus::client::Histogram &h = m.histogram();
+				for (int b = 0; b < h.bucket_size(); ++b) {
+					std::string le = "le=" + std::to_string(h.bucket(b).upper_bound()) + "}";
+					if (labels.empty()) {
+						f.text_prefixes.push_back(name + " {" + le + " ");
+					} else {
+						f.text_prefixes.push_back(name + labels.substr(0, labels.size() - 1) +
+						                          "," + le + " ");
+					}
+				}
+				f.text_prefixes.push_back(name + "_sum" + labels + " ");
+				f.text_prefixes.push_back(name + "_count" + labels + " ");
+			} else {
+				f.text_prefixes.push_back(name + labels + " ");
+			}
+		}
+	}
+
+	f.text = f.text_header;
+	std::vector<std::string>::const_iterator p = f.text_prefixes.begin();
+	char value[64];
+	for (int i = 0; i < f.family.metric_size(); ++i) {
+		const io::prometheus::client::Metric &m = f.family.metric(i);
+		switch (f.family.type()) {
+		case io::prometheus::client::COUNTER:
+			snprintf(value, sizeof(value), "%f\n", m.counter().value());
+			f.text += *p++;
+			f.text += value;
+			break;
+
+		case io::prometheus::client::GAUGE:
+			snprintf(value, sizeof(value), "%f\n", m.gauge().value());
+			f.text += *p++;
+			f.text += value;
+			break;
+
+		case io::prometheus::client::HISTOGRAM:
+			{
+				const io::prometheus::client::Histogram &h = m.histogram();
+				for (int b = 0; b < h.bucket_size(); ++b) {
+					snprintf(value, sizeof(value), "%lu\n",
+					         (unsigned long)h.bucket(b).cumulative_count());
+					f.text += *p++;
+					f.text += value;
+				}
+				snprintf(value, sizeof(value), "%f\n", h.sample_sum());
+				f.text += *p++;
+				f.text += value;
+				snprintf(value, sizeof(value), "%lu\n", (unsigned long)h.sample_count());
+				f.text += *p++;
+				f.text += value;
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+}
+
+
+void
+MetricsRegistry::update_protobuf(Family &f)
+{
+	// length-delimited, as expected by Prometheus for the protobuf format
+	const int size = f.family.ByteSize();
+	f.protobuf.clear();
+	{
+		google::protobuf::io::StringOutputStream raw_output(&f.protobuf);
+		google::protobuf::io::CodedOutputStream output(&raw_output);
+		output.WriteVarint32(size);
+	}
+	f.family.AppendToString(&f.protobuf);
+}
+
+
+std::list<io::prometheus::client::MetricFamily>
+MetricsRegistry::metrics()
+{
+	std::list<io::prometheus::client::MetricFamily> rv;
+
+	MutexLocker lock(mutex_);
+	for (auto &f : families_) {
+		update_values(f);
+		rv.push_back(f.family);
+	}
+
+	return rv;
+}
+
+
+/** Append metrics in the Prometheus text format.
+ * The output is the same as the metrics request processor produces for
+ * the families returned by metrics().
+ * @param buffer buffer to append to
+ */
+void
+MetricsRegistry::append_text(std::string &buffer)
+{
+	MutexLocker lock(mutex_);
+	for (auto &f : families_) {
+		update_values(f);
+		update_text(f);
+		buffer += f.text;
+	}
+}
+
+
+/** Append metrics in the length-delimited protobuf format.
+ * @param buffer buffer to append to
+ */
+void
+MetricsRegistry::append_protobuf(std::string &buffer)
+{
+	MutexLocker lock(mutex_);
+	for (auto &f : families_) {
+		update_values(f);
+		update_protobuf(f);
+		buffer += f.protobuf;
+	}
+}
+
+} // end namespace fawkes
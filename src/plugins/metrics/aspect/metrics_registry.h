@@ -0,0 +1,172 @@
+
+/***************************************************************************
+ *  metrics_registry.h - In-process metrics registry
+ *
+ *  Created: Fri Oct 23 09:12:37 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+#ifndef _PLUGINS_METRICS_ASPECT_METRICS_REGISTRY_H_
+#define _PLUGINS_METRICS_ASPECT_METRICS_REGISTRY_H_
+
+#include <plugins/metrics/aspect/metrics_supplier.h>
+
+#include <algorithm>
+#include <atomic>
+#include <list>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace fawkes {
+
+class Mutex;
+
+class MetricsRegistry : public MetricsSupplier
+{
+ public:
+	class Counter
+	{
+		friend MetricsRegistry;
+	 public:
+		/** Increment counter.
+		 * @param v value to add, must not be negative */
+		void inc(double v = 1.) { atomic_add(value_, v); }
+		/** Get current value.
+		 * @return current value */
+		double value() const { return value_.load(std::memory_order_relaxed); }
+
+	 private:
+		Counter() : value_(0.) {}
+		std::atomic<double> value_;
+	};
+
+	class Gauge
+	{
+		friend MetricsRegistry;
+	 public:
+		/** Set gauge.
+		 * @param v new value */
+		void set(double v) { value_.store(v, std::memory_order_relaxed); }
+		/** Increment gauge.
+		 * @param v value to add */
+		void inc(double v = 1.) { atomic_add(value_, v); }
+		/** Decrement gauge.
+		 * @param v value to subtract */
+		void dec(double v = 1.) { atomic_add(value_, -v); }
+		/** Get current value.
+		 * @return current value */
+		double value() const { return value_.load(std::memory_order_relaxed); }
+
+	 private:
+		Gauge() : value_(0.) {}
+		std::atomic<double> value_;
+	};
+
+	class Histogram
+	{
+		friend MetricsRegistry;
+	 public:
+		/** Record an observation.
+		 * @param v observed value */
+		void observe(double v)
+		{
+			Shard &s = shards_[shard_index()];
+			size_t b = std::lower_bound(upper_bounds_.begin(), upper_bounds_.end(), v)
+				- upper_bounds_.begin();
+			if (b < upper_bounds_.size()) {
+				s.buckets[b].fetch_add(1, std::memory_order_relaxed);
+			}
+			s.count.fetch_add(1, std::memory_order_relaxed);
+			atomic_add(s.sum, v);
+		}
+
+	 private:
+		Histogram(const std::vector<double> &upper_bounds);
+		~Histogram();
+
+		/// @cond INTERNALS
+		struct alignas(64) Shard {
+			std::atomic<uint64_t>  count;
+			std::atomic<double>    sum;
+			std::atomic<uint64_t> *buckets;
+		};
+		/// @endcond
+
+		std::vector<double>    upper_bounds_;
+		std::atomic<uint64_t> *buckets_;
+		Shard                 *shards_;
+	};
+
+	MetricsRegistry();
+	virtual ~MetricsRegistry();
+
+	Counter *   counter(const std::string &name, const std::string &help,
+	                    const std::string &labels = "");
+	Gauge *     gauge(const std::string &name, const std::string &help,
+	                  const std::string &labels = "");
+	Histogram * histogram(const std::string &name, const std::string &help,
+	                      const std::vector<double> &upper_bounds,
+	                      const std::string &labels = "");
+
+	// for MetricsSupplier
+	virtual std::list<io::prometheus::client::MetricFamily>  metrics();
+
+	void append_text(std::string &buffer);
+	void append_protobuf(std::string &buffer);
+
+	/** Number of histogram shards. Threads are distributed among the shards. */
+	static const unsigned int NUM_SHARDS = 16;
+
+ private:
+	static inline void atomic_add(std::atomic<double> &a, double v)
+	{
+		double old = a.load(std::memory_order_relaxed);
+		while (! a.compare_exchange_weak(old, old + v, std::memory_order_relaxed)) {}
+	}
+
+	static unsigned int shard_index();
+
+	/// @cond INTERNALS
+	struct Family {
+		io::prometheus::client::MetricFamily  family;
+		std::vector<void *>                   data;
+		std::string                           text_header;
+		std::vector<std::string>              text_prefixes;
+		std::string                           text;
+		std::string                           protobuf;
+	};
+	/// @endcond
+
+	void update_values(Family &f);
+	void update_text(Family &f);
+	void update_protobuf(Family &f);
+
+	io::prometheus::client::Metric *
+	  add_metric(const std::string &name, const std::string &help,
+	             io::prometheus::client::MetricType type, const std::string &labels,
+	             Family *&family, int &index);
+
+ private:
+	Mutex             *mutex_;
+	std::list<Family>  families_;
+};
+
+} // end namespace fawkes
+
+#endif
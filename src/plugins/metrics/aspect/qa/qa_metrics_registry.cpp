@@ -0,0 +1,188 @@
+/***************************************************************************
+ *  qa_metrics_registry.cpp - QA for concurrent metrics registry updates
+ *
+ *  Created: Sun Oct 18 15:32:10 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+/// @cond QA
+
+#include <plugins/metrics/aspect/metrics_registry.h>
+#include <core/exception.h>
+
+#include <google/protobuf/io/coded_stream.h>
+
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace fawkes;
+
+#define NUM_THREADS    8
+#define NUM_INCREMENTS 200000
+
+/* Threads updating the same metrics concurrently, more threads than
+ * shards, must not lose any update. Scrapes running at the same time must
+ * see consistent histograms. */
+static bool
+test_concurrent(MetricsRegistry &registry)
+{
+	MetricsRegistry::Counter   *counter = registry.counter("qa_counter", "QA counter");
+	MetricsRegistry::Gauge     *gauge   = registry.gauge("qa_gauge", "QA gauge");
+	MetricsRegistry::Histogram *histo   =
+		registry.histogram("qa_histogram", "QA histogram", {1., 2., 3.});
+
+	const unsigned int num_threads = NUM_THREADS * 3;
+	std::vector<std::thread> threads;
+	for (unsigned int t = 0; t < num_threads; ++t) {
+		threads.push_back(std::thread([counter, gauge, histo, t]() {
+			for (unsigned int i = 0; i < NUM_INCREMENTS; ++i) {
+				counter->inc();
+				gauge->inc(2.);
+				gauge->dec();
+				histo->observe(i % 4 + 0.5);
+			}
+		}));
+	}
+
+	bool success = true;
+	for (unsigned int i = 0; i < 20; ++i) {
+		std::list<io::prometheus::client::MetricFamily> mfs = registry.metrics();
+		for (const auto &mf : mfs) {
+			if (mf.type() != io::prometheus::client::HISTOGRAM)  continue;
+			const io::prometheus::client::Histogram &h = mf.metric(0).histogram();
+			if (h.bucket(2).cumulative_count() > h.sample_count()) {
+				printf("Histogram count %lu below bucket count %lu\n",
+				       (unsigned long)h.sample_count(),
+				       (unsigned long)h.bucket(2).cumulative_count());
+				success = false;
+			}
+		}
+	}
+
+	for (auto &t : threads)  t.join();
+
+	const double total = (double)num_threads * NUM_INCREMENTS;
+	if (counter->value() != total) {
+		printf("Counter is %f, expected %f\n", counter->value(), total);
+		success = false;
+	}
+	if (gauge->value() != total) {
+		printf("Gauge is %f, expected %f\n", gauge->value(), total);
+		success = false;
+	}
+
+	std::list<io::prometheus::client::MetricFamily> mfs = registry.metrics();
+	for (const auto &mf : mfs) {
+		if (mf.type() != io::prometheus::client::HISTOGRAM)  continue;
+		const io::prometheus::client::Histogram &h = mf.metric(0).histogram();
+		// a quarter each of 0.5, 1.5, 2.5 and 3.5, the last in no bucket
+		if (h.sample_count() != total || h.bucket(0).cumulative_count() != total / 4 ||
+		    h.bucket(1).cumulative_count() != total / 2 ||
+		    h.bucket(2).cumulative_count() != total / 4 * 3 ||
+		    h.sample_sum() != total * 2.)
+		{
+			printf("Histogram is count %lu sum %f buckets %lu %lu %lu\n",
+			       (unsigned long)h.sample_count(), h.sample_sum(),
+			       (unsigned long)h.bucket(0).cumulative_count(),
+			       (unsigned long)h.bucket(1).cumulative_count(),
+			       (unsigned long)h.bucket(2).cumulative_count());
+			success = false;
+		}
+	}
+
+	return success;
+}
+
+
+/* The cached exposition buffers must follow the values. */
+static bool
+test_exposition(MetricsRegistry &registry)
+{
+	bool success = true;
+	MetricsRegistry::Counter *counter =
+		registry.counter("qa_labeled", "QA labeled counter", "a=1,b=2");
+
+	for (unsigned int i = 0; i < 2; ++i) {
+		counter->inc(3.);
+		std::string text;
+		registry.append_text(text);
+		std::string expected =
+			"qa_labeled {a=1,b=2} " + std::to_string(counter->value()) + "\n";
+		if (text.find(expected) == std::string::npos ||
+		    text.find("# TYPE qa_histogram histogram\n") == std::string::npos ||
+		    text.find("qa_histogram {le=1.000000} ") == std::string::npos)
+		{
+			printf("Unexpected text exposition:\n%s", text.c_str());
+			success = false;
+		}
+
+		std::string protobuf;
+		registry.append_protobuf(protobuf);
+		std::list<io::prometheus::client::MetricFamily> mfs = registry.metrics();
+
+		google::protobuf::io::CodedInputStream input((const uint8_t *)protobuf.data(),
+		                                             protobuf.size());
+		for (const auto &mf : mfs) {
+			uint32_t size;
+			io::prometheus::client::MetricFamily pmf;
+			if (! input.ReadVarint32(&size)) {
+				printf("Protobuf exposition ends before %s\n", mf.name().c_str());
+				return false;
+			}
+			google::protobuf::io::CodedInputStream::Limit limit = input.PushLimit(size);
+			if (! pmf.ParseFromCodedStream(&input) ||
+			    pmf.SerializeAsString() != mf.SerializeAsString())
+			{
+				printf("Protobuf exposition of %s differs\n", mf.name().c_str());
+				success = false;
+			}
+			input.PopLimit(limit);
+		}
+	}
+
+	return success;
+}
+
+
+int
+main(int argc, char **argv)
+{
+	bool success = true;
+	try {
+		MetricsRegistry registry;
+		if (! test_concurrent(registry)) {
+			printf("FAILED concurrent updates\n");
+			success = false;
+		}
+		if (! test_exposition(registry)) {
+			printf("FAILED exposition\n");
+			success = false;
+		}
+	} catch (Exception &e) {
+		printf("FAILED, exception:\n");
+		e.print_trace();
+		success = false;
+	}
+
+	if (success)  printf("PASSED\n");
+	return success ? 0 : 1;
+}
+
+/// @endcond
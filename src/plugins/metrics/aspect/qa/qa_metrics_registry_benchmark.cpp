@@ -0,0 +1,131 @@
+/***************************************************************************
+ *  qa_metrics_registry_benchmark.cpp - Benchmark metrics registry
+ *
+ *  Created: Sun Oct 18 15:58:44 2026
+ *  Copyright  2026  agent
+ *
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version. A runtime exception applies to
+ *  this software (see LICENSE.GPL_WRE file mentioned below for details).
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL_WRE file in the doc directory.
+ */
+
+/// @cond QA
+
+// Measures the cost of updating a counter and a histogram from one and
+// from several threads, and the cost of a scrape by copying the metric
+// families compared to writing the cached exposition buffers.
+
+#include <plugins/metrics/aspect/metrics_registry.h>
+#include <core/exception.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace fawkes;
+
+static double
+elapsed(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void
+update(MetricsRegistry::Counter *counter, MetricsRegistry::Histogram *histogram,
+       unsigned int n)
+{
+	for (unsigned int i = 0; i < n; ++i) {
+		counter->inc();
+		histogram->observe((i % 100) * 0.001);
+	}
+}
+
+int
+main(int argc, char **argv)
+{
+	unsigned int num_threads = 4;
+	if (argc > 1)  num_threads = atoi(argv[1]);
+	const unsigned int num_updates  = 2000000;
+	const unsigned int num_families = 100;
+	const unsigned int num_scrapes  = 200;
+
+	try {
+		MetricsRegistry registry;
+		std::vector<double> buckets = {0.005, 0.01, 0.025, 0.05, 0.1};
+		MetricsRegistry::Counter   *counter = registry.counter("bench_counter", "Counter");
+		MetricsRegistry::Histogram *histogram =
+			registry.histogram("bench_histogram", "Histogram", buckets);
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		update(counter, histogram, num_updates);
+		double t = elapsed(start);
+		printf("1 thread: %.1f ns per counter increment and histogram observation\n",
+		       t / num_updates * 1e9);
+
+		std::vector<std::thread> threads;
+		start = std::chrono::steady_clock::now();
+		for (unsigned int i = 0; i < num_threads; ++i) {
+			threads.push_back(std::thread(update, counter, histogram, num_updates));
+		}
+		for (auto &th : threads)  th.join();
+		t = elapsed(start);
+		printf("%u threads: %.1f ns per update\n",
+		       num_threads, t / ((double)num_updates * num_threads) * 1e9);
+
+		for (unsigned int i = 0; i < num_families; ++i) {
+			std::string labels = "instance=" + std::to_string(i);
+			registry.counter("bench_family_" + std::to_string(i % 10), "Counter family",
+			                 labels)->inc(i);
+			registry.histogram("bench_family_histogram", "Histogram family", buckets,
+			                   labels)->observe(i * 0.001);
+		}
+
+		size_t bytes = 0;
+		start = std::chrono::steady_clock::now();
+		for (unsigned int i = 0; i < num_scrapes; ++i) {
+			std::list<io::prometheus::client::MetricFamily> mfs = registry.metrics();
+			bytes += mfs.size();
+		}
+		printf("Scrape copying families:  %.1f us (not formatted)\n",
+		       elapsed(start) / num_scrapes * 1e6);
+
+		start = std::chrono::steady_clock::now();
+		for (unsigned int i = 0; i < num_scrapes; ++i) {
+			std::string text;
+			registry.append_text(text);
+			bytes += text.size();
+		}
+		printf("Scrape text buffers:      %.1f us\n", elapsed(start) / num_scrapes * 1e6);
+
+		start = std::chrono::steady_clock::now();
+		for (unsigned int i = 0; i < num_scrapes; ++i) {
+			std::string protobuf;
+			registry.append_protobuf(protobuf);
+			bytes += protobuf.size();
+		}
+		printf("Scrape protobuf buffers:  %.1f us\n", elapsed(start) / num_scrapes * 1e6);
+		if (bytes == 0)  printf("Nothing scraped\n");
+	} catch (Exception &e) {
+		printf("Benchmark failed:\n");
+		e.print_trace();
+		return 1;
+	}
+
+	return 0;
+}
+
+/// @endcond
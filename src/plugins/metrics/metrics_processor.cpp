@@ -21,10 +21,12 @@
 
 #include "metrics_processor.h"
 #include "aspect/metrics_manager.h"
+#include "aspect/metrics_registry.h"
 
 #include <webview/page_reply.h>
 #include <webview/request.h>
 #include <logging/logger.h>
+#include <core/threading/mutex_locker.h>
 
 #include <sstream>
 #if GOOGLE_PROTOBUF_VERSION >= 3000000
@@ -76,15 +78,16 @@ MetricsRequestProcessor::process_request(const fawkes::WebRequest *request)
 	
 	// std::string subpath = request->url().substr(base_url_.length());
 	StaticWebReply *reply = new StaticWebReply(WebReply::HTTP_OK);
-	
-	std::list<io::prometheus::client::MetricFamily> metrics(std::move(metrics_manager_->all_metrics()));
 
 	if (accepted_encoding.find("application/vnd.google.protobuf") != std::string::npos) {
 		reply->add_header("Content-type",
 		                  "application/vnd.google.protobuf; "
 		                  "proto=io.prometheus.client.MetricFamily; "
 		                  "encoding=delimited");
+		std::string registry_body;
+		std::list<io::prometheus::client::MetricFamily> metrics(collect_metrics(registry_body, false));
 		std::ostringstream ss;
+		ss << registry_body;
 		for (auto&& metric : metrics) {
 			{
 				google::protobuf::io::OstreamOutputStream raw_output{&ss};
@@ -102,6 +105,7 @@ MetricsRequestProcessor::process_request(const fawkes::WebRequest *request)
 		reply->append_body(ss.str());		
 	} else if (accepted_encoding.find("application/json") != std::string::npos) {
 #if GOOGLE_PROTOBUF_VERSION >= 3000000
+		std::list<io::prometheus::client::MetricFamily> metrics(std::move(metrics_manager_->all_metrics()));
 		reply->add_header("Content-type", "application/json");
 		std::stringstream ss;
 		ss << "[";
@@ -125,6 +129,9 @@ MetricsRequestProcessor::process_request(const fawkes::WebRequest *request)
 	} else {
 		reply->add_header("Content-type", "text/plain; version=0.0.4");
 		reply->append_body("# Fawkes Metrics\n");
+		std::string registry_body;
+		std::list<io::prometheus::client::MetricFamily> metrics(collect_metrics(registry_body, true));
+		reply->append_body(registry_body);
 		for (auto&& metric : metrics) {
 			if (metric.metric_size() > 0) {
 				reply->append_body("\n");
@@ -259,3 +266,36 @@ MetricsRequestProcessor::process_request(const fawkes::WebRequest *request)
 
 	return reply;
 }
+
+
+/** Collect metrics of all suppliers.
+ * Metrics registries write their metrics directly to the body using
+ * the exposition buffers they cache. The metric families of all other
+ * suppliers are returned to be formatted by the caller.
+ * @param body body to append metrics of registries to
+ * @param text true to append in the text format, false for the
+ * length-delimited protobuf format
+ * @return metric families of suppliers other than registries
+ */
+std::list<io::prometheus::client::MetricFamily>
+MetricsRequestProcessor::collect_metrics(std::string &body, bool text)
+{
+	std::list<io::prometheus::client::MetricFamily> metrics;
+
+	const LockList<MetricsSupplier *> &suppliers = metrics_manager_->metrics_suppliers();
+	MutexLocker lock(suppliers.mutex());
+	for (MetricsSupplier *s : suppliers) {
+		MetricsRegistry *registry = dynamic_cast<MetricsRegistry *>(s);
+		if (registry) {
+			if (text) {
+				registry->append_text(body);
+			} else {
+				registry->append_protobuf(body);
+			}
+		} else {
+			metrics.splice(metrics.begin(), s->metrics());
+		}
+	}
+
+	return metrics;
+}
@@ -24,6 +24,9 @@
 
 #include "protobuf/metrics.pb.h"
 
+#include <list>
+#include <string>
+
 namespace fawkes {
   class Logger;
   class MetricsManager;
@@ -42,6 +45,10 @@ class MetricsRequestProcessor
 
   fawkes::WebReply * process_request(const fawkes::WebRequest *request);
 
+ private:
+  std::list<io::prometheus::client::MetricFamily>
+    collect_metrics(std::string &body, bool text);
+
  private:
   fawkes::MetricsManager *  metrics_manager_;
   fawkes::Logger         *  logger_;
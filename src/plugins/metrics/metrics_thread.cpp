@@ -87,42 +87,26 @@ MetricsThread::init()
 
   lock.unlock();
 
-  imf_loop_count_ = std::make_shared<io::prometheus::client::MetricFamily>();
-  imf_loop_count_->set_name("fawkes_loop_count");
-  imf_loop_count_->set_help("Number of Fawkes main loop iterations");
-  imf_loop_count_->set_type(io::prometheus::client::COUNTER);
-  imf_loop_count_->add_metric();
-  internal_metrics_.push_back(imf_loop_count_);
-
-  imf_metrics_requests_ = std::make_shared<io::prometheus::client::MetricFamily>();
-  imf_metrics_requests_->set_name("fawkes_metrics_requests");
-  imf_metrics_requests_->set_help("Number of requests for metrics");
-  imf_metrics_requests_->set_type(io::prometheus::client::COUNTER);
-  imf_metrics_requests_->add_metric();
-  internal_metrics_.push_back(imf_metrics_requests_);
+  im_loop_count_ =
+	  internal_metrics_.counter("fawkes_loop_count", "Number of Fawkes main loop iterations");
+  im_metrics_requests_ =
+	  internal_metrics_.counter("fawkes_metrics_requests", "Number of requests for metrics");
+  im_metrics_proctime_ = NULL;
 
   try {
 		std::vector<float> buckets_le = config->get_floats("/metrics/internal/metrics_requests/buckets");
 
 		if (! buckets_le.empty()) {
-			std::sort(buckets_le.begin(), buckets_le.end());
-
-			imf_metrics_proctime_ = std::make_shared<io::prometheus::client::MetricFamily>();
-			imf_metrics_proctime_->set_name("fawkes_metrics_proctime");
-			imf_metrics_proctime_->set_help("Time required to process metrics");
-			imf_metrics_proctime_->set_type(io::prometheus::client::HISTOGRAM);
-			auto m = imf_metrics_proctime_->add_metric();
-		  auto h = m->mutable_histogram();
-		  for (float &b : buckets_le) {
-			  h->add_bucket()->set_upper_bound(b);
-		  }
-		  internal_metrics_.push_back(imf_metrics_proctime_);
+			im_metrics_proctime_ =
+				internal_metrics_.histogram("fawkes_metrics_proctime", "Time required to process metrics",
+				                            std::vector<double>(buckets_le.begin(), buckets_le.end()));
 		}
   } catch (Exception &e) {
 	  logger->log_warn(name(), "Internal metric metrics_proctime bucket bounds not configured, disabling");
   }
 
   metrics_suppliers_.push_back(this);
+  metrics_suppliers_.push_back(&internal_metrics_);
 
   req_proc_ = new MetricsRequestProcessor(this, logger, URL_PREFIX);
   webview_url_manager->add_handler(WebRequest::METHOD_GET, URL_PREFIX,
@@ -141,8 +125,7 @@ MetricsThread::finalize()
 void
 MetricsThread::loop()
 {
-	imf_loop_count_->mutable_metric(0)->mutable_counter()->set_value
-		(imf_loop_count_->metric(0).counter().value() + 1);
+	im_loop_count_->inc();
 }
 
 
@@ -190,8 +173,7 @@ MetricsThread::metrics()
 	std::chrono::high_resolution_clock::time_point proc_start =
 		std::chrono::high_resolution_clock::now();
 	
-	imf_metrics_requests_->mutable_metric(0)->mutable_counter()->set_value
-		(imf_metrics_requests_->metric(0).counter().value() + 1);
+	im_metrics_requests_->inc();
 
 	std::list<io::prometheus::client::MetricFamily> rv;
 
@@ -259,27 +241,13 @@ MetricsThread::metrics()
 		rv.push_back(std::move(mf));
 	}
 
-  if (imf_metrics_proctime_) {
+  if (im_metrics_proctime_) {
 	  std::chrono::high_resolution_clock::time_point proc_end =
 		  std::chrono::high_resolution_clock::now();
 	  const std::chrono::duration<double> proc_diff = proc_end - proc_start;
-	  for (int i = 0; i < imf_metrics_proctime_->metric(0).histogram().bucket_size(); ++i) {
-		  io::prometheus::client::Histogram *h =
-			  imf_metrics_proctime_->mutable_metric(0)->mutable_histogram();
-		  if (proc_diff.count() < h->bucket(i).upper_bound()) {
-			  io::prometheus::client::Bucket *b = h->mutable_bucket(i);
-			  b->set_cumulative_count(b->cumulative_count() + 1);
-			  h->set_sample_count(h->sample_count() + 1);
-			  h->set_sample_sum(h->sample_sum() + proc_diff.count());
-			  break;
-		  }
-	  }
+	  im_metrics_proctime_->observe(proc_diff.count());
   }
 
-  for (auto &im : internal_metrics_) {
-		rv.push_back(std::move(*im));
-	}
-
 	return rv;
 }
 
@@ -23,6 +23,7 @@
 
 #include "aspect/metrics_supplier.h"
 #include "aspect/metrics_inifin.h"
+#include "aspect/metrics_registry.h"
 
 #include <core/threading/thread.h>
 #include <core/utils/lock_map.h>
@@ -130,12 +131,11 @@ class MetricsThread
 
   fawkes::MetricsAspectIniFin  metrics_aspect_inifin_;
 
-  // Internal metric families
-  std::shared_ptr<io::prometheus::client::MetricFamily> imf_loop_count_;
-  std::shared_ptr<io::prometheus::client::MetricFamily> imf_metrics_requests_;
-  std::shared_ptr<io::prometheus::client::MetricFamily> imf_metrics_proctime_;
-
-  std::vector<std::shared_ptr<io::prometheus::client::MetricFamily>> internal_metrics_;
+  // Internal metrics
+  fawkes::MetricsRegistry              internal_metrics_;
+  fawkes::MetricsRegistry::Counter    *im_loop_count_;
+  fawkes::MetricsRegistry::Counter    *im_metrics_requests_;
+  fawkes::MetricsRegistry::Histogram  *im_metrics_proctime_;
 
   fawkes::LockList<MetricsSupplier *>  metrics_suppliers_;
 };
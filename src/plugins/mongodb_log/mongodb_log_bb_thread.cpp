@@ -23,8 +23,10 @@
 #include "mongodb_log_bb_thread.h"
 
 #include <core/threading/mutex_locker.h>
-#include <plugins/mongodb/aspect/mongodb_conncreator.h>
+#include <core/threading/wait_condition.h>
+#include <cmath>
 #include <cstdlib>
+#include <cstring>
 
 // from MongoDB
 #include <mongo/client/dbclient.h>
@@ -40,12 +42,20 @@ using namespace fawkes;
  * This thread registers to interfaces specified with patterns in the
  * configurationa and logs any changes to MongoDB.
  *
+ * Logging happens in three stages so that the writer of an interface is
+ * never blocked by the database. The blackboard notification only copies
+ * the data chunk into a ring buffer of the interface listener. The loop
+ * of this thread converts the buffered entries to BSON documents and
+ * writes them with one unordered bulk insert per collection. It does so
+ * every flush interval, or earlier when a ring buffer is half full.
+ * If a ring buffer overflows, changes are dropped and reported.
+ *
  * @author Tim Niemueller
  */
 
 /** Constructor. */
 MongoLogBlackboardThread::MongoLogBlackboardThread()
-  : Thread("MongoLogBlackboardThread", Thread::OPMODE_WAITFORWAKEUP),
+  : Thread("MongoLogBlackboardThread", Thread::OPMODE_CONTINUOUS),
     MongoDBAspect("default")
 {
 }
@@ -60,7 +70,6 @@ MongoLogBlackboardThread::~MongoLogBlackboardThread()
 void
 MongoLogBlackboardThread::init()
 {
-  now_ = new Time(clock);
   database_ = "fflog";
   try {
     database_ = config->get_string("/plugins/mongodb-log/database");
@@ -77,6 +86,38 @@ MongoLogBlackboardThread::init()
     excludes_ = config->get_strings("/plugins/mongodb-log/blackboard/excludes");
   } catch (Exception &e) {} // ignored, no include rules
 
+  cfg_buffer_size_ = 128;
+  try {
+    cfg_buffer_size_ = config->get_uint("/plugins/mongodb-log/blackboard/buffer-size");
+  } catch (Exception &e) {} // ignored, use default
+  cfg_batch_size_ = 1000;
+  try {
+    cfg_batch_size_ = config->get_uint("/plugins/mongodb-log/blackboard/batch-size");
+  } catch (Exception &e) {} // ignored, use default
+  cfg_batch_bytes_ = 8 * 1024 * 1024;
+  try {
+    cfg_batch_bytes_ = config->get_uint("/plugins/mongodb-log/blackboard/batch-bytes");
+  } catch (Exception &e) {} // ignored, use default
+  cfg_flush_interval_ = 0.1;
+  try {
+    cfg_flush_interval_ = config->get_float("/plugins/mongodb-log/blackboard/flush-interval");
+  } catch (Exception &e) {} // ignored, use default
+
+  if (cfg_buffer_size_ < 2) {
+    throw Exception("Buffer size must be at least 2, %u configured", cfg_buffer_size_);
+  }
+  if (cfg_batch_size_ == 0) {
+    throw Exception("Batch size must be larger than zero");
+  }
+  if (cfg_flush_interval_ <= 0.) {
+    throw Exception("Flush interval must be larger than zero");
+  }
+
+  flush_mutex_     = new Mutex();
+  flush_waitcond_  = new WaitCondition(flush_mutex_);
+  flush_requested_ = false;
+  num_written_ = num_batches_ = num_failed_ = num_dropped_ = 0;
+
   if (includes.empty()) {
     includes.push_back("*");
   }
@@ -103,9 +144,9 @@ MongoLogBlackboardThread::init()
       if (exclude) continue;
 
       logger->log_debug(name(), "Adding %s", (*i)->uid());
-      mongo::DBClientBase *mc = mongodb_connmgr->create_client();
-      listeners_[(*i)->uid()] = new InterfaceListener(blackboard, *i, mc, database_,
-						      collections_, logger, now_);
+      listeners_[(*i)->uid()] = new InterfaceListener(blackboard, *i, this, database_,
+						      collections_, logger, clock,
+						      cfg_buffer_size_);
     }
   }
 
@@ -118,19 +159,104 @@ MongoLogBlackboardThread::finalize()
 {
   blackboard->unregister_observer(this);
 
+  write_pending();
+
   std::map<std::string, InterfaceListener *>::iterator i;
   for (i = listeners_.begin(); i != listeners_.end(); ++i) {
-    mongo::DBClientBase *mc = i->second->mongodb_client();
     delete i->second;
-    mongodb_connmgr->delete_client(mc);
   }
   listeners_.clear();
+
+  logger->log_info(name(), "Wrote %lu documents in %lu batches, "
+		   "%lu failed, %lu dropped (buffer full)",
+		   num_written_, num_batches_, num_failed_, num_dropped_);
+
+  delete flush_waitcond_;
+  delete flush_mutex_;
 }
 
 
 void
 MongoLogBlackboardThread::loop()
 {
+  flush_mutex_->lock();
+  if (! flush_requested_) {
+    unsigned int sec  = (unsigned int)floorf(cfg_flush_interval_);
+    unsigned int nsec = (unsigned int)((cfg_flush_interval_ - sec) * 1000000000.);
+    flush_waitcond_->reltimed_wait(sec, nsec);
+  }
+  flush_requested_ = false;
+  flush_mutex_->unlock();
+
+  write_pending();
+}
+
+
+/** Wake up the logging thread to write data early.
+ * Called by listeners whose ring buffer is filling up.
+ */
+void
+MongoLogBlackboardThread::request_flush()
+{
+  MutexLocker lock(flush_mutex_);
+  flush_requested_ = true;
+  flush_waitcond_->wake_all();
+}
+
+
+/** Convert and write buffered data of all listeners. */
+void
+MongoLogBlackboardThread::write_pending()
+{
+  // listeners are only deleted on finalize, new ones may be added
+  // concurrently by bb_interface_created()
+  std::vector<InterfaceListener *> listeners;
+  listeners_.lock();
+  std::map<std::string, InterfaceListener *>::iterator l;
+  for (l = listeners_.begin(); l != listeners_.end(); ++l) {
+    listeners.push_back(l->second);
+  }
+  listeners_.unlock();
+
+  std::vector<BSONObj> documents;
+  std::vector<BSONObj> batch;
+  for (InterfaceListener *listener : listeners) {
+    unsigned long dropped = listener->take_dropped();
+    if (dropped > 0) {
+      num_dropped_ += dropped;
+      logger->log_warn(name(), "Dropped %lu changes for %s, buffer full",
+		       dropped, listener->collection().c_str());
+    }
+
+    documents.clear();
+    if (listener->convert(documents) == 0)  continue;
+
+    size_t d = 0;
+    while (d < documents.size()) {
+      batch.clear();
+      size_t bytes = 0;
+      do {
+	bytes += documents[d].objsize();
+	batch.push_back(documents[d++]);
+      } while (d < documents.size() && batch.size() < cfg_batch_size_ &&
+	       bytes + documents[d].objsize() <= cfg_batch_bytes_);
+
+      try {
+	mongodb_client->insert(listener->collection(), batch,
+			       mongo::InsertOption_ContinueOnError);
+	num_written_ += batch.size();
+      } catch (mongo::DBException &e) {
+	num_failed_ += batch.size();
+	logger->log_warn(name(), "Failed to log %zu documents to %s: %s",
+			 batch.size(), listener->collection().c_str(), e.what());
+      } catch (std::exception &e) {
+	num_failed_ += batch.size();
+	logger->log_warn(name(), "Failed to log %zu documents to %s: %s (*)",
+			 batch.size(), listener->collection().c_str(), e.what());
+      }
+      ++num_batches_;
+    }
+  }
 }
 
 // for BlackBoardInterfaceObserver
@@ -151,10 +277,10 @@ MongoLogBlackboardThread::bb_interface_created(const char *type, const char *id)
     Interface *interface = blackboard->open_for_reading(type, id);
     if (listeners_.find(interface->uid()) == listeners_.end()) {
       logger->log_debug(name(), "Opening new %s", interface->uid());
-      mongo::DBClientBase *mc = mongodb_connmgr->create_client();
-      listeners_[interface->uid()] = new InterfaceListener(blackboard, interface, mc,
+      listeners_[interface->uid()] = new InterfaceListener(blackboard, interface, this,
 							   database_, collections_,
-							   logger, now_);
+							   logger, clock,
+							   cfg_buffer_size_);
     } else {
       logger->log_warn(name(), "Interface %s already opened", interface->uid());
       blackboard->close(interface);
@@ -172,26 +298,28 @@ MongoLogBlackboardThread::bb_interface_created(const char *type, const char *id)
 /** Constructor.
  * @param blackboard blackboard
  * @param interface interface to listen for
- * @param mongodb MongoDB client to write to
+ * @param writer logging thread to wake up when the buffer fills up
  * @param database name of database to write to
  * @param colls collections
  * @param logger logger
- * @param now Time
+ * @param clock clock to timestamp changes
+ * @param buffer_size number of changes that can be buffered
  */
 MongoLogBlackboardThread::InterfaceListener::InterfaceListener(BlackBoard *blackboard,
 							       Interface *interface,
-							       mongo::DBClientBase *mongodb,
+							       MongoLogBlackboardThread *writer,
 							       std::string &database,
 							       LockSet<std::string> &colls,
-							       Logger *logger, Time *now)
+							       Logger *logger, Clock *clock,
+							       unsigned int buffer_size)
   : BlackBoardInterfaceListener("MongoLogListener-%s", interface->uid()),
     database_(database), collections_(colls)
 {
   blackboard_ = blackboard;
   interface_  = interface;
-  mongodb_    = mongodb;
+  writer_     = writer;
   logger_     = logger;
-  now_        = now;
+  clock_      = clock;
 
   // sanitize interface ID to be suitable for MongoDB
   std::string id = interface->id();
@@ -206,6 +334,22 @@ MongoLogBlackboardThread::InterfaceListener::InterfaceListener(BlackBoard *black
 		    collection_.c_str(), interface->uid());
   }
 
+  // remember where fields are located to convert copies of the data chunk
+  const char *data = (const char *)interface->datachunk();
+  InterfaceFieldIterator i;
+  for (i = interface->fields(); i != interface->fields_end(); ++i) {
+    FieldInfo field;
+    field.name   = i.get_name();
+    field.type   = i.get_type();
+    field.length = i.get_length();
+    field.offset = (const char *)i.get_value() - data;
+    fields_.push_back(field);
+  }
+
+  // each entry is the timestamp in msec followed by the data chunk
+  ring_    = new MongoLogRingBuffer(sizeof(long long) + interface->datasize(), buffer_size);
+  dropped_ = 0;
+
   bbil_add_data_interface(interface);
   blackboard_->register_listener(this, BlackBoard::BBIL_FLAG_DATA);
 }
@@ -215,202 +359,168 @@ MongoLogBlackboardThread::InterfaceListener::InterfaceListener(BlackBoard *black
 MongoLogBlackboardThread::InterfaceListener::~InterfaceListener()
 {
   blackboard_->unregister_listener(this);
+  delete ring_;
 }
 
+
+/** Convert buffered changes to documents.
+ * Must only be called by the logging thread.
+ * @param documents converted documents are appended to this vector
+ * @return number of converted documents
+ */
+unsigned int
+MongoLogBlackboardThread::InterfaceListener::convert(std::vector<BSONObj> &documents)
+{
+  // only convert what is there now, the producer may keep writing
+  unsigned int num_converted = ring_->fill();
+
+  for (unsigned int i = 0; i < num_converted; ++i) {
+    const char *entry = ring_->read_begin();
+    try {
+      documents.push_back(to_bson(entry));
+    } catch (std::exception &e) {
+      logger_->log_warn(bbil_name(), "Failed to convert data for %s: %s",
+			collection_.c_str(), e.what());
+    }
+    // entry may be overwritten from now on
+    ring_->read_end();
+  }
+
+  return num_converted;
+}
+
+
+/** Get and reset number of changes dropped because the buffer was full.
+ * @return number of changes dropped since the last call
+ */
+unsigned long
+MongoLogBlackboardThread::InterfaceListener::take_dropped()
+{
+  return dropped_.exchange(0);
+}
+
+
 void
 MongoLogBlackboardThread::InterfaceListener::bb_interface_data_changed(Interface *interface)
   throw()
 {
-  now_->stamp();
   interface->read();
 
-  try {
-    // write interface data
-    BSONObjBuilder document;
-    document.append("timestamp", (long long) now_->in_msec());
-    InterfaceFieldIterator i;
-    for (i = interface->fields(); i != interface->fields_end(); ++i) {
-      size_t length = i.get_length();
-      bool is_array = (length > 1);
-
-      switch (i.get_type()) {
-      case IFT_BOOL:
-	if (is_array) {
-	  bool *bools = i.get_bools();
-	  BSONArrayBuilder subb(document.subarrayStart(i.get_name()));
-	  for (size_t l = 0; l < length; ++l) {
-	    subb.append(bools[l]);
-	  }
-	  subb.doneFast();
-	} else {
-	  document.append(i.get_name(), i.get_bool());
-	}
-	break;
-
-      case IFT_INT8:
-	if (is_array) {
-	  int8_t *ints = i.get_int8s();
-	  BSONArrayBuilder subb(document.subarrayStart(i.get_name()));
-	  for (size_t l = 0; l < length; ++l) {
-	    subb.append(ints[l]);
-	  }
-	  subb.doneFast();
-	} else {
-	  document.append(i.get_name(), i.get_int8());
-	}
-	break;
-
-      case IFT_UINT8:
-	if (is_array) {
-	  uint8_t *ints = i.get_uint8s();
-	  BSONArrayBuilder subb(document.subarrayStart(i.get_name()));
-	  for (size_t l = 0; l < length; ++l) {
-	    subb.append(ints[l]);
-	  }
-	  subb.doneFast();
-	} else {
-	  document.append(i.get_name(), i.get_uint8());
-	}
-	break;
-
-      case IFT_INT16:
-	if (is_array) {
-	  int16_t *ints = i.get_int16s();
-	  BSONArrayBuilder subb(document.subarrayStart(i.get_name()));
-	  for (size_t l = 0; l < length; ++l) {
-	    subb.append(ints[l]);
-	  }
-	  subb.doneFast();
-	} else {
-	  document.append(i.get_name(), i.get_int16());
-	}
-	break;
-
-      case IFT_UINT16:
-	if (is_array) {
-	  uint16_t *ints = i.get_uint16s();
-	  BSONArrayBuilder subb(document.subarrayStart(i.get_name()));
-	  for (size_t l = 0; l < length; ++l) {
-	    subb.append(ints[l]);
-	  }
-	  subb.doneFast();
-	} else {
-	  document.append(i.get_name(), i.get_uint16());
-	}
-	break;
-
-      case IFT_INT32:
-	if (is_array) {
-	  int32_t *ints = i.get_int32s();
-	  BSONArrayBuilder subb(document.subarrayStart(i.get_name()));
-	  for (size_t l = 0; l < length; ++l) {
-	    subb.append(ints[l]);
-	  }
-	  subb.doneFast();
-	} else {
-	  document.append(i.get_name(), i.get_int32());
-	}
-	break;
-
-      case IFT_UINT32:
-	if (is_array) {
-	  uint32_t *ints = i.get_uint32s();
-	  BSONArrayBuilder subb(document.subarrayStart(i.get_name()));
-	  for (size_t l = 0; l < length; ++l) {
-	    subb.append(ints[l]);
-	  }
-	  subb.doneFast();
-	} else {
-	  document.append(i.get_name(), i.get_uint32());
-	}
-	break;
-
-      case IFT_INT64:
-	if (is_array) {
-	  int64_t *ints = i.get_int64s();
-	  BSONArrayBuilder subb(document.subarrayStart(i.get_name()));
-	  for (size_t l = 0; l < length; ++l) {
-	    subb.append((long long int)ints[l]);
-	  }
-	  subb.doneFast();
-	} else {
-	  document.append(i.get_name(), (long long int)i.get_int64());
-	}
-	break;
-
-      case IFT_UINT64:
-	if (is_array) {
-	  uint64_t *ints = i.get_uint64s();
-	  BSONArrayBuilder subb(document.subarrayStart(i.get_name()));
-	  for (size_t l = 0; l < length; ++l) {
-	    subb.append((long long int)ints[l]);
-	  }
-	  subb.doneFast();
-	} else {
-	  document.append(i.get_name(), (long long int)i.get_uint64());
-	}
-	break;
-
-      case IFT_FLOAT:
-	if (is_array) {
-	  float *floats = i.get_floats();
-	  BSONArrayBuilder subb(document.subarrayStart(i.get_name()));
-	  for (size_t l = 0; l < length; ++l) {
-	    subb.append(floats[l]);
-	  }
-	  subb.doneFast();
-	} else {
-	  document.append(i.get_name(), i.get_float());
-	}
-	break;
-
-      case IFT_DOUBLE:
-	if (is_array) {
-	  double *doubles = i.get_doubles();
-	  BSONArrayBuilder subb(document.subarrayStart(i.get_name()));
-	  for (size_t l = 0; l < length; ++l) {
-	    subb.append(doubles[l]);
-	  }
-	  subb.doneFast();
-	} else {
-	  document.append(i.get_name(), i.get_double());
-	}
-	break;
-
-      case IFT_STRING:
-	document.append(i.get_name(), i.get_string());
-	break;
-
-      case IFT_BYTE:
-	if (is_array) {
-	  document.appendBinData(i.get_name(), length,
-				 BinDataGeneral, i.get_bytes());
-	} else {
-	  document.append(i.get_name(), i.get_byte());
-	}
-	break;
-
-      case IFT_ENUM:
-	if (is_array) {
-	  int32_t *ints = i.get_enums();
-	  BSONArrayBuilder subb(document.subarrayStart(i.get_name()));
-	  for (size_t l = 0; l < length; ++l) {
-	    subb.append(ints[l]);
-	  }
-	  subb.doneFast();
-	} else {
-	  document.append(i.get_name(), i.get_enum());
-	}
-	break;
-      }
+  char *entry = ring_->write_begin();
+  if (! entry) {
+    ++dropped_;
+    return;
+  }
+
+  Time now(clock_);
+  now.stamp();
+  long long msec = now.in_msec();
+
+  memcpy(entry, &msec, sizeof(msec));
+  memcpy(entry + sizeof(msec), interface->datachunk(), interface->datasize());
+  ring_->write_end();
+
+  if (ring_->fill() == ring_->capacity() / 2) {
+    writer_->request_flush();
+  }
+}
+
+
+/// @cond INTERNALS
+// data chunks are packed, read values through memcpy
+template <typename T>
+static inline T
+field_value(const char *data, size_t index = 0)
+{
+  T value;
+  memcpy(&value, data + index * sizeof(T), sizeof(T));
+  return value;
+}
+
+template <typename T, typename BT = T>
+static void
+append_field(BSONObjBuilder &document, const char *name,
+	     const char *data, size_t length)
+{
+  if (length > 1) {
+    BSONArrayBuilder subb(document.subarrayStart(name));
+    for (size_t l = 0; l < length; ++l) {
+      subb.append((BT)field_value<T>(data, l));
     }
+    subb.doneFast();
+  } else {
+    document.append(name, (BT)field_value<T>(data));
+  }
+}
+/// @endcond
+
 
-    mongodb_->insert(collection_, document.obj());
-  } catch (mongo::DBException &e) {
-    logger_->log_warn(bbil_name(), "Failed to log to %s: %s",
-                       collection_.c_str(), e.what());
-  } catch (std::exception &e) {
-    logger_->log_warn(bbil_name(), "Failed to log to %s: %s (*)",
-                       collection_.c_str(), e.what());
+/** Convert a buffered change to a document.
+ * @param entry ring buffer entry
+ * @return document for entry
+ */
+BSONObj
+MongoLogBlackboardThread::InterfaceListener::to_bson(const char *entry) const
+{
+  const char *chunk = entry + sizeof(long long);
+
+  BSONObjBuilder document;
+  document.append("timestamp", field_value<long long>(entry));
+
+  for (const FieldInfo &f : fields_) {
+    const char *data = chunk + f.offset;
+
+    switch (f.type) {
+    case IFT_BOOL:
+      append_field<bool>(document, f.name, data, f.length);
+      break;
+    case IFT_INT8:
+      append_field<int8_t>(document, f.name, data, f.length);
+      break;
+    case IFT_UINT8:
+      append_field<uint8_t>(document, f.name, data, f.length);
+      break;
+    case IFT_INT16:
+      append_field<int16_t>(document, f.name, data, f.length);
+      break;
+    case IFT_UINT16:
+      append_field<uint16_t>(document, f.name, data, f.length);
+      break;
+    case IFT_INT32:
+      append_field<int32_t>(document, f.name, data, f.length);
+      break;
+    case IFT_UINT32:
+      append_field<uint32_t>(document, f.name, data, f.length);
+      break;
+    case IFT_INT64:
+      append_field<int64_t, long long int>(document, f.name, data, f.length);
+      break;
+    case IFT_UINT64:
+      append_field<uint64_t, long long int>(document, f.name, data, f.length);
+      break;
+    case IFT_FLOAT:
+      append_field<float>(document, f.name, data, f.length);
+      break;
+    case IFT_DOUBLE:
+      append_field<double>(document, f.name, data, f.length);
+      break;
+    case IFT_ENUM:
+      append_field<int32_t>(document, f.name, data, f.length);
+      break;
+
+    case IFT_STRING:
+      document.append(f.name, std::string(data, strnlen(data, f.length)));
+      break;
+
+    case IFT_BYTE:
+      if (f.length > 1) {
+	document.appendBinData(f.name, f.length, BinDataGeneral, data);
+      } else {
+	document.append(f.name, field_value<uint8_t>(data));
+      }
+      break;
+    }
   }
+
+  return document.obj();
 }
@@ -34,9 +34,21 @@
 #include <blackboard/interface_listener.h>
 #include <core/utils/lock_map.h>
 #include <core/utils/lock_set.h>
+#include <interface/types.h>
 
+#include "ring_buffer.h"
+
+#include <atomic>
 #include <string>
+#include <vector>
 
+namespace fawkes {
+  class Mutex;
+  class WaitCondition;
+}
+namespace mongo {
+  class BSONObj;
+}
 
 class MongoLogBlackboardThread
 : public fawkes::Thread,
@@ -62,45 +74,84 @@ class MongoLogBlackboardThread
  protected: virtual void run() { Thread::run(); }
 
  private:
-  /** Mongo Logger interface listener. */
+  /** Mongo Logger interface listener.
+   * Data changes are copied into a ring buffer, the conversion to BSON
+   * and the database write happen in the logging thread. */
   class InterfaceListener : public fawkes::BlackBoardInterfaceListener
   {
    public:
     InterfaceListener(fawkes::BlackBoard *blackboard,
 		      fawkes::Interface *interface,
-		      mongo::DBClientBase *mongodb,
+		      MongoLogBlackboardThread *writer,
 		      std::string &database,
 		      fawkes::LockSet<std::string> &colls,
 		      fawkes::Logger *logger,
-		      fawkes::Time *now);
+		      fawkes::Clock *clock,
+		      unsigned int buffer_size);
     ~InterfaceListener();
 
-    /** Get MongoDB Client.
-     * @return MongoDB client */
-    mongo::DBClientBase * mongodb_client() const
-    { return mongodb_; }
+    /** Get collection logged to.
+     * @return collection name including database */
+    const std::string & collection() const
+    { return collection_; }
+
+    unsigned int convert(std::vector<mongo::BSONObj> &documents);
+    unsigned long take_dropped();
 
     // for BlackBoardInterfaceListener
     virtual void bb_interface_data_changed(fawkes::Interface *interface) throw();
 
+   private:
+    /** Location of a field in the interface data chunk. */
+    typedef struct {
+      const char                    *name;	/**< field name */
+      fawkes::interface_fieldtype_t  type;	/**< field type */
+      size_t                         length;	/**< number of elements */
+      size_t                         offset;	/**< offset in data chunk */
+    } FieldInfo;
+
+    mongo::BSONObj to_bson(const char *entry) const;
+
    private:
     fawkes::BlackBoard  *blackboard_;
     fawkes::Interface   *interface_;
-    mongo::DBClientBase *mongodb_;
+    MongoLogBlackboardThread *writer_;
     fawkes::Logger      *logger_;
+    fawkes::Clock       *clock_;
     std::string          collection_;
     std::string         &database_;
     fawkes::LockSet<std::string> &collections_;
-    fawkes::Time        *now_;
+
+    std::vector<FieldInfo> fields_;
+
+    // ring buffer of timestamp and data chunk entries, written by the
+    // notifying thread, read by the logging thread
+    MongoLogRingBuffer        *ring_;
+    std::atomic<unsigned long> dropped_;
   };
 
+  void request_flush();
+  void write_pending();
 
   fawkes::LockMap<std::string, InterfaceListener *> listeners_;
   fawkes::LockSet<std::string> collections_;
   std::string database_;
-  fawkes::Time        *now_;
 
   std::vector<std::string> excludes_;
+
+  unsigned int cfg_buffer_size_;
+  unsigned int cfg_batch_size_;
+  unsigned int cfg_batch_bytes_;
+  float        cfg_flush_interval_;
+
+  fawkes::Mutex         *flush_mutex_;
+  fawkes::WaitCondition *flush_waitcond_;
+  bool                   flush_requested_;
+
+  unsigned long num_written_;
+  unsigned long num_batches_;
+  unsigned long num_failed_;
+  unsigned long num_dropped_;
 };
 
 #endif
@@ -152,7 +152,11 @@ MongoLogImagesThread::loop()
 
       std::stringstream name;
       name << imginfo.topic_name << "_" << cap_time.in_msec();
-      subb.append("data", gridfs_->storeFile((char*) imginfo.img->buffer(), imginfo.img->data_size(), name.str()));
+      // the shared memory segment may hold several image slots
+      size_t image_size = colorspace_buffer_size(imginfo.img->colorspace(),
+                                                 imginfo.img->width(),
+                                                 imginfo.img->height());
+      subb.append("data", gridfs_->storeFile((char*) imginfo.img->buffer(), image_size, name.str()));
 
       subb.doneFast();
       collection_ = database_ + "."  + imginfo.topic_name;
@@ -0,0 +1,215 @@
+/***************************************************************************
+ *  qa_mongodb_log_ring_buffer.cpp - QA for the blackboard logger ring buffer
+ *
+ *  Created: Sun Oct 18 19:24:51 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+/// @cond QA
+
+// Checks the ring buffer the blackboard logger copies data changes into.
+// Entries are numbered, the number is followed by a pattern derived from
+// it, so that overwritten, torn, lost, or repeated entries are detected.
+// Capacities are mostly not powers of two and every test runs the slot
+// indices around the end of the buffer many times, first from a single
+// thread, then with a producer and a consumer thread, once waiting for
+// free space and once dropping entries like the logger does.
+
+#include "../ring_buffer.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+#include <thread>
+
+// odd size, entries are not aligned in the buffer
+#define ENTRY_SIZE 29
+
+static void
+write_entry(char *entry, uint64_t n)
+{
+  memcpy(entry, &n, sizeof(n));
+  for (size_t i = sizeof(n); i < ENTRY_SIZE; ++i) {
+    entry[i] = (char)(n * 31 + i);
+  }
+}
+
+static bool
+check_entry(const char *entry, uint64_t &n)
+{
+  memcpy(&n, entry, sizeof(n));
+  for (size_t i = sizeof(n); i < ENTRY_SIZE; ++i) {
+    if (entry[i] != (char)(n * 31 + i)) {
+      printf("Entry %lu corrupted at byte %zu\n", (unsigned long)n, i);
+      return false;
+    }
+  }
+  return true;
+}
+
+
+/* Alternately write and read batches of varying size, the buffer must
+ * behave like a FIFO of the given capacity. */
+static bool
+test_sequential(unsigned int capacity)
+{
+  MongoLogRingBuffer ring(ENTRY_SIZE, capacity);
+  uint64_t next_write = 0, next_read = 0;
+
+  for (unsigned int round = 0; round < capacity * 20 + 50; ++round) {
+    unsigned int num_write = (round * 7 + 3) % (capacity + 2);
+    for (unsigned int i = 0; i < num_write; ++i) {
+      char *entry = ring.write_begin();
+      if (! entry) {
+	if (next_write - next_read != capacity) {
+	  printf("Capacity %u: full with %lu entries\n", capacity,
+		 (unsigned long)(next_write - next_read));
+	  return false;
+	}
+	break;
+      }
+      write_entry(entry, next_write++);
+      ring.write_end();
+    }
+    if (ring.fill() != next_write - next_read) {
+      printf("Capacity %u: fill %u, expected %lu\n", capacity, ring.fill(),
+	     (unsigned long)(next_write - next_read));
+      return false;
+    }
+
+    unsigned int num_read = (round * 5 + 1) % (capacity + 2);
+    for (unsigned int i = 0; i < num_read; ++i) {
+      const char *entry = ring.read_begin();
+      if (! entry) {
+	if (next_write != next_read) {
+	  printf("Capacity %u: empty with %lu entries\n", capacity,
+		 (unsigned long)(next_write - next_read));
+	  return false;
+	}
+	break;
+      }
+      uint64_t n;
+      if (! check_entry(entry, n))  return false;
+      if (n != next_read) {
+	printf("Capacity %u: read entry %lu, expected %lu\n", capacity,
+	       (unsigned long)n, (unsigned long)next_read);
+	return false;
+      }
+      ++next_read;
+      ring.read_end();
+    }
+  }
+
+  if (next_read < capacity * 3) {
+    printf("Capacity %u: only %lu entries passed the buffer\n", capacity,
+	   (unsigned long)next_read);
+    return false;
+  }
+  return true;
+}
+
+
+/* A producer and a consumer thread pass entries concurrently. Without
+ * dropping the consumer must see every entry in order, when dropping on
+ * overflow it must see increasing entries and all entries not dropped. */
+static bool
+test_concurrent(unsigned int capacity, uint64_t num_entries, bool drop)
+{
+  MongoLogRingBuffer ring(ENTRY_SIZE, capacity);
+  std::atomic<uint64_t> num_dropped(0);
+
+  std::thread producer([&ring, &num_dropped, num_entries, drop]() {
+    for (uint64_t n = 0; n < num_entries; ++n) {
+      char *entry;
+      while (! (entry = ring.write_begin())) {
+	if (drop)  break;
+	std::this_thread::yield();
+      }
+      if (! entry) {
+	++num_dropped;
+	continue;
+      }
+      write_entry(entry, n);
+      ring.write_end();
+    }
+  });
+
+  bool success = true;
+  uint64_t num_read = 0, last = 0;
+  while (success) {
+    const char *entry = ring.read_begin();
+    if (! entry) {
+      if (num_read + num_dropped == num_entries)  break;
+      std::this_thread::yield();
+      continue;
+    }
+    uint64_t n;
+    if (! check_entry(entry, n)) {
+      success = false;
+    } else if ((drop && num_read > 0 && n <= last) || (! drop && n != num_read)) {
+      printf("Capacity %u: read entry %lu after %lu\n", capacity,
+	     (unsigned long)n, (unsigned long)last);
+      success = false;
+    }
+    last = n;
+    ++num_read;
+    ring.read_end();
+  }
+  producer.join();
+
+  if (success && num_read + num_dropped != num_entries) {
+    printf("Capacity %u: read %lu and dropped %lu of %lu entries\n", capacity,
+	   (unsigned long)num_read, (unsigned long)num_dropped.load(), (unsigned long)num_entries);
+    success = false;
+  }
+  return success;
+}
+
+
+int
+main(int argc, char **argv)
+{
+  uint64_t num_entries = 1000000;
+  if (argc > 1)  num_entries = strtoull(argv[1], NULL, 10);
+
+  const unsigned int capacities[] = { 1, 2, 3, 5, 7, 64, 100, 127, 128 };
+
+  bool success = true;
+  for (unsigned int capacity : capacities) {
+    if (! test_sequential(capacity)) {
+      printf("FAILED sequential, capacity %u\n", capacity);
+      success = false;
+    }
+  }
+
+  for (unsigned int capacity : { 3u, 7u, 100u }) {
+    if (! test_concurrent(capacity, num_entries, false)) {
+      printf("FAILED concurrent, capacity %u\n", capacity);
+      success = false;
+    }
+    if (! test_concurrent(capacity, num_entries, true)) {
+      printf("FAILED concurrent with drops, capacity %u\n", capacity);
+      success = false;
+    }
+  }
+
+  if (success)  printf("PASSED\n");
+  return success ? 0 : 1;
+}
+
+/// @endcond
@@ -0,0 +1,109 @@
+/***************************************************************************
+ *  ring_buffer.h - Single-producer/single-consumer ring buffer
+ *
+ *  Created: Sun Oct 18 19:12:37 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#ifndef _PLUGINS_MONGODB_LOG_RING_BUFFER_H_
+#define _PLUGINS_MONGODB_LOG_RING_BUFFER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/** Ring buffer of fixed size entries for one producer and one consumer.
+ * The producer fills an entry returned by write_begin() and publishes it
+ * with write_end(), the consumer reads the entry returned by read_begin()
+ * and releases it with read_end(). Neither side blocks or allocates.
+ *
+ * The buffer has one slot more than it can hold entries, head and tail
+ * are slot indices which wrap at the number of slots. The capacity may
+ * therefore be any number, not only a power of two.
+ */
+class MongoLogRingBuffer
+{
+ public:
+  /** Constructor.
+   * @param entry_size size of an entry in bytes
+   * @param capacity maximum number of entries held at a time
+   */
+  MongoLogRingBuffer(size_t entry_size, unsigned int capacity)
+  : entry_size_(entry_size), num_slots_(capacity + 1), head_(0), tail_(0)
+  {
+    ring_.resize(entry_size_ * num_slots_);
+  }
+
+  /** Get maximum number of entries.
+   * @return maximum number of entries held at a time */
+  unsigned int capacity() const
+  { return num_slots_ - 1; }
+
+  /** Get size of an entry.
+   * @return entry size in bytes */
+  size_t entry_size() const
+  { return entry_size_; }
+
+  /** Get number of entries written and not yet read.
+   * Exact only when called by the producer or the consumer while the other
+   * side is idle, otherwise a snapshot.
+   * @return number of entries */
+  unsigned int fill() const
+  {
+    unsigned int head = head_.load(std::memory_order_acquire);
+    unsigned int tail = tail_.load(std::memory_order_acquire);
+    return (head >= tail) ? head - tail : num_slots_ - tail + head;
+  }
+
+  /** Get entry to write to. Must only be called by the producer.
+   * @return entry, NULL if the buffer is full */
+  char * write_begin()
+  {
+    unsigned int head = head_.load(std::memory_order_relaxed);
+    if (next(head) == tail_.load(std::memory_order_acquire))  return NULL;
+    return &ring_[head * entry_size_];
+  }
+
+  /** Publish the entry returned by write_begin(). */
+  void write_end()
+  { head_.store(next(head_.load(std::memory_order_relaxed)), std::memory_order_release); }
+
+  /** Get oldest entry. Must only be called by the consumer.
+   * @return entry, NULL if the buffer is empty */
+  const char * read_begin() const
+  {
+    unsigned int tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire))  return NULL;
+    return &ring_[tail * entry_size_];
+  }
+
+  /** Release the entry returned by read_begin(), it may be overwritten afterwards. */
+  void read_end()
+  { tail_.store(next(tail_.load(std::memory_order_relaxed)), std::memory_order_release); }
+
+ private:
+  unsigned int next(unsigned int slot) const
+  { return (slot + 1 == num_slots_) ? 0 : slot + 1; }
+
+ private:
+  std::vector<char>         ring_;
+  size_t                    entry_size_;
+  unsigned int              num_slots_;
+  std::atomic<unsigned int> head_;
+  std::atomic<unsigned int> tail_;
+};
+
+#endif
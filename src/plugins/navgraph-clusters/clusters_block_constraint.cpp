@@ -46,7 +46,9 @@ NavGraphClustersBlockConstraint::~NavGraphClustersBlockConstraint()
 bool
 NavGraphClustersBlockConstraint::compute(void) throw()
 {
-  blocked_ = parent_->blocked_edges();
+  std::list<std::pair<std::string, std::string>> blocked = parent_->blocked_edges();
+  if (blocked == blocked_)  return false;
+  blocked_.swap(blocked);
   return true;
 }
 
@@ -73,9 +73,22 @@ NavGraphClustersDistanceCostConstraint::~NavGraphClustersDistanceCostConstraint(
 bool
 NavGraphClustersDistanceCostConstraint::compute(void) throw()
 {
-  blocked_ = parent_->blocked_edges_centroids();
-  valid_   = parent_->robot_pose(pose_);
-  return valid_;
+  std::list<std::tuple<std::string, std::string, Eigen::Vector2f>> blocked =
+    parent_->blocked_edges_centroids();
+  Eigen::Vector2f pose;
+  bool valid = parent_->robot_pose(pose);
+
+  // the pose only matters for the cost of blocked edges
+  if ((valid == valid_) && (blocked == blocked_) &&
+      (! valid || blocked.empty() || pose == pose_))
+  {
+    return false;
+  }
+
+  blocked_.swap(blocked);
+  valid_ = valid;
+  if (valid)  pose_ = pose;
+  return true;
 }
 
 
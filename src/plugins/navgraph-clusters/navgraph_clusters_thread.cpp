@@ -243,8 +243,6 @@ NavGraphClustersThread::blocked_edges_centroids() throw()
   MutexLocker lock(cluster_ifs_.mutex());
   std::list<std::tuple<std::string, std::string, Eigen::Vector2f>> blocked;
 
-  const std::vector<NavGraphEdge> &graph_edges = navgraph->edges();
-
   for (Position3DInterface *pif : cluster_ifs_) {
     pif->read();
     if (pif->visibility_history() >= cfg_min_vishistory_) {
@@ -254,21 +252,11 @@ NavGraphClustersThread::blocked_edges_centroids() throw()
 	Eigen::Vector2f centroid(fixed_frame_pose(pif->frame(), fawkes::Time(0,0),
 						  pif->translation(0), pif->translation(1)));
 
-	for (const NavGraphEdge &edge : graph_edges) {
-	  const Eigen::Vector2f origin(edge.from_node().x(), edge.from_node().y());
-	  const Eigen::Vector2f target(edge.to_node().x(), edge.to_node().y());
-	  const Eigen::Vector2f direction(target - origin);
-	  const Eigen::Vector2f direction_norm = direction.normalized();
-	  const Eigen::Vector2f diff = centroid - origin;
-	  const float t = direction.dot(diff) / direction.squaredNorm();
-
-	  if (t >= 0.0 && t <= 1.0) {
-	    // projection of the centroid onto the edge is within the line segment
-	    float distance = (diff - direction_norm.dot(diff) * direction_norm).norm();
-	    if (distance < cfg_close_threshold_) {
-	      blocked.push_back(make_tuple(edge.from(), edge.to(), centroid));
-	    }
-	  }
+	// edges onto which the centroid projects within the threshold
+	for (const NavGraphEdge &edge :
+	       navgraph->search_edges(centroid[0], centroid[1], cfg_close_threshold_))
+	{
+	  blocked.push_back(make_tuple(edge.from(), edge.to(), centroid));
 	}
       } catch (Exception &e) {
 	//logger->log_info(name(), "Failed to transform %s, ignoring", pif->uid());
@@ -642,34 +642,32 @@ NavGraphGeneratorThread::filter_edges_from_map(float max_dist)
   std::vector<std::pair<int, int> > free_space_indices;
   map_t *map = load_map(free_space_indices);
 
-  const std::vector<NavGraphEdge> &edges = navgraph->edges();
+  // collect first, removing edges while querying would force the
+  // navgraph to rebuild its spatial index for every removed edge
+  std::list<NavGraphEdge> remove_edges;
 
   for (int x = 0; x < map->size_x; ++x) {
     for (int y = 0; y < map->size_y; ++y) {
       if (map->cells[MAP_INDEX(map, x, y)].occ_state > 0) {
-	// cell is occupied, generate point in cloud
-	Eigen::Vector2f gp;
-	gp[0] = MAP_WXGX(map, x) + 0.5 * map->scale;
-	gp[1] = MAP_WYGY(map, y) + 0.5 * map->scale;
-
-	for (const NavGraphEdge &e : edges) {
-	  try {
-	    cart_coord_2d_t poe = e.closest_point_on_edge(gp[0], gp[1]);
-	    Eigen::Vector2f p;
-	    p[0] = poe.x; p[1] = poe.y;
-	    if ((gp - p).norm() <= max_dist) {
-	      // edge too close, remove it!
-	      logger->log_debug(name(),
-				"  Removing edge (%s--%s), too close to occupied map cell (%f,%f)",
-				e.from().c_str(), e.to().c_str(), gp[0], gp[1]);
-	      navgraph->remove_edge(e);
-	      break;
-	    }
-	  } catch (Exception &e) {} // alright, not close
+	// cell is occupied, only check edges passing close by
+	float gx = MAP_WXGX(map, x) + 0.5 * map->scale;
+	float gy = MAP_WYGY(map, y) + 0.5 * map->scale;
+
+	for (const NavGraphEdge &e : navgraph->search_edges(gx, gy, max_dist)) {
+	  if (std::find(remove_edges.begin(), remove_edges.end(), e) == remove_edges.end()) {
+	    logger->log_debug(name(),
+			      "  Removing edge (%s--%s), too close to occupied map cell (%f,%f)",
+			      e.from().c_str(), e.to().c_str(), gx, gy);
+	    remove_edges.push_back(e);
+	  }
 	}
       }
     }
   }
+
+  for (const NavGraphEdge &e : remove_edges) {
+    navgraph->remove_edge(e);
+  }
   map_free(map);
 }
 
@@ -35,6 +35,7 @@
 #include <logging/logger.h>
 
 #include <fvcams/shmem.h>
+#include <fvcams/user_buffers.h>
 #include <fvutils/color/conversions.h>
 #include <interfaces/SwitchInterface.h>
 
@@ -85,6 +86,9 @@ FvAcquisitionThread::FvAcquisitionThread(const char *id,  Camera *camera,
   height_        = camera_->pixel_height();
   colorspace_    = camera_->colorspace();
 
+  user_buffers_  = dynamic_cast<CameraUserBuffers *>(camera_);
+  zero_copy_shm_ = NULL;
+
   mode_ = AqtContinuous;
   enabled_ = false;
 
@@ -193,7 +197,7 @@ FvAcquisitionThread::camera_instance(colorspace_t cspace, bool deep_copy)
 	throw OutOfMemoryException("FvAcqThread::camera_instance(): Could not create image ID");
       }
       img_id = tmp;
-      shm_[cspace] = new SharedMemoryImageBuffer(img_id, cspace, width_, height_);
+      shm_[cspace] = create_shm(img_id, cspace);
     } else {
       img_id = shm_[cspace]->image_id();
     }
@@ -206,6 +210,57 @@ FvAcquisitionThread::camera_instance(colorspace_t cspace, bool deep_copy)
 }
 
 
+/** Create shared memory image buffer.
+ * If the camera can capture into user provided memory and the image
+ * in the requested colorspace is exactly the raw camera image, a buffer
+ * with one slot per camera buffer is created and given to the camera.
+ * Publishing an image then only requires to set the current slot,
+ * the image data is not copied.
+ * @param img_id image ID of the buffer
+ * @param cspace colorspace of the buffer
+ * @return shared memory image buffer
+ */
+SharedMemoryImageBuffer *
+FvAcquisitionThread::create_shm(const char *img_id, colorspace_t cspace)
+{
+  if ( (cspace != colorspace_) || zero_copy_shm_ ||
+       ! user_buffers_ || ! user_buffers_->supports_user_buffers() ||
+       (user_buffers_->user_buffer_size() != colorspace_buffer_size(cspace, width_, height_)) )
+  {
+    return new SharedMemoryImageBuffer(img_id, cspace, width_, height_);
+  }
+
+  MutexLocker lock(enabled_mutex_);
+  unsigned int num_slots = user_buffers_->num_user_buffers();
+  SharedMemoryImageBuffer *shm =
+    new SharedMemoryImageBuffer(img_id, cspace, width_, height_, num_slots);
+
+  unsigned char **slots = new unsigned char *[num_slots];
+  for (unsigned int i = 0; i < num_slots; ++i) {
+    slots[i] = shm->slot_buffer(i);
+  }
+
+  try {
+    // buffers can only be exchanged on a stopped camera
+    if (enabled_)  camera_->stop();
+    user_buffers_->set_user_buffers(slots, num_slots);
+    if (enabled_)  camera_->start();
+    zero_copy_shm_ = shm;
+    logger->log_info(name(), "Capturing directly into %u slots of %s",
+		     num_slots, img_id);
+  } catch (Exception &e) {
+    logger->log_warn(name(), "Failed to capture into shared memory, copying images");
+    logger->log_warn(name(), e);
+    if (enabled_)  camera_->start();
+    delete shm;
+    shm = new SharedMemoryImageBuffer(img_id, cspace, width_, height_);
+  }
+  delete[] slots;
+
+  return shm;
+}
+
+
 /** Get the Camera of this acquisition thread.
  * This is just used for the camera controls, if you want to access the camera,
  * use camera_instance()
@@ -332,9 +387,13 @@ FvAcquisitionThread::loop()
 	shmit_->second->lock_for_write();
 	tt_->ping_end(ttc_lock_);
 	tt_->ping_start(ttc_convert_);
-	convert(colorspace_, shmit_->first,
-		camera_->buffer(), shmit_->second->buffer(),
-		width_, height_);
+	if (shmit_->second == zero_copy_shm_) {
+	  shmit_->second->set_current_slot(user_buffers_->current_user_buffer());
+	} else {
+	  convert(colorspace_, shmit_->first,
+		  camera_->buffer(), shmit_->second->buffer(),
+		  width_, height_);
+	}
 	try {
 	  shmit_->second->set_capture_time(camera_->capture_time());
 	} catch (NotImplementedException &e) {
@@ -367,9 +426,13 @@ FvAcquisitionThread::loop()
       for (shmit_ = shm_.begin(); shmit_ != shm_.end(); ++shmit_) {
 	if (shmit_->first == CS_UNKNOWN)  continue;
 	shmit_->second->lock_for_write();
-	convert(colorspace_, shmit_->first,
-		camera_->buffer(), shmit_->second->buffer(),
-		width_, height_);
+	if (shmit_->second == zero_copy_shm_) {
+	  shmit_->second->set_current_slot(user_buffers_->current_user_buffer());
+	} else {
+	  convert(colorspace_, shmit_->first,
+		  camera_->buffer(), shmit_->second->buffer(),
+		  width_, height_);
+	}
 	try {
 	  shmit_->second->set_capture_time(camera_->capture_time());
 	} catch (NotImplementedException &e) {
@@ -46,6 +46,7 @@ namespace fawkes {
 }
 namespace firevision {
   class SharedMemoryImageBuffer;
+  class CameraUserBuffers;
 }
 class FvBaseThread;
 class FvAqtVisionThreads;
@@ -96,6 +97,8 @@ class FvAcquisitionThread
  private:
   virtual bool bb_interface_message_received(fawkes::Interface *interface,
                                              fawkes::Message *message) throw();
+  firevision::SharedMemoryImageBuffer * create_shm(const char *img_id,
+						   firevision::colorspace_t cspace);
 
  private:
   bool                      enabled_;
@@ -114,6 +117,9 @@ class FvAcquisitionThread
   std::map<firevision::colorspace_t, firevision::SharedMemoryImageBuffer *> shm_;
   std::map<firevision::colorspace_t, firevision::SharedMemoryImageBuffer *>::iterator shmit_;
 
+  firevision::CameraUserBuffers       *user_buffers_;
+  firevision::SharedMemoryImageBuffer *zero_copy_shm_;
+
   fawkes::SwitchInterface  *enabled_if_;
 
 #ifdef FVBASE_TIMETRACKER
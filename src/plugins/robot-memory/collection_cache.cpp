@@ -0,0 +1,513 @@
+/***************************************************************************
+ *  collection_cache.cpp - In-memory copy of a robot memory collection
+ *
+ *  Created: 4:12:53 PM 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#include "collection_cache.h"
+#include "event_trigger_manager.h"
+#include "computables/query_matcher.h"
+#include <core/threading/mutex.h>
+#include <core/threading/mutex_locker.h>
+#include <cstring>
+
+using namespace fawkes;
+using namespace mongo;
+
+/** @class CollectionCache  collection_cache.h
+ * In-memory copy of a collection to answer queries without the database.
+ * The cache loads all documents of the collection and keeps them up to
+ * date by tailing the oplog through an EventTrigger. Queries and
+ * aggregations the QueryMatcher can evaluate are answered from memory,
+ * equality conditions on configured top-level fields are looked up in an
+ * index instead of matching all documents.
+ *
+ * Changes from the oplog are applied in the RobotMemory loop. Writes
+ * through the RobotMemory mark the cache as outdated by calling written()
+ * and queries go to the database until the next loop has applied the
+ * oplog, therefore a query always sees the preceding writes of the robot
+ * memory. Changes by other clients become visible in the cache with the
+ * next loop. Dropping the collection is only noticed if done through the
+ * robot memory.
+ *
+ * Results are in the order the documents were inserted, updated documents
+ * keep their position. This matches the natural order of the database with
+ * the WiredTiger storage engine. Queries with sort order or other modifiers
+ * are passed to the database.
+ * @author agent
+ */
+
+/**
+ * Constructor, call reload() to load the collection.
+ * @param logger Logger
+ * @param collection db.collection to cache
+ * @param index_fields top-level fields to index for equality queries
+ * @param trigger_manager EventTriggerManager to tail the oplog
+ * @param mongodb_client client to load documents with
+ * @param mongodb_client_mutex mutex to lock while using @p mongodb_client
+ */
+CollectionCache::CollectionCache(Logger* logger, const std::string& collection,
+                                 const std::vector<std::string>& index_fields,
+                                 EventTriggerManager* trigger_manager,
+                                 DBClientBase* mongodb_client, Mutex* mongodb_client_mutex)
+: logger_(logger),
+  collection_(collection),
+  trigger_manager_(trigger_manager),
+  trigger_(NULL),
+  mongodb_client_(mongodb_client),
+  mongodb_client_mutex_(mongodb_client_mutex),
+  loaded_(false),
+  next_position_(0),
+  write_generation_(0),
+  synced_generation_(0),
+  reload_requested_(false),
+  hits_(0),
+  misses_(0)
+{
+  mutex_ = new Mutex();
+  for (const std::string& field : index_fields)
+  {
+    if (field.find('.') != std::string::npos || field[0] == '$')
+      logger_->log_warn(name.c_str(), "Cannot index field %s of %s, only top-level fields supported",
+                        field.c_str(), collection_.c_str());
+    else
+      indexes_[field];
+  }
+}
+
+CollectionCache::~CollectionCache()
+{
+  logger_->log_info(name.c_str(), "Cache of %s: %lu queries answered, %lu passed to database",
+                    collection_.c_str(), hits_.load(), misses_.load());
+  if (trigger_)
+    trigger_manager_->remove_trigger(trigger_);
+  delete mutex_;
+}
+
+/**
+ * Answer a query from the cache.
+ * @param query The query
+ * @param docs Vector to store the matching documents in
+ * @return true if the query was answered, false if it has to be passed to the database
+ */
+bool CollectionCache::query(const Query& query, std::vector<BSONObj>& docs)
+{
+  if (synced_generation_ != write_generation_ || query.isComplex())
+  {
+    misses_++;
+    return false;
+  }
+  MutexLocker lock(mutex_);
+  if (! loaded_ || ! find(query.getFilter(), docs))
+  {
+    misses_++;
+    return false;
+  }
+  hits_++;
+  return true;
+}
+
+/**
+ * Run an aggregation on the cache.
+ * Supported stages are $match with queries the QueryMatcher supports,
+ * $skip, $limit, and $facet with sub-pipelines of these stages.
+ * @param pipeline Series of aggregation stages
+ * @param docs Vector to store the resulting documents in
+ * @return true if the aggregation was answered, false if it has to be passed to the database
+ */
+bool CollectionCache::aggregate(const std::vector<BSONObj>& pipeline, std::vector<BSONObj>& docs)
+{
+  if (synced_generation_ != write_generation_ || pipeline.empty())
+  {
+    misses_++;
+    return false;
+  }
+  MutexLocker lock(mutex_);
+  bool ok = loaded_;
+  size_t first = 0;
+  if (ok && strcmp(pipeline[0].firstElementFieldName(), "$match") == 0 && pipeline[0].nFields() == 1)
+  {
+    //use indexes for the first stage
+    ok = pipeline[0].firstElement().type() == Object &&
+      find(pipeline[0].firstElement().embeddedObject(), docs);
+    first = 1;
+  }
+  else if (ok)
+  {
+    for (const auto& d : docs_)
+      docs.push_back(d.second);
+  }
+  for (size_t i = first; ok && i < pipeline.size(); ++i)
+    ok = apply_stage(pipeline[i], docs);
+
+  if (! ok)
+  {
+    docs.clear();
+    misses_++;
+    return false;
+  }
+  hits_++;
+  return true;
+}
+
+/**
+ * Notify about a write to the collection through the robot memory.
+ * The cache is not used until the next sync has applied the change.
+ * @param reload true to reload all documents on the next sync, necessary
+ * if the change is not reflected in the oplog of the collection (e.g. dropping it)
+ */
+void CollectionCache::written(bool reload)
+{
+  if (reload)
+    reload_requested_ = true;
+  write_generation_++;
+}
+
+/**
+ * Start synchronization, call before processing the oplog.
+ * @return write generation to pass to sync_end()
+ */
+unsigned long CollectionCache::sync_begin()
+{
+  return write_generation_;
+}
+
+/**
+ * Finish synchronization, call after processing the oplog.
+ * All writes that happened before sync_begin() are reflected in the cache afterwards.
+ * @param generation write generation returned by sync_begin()
+ */
+void CollectionCache::sync_end(unsigned long generation)
+{
+  if (reload_requested_.exchange(false))
+    reload();
+  synced_generation_ = generation;
+}
+
+/**
+ * Load all documents of the collection.
+ * The oplog is tailed from before loading, changes during loading are
+ * therefore not missed.
+ */
+void CollectionCache::reload()
+{
+  MutexLocker lock(mutex_);
+  docs_.clear();
+  positions_.clear();
+  next_position_ = 0;
+  for (auto& index : indexes_)
+    index.second.clear();
+  loaded_ = false;
+  try
+  {
+    if (trigger_)
+    {
+      trigger_manager_->remove_trigger(trigger_);
+      trigger_ = NULL;
+    }
+    trigger_ = trigger_manager_->register_trigger(Query(), collection_, &CollectionCache::apply_change, this);
+
+    MutexLocker client_lock(mongodb_client_mutex_);
+    std::unique_ptr<DBClientCursor> cursor = mongodb_client_->query(collection_, Query());
+    while (cursor->more())
+      add_doc(cursor->next());
+    loaded_ = true;
+  }
+  catch (DBException &e)
+  {
+    logger_->log_error(name.c_str(), "Failed to load %s: %s", collection_.c_str(), e.what());
+    reload_requested_ = true;
+  }
+}
+
+/**
+ * Get number of queries and aggregations answered from the cache.
+ * @return number of cache hits
+ */
+unsigned long CollectionCache::hits() const
+{
+  return hits_;
+}
+
+/**
+ * Get number of queries and aggregations passed to the database.
+ * @return number of cache misses
+ */
+unsigned long CollectionCache::misses() const
+{
+  return misses_;
+}
+
+void CollectionCache::apply_change(BSONObj change)
+{
+  std::string op = change.getStringField("op");
+  MutexLocker lock(mutex_);
+  if (op == "i")
+  {
+    add_doc(change.getObjectField("o"));
+  }
+  else if (op == "d")
+  {
+    remove_doc(value_key(change.getObjectField("o").getField("_id")));
+  }
+  else if (op == "u")
+  {
+    //updates may only contain modifiers, fetch the resulting document
+    BSONObjBuilder id_query;
+    id_query.appendAs(change.getObjectField("o2").getField("_id"), "_id");
+    BSONObj id = id_query.obj();
+    try
+    {
+      MutexLocker client_lock(mongodb_client_mutex_);
+      BSONObj doc = mongodb_client_->findOne(collection_, Query(id));
+      client_lock.unlock();
+      if (doc.isEmpty())
+        remove_doc(value_key(id.firstElement()));
+      else
+        add_doc(doc);
+    }
+    catch (DBException &e)
+    {
+      logger_->log_warn(name.c_str(), "Failed to fetch updated document, reloading %s: %s",
+                        collection_.c_str(), e.what());
+      loaded_ = false;
+      reload_requested_ = true;
+    }
+  }
+}
+
+void CollectionCache::add_doc(const BSONObj& doc)
+{
+  BSONObj owned = doc.getOwned();
+  std::string id = value_key(owned.getField("_id"));
+  //updated documents keep their position
+  unsigned long pos;
+  std::unordered_map<std::string, unsigned long>::iterator p = positions_.find(id);
+  if (p != positions_.end())
+  {
+    pos = p->second;
+    index_doc(pos, docs_[pos], false);
+  }
+  else
+  {
+    pos = next_position_++;
+    positions_[id] = pos;
+  }
+  docs_[pos] = owned;
+  index_doc(pos, owned, true);
+}
+
+void CollectionCache::remove_doc(const std::string& id)
+{
+  std::unordered_map<std::string, unsigned long>::iterator p = positions_.find(id);
+  if (p == positions_.end())
+    return;
+  std::map<unsigned long, BSONObj>::iterator d = docs_.find(p->second);
+  index_doc(d->first, d->second, false);
+  docs_.erase(d);
+  positions_.erase(p);
+}
+
+void CollectionCache::index_doc(unsigned long pos, const BSONObj& doc, bool add)
+{
+  for (auto& index : indexes_)
+  {
+    BSONElement e = doc.getField(index.first);
+    if (e.eoo())
+      continue;
+    std::vector<std::string> keys{value_key(e)};
+    //equality queries also match array members
+    if (e.type() == Array)
+    {
+      BSONObjIterator i(e.embeddedObject());
+      while (i.more())
+        keys.push_back(value_key(i.next()));
+    }
+    for (const std::string& key : keys)
+    {
+      if (add)
+      {
+        index.second[key].insert(pos);
+        continue;
+      }
+      auto positions = index.second.find(key);
+      if (positions == index.second.end())
+        continue;
+      positions->second.erase(pos);
+      if (positions->second.empty())
+        index.second.erase(positions);
+    }
+  }
+}
+
+bool CollectionCache::find(const BSONObj& filter, std::vector<BSONObj>& docs)
+{
+  QueryMatcher matcher(filter);
+  if (! matcher.supported())
+    return false;
+
+  //look for an equality condition on an indexed field
+  BSONObjIterator i(filter);
+  while (i.more())
+  {
+    BSONElement e = i.next();
+    auto index = indexes_.find(e.fieldName());
+    if (index == indexes_.end() || e.type() == Object || e.type() == Array ||
+        e.isNull() || e.type() == Undefined)
+      continue;
+    auto positions = index->second.find(value_key(e));
+    if (positions != index->second.end())
+    {
+      for (unsigned long pos : positions->second)
+      {
+        const BSONObj& doc = docs_[pos];
+        if (matcher.matches(doc))
+          docs.push_back(doc);
+      }
+    }
+    return true;
+  }
+
+  for (const auto& d : docs_)
+  {
+    if (matcher.matches(d.second))
+      docs.push_back(d.second);
+  }
+  return true;
+}
+
+bool CollectionCache::apply_stage(const BSONObj& stage, std::vector<BSONObj>& docs)
+{
+  if (stage.nFields() != 1)
+    return false;
+  BSONElement e = stage.firstElement();
+  const char *op = e.fieldName();
+  if (strcmp(op, "$match") == 0)
+  {
+    if (e.type() != Object)
+      return false;
+    QueryMatcher matcher(e.embeddedObject());
+    if (! matcher.supported())
+      return false;
+    std::vector<BSONObj> matching;
+    for (const BSONObj& doc : docs)
+    {
+      if (matcher.matches(doc))
+        matching.push_back(doc);
+    }
+    docs.swap(matching);
+  }
+  else if (strcmp(op, "$skip") == 0 || strcmp(op, "$limit") == 0)
+  {
+    if (! e.isNumber() || e.numberLong() < 0)
+      return false;
+    size_t n = std::min((size_t)e.numberLong(), docs.size());
+    if (op[1] == 's')
+      docs.erase(docs.begin(), docs.begin() + n);
+    else
+      docs.resize(n);
+  }
+  else if (strcmp(op, "$facet") == 0)
+  {
+    if (e.type() != Object)
+      return false;
+    BSONObjBuilder result;
+    BSONObjIterator f(e.embeddedObject());
+    while (f.more())
+    {
+      BSONElement facet = f.next();
+      if (facet.type() != Array)
+        return false;
+      std::vector<BSONObj> facet_docs(docs);
+      BSONObjIterator s(facet.embeddedObject());
+      while (s.more())
+      {
+        BSONElement sub_stage = s.next();
+        if (sub_stage.type() != Object || ! apply_stage(sub_stage.embeddedObject(), facet_docs))
+          return false;
+      }
+      BSONArrayBuilder facet_result;
+      for (const BSONObj& doc : facet_docs)
+        facet_result.append(doc);
+      result.appendArray(facet.fieldName(), facet_result.arr());
+    }
+    docs.clear();
+    docs.push_back(result.obj());
+  }
+  else
+  {
+    return false;
+  }
+  return true;
+}
+
+std::string CollectionCache::value_key(const BSONElement& value)
+{
+  //equal numbers of different types must get the same key
+  if (value.isNumber())
+  {
+    double d = value.numberDouble();
+    if (d == 0.)
+      d = 0.;
+    return std::string(1, 'N') + std::string((const char *)&d, sizeof(d));
+  }
+  return std::string(1, (char)value.canonicalType()) + std::string(value.value(), value.valuesize());
+}
+
+
+/** @class CachedQueryCursor  collection_cache.h
+ * Cursor over documents of a CollectionCache.
+ * Only more(), next(), and nextSafe() are supported.
+ * @author agent
+ */
+
+/**
+ * Constructor.
+ * @param mongodb_client client the collection belongs to
+ * @param collection db.collection
+ * @param docs result documents, the vector is emptied
+ */
+CachedQueryCursor::CachedQueryCursor(DBClientBase* mongodb_client, const std::string& collection,
+                                     std::vector<BSONObj>& docs)
+: DBClientCursor(mongodb_client, collection, 0, 0, 0),
+  next_(0)
+{
+  docs_.swap(docs);
+}
+
+CachedQueryCursor::~CachedQueryCursor()
+{
+}
+
+/**
+ * Check if more documents are available.
+ * @return true if next() returns another document
+ */
+bool CachedQueryCursor::more()
+{
+  return next_ < docs_.size();
+}
+
+/**
+ * Get next document.
+ * @return next document
+ */
+BSONObj CachedQueryCursor::next()
+{
+  uassert(13422, "DBClientCursor next() called but more() is false", more());
+  return docs_[next_++];
+}
@@ -0,0 +1,111 @@
+/***************************************************************************
+ *  collection_cache.h - In-memory copy of a robot memory collection
+ *
+ *  Created: 4:12:53 PM 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#ifndef FAWKES_SRC_PLUGINS_ROBOT_MEMORY_COLLECTION_CACHE_H_
+#define FAWKES_SRC_PLUGINS_ROBOT_MEMORY_COLLECTION_CACHE_H_
+
+#include <mongo/client/dbclient.h>
+#include <aspect/logging.h>
+#include <atomic>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace fawkes {
+  class Mutex;
+}
+
+class EventTrigger;
+class EventTriggerManager;
+
+class CollectionCache
+{
+  public:
+    CollectionCache(fawkes::Logger* logger, const std::string& collection,
+                    const std::vector<std::string>& index_fields,
+                    EventTriggerManager* trigger_manager,
+                    mongo::DBClientBase* mongodb_client, fawkes::Mutex* mongodb_client_mutex);
+    virtual ~CollectionCache();
+
+    bool query(const mongo::Query& query, std::vector<mongo::BSONObj>& docs);
+    bool aggregate(const std::vector<mongo::BSONObj>& pipeline, std::vector<mongo::BSONObj>& docs);
+
+    void written(bool reload = false);
+    unsigned long sync_begin();
+    void sync_end(unsigned long generation);
+    void reload();
+
+    unsigned long hits() const;
+    unsigned long misses() const;
+
+  private:
+    void apply_change(mongo::BSONObj change);
+    void add_doc(const mongo::BSONObj& doc);
+    void remove_doc(const std::string& id);
+    void index_doc(unsigned long pos, const mongo::BSONObj& doc, bool add);
+    bool find(const mongo::BSONObj& filter, std::vector<mongo::BSONObj>& docs);
+    bool apply_stage(const mongo::BSONObj& stage, std::vector<mongo::BSONObj>& docs);
+
+    static std::string value_key(const mongo::BSONElement& value);
+
+  private:
+    std::string name = "RobotMemory CollectionCache";
+    fawkes::Logger* logger_;
+    std::string collection_;
+    EventTriggerManager* trigger_manager_;
+    EventTrigger* trigger_;
+    mongo::DBClientBase* mongodb_client_;
+    fawkes::Mutex* mongodb_client_mutex_;
+    fawkes::Mutex* mutex_;
+
+    bool loaded_;
+    //documents in insertion order, by position
+    std::map<unsigned long, mongo::BSONObj> docs_;
+    //_id -> position of the document
+    std::unordered_map<std::string, unsigned long> positions_;
+    unsigned long next_position_;
+    //field -> value -> positions of documents with that value
+    std::map<std::string, std::unordered_map<std::string, std::set<unsigned long>>> indexes_;
+
+    std::atomic<unsigned long> write_generation_;
+    std::atomic<unsigned long> synced_generation_;
+    std::atomic<bool> reload_requested_;
+    std::atomic<unsigned long> hits_;
+    std::atomic<unsigned long> misses_;
+};
+
+class CachedQueryCursor : public mongo::DBClientCursor
+{
+  public:
+    CachedQueryCursor(mongo::DBClientBase* mongodb_client, const std::string& collection,
+                      std::vector<mongo::BSONObj>& docs);
+    virtual ~CachedQueryCursor();
+
+    virtual bool more();
+    virtual mongo::BSONObj next();
+
+  private:
+    std::vector<mongo::BSONObj> docs_;
+    size_t next_;
+};
+
+#endif /* FAWKES_SRC_PLUGINS_ROBOT_MEMORY_COLLECTION_CACHE_H_ */
@@ -39,6 +39,7 @@ using namespace mongo;
  * @param priority Computable priority ordering the evaluation
  */
 Computable::Computable(Query query_to_compute, std::string collection, const boost::function<std::list<BSONObj> (BSONObj, std::string)> &compute_function, double caching_time, int priority)
+: matcher(query_to_compute.getFilter())
 {
   this->compute_function = compute_function;
   this->query_to_compute = query_to_compute;
@@ -107,4 +108,11 @@ int Computable::get_priority()
   return priority;
 }
 
-
+/**
+ * Gets the matcher checking if a query invokes the computable
+ * @return Matcher for the query defining the computable
+ */
+const QueryMatcher & Computable::get_matcher() const
+{
+  return matcher;
+}
@@ -24,6 +24,7 @@
 
 #include <mongo/client/dbclient.h>
 #include <boost/function.hpp>
+#include "query_matcher.h"
 
 class Computable
 {
@@ -35,10 +36,12 @@ class Computable
     mongo::Query get_query();
     std::string get_collection();
     int get_priority();
+    const QueryMatcher & get_matcher() const;
 
   private:
     boost::function<std::list<mongo::BSONObj> (mongo::BSONObj, std::string)> compute_function;
     mongo::Query query_to_compute;
+    QueryMatcher matcher;
     std::string collection;
     int caching_time; //in milliseconds
     int priority;
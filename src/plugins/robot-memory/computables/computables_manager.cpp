@@ -88,25 +88,37 @@ void ComputablesManager::remove_computable(Computable* computable)
  */
 bool ComputablesManager::check_and_compute(mongo::Query query, std::string collection)
 {
-  //check if computation result of the query is already cached
-  for(std::map<std::tuple<std::string, std::string>, long long>::iterator it = cached_querries_.begin();
-      it != cached_querries_.end(); it++)
-  {
-    if(collection == std::get<0>(it->first) && query.toString() == std::get<1>(it->first))
-    {
-      return false;
-    }
-  }
   if(collection.find(matching_test_collection_) != std::string::npos)
     return false; //not necessary for matching test itself
+  BSONObj filter = query.getFilter();
+  //check if computation result of the query is already cached
+  std::string key = cache_key(filter, collection);
+  if(cached_querries_.find(key) != cached_querries_.end())
+    return false;
   bool added_computed_docs = false;
   //check if the query is matched by the computable identifyer
-  //to do that we just insert the query as if it would be a document and query for it with the computable identifiers
-  std::string current_test_collection = matching_test_collection_ + std::to_string(rand());
-  robot_memory_->insert(query.obj, current_test_collection);
+  //the query is treated as if it would be a document and matched with the computable identifiers.
+  //Identifiers not supported by the matcher are checked by inserting the query into a test collection
+  std::string current_test_collection;
   for(std::list<Computable*>::iterator it = computables.begin(); it != computables.end(); it++)
   {
-    if(collection == (*it)->get_collection() &&  robot_memory_->query((*it)->get_query(), current_test_collection)->more())
+    if(collection != (*it)->get_collection())
+      continue;
+    bool matches;
+    if((*it)->get_matcher().supported())
+    {
+      matches = (*it)->get_matcher().matches(filter);
+    }
+    else
+    {
+      if(current_test_collection.empty())
+      {
+        current_test_collection = matching_test_collection_ + std::to_string(rand());
+        robot_memory_->insert(filter, current_test_collection);
+      }
+      matches = robot_memory_->query((*it)->get_query(), current_test_collection)->more();
+    }
+    if(matches)
     {
       std::list<BSONObj> computed_docs_list = (*it)->compute(query.obj);
       if(! computed_docs_list.empty())
@@ -116,17 +128,30 @@ bool ComputablesManager::check_and_compute(mongo::Query query, std::string colle
           std::make_move_iterator(std::end(computed_docs_list))};
         //remember how long a query is cached:
         long long cached_until = computed_docs_vector[0].getField("_robmem_info").Obj().getField("cached_until").Long();
-        cached_querries_[std::make_tuple(collection, query.toString())] = cached_until;
-        //TODO: fix minor problem: equivalent queries in different order jield unequal strings
+        cached_querries_[key] = CachedQuery{collection, cached_until};
         robot_memory_->insert(computed_docs_vector, (*it)->get_collection());
         added_computed_docs = true;
       }
     }
   }
-  robot_memory_->drop_collection(current_test_collection);
+  if(! current_test_collection.empty())
+    robot_memory_->drop_collection(current_test_collection);
   return added_computed_docs;
 }
 
+/**
+ * Get key of a query in the cache.
+ * Equivalent queries only differing in the order of fields get the same key.
+ * @param query The query (without modifiers such as sorting)
+ * @param collection The collection that is querried
+ * @return cache key
+ */
+std::string ComputablesManager::cache_key(const mongo::BSONObj& query, const std::string& collection)
+{
+  BSONObj normalized = QueryMatcher::normalize(query);
+  return collection + '\0' + std::string(normalized.objdata(), normalized.objsize());
+}
+
 /**
  * Clean up all collections containing documents computed on demand
  */
@@ -135,14 +160,18 @@ void ComputablesManager::cleanup_computed_docs()
   long long current_time_ms =
           std::chrono::system_clock::now().time_since_epoch() /
           std::chrono::milliseconds(1);
-  for(std::map<std::tuple<std::string, std::string>, long long>::iterator it = cached_querries_.begin();
-        it != cached_querries_.end(); it++)
+  for(std::unordered_map<std::string, CachedQuery>::iterator it = cached_querries_.begin();
+        it != cached_querries_.end(); )
     {
-      if(current_time_ms > it->second)
+      if(current_time_ms > it->second.cached_until)
       {
         robot_memory_->remove(BSON("_robmem_info.computed" << true
-            << "_robmem_info.cached_until" << BSON("$lt" << current_time_ms)), std::get<0>(it->first));
-        cached_querries_.erase(it->first);
+            << "_robmem_info.cached_until" << BSON("$lt" << current_time_ms)), it->second.collection);
+        it = cached_querries_.erase(it);
+      }
+      else
+      {
+        it++;
       }
     }
 }
@@ -29,8 +29,7 @@
 #include "computable.h"
 #include <boost/bind.hpp>
 #include <utility>
-#include <map>
-#include <tuple>
+#include <unordered_map>
 
 //forward declaration
 class RobotMemory;
@@ -79,8 +78,16 @@ class ComputablesManager
 
     std::list<Computable*> computables;
     std::string matching_test_collection_;
-    //cached querries as ((collection, querry), cached_until)
-    std::map<std::tuple<std::string, std::string>, long long> cached_querries_;
+    /// @cond INTERNALS
+    typedef struct {
+      std::string collection;
+      long long cached_until;
+    } CachedQuery;
+    /// @endcond
+    //cached querries indexed by collection and normalized query
+    std::unordered_map<std::string, CachedQuery> cached_querries_;
+
+    static std::string cache_key(const mongo::BSONObj& query, const std::string& collection);
 };
 
 #endif /* FAWKES_SRC_PLUGINS_ROBOT_MEMORY_COMPUTABLES_COMPUTABLES_MANAGER_H_ */
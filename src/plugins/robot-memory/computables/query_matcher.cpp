@@ -0,0 +1,346 @@
+/***************************************************************************
+ *  query_matcher.cpp - Match documents against queries without a database
+ *
+ *  Created: 2:41:17 PM 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#include "query_matcher.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace mongo;
+
+/** @class QueryMatcher  query_matcher.h
+ * Matches documents against a MongoDB query in-process.
+ * This implements the subset of the MongoDB query language used to
+ * specify computables: equality (also on array members), dotted field
+ * paths, the comparison operators $eq, $ne, $gt, $gte, $lt, $lte, $in,
+ * $nin, $all, $exists, $size, and $not, and the logical operators $and,
+ * $or, and $nor. Queries using anything else, for example regular
+ * expressions, are not supported(), such queries must be evaluated by
+ * the database instead.
+ * @author agent
+ */
+
+/**
+ * Constructor.
+ * @param query query documents are matched against
+ */
+QueryMatcher::QueryMatcher(const BSONObj &query)
+: query(query.getOwned()),
+  query_supported(is_supported(this->query))
+{
+}
+
+QueryMatcher::~QueryMatcher()
+{
+}
+
+/**
+ * Check if the query can be evaluated by the matcher.
+ * @return true if matches() yields the same result as MongoDB
+ */
+bool QueryMatcher::supported() const
+{
+  return query_supported;
+}
+
+/**
+ * Check if a document matches the query.
+ * The result is only meaningful if the query is supported().
+ * @param doc document to check
+ * @return true if the document matches the query
+ */
+bool QueryMatcher::matches(const BSONObj &doc) const
+{
+  return matches_query(query, doc);
+}
+
+static BSONArray
+normalize_array(const BSONObj &array)
+{
+  BSONArrayBuilder b;
+  BSONObjIterator i(array);
+  while (i.more()) {
+    BSONElement e = i.next();
+    if (e.type() == Object) {
+      b.append(QueryMatcher::normalize(e.embeddedObject()));
+    } else if (e.type() == Array) {
+      b.append(normalize_array(e.embeddedObject()));
+    } else {
+      b.append(e);
+    }
+  }
+  return b.arr();
+}
+
+/**
+ * Get normalized representation of a query.
+ * Fields of (sub-)documents are sorted by name, therefore queries only
+ * differing in the order of their fields result in equal objects. The
+ * order of array elements is kept.
+ * @param query query to normalize
+ * @return normalized query
+ */
+BSONObj QueryMatcher::normalize(const BSONObj &query)
+{
+  std::vector<BSONElement> fields;
+  BSONObjIterator i(query);
+  while (i.more()) {
+    fields.push_back(i.next());
+  }
+  std::sort(fields.begin(), fields.end(),
+            [](const BSONElement &a, const BSONElement &b) {
+              return strcmp(a.fieldName(), b.fieldName()) < 0;
+            });
+
+  BSONObjBuilder b;
+  for (const BSONElement &e : fields) {
+    if (e.type() == Object) {
+      b.append(e.fieldName(), normalize(e.embeddedObject()));
+    } else if (e.type() == Array) {
+      b.appendArray(e.fieldName(), normalize_array(e.embeddedObject()));
+    } else {
+      b.append(e);
+    }
+  }
+  return b.obj();
+}
+
+bool QueryMatcher::is_operator_object(const BSONElement &cond)
+{
+  return cond.type() == Object && cond.embeddedObject().firstElementFieldName()[0] == '$';
+}
+
+bool QueryMatcher::is_supported(const BSONObj &query)
+{
+  BSONObjIterator i(query);
+  while (i.more()) {
+    BSONElement e = i.next();
+    const char *name = e.fieldName();
+    if (name[0] == '$') {
+      if (strcmp(name, "$and") != 0 && strcmp(name, "$or") != 0 && strcmp(name, "$nor") != 0)
+        return false;
+      if (e.type() != Array)
+        return false;
+      BSONObjIterator s(e.embeddedObject());
+      while (s.more()) {
+        BSONElement sub = s.next();
+        if (sub.type() != Object || ! is_supported(sub.embeddedObject()))
+          return false;
+      }
+    } else if (! is_supported_condition(e)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool QueryMatcher::is_supported_condition(const BSONElement &cond)
+{
+  if (cond.type() == RegEx)
+    return false;
+  if (! is_operator_object(cond))
+    return true;
+
+  BSONObjIterator i(cond.embeddedObject());
+  while (i.more()) {
+    BSONElement op = i.next();
+    const char *name = op.fieldName();
+    if (strcmp(name, "$eq") == 0 || strcmp(name, "$ne") == 0 ||
+        strcmp(name, "$gt") == 0 || strcmp(name, "$gte") == 0 ||
+        strcmp(name, "$lt") == 0 || strcmp(name, "$lte") == 0)
+    {
+      if (op.type() == RegEx)
+        return false;
+    } else if (strcmp(name, "$in") == 0 || strcmp(name, "$nin") == 0 ||
+               strcmp(name, "$all") == 0)
+    {
+      if (op.type() != Array)
+        return false;
+      BSONObjIterator a(op.embeddedObject());
+      while (a.more()) {
+        BSONElement v = a.next();
+        if (v.type() == RegEx || is_operator_object(v))
+          return false;
+      }
+    } else if (strcmp(name, "$size") == 0) {
+      if (! op.isNumber())
+        return false;
+    } else if (strcmp(name, "$not") == 0) {
+      if (! is_operator_object(op) || ! is_supported_condition(op))
+        return false;
+    } else if (strcmp(name, "$exists") != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool QueryMatcher::matches_query(const BSONObj &query, const BSONObj &doc)
+{
+  BSONObjIterator i(query);
+  while (i.more()) {
+    BSONElement e = i.next();
+    const char *name = e.fieldName();
+    if (strcmp(name, "$and") == 0 || strcmp(name, "$or") == 0 || strcmp(name, "$nor") == 0) {
+      bool is_and = (name[1] == 'a');
+      bool any = false, all = true;
+      BSONObjIterator s(e.embeddedObject());
+      while (s.more()) {
+        bool sub_matches = matches_query(s.next().embeddedObject(), doc);
+        any = any || sub_matches;
+        all = all && sub_matches;
+      }
+      if (is_and ? ! all : (name[1] == 'o' ? ! any : any))
+        return false;
+    } else {
+      std::vector<BSONElement> values;
+      collect_values(doc, name, values);
+      if (! matches_condition(e, values))
+        return false;
+    }
+  }
+  return true;
+}
+
+bool QueryMatcher::matches_condition(const BSONElement &cond, const std::vector<BSONElement> &values)
+{
+  //conditions hold if they hold for the value or any member of an array value
+  std::vector<BSONElement> candidates(values);
+  for (const BSONElement &v : values) {
+    if (v.type() == Array) {
+      BSONObjIterator i(v.embeddedObject());
+      while (i.more())
+        candidates.push_back(i.next());
+    }
+  }
+
+  if (! is_operator_object(cond))
+    return equals_any(cond, candidates) || (cond.isNull() && values.empty());
+
+  BSONObjIterator i(cond.embeddedObject());
+  while (i.more()) {
+    if (! matches_operator(i.next(), values, candidates))
+      return false;
+  }
+  return true;
+}
+
+bool QueryMatcher::matches_operator(const BSONElement &op, const std::vector<BSONElement> &values,
+                                    const std::vector<BSONElement> &candidates)
+{
+  const char *name = op.fieldName();
+  if (strcmp(name, "$eq") == 0) {
+    return equals_any(op, candidates) || (op.isNull() && values.empty());
+  } else if (strcmp(name, "$ne") == 0) {
+    return ! (equals_any(op, candidates) || (op.isNull() && values.empty()));
+  } else if (strcmp(name, "$gt") == 0) {
+    return compares_any(op, candidates, false, false);
+  } else if (strcmp(name, "$gte") == 0) {
+    return compares_any(op, candidates, false, true);
+  } else if (strcmp(name, "$lt") == 0) {
+    return compares_any(op, candidates, true, false);
+  } else if (strcmp(name, "$lte") == 0) {
+    return compares_any(op, candidates, true, true);
+  } else if (strcmp(name, "$in") == 0) {
+    return in_array(op, values, candidates);
+  } else if (strcmp(name, "$nin") == 0) {
+    return ! in_array(op, values, candidates);
+  } else if (strcmp(name, "$all") == 0) {
+    BSONObjIterator i(op.embeddedObject());
+    if (! i.more())
+      return false;
+    while (i.more()) {
+      if (! equals_any(i.next(), candidates))
+        return false;
+    }
+    return true;
+  } else if (strcmp(name, "$exists") == 0) {
+    return op.trueValue() == ! values.empty();
+  } else if (strcmp(name, "$size") == 0) {
+    for (const BSONElement &v : values) {
+      if (v.type() == Array && v.embeddedObject().nFields() == op.numberLong())
+        return true;
+    }
+    return false;
+  } else if (strcmp(name, "$not") == 0) {
+    return ! matches_condition(op, values);
+  }
+  return false;
+}
+
+bool QueryMatcher::in_array(const BSONElement &array, const std::vector<BSONElement> &values,
+                            const std::vector<BSONElement> &candidates)
+{
+  BSONObjIterator i(array.embeddedObject());
+  while (i.more()) {
+    BSONElement e = i.next();
+    if (equals_any(e, candidates) || (e.isNull() && values.empty()))
+      return true;
+  }
+  return false;
+}
+
+bool QueryMatcher::equals_any(const BSONElement &value, const std::vector<BSONElement> &values)
+{
+  for (const BSONElement &v : values) {
+    if (v.canonicalType() == value.canonicalType() && v.woCompare(value, false) == 0)
+      return true;
+  }
+  return false;
+}
+
+bool QueryMatcher::compares_any(const BSONElement &value, const std::vector<BSONElement> &values,
+                                bool less, bool equal)
+{
+  for (const BSONElement &v : values) {
+    //like MongoDB only compare values of the same type (e.g. numbers)
+    if (v.canonicalType() != value.canonicalType())
+      continue;
+    int c = v.woCompare(value, false);
+    if (c == 0 ? equal : (less ? c < 0 : c > 0))
+      return true;
+  }
+  return false;
+}
+
+void QueryMatcher::collect_values(const BSONObj &doc, const char *path,
+                                  std::vector<BSONElement> &values)
+{
+  const char *dot = strchr(path, '.');
+  if (! dot) {
+    BSONElement e = doc.getField(path);
+    if (! e.eoo())
+      values.push_back(e);
+    return;
+  }
+
+  BSONElement e = doc.getField(std::string(path, dot - path));
+  if (e.type() == Object) {
+    collect_values(e.embeddedObject(), dot + 1, values);
+  } else if (e.type() == Array) {
+    //positional access (e.g. a.0.b) or path into each array member
+    collect_values(e.embeddedObject(), dot + 1, values);
+    BSONObjIterator i(e.embeddedObject());
+    while (i.more()) {
+      BSONElement member = i.next();
+      if (member.type() == Object)
+        collect_values(member.embeddedObject(), dot + 1, values);
+    }
+  }
+}
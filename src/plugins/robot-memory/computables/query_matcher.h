@@ -0,0 +1,66 @@
+/***************************************************************************
+ *  query_matcher.h - Match documents against queries without a database
+ *
+ *  Created: 2:41:17 PM 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#ifndef FAWKES_SRC_PLUGINS_ROBOT_MEMORY_COMPUTABLES_QUERY_MATCHER_H_
+#define FAWKES_SRC_PLUGINS_ROBOT_MEMORY_COMPUTABLES_QUERY_MATCHER_H_
+
+#include <mongo/client/dbclient.h>
+#include <string>
+#include <vector>
+
+class QueryMatcher
+{
+  public:
+    QueryMatcher(const mongo::BSONObj &query);
+    virtual ~QueryMatcher();
+
+    bool supported() const;
+    bool matches(const mongo::BSONObj &doc) const;
+
+    static mongo::BSONObj normalize(const mongo::BSONObj &query);
+
+  private:
+    static bool is_supported(const mongo::BSONObj &query);
+    static bool is_supported_condition(const mongo::BSONElement &cond);
+    static bool is_operator_object(const mongo::BSONElement &cond);
+
+    static bool matches_query(const mongo::BSONObj &query, const mongo::BSONObj &doc);
+    static bool matches_condition(const mongo::BSONElement &cond,
+                                  const std::vector<mongo::BSONElement> &values);
+    static bool matches_operator(const mongo::BSONElement &op,
+                                 const std::vector<mongo::BSONElement> &values,
+                                 const std::vector<mongo::BSONElement> &candidates);
+    static bool in_array(const mongo::BSONElement &array,
+                         const std::vector<mongo::BSONElement> &values,
+                         const std::vector<mongo::BSONElement> &candidates);
+    static bool equals_any(const mongo::BSONElement &value,
+                           const std::vector<mongo::BSONElement> &values);
+    static bool compares_any(const mongo::BSONElement &value,
+                             const std::vector<mongo::BSONElement> &values,
+                             bool less, bool equal);
+    static void collect_values(const mongo::BSONObj &doc, const char *path,
+                               std::vector<mongo::BSONElement> &values);
+
+  private:
+    mongo::BSONObj query;
+    bool query_supported;
+};
+
+#endif /* FAWKES_SRC_PLUGINS_ROBOT_MEMORY_COMPUTABLES_QUERY_MATCHER_H_ */
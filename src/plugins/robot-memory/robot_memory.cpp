@@ -31,6 +31,7 @@
 #include <string>
 #include <chrono>
 #include <thread>
+#include <set>
 
 // from MongoDB
 #include <mongo/client/dbclient.h>
@@ -38,6 +39,23 @@
 using namespace mongo;
 using namespace fawkes;
 
+/// @cond INTERNALS
+/** Notify a collection cache about a write when leaving the scope. */
+class CacheWriteGuard
+{
+ public:
+  CacheWriteGuard(CollectionCache* cache, bool reload = false)
+  : cache_(cache), reload_(reload) {}
+  ~CacheWriteGuard()
+  {
+    if (cache_) cache_->written(reload_);
+  }
+ private:
+  CollectionCache* cache_;
+  bool reload_;
+};
+/// @endcond
+
 /** @class RobotMemory "robot_memory.h"
  * Access to the robot memory based on mongodb.
  * Using this class, you can query/insert/remove/update information in
@@ -74,6 +92,9 @@ RobotMemory::RobotMemory(fawkes::Configuration* config, fawkes::Logger* logger,
 
 RobotMemory::~RobotMemory()
 {
+  for (auto &c : caches_) {
+    delete c.second;
+  }
   mongo_connection_manager_->delete_client(mongodb_client_local_);
   mongo_connection_manager_->delete_client(mongodb_client_distributed_);
   delete mutex_;
@@ -147,12 +168,42 @@ void RobotMemory::init()
   trigger_manager_ = new EventTriggerManager(logger_, config_, mongo_connection_manager_);
   computables_manager_ = new ComputablesManager(logger_, config_, this, clock_);
 
+  //Setup caches of collections queried often
+  std::string cache_prefix = "/plugins/robot-memory/cache/";
+  std::set<std::string> cache_names;
+  std::unique_ptr<Configuration::ValueIterator> i(config_->search(cache_prefix.c_str()));
+  while (i->next()) {
+    std::string cache_name = std::string(i->path()).substr(cache_prefix.length());
+    cache_names.insert(cache_name.substr(0, cache_name.find("/")));
+  }
+  for (const std::string& cache_name : cache_names) {
+    std::string coll = check_collection_name(
+      config_->get_string((cache_prefix + cache_name + "/collection").c_str()));
+    std::vector<std::string> index_fields;
+    try {
+      index_fields = config_->get_strings((cache_prefix + cache_name + "/index-fields").c_str());
+    } catch (Exception &e) {} // ignored, no indexes
+    log("Caching collection " + coll);
+    CollectionCache* cache = new CollectionCache(logger_, coll, index_fields, trigger_manager_,
+                                                 get_mongodb_client(coll), mutex_);
+    cache->reload();
+    caches_[coll] = cache;
+  }
+
   log_deb("Initialized RobotMemory");
 }
 
 void RobotMemory::loop()
 {
+  std::vector<unsigned long> cache_generations;
+  for (auto &c : caches_) {
+    cache_generations.push_back(c.second->sync_begin());
+  }
   trigger_manager_->check_events();
+  size_t cache_index = 0;
+  for (auto &c : caches_) {
+    c.second->sync_end(cache_generations[cache_index++]);
+  }
   computables_manager_->cleanup_computed_docs();
 }
 
@@ -171,6 +222,15 @@ QResCursor RobotMemory::query(Query query, const std::string& collection)
   //check if computation on demand is necessary and execute Computables
   computables_manager_->check_and_compute(query, coll);
 
+  //answer from cache if possible
+  CollectionCache* cache = get_cache(coll);
+  if (cache) {
+    std::vector<BSONObj> docs;
+    if (cache->query(query, docs)) {
+      return QResCursor(new CachedQueryCursor(mongodb_client, coll, docs));
+    }
+  }
+
   //lock (mongo_client not thread safe)
   MutexLocker lock(mutex_);
 
@@ -207,6 +267,22 @@ RobotMemory::aggregate(const std::vector<mongo::BSONObj>& pipeline, const std::s
   // that might be complicated because you need to build a query to check against from the fields mentioned in the different parts of the pipeline
   // A possible solution might be forcing the user to define the $match oject seperately and using it as query to check computables
 
+  //answer from cache if possible
+  CollectionCache* cache = get_cache(coll);
+  if (cache) {
+    std::vector<BSONObj> docs;
+    if (cache->aggregate(pipeline, docs)) {
+      BSONArrayBuilder result;
+      for (const BSONObj& doc : docs) {
+        result.append(doc);
+      }
+      BSONObjBuilder b;
+      b.append("result", result.arr());
+      b.append("ok", 1.0);
+      return b.obj();
+    }
+  }
+
   //lock (mongo_client not thread safe)
   MutexLocker lock(mutex_);
 
@@ -242,6 +318,7 @@ int RobotMemory::insert(mongo::BSONObj obj, const std::string& collection)
 {
   check_collection_name(collection);
   mongo::DBClientBase* mongodb_client = get_mongodb_client(collection);
+  CacheWriteGuard cache_guard(get_cache(check_collection_name(collection)));
 
   log_deb(std::string("Inserting "+ obj.toString() + " into collection " + collection));
 
@@ -302,6 +379,7 @@ int RobotMemory::insert(std::vector<mongo::BSONObj> v_obj, const std::string& co
 {
   check_collection_name(collection);
   mongo::DBClientBase* mongodb_client = get_mongodb_client(collection);
+  CacheWriteGuard cache_guard(get_cache(check_collection_name(collection)));
 
   std::string insert_string = "[";
   for(BSONObj obj : v_obj)
@@ -351,6 +429,7 @@ int RobotMemory::update(mongo::Query query, mongo::BSONObj update, const std::st
 {
   check_collection_name(collection);
   mongo::DBClientBase* mongodb_client = get_mongodb_client(collection);
+  CacheWriteGuard cache_guard(get_cache(check_collection_name(collection)));
   log_deb(std::string("Executing Update "+update.toString()+" for query "+query.toString()+" on collection "+ collection));
 
   //lock (mongo_client not thread safe)
@@ -396,6 +475,7 @@ RobotMemory::find_one_and_update(const mongo::BSONObj& filter, const mongo::BSON
 {
   check_collection_name(collection);
   mongo::DBClientBase* mongodb_client = get_mongodb_client(collection);
+  CacheWriteGuard cache_guard(get_cache(check_collection_name(collection)));
 
   log_deb(std::string("Executing findOneAndUpdate "+update.toString()+
                       " for filter "+filter.toString()+" on collection "+ collection));
@@ -424,6 +504,7 @@ int RobotMemory::remove(mongo::Query query, const std::string& collection)
 {
   check_collection_name(collection);
   mongo::DBClientBase* mongodb_client = get_mongodb_client(collection);
+  CacheWriteGuard cache_guard(get_cache(check_collection_name(collection)));
   log_deb(std::string("Executing Remove "+query.toString()+" on collection "+collection));
 
   //lock (mongo_client not thread safe)
@@ -468,9 +549,24 @@ QResCursor RobotMemory::aggregate(mongo::BSONObj pipeline, const std::string& co
 {
   check_collection_name(collection);
   mongo::DBClientBase* mongodb_client = get_mongodb_client(collection);
-  MutexLocker lock(mutex_);
   log_deb(std::string("Executing Aggregation pipeline: "+pipeline.toString() +" on collection "+collection));
 
+  //answer from cache if possible
+  CollectionCache* cache = get_cache(check_collection_name(collection));
+  if (cache) {
+    std::vector<BSONObj> stages;
+    for (BSONObjIterator i(pipeline); i.more(); ) {
+      BSONElement e = i.next();
+      if (e.type() == Object) stages.push_back(e.Obj());
+    }
+    std::vector<BSONObj> docs;
+    if ((int)stages.size() == pipeline.nFields() && cache->aggregate(stages, docs)) {
+      return QResCursor(new CachedQueryCursor(mongodb_client, collection, docs));
+    }
+  }
+
+  MutexLocker lock(mutex_);
+
   QResCursor cursor;
   try{
     cursor = mongodb_client->aggregate(collection, pipeline);
@@ -492,6 +588,7 @@ int RobotMemory::drop_collection(const std::string& collection)
 {
   check_collection_name(collection);
   mongo::DBClientBase* mongodb_client = get_mongodb_client(collection);
+  CacheWriteGuard cache_guard(get_cache(check_collection_name(collection)), true);
   MutexLocker lock(mutex_);
   log_deb("Dropping collection " + collection);
   return mongodb_client->dropCollection(collection);
@@ -503,6 +600,14 @@ int RobotMemory::drop_collection(const std::string& collection)
  */
 int RobotMemory::clear_memory()
 {
+  std::vector<CacheWriteGuard> cache_guards;
+  cache_guards.reserve(caches_.size());
+  for (auto &c : caches_) {
+    if (EventTriggerManager::get_db_name(c.first) == database_name_) {
+      cache_guards.emplace_back(c.second, true);
+    }
+  }
+
   //lock (mongo_client not thread safe)
   MutexLocker lock(mutex_);
 
@@ -521,6 +626,7 @@ int RobotMemory::restore_collection(const std::string& collection, const std::st
 {
   std::string coll{std::move(check_collection_name(collection))};
   drop_collection(coll);
+  CacheWriteGuard cache_guard(get_cache(coll), true);
 
   //lock (mongo_client not thread safe)
    MutexLocker lock(mutex_);
@@ -763,6 +869,21 @@ RobotMemory::get_mongodb_client(const std::string& collection)
   return mongodb_client_local_;
 }
 
+/**
+ * Get the cache of a collection.
+ * @param collection The database and collection (e.g. robmem.worldmodel)
+ * @return cache or NULL if the collection is not cached
+ */
+CollectionCache*
+RobotMemory::get_cache(const std::string& collection)
+{
+  if (caches_.empty()) {
+    return NULL;
+  }
+  std::map<std::string, CollectionCache*>::iterator c = caches_.find(collection);
+  return c != caches_.end() ? c->second : NULL;
+}
+
 /**
  * Remove a previously registered trigger
  * @param trigger Pointer to the trigger to remove
@@ -32,6 +32,7 @@
 #include <mongo/client/dbclient.h>
 #include "event_trigger_manager.h"
 #include "computables/computables_manager.h"
+#include "collection_cache.h"
 
 namespace fawkes {
   class Mutex;
@@ -139,6 +140,8 @@ class RobotMemory
     }
     void remove_computable(Computable* computable);
 
+    CollectionCache* get_cache(const std::string& collection);
+
   private:
     fawkes::MongoDBConnCreator* mongo_connection_manager_;
     mongo::DBClientBase* mongodb_client_local_;
@@ -158,6 +161,7 @@ class RobotMemory
     EventTriggerManager* trigger_manager_;
     ComputablesManager* computables_manager_;
     std::vector<std::string> distributed_dbs_;
+    std::map<std::string, CollectionCache*> caches_;
 
     unsigned int cfg_startup_grace_period_;
     std::string  cfg_coord_database_;
@@ -304,6 +304,25 @@ TEST_F(RobotMemoryTest, ComputableCallAddition)
 }
 
 
+TEST_F(RobotMemoryTest, ComputableCallOperators)
+{
+  TestComputable* tc = new TestComputable();
+  Computable* comp = robot_memory->register_computable(fromjson(
+      "{compute:'sum',x:{$gte:0,$lt:100},y:{$in:[1,2,3]}}"), "robmem.test", &TestComputable::compute_sum, tc, 10.0);
+  QResCursor qres = robot_memory->query(fromjson("{y:2,compute:'sum',x:40}"), "robmem.test");
+  ASSERT_TRUE(qres->more());
+  ASSERT_TRUE(contains_pairs(qres->next(), fromjson("{sum:42}")));
+  //same query with different field order is cached and not computed again
+  qres = robot_memory->query(fromjson("{compute:'sum',x:40,y:2}"), "robmem.test");
+  ASSERT_TRUE(qres->more());
+  qres->next();
+  ASSERT_FALSE(qres->more());
+  qres = robot_memory->query(fromjson("{compute:'sum',x:200,y:2}"), "robmem.test");
+  ASSERT_FALSE(qres->more());
+  robot_memory->remove_computable(comp);
+}
+
+
 TEST_F(RobotMemoryTest, ComputableMultiple)
 {
   TestComputable* tc = new TestComputable();
@@ -371,3 +390,143 @@ TEST_F(RobotMemoryTest, TransformComputable)
   ASSERT_TRUE(fabs(0.1 - res.getField("translation").Array()[0].Double()) < 0.001);
   ASSERT_TRUE(fabs(-0.5 - res.getField("rotation").Array()[0].Double()) < 0.001);
 }
+
+/* The following tests need the collection robmem.cachetest to be cached
+ * with index field "tags", see gtest-robot-memory.yaml.
+ */
+
+TEST_F(RobotMemoryTest, CacheHitAfterSync)
+{
+  CollectionCache* cache = robot_memory->get_cache("robmem.cachetest");
+  ASSERT_FALSE(cache == NULL);
+  //start from an empty collection, it may not exist yet
+  robot_memory->drop_collection("robmem.cachetest");
+  ASSERT_TRUE(robot_memory->insert("{testname:'cache-hit', v:1}", "robmem.cachetest"));
+
+  //wait for robot memory to apply the oplog to the cache
+  usleep(1000000);
+
+  unsigned long hits = cache->hits();
+  QResCursor qres = robot_memory->query("{testname:'cache-hit'}", "robmem.cachetest");
+  ASSERT_EQ(hits + 1, cache->hits());
+  ASSERT_TRUE(qres->more());
+  ASSERT_TRUE(contains_pairs(qres->next(), fromjson("{testname:'cache-hit', v:1}")));
+  ASSERT_FALSE(qres->more());
+}
+
+TEST_F(RobotMemoryTest, CacheReadYourWrites)
+{
+  CollectionCache* cache = robot_memory->get_cache("robmem.cachetest");
+  ASSERT_FALSE(cache == NULL);
+  ASSERT_TRUE(robot_memory->insert("{testname:'cache-ryw', v:1}", "robmem.cachetest"));
+  usleep(1000000);
+
+  //queries right after a write go to the database and see the write
+  ASSERT_TRUE(robot_memory->update("{testname:'cache-ryw'}", "{testname:'cache-ryw', v:2}",
+                                   "robmem.cachetest"));
+  unsigned long misses = cache->misses();
+  QResCursor qres = robot_memory->query("{testname:'cache-ryw'}", "robmem.cachetest");
+  ASSERT_EQ(misses + 1, cache->misses());
+  ASSERT_TRUE(qres->more());
+  ASSERT_TRUE(contains_pairs(qres->next(), fromjson("{v:2}")));
+  ASSERT_FALSE(qres->more());
+
+  //after the sync the cache answers with the written document
+  usleep(1000000);
+  unsigned long hits = cache->hits();
+  qres = robot_memory->query("{testname:'cache-ryw'}", "robmem.cachetest");
+  ASSERT_EQ(hits + 1, cache->hits());
+  ASSERT_TRUE(qres->more());
+  ASSERT_TRUE(contains_pairs(qres->next(), fromjson("{v:2}")));
+  ASSERT_FALSE(qres->more());
+}
+
+TEST_F(RobotMemoryTest, CacheIndexArrayField)
+{
+  CollectionCache* cache = robot_memory->get_cache("robmem.cachetest");
+  ASSERT_FALSE(cache == NULL);
+  ASSERT_TRUE(robot_memory->insert("{testname:'cache-index', tags:['a', 'b'], v:1}",
+                                   "robmem.cachetest"));
+  ASSERT_TRUE(robot_memory->insert("{testname:'cache-index', tags:'b', v:2}", "robmem.cachetest"));
+  ASSERT_TRUE(robot_memory->insert("{testname:'cache-index', tags:['c'], v:3}", "robmem.cachetest"));
+  usleep(1000000);
+
+  unsigned long hits = cache->hits();
+  QResCursor qres = robot_memory->query("{tags:'b', testname:'cache-index'}", "robmem.cachetest");
+  ASSERT_EQ(hits + 1, cache->hits());
+  std::list<int> values = {1, 2};
+  while (qres->more()) {
+    int got = qres->next().getField("v").Int();
+    ASSERT_TRUE(std::find(values.begin(), values.end(), got) != values.end());
+    values.remove(got);
+  }
+  ASSERT_EQ(0, values.size());
+
+  qres = robot_memory->query("{tags:'c', testname:'cache-index'}", "robmem.cachetest");
+  ASSERT_TRUE(qres->more());
+  ASSERT_TRUE(contains_pairs(qres->next(), fromjson("{v:3}")));
+  ASSERT_FALSE(qres->more());
+}
+
+TEST_F(RobotMemoryTest, CacheNaturalOrder)
+{
+  CollectionCache* cache = robot_memory->get_cache("robmem.cachetest");
+  ASSERT_FALSE(cache == NULL);
+  ASSERT_TRUE(robot_memory->insert("{testname:'cache-order', tags:'o', v:1}", "robmem.cachetest"));
+  ASSERT_TRUE(robot_memory->insert("{testname:'cache-order', tags:'o', v:2}", "robmem.cachetest"));
+  ASSERT_TRUE(robot_memory->insert("{testname:'cache-order', tags:'o', v:3}", "robmem.cachetest"));
+  ASSERT_TRUE(robot_memory->update("{testname:'cache-order', v:1}",
+                                   "{testname:'cache-order', tags:'o', v:1, grown:'abcdefghij'}",
+                                   "robmem.cachetest"));
+  usleep(1000000);
+
+  //the updated document keeps its position, with and without index
+  for (std::string query : {"{testname:'cache-order'}", "{tags:'o', testname:'cache-order'}"}) {
+    unsigned long hits = cache->hits();
+    QResCursor qres = robot_memory->query(query, "robmem.cachetest");
+    ASSERT_EQ(hits + 1, cache->hits());
+    for (int v = 1; v <= 3; ++v) {
+      ASSERT_TRUE(qres->more());
+      ASSERT_EQ(v, qres->next().getField("v").Int());
+    }
+    ASSERT_FALSE(qres->more());
+  }
+
+  //queries with sort order are passed to the database
+  unsigned long misses = cache->misses();
+  QResCursor qres = robot_memory->query(Query(fromjson("{testname:'cache-order'}")).sort("v", -1),
+                                        "robmem.cachetest");
+  ASSERT_EQ(misses + 1, cache->misses());
+  ASSERT_TRUE(qres->more());
+  ASSERT_EQ(3, qres->next().getField("v").Int());
+}
+
+TEST_F(RobotMemoryTest, CacheReloadAfterDrop)
+{
+  CollectionCache* cache = robot_memory->get_cache("robmem.cachetest");
+  ASSERT_FALSE(cache == NULL);
+  ASSERT_TRUE(robot_memory->insert("{testname:'cache-drop', v:1}", "robmem.cachetest"));
+  usleep(1000000);
+  QResCursor qres = robot_memory->query("{testname:'cache-drop'}", "robmem.cachetest");
+  ASSERT_TRUE(qres->more());
+
+  //dropping is not in the oplog of the collection, the cache is reloaded
+  ASSERT_TRUE(robot_memory->drop_collection("robmem.cachetest"));
+  qres = robot_memory->query("{testname:'cache-drop'}", "robmem.cachetest");
+  ASSERT_FALSE(qres->more());
+  usleep(1000000);
+  unsigned long hits = cache->hits();
+  qres = robot_memory->query("{testname:'cache-drop'}", "robmem.cachetest");
+  ASSERT_EQ(hits + 1, cache->hits());
+  ASSERT_FALSE(qres->more());
+
+  //the reloaded cache follows the oplog again
+  ASSERT_TRUE(robot_memory->insert("{testname:'cache-drop', v:2}", "robmem.cachetest"));
+  usleep(1000000);
+  hits = cache->hits();
+  qres = robot_memory->query("{testname:'cache-drop'}", "robmem.cachetest");
+  ASSERT_EQ(hits + 1, cache->hits());
+  ASSERT_TRUE(qres->more());
+  ASSERT_TRUE(contains_pairs(qres->next(), fromjson("{v:2}")));
+  ASSERT_FALSE(qres->more());
+}
@@ -129,6 +129,10 @@ SkillerExecutionThread::init()
     lua_->set_finalization_calls("skiller.fawkes.finalize()",
                                   "skiller.fawkes.finalize_prepare()",
                                   "skiller.fawkes.finalize_cancel()");
+
+    lua_loop_ = lua_->add_entry_point("skillenv.loop");
+    lua_notify_reader_removed_ =
+      lua_->add_entry_point("skiller.fawkes.notify_reader_removed");
     
     lua_->set_start_script(LUADIR"/skiller/fawkes/start.lua");
 
@@ -231,10 +235,11 @@ SkillerExecutionThread::loop()
 
   skiller_if_removed_readers_.lock();
   while (! skiller_if_removed_readers_.empty()) {
-	  lua_->do_string("skiller.fawkes.notify_reader_removed(%u)", skiller_if_removed_readers_.front());
+	  lua_->push_integer(skiller_if_removed_readers_.front());
+	  lua_->call_entry_point(lua_notify_reader_removed_, 1);
 	  skiller_if_removed_readers_.pop();
   }
   skiller_if_removed_readers_.unlock();
 
-  lua_->do_string("skillenv.loop()");
+  lua_->call_entry_point(lua_loop_);
 }
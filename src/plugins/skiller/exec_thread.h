@@ -101,6 +101,8 @@ class SkillerExecutionThread
   fawkes::SkillerInterface      *skiller_if_;
 
   fawkes::LuaContext  *lua_;
+  unsigned int         lua_loop_;
+  unsigned int         lua_notify_reader_removed_;
 
   std::list<SkillerFeature *> features_;
 };
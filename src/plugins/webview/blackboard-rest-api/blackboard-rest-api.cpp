@@ -20,8 +20,11 @@
  */
 
 #include "blackboard-rest-api.h"
+#include "interface_stream_producer.h"
+#include "interface_stream_reply.h"
 
 #include <webview/rest_api_manager.h>
+#include <core/threading/mutex.h>
 #include <core/threading/mutex_locker.h>
 #include <utils/time/wait.h>
 
@@ -53,6 +56,34 @@ BlackboardRestApi::~BlackboardRestApi()
 void
 BlackboardRestApi::init()
 {
+	cfg_stream_max_rate_ = 10.;
+	try {
+		cfg_stream_max_rate_ = config->get_float("/webview/blackboard/stream-max-rate");
+	} catch (Exception &e) {} // ignored, use default
+	if (cfg_stream_max_rate_ <= 0.) {
+		throw Exception("Maximum stream rate must be larger than zero");
+	}
+	cfg_stream_max_clients_ = 4;
+	try {
+		cfg_stream_max_clients_ = config->get_uint("/webview/blackboard/stream-max-clients");
+	} catch (Exception &e) {} // ignored, use default
+	// a stream blocks a thread of the web server until it ends, keep one
+	// thread for other requests, without thread pool it would block all
+	unsigned int max_clients = 0;
+	try {
+		if (config->get_bool("/webview/thread-pool/enable")) {
+			unsigned int num_threads = config->get_uint("/webview/thread-pool/num-threads");
+			if (num_threads > 0)  max_clients = num_threads - 1;
+		}
+	} catch (Exception &e) {} // ignored, no thread pool
+	if (cfg_stream_max_clients_ > max_clients) {
+		logger->log_warn(name(), "Limiting blackboard streams to %u, web server has too few threads",
+		                 max_clients);
+		cfg_stream_max_clients_ = max_clients;
+	}
+	num_streams_ = std::make_shared<std::atomic<unsigned int>>(0);
+	stream_producers_mutex_ = new Mutex();
+
 	rest_api_ = new WebviewRestApi("blackboard", logger);
 	rest_api_->add_handler<WebviewRestArray<::InterfaceInfo>>
 		(WebRequest::METHOD_GET, "/interfaces",
@@ -66,6 +97,8 @@ BlackboardRestApi::init()
 	rest_api_->add_handler<BlackboardGraph>
 		(WebRequest::METHOD_GET, "/graph",
 		 std::bind(&BlackboardRestApi::cb_get_graph, this));
+	rest_api_->add_handler(WebRequest::METHOD_GET, "/stream",
+		 std::bind(&BlackboardRestApi::cb_stream_interfaces, this, std::placeholders::_1));
 	webview_rest_api_manager->register_api(rest_api_);
 }
 
@@ -74,6 +107,16 @@ BlackboardRestApi::finalize()
 {
 	webview_rest_api_manager->unregister_api(rest_api_);
 	delete rest_api_;
+
+	// end streams still open, they may outlive the plugin
+	stream_producers_mutex_->lock();
+	for (auto &p : stream_producers_) {
+		std::shared_ptr<WebviewInterfaceStreamProducer> producer = p.second.lock();
+		if (producer)  producer->close();
+	}
+	stream_producers_.clear();
+	stream_producers_mutex_->unlock();
+	delete stream_producers_mutex_;
 }
 
 
@@ -440,3 +483,98 @@ BlackboardRestApi::cb_get_graph()
 		                           e.what_no_backtrace());
 	}
 }
+
+
+/** Get producer for an interface data stream.
+ * Producers are shared among all streams of the same interface and
+ * released with the last stream.
+ * @param ii interface to get producer for
+ * @return stream producer
+ */
+std::shared_ptr<WebviewInterfaceStreamProducer>
+BlackboardRestApi::get_stream_producer(const fawkes::InterfaceInfo &ii)
+{
+	MutexLocker lock(stream_producers_mutex_);
+	// forget producers released since
+	for (auto p = stream_producers_.begin(); p != stream_producers_.end(); ) {
+		if (p->second.expired()) {
+			p = stream_producers_.erase(p);
+		} else {
+			++p;
+		}
+	}
+
+	std::string uid = std::string(ii.type()) + "::" + ii.id();
+	std::shared_ptr<WebviewInterfaceStreamProducer> producer = stream_producers_[uid].lock();
+	if (! producer) {
+		producer =
+			std::make_shared<WebviewInterfaceStreamProducer>
+			(blackboard, ii.type(), ii.id(),
+			 [](Interface *iface) { return gen_interface_data(iface, false).to_json(false); });
+		stream_producers_[uid] = producer;
+	}
+	return producer;
+}
+
+
+std::unique_ptr<WebReply>
+BlackboardRestApi::cb_stream_interfaces(WebviewRestParams& params)
+{
+	// refuse early, before opening interfaces, counted when the reply is created
+	if (*num_streams_ >= cfg_stream_max_clients_) {
+		throw WebviewRestException(WebReply::HTTP_SERVICE_UNAVAILABLE,
+		                           "Too many streams, at most %u allowed", cfg_stream_max_clients_);
+	}
+
+	// comma-separated list of type::id patterns, e.g. Position3DInterface::*
+	std::vector<std::string> patterns = str_split(params.query_arg("interfaces"), ',');
+	if (patterns.empty()) {
+		throw WebviewRestException(WebReply::HTTP_BAD_REQUEST,
+		                           "No interfaces given, pass interfaces=type::id[,...]");
+	}
+
+	float rate = cfg_stream_max_rate_;
+	if (params.has_query_arg("rate")) {
+		try {
+			rate = std::min(std::stof(params.query_arg("rate")), cfg_stream_max_rate_);
+		} catch (std::exception &e) {
+			throw WebviewRestException(WebReply::HTTP_BAD_REQUEST, "Invalid rate '%s'",
+			                           params.query_arg("rate").c_str());
+		}
+		if (rate <= 0.) {
+			throw WebviewRestException(WebReply::HTTP_BAD_REQUEST, "Rate must be larger than zero");
+		}
+	}
+
+	std::vector<std::shared_ptr<WebviewInterfaceStreamProducer>> producers;
+	std::set<std::string> uids;
+	for (const std::string &p : patterns) {
+		std::string::size_type sep = p.find("::");
+		if (sep == std::string::npos) {
+			throw WebviewRestException(WebReply::HTTP_BAD_REQUEST,
+			                           "Invalid interface '%s', must be type::id", p.c_str());
+		}
+		std::unique_ptr<InterfaceInfoList> ifls
+			{blackboard->list(p.substr(0, sep).c_str(), p.substr(sep + 2).c_str())};
+		for (const auto &ii : *ifls) {
+			std::string uid = std::string(ii.type()) + "::" + ii.id();
+			if (! uids.insert(uid).second)  continue;
+			try {
+				producers.push_back(get_stream_producer(ii));
+			} catch (Exception &e) {
+				throw WebviewRestException(WebReply::HTTP_NOT_FOUND, "Failed to open %s: %s",
+				                           uid.c_str(), e.what_no_backtrace());
+			}
+		}
+	}
+	if (producers.empty()) {
+		throw WebviewRestException(WebReply::HTTP_NOT_FOUND, "No matching interfaces");
+	}
+
+	if (num_streams_->fetch_add(1) >= cfg_stream_max_clients_) {
+		num_streams_->fetch_sub(1);
+		throw WebviewRestException(WebReply::HTTP_SERVICE_UNAVAILABLE,
+		                           "Too many streams, at most %u allowed", cfg_stream_max_clients_);
+	}
+	return std::make_unique<DynamicInterfaceStreamWebReply>(producers, rate, num_streams_);
+}
@@ -23,6 +23,7 @@
 
 #include <core/threading/thread.h>
 #include <aspect/clock.h>
+#include <aspect/configurable.h>
 #include <aspect/logging.h>
 #include <aspect/webview.h>
 #include <aspect/blackboard.h>
@@ -36,13 +37,21 @@
 #include "model/InterfaceData.h"
 #include "model/BlackboardGraph.h"
 
+#include <atomic>
 #include <map>
+#include <memory>
 #include <string>
 #include <utility>
 
+namespace fawkes {
+	class Mutex;
+	class WebviewInterfaceStreamProducer;
+}
+
 class BlackboardRestApi
 : public fawkes::Thread,
 	public fawkes::ClockAspect,
+	public fawkes::ConfigurableAspect,
   public fawkes::LoggingAspect,
 	public fawkes::BlackBoardAspect,
 	public fawkes::WebviewAspect
@@ -66,12 +75,18 @@ class BlackboardRestApi
 
 	BlackboardGraph cb_get_graph();
 
+	std::unique_ptr<fawkes::WebReply>
+		cb_stream_interfaces(fawkes::WebviewRestParams& params);
+
+	std::shared_ptr<fawkes::WebviewInterfaceStreamProducer>
+		get_stream_producer(const fawkes::InterfaceInfo &ii);
+
 	std::vector<std::shared_ptr<InterfaceFieldType>>
 		gen_fields(fawkes::InterfaceFieldIterator begin,
 		           fawkes::InterfaceFieldIterator end);
 
 	InterfaceInfo gen_interface_info(const fawkes::InterfaceInfo &ii);
-	InterfaceData gen_interface_data(fawkes::Interface *iface, bool pretty);
+	static InterfaceData gen_interface_data(fawkes::Interface *iface, bool pretty);
 
 	std::string generate_graph(const std::string& for_owner = "");
 
@@ -81,6 +96,11 @@ class BlackboardRestApi
 	std::map<std::string, std::pair<std::vector<std::shared_ptr<InterfaceFieldType>>,
 	                                std::vector<std::shared_ptr<InterfaceMessageType>>>>
 		type_info_cache_;
-	
+
+	float                                                               cfg_stream_max_rate_;
+	unsigned int                                                        cfg_stream_max_clients_;
+	std::shared_ptr<std::atomic<unsigned int>>                          num_streams_;
+	fawkes::Mutex                                                      *stream_producers_mutex_;
+	std::map<std::string, std::weak_ptr<fawkes::WebviewInterfaceStreamProducer>> stream_producers_;
 
 };
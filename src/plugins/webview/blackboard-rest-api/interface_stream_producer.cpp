@@ -0,0 +1,175 @@
+/***************************************************************************
+ *  interface_stream_producer.cpp - Blackboard interface change stream producer
+ *
+ *  Created: Sun Oct 18 16:04:12 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#include "interface_stream_producer.h"
+
+#include <blackboard/blackboard.h>
+#include <core/threading/mutex.h>
+#include <core/threading/mutex_locker.h>
+#include <core/exception.h>
+#include <interface/interface.h>
+
+namespace fawkes {
+
+/** @class WebviewInterfaceStreamProducer "interface_stream_producer.h"
+ * Blackboard interface change stream producer.
+ * The producer listens for data changes of one interface and notifies
+ * its subscribers. The data is only serialized when a subscriber asks
+ * for it, and only once per data revision, all subscribers receive the
+ * very same string.
+ * @author agent
+ */
+
+/** @class WebviewInterfaceStreamProducer::Subscriber "interface_stream_producer.h"
+ * Interface change stream subscriber.
+ * @author agent
+ */
+
+/** Destructor. */
+WebviewInterfaceStreamProducer::Subscriber::~Subscriber()
+{
+}
+
+
+/** Constructor.
+ * @param blackboard blackboard to open interface from
+ * @param type type of interface to stream
+ * @param id ID of interface to stream
+ * @param serializer function to convert the interface data to a string,
+ * for example a JSON document, which must not contain newlines
+ */
+WebviewInterfaceStreamProducer::WebviewInterfaceStreamProducer(BlackBoard *blackboard,
+                                                               const char *type,
+                                                               const char *id,
+                                                               Serializer serializer)
+	: BlackBoardInterfaceListener("WebviewInterfaceStream-%s::%s", type, id),
+	  blackboard_(blackboard), serializer_(serializer)
+{
+	interface_ = blackboard_->open_for_reading(type, id);
+	revision_       = 1;
+	event_revision_ = 0;
+	event_mutex_    = new Mutex();
+
+	bbil_add_data_interface(interface_);
+	blackboard_->register_listener(this, BlackBoard::BBIL_FLAG_DATA);
+}
+
+
+/** Destructor. */
+WebviewInterfaceStreamProducer::~WebviewInterfaceStreamProducer()
+{
+	close();
+	delete event_mutex_;
+}
+
+
+/** Add a subscriber.
+ * @param subscriber subscriber to notify on changes
+ */
+void
+WebviewInterfaceStreamProducer::add_subscriber(Subscriber *subscriber)
+{
+	subs_.push_back_locked(subscriber);
+}
+
+
+/** Remove a subscriber.
+ * @param subscriber subscriber to remove
+ */
+void
+WebviewInterfaceStreamProducer::remove_subscriber(Subscriber *subscriber)
+{
+	subs_.remove_locked(subscriber);
+}
+
+
+/** Close the stream.
+ * The interface is closed and the subscribers are notified, they should
+ * end their stream once they notice that the producer is closed().
+ * Call this before the thread providing the serializer is finalized.
+ */
+void
+WebviewInterfaceStreamProducer::close()
+{
+	event_mutex_->lock();
+	if (! interface_) {
+		event_mutex_->unlock();
+		return;
+	}
+	blackboard_->unregister_listener(this);
+	blackboard_->close(interface_);
+	interface_ = NULL;
+	event_mutex_->unlock();
+
+	MutexLocker lock(subs_.mutex());
+	for (Subscriber *s : subs_) {
+		s->interface_changed(this);
+	}
+}
+
+
+/** Check if the stream has been closed.
+ * @return true if close() has been called, false otherwise
+ */
+bool
+WebviewInterfaceStreamProducer::closed()
+{
+	MutexLocker lock(event_mutex_);
+	return interface_ == NULL;
+}
+
+
+/** Get server-sent event for the current interface data.
+ * The event is generated on the first call after the data changed and
+ * shared with all later callers until the next change.
+ * @return event with the serialized interface data
+ * @exception Exception thrown if the stream has been closed
+ */
+std::shared_ptr<const std::string>
+WebviewInterfaceStreamProducer::event()
+{
+	MutexLocker lock(event_mutex_);
+	if (! interface_) {
+		throw Exception("Interface stream has been closed");
+	}
+	// fetch revision before reading, a change after reading is
+	// announced to the subscribers again
+	unsigned int revision = revision_;
+	if (! event_ || event_revision_ != revision) {
+		interface_->read();
+		event_ = std::make_shared<const std::string>("data: " + serializer_(interface_) + "\n\n");
+		event_revision_ = revision;
+	}
+	return event_;
+}
+
+
+void
+WebviewInterfaceStreamProducer::bb_interface_data_changed(Interface *interface) throw()
+{
+	++revision_;
+
+	MutexLocker lock(subs_.mutex());
+	for (Subscriber *s : subs_) {
+		s->interface_changed(this);
+	}
+}
+
+} // end namespace fawkes
@@ -0,0 +1,85 @@
+/***************************************************************************
+ *  interface_stream_producer.h - Blackboard interface change stream producer
+ *
+ *  Created: Sun Oct 18 16:02:31 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#pragma once
+
+#include <blackboard/interface_listener.h>
+#include <core/utils/lock_list.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace fawkes {
+
+class BlackBoard;
+class Interface;
+class Mutex;
+
+class WebviewInterfaceStreamProducer
+: public fawkes::BlackBoardInterfaceListener
+{
+ public:
+	/** Function to serialize the current interface data. */
+	typedef std::function<std::string (Interface *)> Serializer;
+
+	class Subscriber {
+	 public:
+		virtual ~Subscriber();
+		/** Notification that the interface data has changed.
+		 * Called in the thread of the interface writer, must be cheap.
+		 * @param producer producer whose interface has changed
+		 */
+		virtual void interface_changed(WebviewInterfaceStreamProducer *producer) = 0;
+	};
+
+ public:
+	WebviewInterfaceStreamProducer(BlackBoard *blackboard,
+	                               const char *type, const char *id,
+	                               Serializer serializer);
+	virtual ~WebviewInterfaceStreamProducer();
+
+	void add_subscriber(Subscriber *subscriber);
+	void remove_subscriber(Subscriber *subscriber);
+
+	std::shared_ptr<const std::string> event();
+
+	void close();
+	bool closed();
+
+	// for BlackBoardInterfaceListener
+	virtual void bb_interface_data_changed(Interface *interface) throw();
+
+ private:
+	BlackBoard *blackboard_;
+	Interface  *interface_;
+	Serializer  serializer_;
+
+	std::atomic<unsigned int> revision_;
+
+	fawkes::Mutex                     *event_mutex_;
+	std::shared_ptr<const std::string> event_;
+	unsigned int                       event_revision_;
+
+	fawkes::LockList<Subscriber *> subs_;
+};
+
+} // end namespace fawkes
@@ -0,0 +1,164 @@
+/***************************************************************************
+ *  interface_stream_reply.cpp - Web request blackboard event stream reply
+ *
+ *  Created: Sun Oct 18 16:23:05 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#include "interface_stream_reply.h"
+
+#include <core/threading/mutex.h>
+#include <core/threading/mutex_locker.h>
+#include <core/threading/wait_condition.h>
+#include <core/exception.h>
+
+#include <algorithm>
+#include <unistd.h>
+#include <cstring>
+
+/// Seconds after which a comment is sent if nothing changed.
+#define KEEPALIVE_INTERVAL_SEC 15
+
+namespace fawkes {
+
+/** @class DynamicInterfaceStreamWebReply "interface_stream_reply.h"
+ * Server-sent events stream of blackboard interface data.
+ * The reply is an endless text/event-stream, each event carries the data
+ * of one interface. Initially the current data of all subscribed
+ * interfaces is sent, afterwards only the data of interfaces that
+ * changed. Events are sent at most with the given rate, changes in
+ * between are coalesced and only the latest data is sent. If nothing
+ * changes for a while a comment is sent to detect closed connections.
+ * The stream ends once one of the producers has been closed.
+ * @author agent
+ */
+
+/** Constructor.
+ * @param producers producers of interfaces to stream
+ * @param max_rate maximum number of updates per second
+ * @param num_streams counter of open streams, the caller has already
+ * counted this stream, it is decremented when the reply is destroyed
+ */
+DynamicInterfaceStreamWebReply::DynamicInterfaceStreamWebReply
+  (std::vector<std::shared_ptr<WebviewInterfaceStreamProducer>> producers, float max_rate,
+   std::shared_ptr<std::atomic<unsigned int>> num_streams)
+	: DynamicWebReply(WebReply::HTTP_OK), producers_(producers),
+	  min_interval_(1.f / max_rate), num_streams_(num_streams),
+	  closed_(false), event_bytes_written_(0), last_sent_(0, 0)
+{
+	changed_mutex_    = new fawkes::Mutex();
+	changed_waitcond_ = new fawkes::WaitCondition(changed_mutex_);
+
+	add_header("Content-type", "text/event-stream");
+	add_header("Cache-Control", "no-cache");
+
+	for (auto &p : producers_) {
+		changed_.insert(&*p);
+		p->add_subscriber(this);
+	}
+}
+
+/** Destructor. */
+DynamicInterfaceStreamWebReply::~DynamicInterfaceStreamWebReply()
+{
+	for (auto &p : producers_) {
+		p->remove_subscriber(this);
+	}
+	delete changed_waitcond_;
+	delete changed_mutex_;
+	num_streams_->fetch_sub(1);
+}
+
+size_t
+DynamicInterfaceStreamWebReply::size()
+{
+	return -1;
+}
+
+void
+DynamicInterfaceStreamWebReply::interface_changed(WebviewInterfaceStreamProducer *producer)
+{
+	MutexLocker lock(changed_mutex_);
+	changed_.insert(producer);
+	changed_waitcond_->wake_all();
+}
+
+void
+DynamicInterfaceStreamWebReply::wait_for_events()
+{
+	// cap the rate, changes meanwhile are coalesced
+	fawkes::Time now;
+	now.stamp_systime();
+	float since_last = now - &last_sent_;
+	if (since_last < min_interval_) {
+		usleep((useconds_t)((min_interval_ - since_last) * 1000000.));
+	}
+
+	std::set<WebviewInterfaceStreamProducer *> changed;
+	changed_mutex_->lock();
+	while (changed_.empty()) {
+		if (! changed_waitcond_->reltimed_wait(KEEPALIVE_INTERVAL_SEC, 0) && changed_.empty()) {
+			break;
+		}
+	}
+	changed.swap(changed_);
+	changed_mutex_->unlock();
+
+	if (changed.empty()) {
+		static const auto keepalive = std::make_shared<const std::string>(":\n\n");
+		events_.push_back(keepalive);
+	} else {
+		for (WebviewInterfaceStreamProducer *p : changed) {
+			try {
+				events_.push_back(p->event());
+			} catch (Exception &e) {
+				// end the stream if closed, otherwise ignored, interface could not be read
+				if (p->closed())  closed_ = true;
+			}
+		}
+	}
+	last_sent_.stamp_systime();
+}
+
+size_t
+DynamicInterfaceStreamWebReply::next_chunk(size_t pos, char *buffer, size_t buf_max_size)
+{
+	if (buf_max_size == 0)  return 0;
+
+	while (events_.empty()) {
+		if (closed_)  return -1; // end of stream
+		wait_for_events();
+	}
+
+	size_t written = 0;
+	while (! events_.empty() && written < buf_max_size) {
+		const std::string &event = *events_.front();
+		size_t remaining = event.size() - event_bytes_written_;
+		size_t n = std::min(remaining, buf_max_size - written);
+		memcpy(buffer + written, event.data() + event_bytes_written_, n);
+		written += n;
+		if (n == remaining) {
+			events_.pop_front();
+			event_bytes_written_ = 0;
+		} else {
+			event_bytes_written_ += n;
+		}
+	}
+
+	return written;
+}
+
+} // end namespace fawkes
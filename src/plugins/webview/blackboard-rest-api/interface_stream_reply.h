@@ -0,0 +1,73 @@
+/***************************************************************************
+ *  interface_stream_reply.h - Web request blackboard event stream reply
+ *
+ *  Created: Sun Oct 18 16:21:48 2026
+ *  Copyright  2026  agent
+ ****************************************************************************/
+
+/*  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  Read the full text in the LICENSE.GPL file in the doc directory.
+ */
+
+#pragma once
+
+#include "interface_stream_producer.h"
+
+#include <webview/reply.h>
+#include <utils/time/time.h>
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace fawkes {
+
+class Mutex;
+class WaitCondition;
+
+class DynamicInterfaceStreamWebReply
+: public DynamicWebReply,
+  public WebviewInterfaceStreamProducer::Subscriber
+{
+ public:
+	DynamicInterfaceStreamWebReply(std::vector<std::shared_ptr<WebviewInterfaceStreamProducer>> producers,
+	                               float max_rate,
+	                               std::shared_ptr<std::atomic<unsigned int>> num_streams);
+	virtual ~DynamicInterfaceStreamWebReply();
+
+	virtual size_t size();
+	virtual size_t next_chunk(size_t pos, char *buffer, size_t buf_max_size);
+
+	virtual void interface_changed(WebviewInterfaceStreamProducer *producer);
+
+ private:
+	void wait_for_events();
+
+ private:
+	std::vector<std::shared_ptr<WebviewInterfaceStreamProducer>> producers_;
+	float min_interval_;
+	std::shared_ptr<std::atomic<unsigned int>> num_streams_;
+
+	fawkes::Mutex                             *changed_mutex_;
+	fawkes::WaitCondition                     *changed_waitcond_;
+	std::set<WebviewInterfaceStreamProducer *> changed_;
+
+	bool                                           closed_;
+	std::deque<std::shared_ptr<const std::string>> events_;
+	size_t                                         event_bytes_written_;
+	fawkes::Time                                   last_sent_;
+};
+
+} // end namespace fawkes